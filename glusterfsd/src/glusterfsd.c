@@ -199,6 +199,11 @@ static struct argp_option gf_options[] = {
      "Enables thin mount and connects via gfproxyd daemon"},
     {"global-threading", ARGP_GLOBAL_THREADING_KEY, "BOOL", OPTION_ARG_OPTIONAL,
      "Use the global thread pool instead of io-threads"},
+    {"iobuf-hugepages", ARGP_IOBUF_HUGEPAGES_KEY, "off|thp|hugetlb", 0,
+     "Back I/O buffers with transparent or hugetlb hugepages "
+     "[default: off]"},
+    {"iobuf-numa", ARGP_IOBUF_NUMA_KEY, "BOOL", OPTION_ARG_OPTIONAL,
+     "Allocate I/O buffers from the NUMA node of the requesting thread"},
     {0, 0, 0, 0, "Fuse options:"},
     {"direct-io-mode", ARGP_DIRECT_IO_MODE_KEY, "BOOL|auto",
      OPTION_ARG_OPTIONAL, "Specify direct I/O strategy [default: \"auto\"]"},
@@ -1369,6 +1374,33 @@ parse_opts(int key, char *arg, struct argp_state *state)
                          "Invalid value for global threading \"%s\"", arg);
             break;
 
+        case ARGP_IOBUF_HUGEPAGES_KEY:
+            if (strcmp(arg, "off") == 0) {
+                cmd_args->iobuf_hugepages = GF_IOBUF_HUGEPAGES_OFF;
+            } else if (strcmp(arg, "thp") == 0) {
+                cmd_args->iobuf_hugepages = GF_IOBUF_HUGEPAGES_THP;
+            } else if (strcmp(arg, "hugetlb") == 0) {
+                cmd_args->iobuf_hugepages = GF_IOBUF_HUGEPAGES_HUGETLB;
+            } else {
+                argp_failure(state, -1, 0,
+                             "Invalid value for iobuf hugepages \"%s\"", arg);
+            }
+            break;
+
+        case ARGP_IOBUF_NUMA_KEY:
+            if (!arg || (*arg == 0)) {
+                arg = "yes";
+            }
+
+            if (gf_string2boolean(arg, &b) == 0) {
+                cmd_args->iobuf_numa = b;
+                break;
+            }
+
+            argp_failure(state, -1, 0, "Invalid value for iobuf numa \"%s\"",
+                         arg);
+            break;
+
         case ARGP_FUSE_DEV_EPERM_RATELIMIT_NS_KEY:
             if (gf_string2uint32(arg, &cmd_args->fuse_dev_eperm_ratelimit_ns)) {
                 argp_failure(state, -1, 0,
@@ -2674,6 +2706,9 @@ main(int argc, char *argv[])
         goto out;
     }
 
+    iobuf_pool_set_layout(ctx->iobuf_pool, cmd->iobuf_hugepages,
+                          cmd->iobuf_numa);
+
     /* log the version of glusterfs running here along with the actual
        command line options. */
     {
@@ -117,6 +117,8 @@ enum argp_option_keys {
     ARGP_FUSE_DEV_EPERM_RATELIMIT_NS_KEY = 194,
     ARGP_FUSE_INVALIDATE_LIMIT_KEY = 195,
     ARGP_FUSE_DISPLAY_NAME_KEY = 196,
+    ARGP_IOBUF_HUGEPAGES_KEY = 197,
+    ARGP_IOBUF_NUMA_KEY = 198,
 };
 
 struct _gfd_vol_top_priv {
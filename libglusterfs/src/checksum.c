@@ -14,6 +14,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "xxhash.h"
+
 /*
  * The "weak" checksum required for the rsync algorithm.
  *
@@ -42,3 +44,13 @@ gf_rsync_md5_checksum(unsigned char *data, size_t len, unsigned char *md5)
 {
     MD5(data, len, md5);
 }
+
+/*
+ * A fast, non-cryptographic checksum, for comparing data where a FIPS
+ * compliant one is not required.
+ */
+void
+gf_rsync_xxh64_checksum(unsigned char *data, size_t len, unsigned char *xxh64)
+{
+    XXH64_canonicalFromHash((XXH64_canonical_t *)xxh64, XXH64(data, len, 0));
+}
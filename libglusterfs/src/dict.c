@@ -15,20 +15,17 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <fnmatch.h>
+#include <stddef.h>
 
-
-/* dict_t is always initialized with hash_size = 1
- * with this usage it's implemented as a doubly-linked list
- * and the hash calculation done per operation is not necessary.
- * using this macro to delimit blocks related to hash imp */
-#define DICT_LIST_IMP 1
-
+/* Small dicts keep up to DICT_INLINE_PAIRS pairs and their keys inside
+ * dict_t and are searched linearly; no hashing, no allocations. Beyond that
+ * an open addressing (linear probing) table indexes all the pairs. The
+ * members_list keeps the pairs in insertion order (newest first) for
+ * iteration. */
 
 #include "glusterfs/dict.h"
-#if !DICT_LIST_IMP
 #define XXH_INLINE_ALL
 #include "xxhash.h"
-#endif
 #include "glusterfs/compat.h"
 #include "glusterfs/compat-errno.h"
 #include "glusterfs/byte-order.h"
@@ -74,48 +71,37 @@ get_new_data()
 
     GF_ATOMIC_INIT(data->refcount, 0);
     data->is_static = _gf_false;
+    data->buf = NULL;
 
     return data;
 }
 
+#define DICT_INLINE_MAP_ALL ((1U << DICT_INLINE_PAIRS) - 1)
+#define DICT_TABLE_MIN_SIZE 16
+/* The load of the hash table, tombstones included, is kept under 2/3.
+ * Rebuilding sizes it for a load under 1/3, half of that. */
+#define dict_table_full(fill, size) ((uint64_t)(fill)*3 > (uint64_t)(size)*2)
+#define DICT_TOMBSTONE ((data_pair_t *)1)
+
+#define dict_key_is_inline(dict, key)                                          \
+    (((key) >= (dict)->inline_keys) &&                                         \
+     ((key) < (dict)->inline_keys + DICT_INLINE_KEY_BYTES))
+
+#define dict_pair_is_inline(dict, pair)                                        \
+    (((pair) >= (dict)->inline_pairs) &&                                       \
+     ((pair) < (dict)->inline_pairs + DICT_INLINE_PAIRS))
+
 static dict_t *
-get_new_dict_full(int size_hint)
+get_new_dict(void)
 {
-    dict_t *dict = mem_get0(THIS->ctx->dict_pool);
+    dict_t *dict = mem_get(THIS->ctx->dict_pool);
 
     if (!dict) {
         return NULL;
     }
 
-    dict->hash_size = size_hint;
-#if DICT_LIST_IMP
-    /*
-     * This is the only case we ever see currently.  If we ever
-     * need to support resizing the hash table, the resize function
-     * will have to take into account the possibility that
-     * "members" is not separately allocated (i.e. don't just call
-     * realloc() blindly.
-     */
-    dict->members = &dict->members_internal;
-#else
-    /*
-     * We actually need to allocate space for size_hint *pointers*
-     * but we actually allocate space for one *structure*.  Since
-     * a data_pair_t consists of five pointers, we're wasting four
-     * pointers' worth for N=1, and will overrun what we allocated
-     * for N>5.  If anybody ever starts using size_hint, we'll need
-     * to fix this.
-     */
-    GF_ASSERT(size_hint <= (sizeof(data_pair_t) / sizeof(data_pair_t *)));
-    dict->members = mem_get0(THIS->ctx->dict_pair_pool);
-    if (!dict->members) {
-        mem_put(dict);
-        return NULL;
-    }
-#endif
-
-    dict->free_pair.key = NULL;
-    dict->totkvlen = 0;
+    /* inline pairs and keys get initialized when they are handed out */
+    memset(dict, 0, offsetof(dict_t, inline_pairs));
     LOCK_INIT(&dict->lock);
 
     return dict;
@@ -124,7 +110,7 @@ get_new_dict_full(int size_hint)
 dict_t *
 dict_new(void)
 {
-    dict_t *dict = get_new_dict_full(DICT_LIST_IMP);
+    dict_t *dict = get_new_dict();
 
     if (dict)
         dict_ref(dict);
@@ -311,7 +297,9 @@ void
 data_destroy(data_t *data)
 {
     if (data) {
-        if (!data->is_static)
+        if (data->buf)
+            data_buf_unref(data->buf);
+        else if (!data->is_static)
             GF_FREE(data->data);
 
         data->len = 0xbabababa;
@@ -349,25 +337,114 @@ err_out:
     return NULL;
 }
 
+static inline uint32_t
+dict_hash(const char *key, const int keylen)
+{
+    return (uint32_t)XXH64(key, keylen, 0);
+}
+
+static inline gf_boolean_t
+dict_key_match(const data_pair_t *pair, const char *key, const int keylen)
+{
+    return (pair->keylen == keylen) && !memcmp(pair->key, key, keylen);
+}
+
+/* Returns the table slot of @key, -1 if it's not there. */
+static int
+dict_table_find(const dict_t *this, const char *key, const int keylen,
+                const uint32_t hash)
+{
+    uint32_t mask = this->table_size - 1;
+    uint32_t i = 0;
+    data_pair_t *pair = NULL;
+
+    for (i = hash & mask; (pair = this->table[i]) != NULL;
+         i = (i + 1) & mask) {
+        if ((pair != DICT_TOMBSTONE) && (pair->key_hash == hash) &&
+            dict_key_match(pair, key, keylen))
+            return i;
+    }
+
+    return -1;
+}
+
+static void
+dict_table_insert(dict_t *this, data_pair_t *pair)
+{
+    uint32_t mask = this->table_size - 1;
+    uint32_t i = 0;
+
+    for (i = pair->key_hash & mask;
+         this->table[i] && (this->table[i] != DICT_TOMBSTONE);
+         i = (i + 1) & mask)
+        ;
+
+    if (!this->table[i])
+        this->table_fill++;
+    this->table[i] = pair;
+}
+
+/* Makes room in the table for one more pair, building it the first time
+ * the inline pairs don't suffice. Rebuilding also drops the tombstones. */
+static int
+dict_table_reserve(dict_t *this)
+{
+    data_pair_t **table = NULL;
+    data_pair_t *pair = NULL;
+    uint32_t size = DICT_TABLE_MIN_SIZE;
+
+    if (this->table) {
+        if (!dict_table_full(this->table_fill + 1, this->table_size))
+            return 0;
+        size = this->table_size;
+    } else if (this->count < DICT_INLINE_PAIRS) {
+        return 0;
+    }
+
+    while ((this->count + 1) * 3 > size)
+        size *= 2;
+
+    table = GF_CALLOC(size, sizeof(*table), gf_common_mt_dict_table);
+    if (!table)
+        return -1;
+
+    if (!this->table) {
+        /* pairs added while the dict was small weren't hashed */
+        for (pair = this->members_list; pair; pair = pair->next)
+            pair->key_hash = dict_hash(pair->key, pair->keylen);
+    }
+
+    GF_FREE(this->table);
+    this->table = table;
+    this->table_size = size;
+    this->table_fill = 0;
+
+    for (pair = this->members_list; pair; pair = pair->next)
+        dict_table_insert(this, pair);
+
+    return 0;
+}
+
 /* Always need to be called under lock
  * Always this and key variables are not null -
  * checked by callers.
  */
 static data_pair_t *
-dict_lookup_common(const dict_t *this, const char *key, const uint32_t hash)
+dict_lookup_common(const dict_t *this, const char *key, const int keylen)
 {
-    int hashval = 0;
-    data_pair_t *pair;
+    data_pair_t *pair = NULL;
+    uint32_t map = 0;
+    int i = 0;
 
-    /* If the divisor is 1, the modulo is always 0,
-     * in such case avoid hash calculation.
-     */
-#if !DICT_LIST_IMP
-    hashval = hash % this->hash_size;
-#endif
+    if (this->table) {
+        i = dict_table_find(this, key, keylen, dict_hash(key, keylen));
+        return (i < 0) ? NULL : this->table[i];
+    }
 
-    for (pair = this->members[hashval]; pair != NULL; pair = pair->hash_next) {
-        if (pair->key && (hash == pair->key_hash) && !strcmp(pair->key, key))
+    /* without a table all the pairs are inline */
+    for (map = this->inline_map; map; map &= map - 1) {
+        pair = (data_pair_t *)&this->inline_pairs[__builtin_ctz(map)];
+        if (dict_key_match(pair, key, keylen))
             return pair;
     }
 
@@ -385,16 +462,11 @@ dict_lookup(dict_t *this, char *key, data_t **data)
     }
 
     data_pair_t *tmp = NULL;
-
-    uint32_t hash = 0;
-
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, strlen(key), 0);
-#endif
+    const int keylen = strlen(key);
 
     LOCK(&this->lock);
     {
-        tmp = dict_lookup_common(this, key, hash);
+        tmp = dict_lookup_common(this, key, keylen);
     }
     UNLOCK(&this->lock);
 
@@ -405,82 +477,104 @@ dict_lookup(dict_t *this, char *key, data_t **data)
     return 0;
 }
 
+static data_pair_t *
+dict_pair_alloc(dict_t *this)
+{
+    uint32_t free_map = ~this->inline_map & DICT_INLINE_MAP_ALL;
+    int i = 0;
+
+    if (free_map) {
+        i = __builtin_ctz(free_map);
+        this->inline_map |= (1U << i);
+        return &this->inline_pairs[i];
+    }
+
+    return mem_get(THIS->ctx->dict_pair_pool);
+}
+
+static void
+dict_pair_free(dict_t *this, data_pair_t *pair)
+{
+    if (!dict_key_is_inline(this, pair->key))
+        GF_FREE(pair->key);
+    pair->key = NULL;
+
+    if (dict_pair_is_inline(this, pair))
+        this->inline_map &= ~(1U << (pair - this->inline_pairs));
+    else
+        mem_put(pair);
+}
+
+/* Copies @key into the inline key space if it fits. Deleted keys aren't
+ * reclaimed until the dict is empty again. */
+static char *
+dict_key_dup(dict_t *this, const char *key, const int keylen)
+{
+    char *copy = NULL;
+
+    if (keylen < (DICT_INLINE_KEY_BYTES - this->keys_used)) {
+        copy = this->inline_keys + this->keys_used;
+        this->keys_used += keylen + 1;
+    } else {
+        copy = GF_MALLOC(keylen + 1, gf_common_mt_char);
+        if (!copy)
+            return NULL;
+    }
+
+    memcpy(copy, key, keylen);
+    copy[keylen] = '\0';
+
+    return copy;
+}
+
 static int32_t
 dict_set_lk(dict_t *this, char *key, const int key_len, data_t *value,
-            const uint32_t hash, gf_boolean_t replace)
+            gf_boolean_t replace)
 {
-    int hashval = 0;
     data_pair_t *pair;
-    int key_free = 0;
-    uint32_t key_hash = 0;
+    char ref_key[32];
     int keylen;
 
     if (!key) {
-        keylen = gf_asprintf(&key, "ref:%p", value);
-        if (-1 == keylen) {
-            return -1;
-        }
-        key_free = 1;
-#if !DICT_LIST_IMP
-        key_hash = (uint32_t)XXH64(key, keylen, 0);
-#endif
+        keylen = snprintf(ref_key, sizeof(ref_key), "ref:%p", value);
+        key = ref_key;
     } else {
         keylen = key_len;
-        key_hash = hash;
     }
 
     /* Search for a existing key if 'replace' is asked for */
     if (replace) {
-        pair = dict_lookup_common(this, key, key_hash);
+        pair = dict_lookup_common(this, key, keylen);
         if (pair) {
             data_t *unref_data = pair->value;
             pair->value = data_ref(value);
             this->totkvlen += (value->len - unref_data->len);
             data_unref(unref_data);
-            if (key_free)
-                GF_FREE(key);
             /* Indicates duplicate key */
             return 0;
         }
     }
 
-    if (this->free_pair.key) { /* the free_pair is used */
-        pair = mem_get(THIS->ctx->dict_pair_pool);
-        if (!pair) {
-            if (key_free)
-                GF_FREE(key);
-            return -1;
-        }
-    } else { /* assign the pair to the free pair */
-        pair = &this->free_pair;
-    }
+    if (dict_table_reserve(this) != 0)
+        return -1;
 
-    if (key_free) {
-        /* It's ours.  Use it. */
-        pair->key = key;
-        key_free = 0;
-    } else {
-        pair->key = (char *)GF_MALLOC(keylen + 1, gf_common_mt_char);
-        if (!pair->key) {
-            if (pair != &this->free_pair) {
-                mem_put(pair);
-            }
-            return -1;
-        }
-        strcpy(pair->key, key);
+    pair = dict_pair_alloc(this);
+    if (!pair)
+        return -1;
+
+    pair->key = dict_key_dup(this, key, keylen);
+    if (!pair->key) {
+        dict_pair_free(this, pair);
+        return -1;
     }
-    pair->key_hash = key_hash;
+    pair->keylen = keylen;
     pair->value = data_ref(value);
     this->totkvlen += (keylen + 1 + value->len);
 
-    /* If the divisor is 1, the modulo is always 0,
-     * in such case avoid hash calculation.
-     */
-#if !DICT_LIST_IMP
-    hashval = (key_hash % this->hash_size);
-#endif
-    pair->hash_next = this->members[hashval];
-    this->members[hashval] = pair;
+    if (this->table) {
+        pair->key_hash = dict_hash(key, keylen);
+        dict_table_insert(this, pair);
+    }
 
     pair->next = this->members_list;
     pair->prev = NULL;
@@ -489,9 +583,6 @@ dict_set_lk(dict_t *this, char *key, const int key_len, data_t *value,
     this->members_list = pair;
     this->count++;
 
-    if (key_free)
-        GF_FREE(key);
-
     if (this->max_count < this->count)
         this->max_count = this->count;
     return 0;
@@ -510,7 +601,6 @@ int32_t
 dict_setn(dict_t *this, char *key, const int keylen, data_t *value)
 {
     int32_t ret;
-    uint32_t key_hash = 0;
 
     if (!this || !value) {
         gf_msg_callingfn("dict", GF_LOG_WARNING, EINVAL, LG_MSG_INVALID_ARG,
@@ -520,15 +610,9 @@ dict_setn(dict_t *this, char *key, const int keylen, data_t *value)
         return -1;
     }
 
-#if !DICT_LIST_IMP
-    if (key) {
-        key_hash = (uint32_t)XXH64(key, keylen, 0);
-    }
-#endif
-
     LOCK(&this->lock);
 
-    ret = dict_set_lk(this, key, keylen, value, key_hash, 1);
+    ret = dict_set_lk(this, key, keylen, value, 1);
 
     UNLOCK(&this->lock);
 
@@ -548,7 +632,6 @@ int32_t
 dict_addn(dict_t *this, char *key, const int keylen, data_t *value)
 {
     int32_t ret;
-    uint32_t key_hash = 0;
 
     if (!this || !value) {
         gf_msg_callingfn("dict", GF_LOG_WARNING, EINVAL, LG_MSG_INVALID_ARG,
@@ -556,15 +639,9 @@ dict_addn(dict_t *this, char *key, const int keylen, data_t *value)
         return -1;
     }
 
-#if !DICT_LIST_IMP
-    if (key) {
-        key_hash = (uint32_t)XXH64(key, keylen, 0);
-    }
-#endif
-
     LOCK(&this->lock);
 
-    ret = dict_set_lk(this, key, keylen, value, key_hash, 0);
+    ret = dict_set_lk(this, key, keylen, value, 0);
 
     UNLOCK(&this->lock);
 
@@ -579,18 +656,13 @@ dict_get(dict_t *this, char *key)
                          "!this || key=%s", (key) ? key : "()");
         return NULL;
     }
-#if !DICT_LIST_IMP
     return dict_getn(this, key, strlen(key));
-#else   
-    return dict_getn(this, key, 0);
-#endif
 }
 
 data_t *
 dict_getn(dict_t *this, char *key, const int keylen)
 {
     data_pair_t *pair;
-    uint32_t hash = 0;
 
     if (!this || !key) {
         gf_msg_callingfn("dict", GF_LOG_DEBUG, EINVAL, LG_MSG_INVALID_ARG,
@@ -598,13 +670,9 @@ dict_getn(dict_t *this, char *key, const int keylen)
         return NULL;
     }
 
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, keylen, 0);
-#endif
-
     LOCK(&this->lock);
     {
-        pair = dict_lookup_common(this, key, hash);
+        pair = dict_lookup_common(this, key, keylen);
     }
     UNLOCK(&this->lock);
 
@@ -642,19 +710,15 @@ dict_del(dict_t *this, char *key)
                          "!this || key=%s", key);
         return _gf_false;
     }
-#if !DICT_LIST_IMP
     return dict_deln(this, key, strlen(key));
-#else
-    return dict_deln(this, key, 0);
-#endif
 }
 
 gf_boolean_t
 dict_deln(dict_t *this, char *key, const int keylen)
 {
-    int hashval = 0;
-    uint32_t hash = 0;
+    data_pair_t *pair = NULL;
     gf_boolean_t rc = _gf_false;
+    int slot = -1;
 
     if (!this || !key) {
         gf_msg_callingfn("dict", GF_LOG_WARNING, EINVAL, LG_MSG_INVALID_ARG,
@@ -662,54 +726,35 @@ dict_deln(dict_t *this, char *key, const int keylen)
         return rc;
     }
 
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, keylen, 0);
-#endif
-
     LOCK(&this->lock);
 
-    /* If the divisor is 1, the modulo is always 0,
-     * in such case avoid hash calculation.
-     */
-#if !DICT_LIST_IMP
-    hashval = hash % this->hash_size;
-#endif
-
-    data_pair_t *pair = this->members[hashval];
-    data_pair_t *prev = NULL;
-
-    while (pair) {
-        if ((hash == pair->key_hash) && strcmp(pair->key, key) == 0) {
-            if (prev)
-                prev->hash_next = pair->hash_next;
-            else
-                this->members[hashval] = pair->hash_next;
-
-            this->totkvlen -= pair->value->len;
-            data_unref(pair->value);
+    if (this->table) {
+        slot = dict_table_find(this, key, keylen, dict_hash(key, keylen));
+        if (slot >= 0) {
+            pair = this->table[slot];
+            this->table[slot] = DICT_TOMBSTONE;
+        }
+    } else {
+        pair = dict_lookup_common(this, key, keylen);
+    }
 
-            if (pair->prev)
-                pair->prev->next = pair->next;
-            else
-                this->members_list = pair->next;
+    if (pair) {
+        this->totkvlen -= (pair->value->len + pair->keylen + 1);
+        data_unref(pair->value);
 
-            if (pair->next)
-                pair->next->prev = pair->prev;
+        if (pair->prev)
+            pair->prev->next = pair->next;
+        else
+            this->members_list = pair->next;
 
-            this->totkvlen -= (strlen(pair->key) + 1);
-            GF_FREE(pair->key);
-            if (pair == &this->free_pair) {
-                this->free_pair.key = NULL;
-            } else {
-                mem_put(pair);
-            }
-            this->count--;
-            rc = _gf_true;
-            break;
-        }
+        if (pair->next)
+            pair->next->prev = pair->prev;
 
-        prev = pair;
-        pair = pair->hash_next;
+        dict_pair_free(this, pair);
+        this->count--;
+        if (this->count == 0)
+            this->keys_used = 0;
+        rc = _gf_true;
     }
 
     UNLOCK(&this->lock);
@@ -728,15 +773,17 @@ dict_clear_data(dict_t *this)
     while (curr != NULL) {
         next = curr->next;
         data_unref(curr->value);
-        GF_FREE(curr->key);
-        if (curr == &this->free_pair) {
-            this->free_pair.key = NULL;
-        } else {
-            mem_put(curr);
-        }
+        dict_pair_free(this, curr);
         curr = next;
     }
+    this->members_list = NULL;
     this->count = this->totkvlen = 0;
+    this->keys_used = 0;
+
+    if (this->table) {
+        memset(this->table, 0, this->table_size * sizeof(*this->table));
+        this->table_fill = 0;
+    }
 }
 
 static void
@@ -755,9 +802,7 @@ dict_destroy(dict_t *this)
     LOCK_DESTROY(&this->lock);
 
     dict_clear_data(this);
-    if (this->members != &this->members_internal) {
-        mem_put(this->members);
-    }
+    GF_FREE(this->table);
 
     free(this->extra_stdfree);
 
@@ -1120,6 +1165,77 @@ data_from_dynptr(void *value, int32_t len)
     return data;
 }
 
+/* malloc()ed buffers, usually straight out of XDR decoding, that values
+ * point into instead of holding a copy. They are released together with the
+ * last data_t referring to them. */
+struct _data_buf {
+    gf_atomic_t refcount;
+    int count;
+    int max;
+    char *bufs[];
+};
+
+data_buf_t *
+data_buf_new(int max)
+{
+    data_buf_t *buf = NULL;
+
+    buf = GF_MALLOC(sizeof(*buf) + max * sizeof(char *), gf_common_mt_data_buf);
+    if (!buf)
+        return NULL;
+
+    GF_ATOMIC_INIT(buf->refcount, 1);
+    buf->count = 0;
+    buf->max = max;
+
+    return buf;
+}
+
+/* hand @stdbuf over to @buf, it will be free()d with it */
+int
+data_buf_adopt(data_buf_t *buf, char *stdbuf)
+{
+    if (buf->count == buf->max)
+        return -1;
+
+    buf->bufs[buf->count++] = stdbuf;
+
+    return 0;
+}
+
+void
+data_buf_unref(data_buf_t *buf)
+{
+    int i = 0;
+
+    if (GF_ATOMIC_DEC(buf->refcount) != 0)
+        return;
+
+    for (i = 0; i < buf->count; i++)
+        free(buf->bufs[i]);
+
+    GF_FREE(buf);
+}
+
+data_t *
+data_from_buf(data_buf_t *buf, char *value, int32_t len,
+              gf_dict_data_type_t type)
+{
+    data_t *data = get_new_data();
+
+    if (!data)
+        return NULL;
+
+    data->len = len;
+    data->data = value;
+    data->data_type = type;
+    data->is_static = _gf_true;
+    data->buf = buf;
+    GF_ATOMIC_INC(buf->refcount);
+
+    return data;
+}
+
 data_t *
 bin_to_data(void *value, int32_t len)
 {
@@ -1492,7 +1608,7 @@ dict_copy(dict_t *dict, dict_t *new)
     }
 
     if (!new)
-        new = get_new_dict_full(dict->hash_size);
+        new = get_new_dict();
 
     dict_foreach(dict, dict_copy_one, new);
 
@@ -1509,13 +1625,9 @@ dict_reset(dict_t *dict)
         goto out;
     }
 
-    int i;
     LOCK(&dict->lock);
 
     dict_clear_data(dict);
-    for (i = 0; i < dict->hash_size; i++)
-        dict->members[i] = NULL;
-    dict->members_list = NULL;
 
     UNLOCK(&dict->lock);
     ret = 0;
@@ -1557,15 +1669,10 @@ dict_get_with_refn(dict_t *this, char *key, const int keylen, data_t **data)
 {
     data_pair_t *pair = NULL;
     int ret = -ENOENT;
-    uint32_t hash = 0;
-
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, keylen, 0);
-#endif
 
     LOCK(&this->lock);
     {
-        pair = dict_lookup_common(this, key, hash);
+        pair = dict_lookup_common(this, key, keylen);
 
         if (pair) {
             ret = 0;
@@ -1585,11 +1692,7 @@ dict_get_with_ref(dict_t *this, char *key, data_t **data)
                          "dict OR key (%s) is NULL", key);
         return -EINVAL;
     }
-#if !DICT_LIST_IMP
     return dict_get_with_refn(this, key, strlen(key), data);
-#else
-    return dict_get_with_refn(this, key, 0, data);
-#endif
 }
 
 static int
@@ -2163,8 +2266,6 @@ _dict_modify_flag(dict_t *this, char *key, int flag, int op)
     int ret = 0;
     data_pair_t *pair = NULL;
     char *ptr = NULL;
-    int hashval = 0;
-    uint32_t hash = 0;
 
     if (!this || !key) {
         gf_msg_callingfn("dict", GF_LOG_WARNING, EINVAL, LG_MSG_INVALID_ARG,
@@ -2179,13 +2280,9 @@ _dict_modify_flag(dict_t *this, char *key, int flag, int op)
      */
     GF_ASSERT(flag >= 0 && flag < DICT_MAX_FLAGS);
 
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, strlen(key), 0);
-#endif
-
     LOCK(&this->lock);
     {
-        pair = dict_lookup_common(this, key, hash);
+        pair = dict_lookup_common(this, key, strlen(key));
 
         if (pair) {
             data = pair->value;
@@ -2217,44 +2314,13 @@ _dict_modify_flag(dict_t *this, char *key, int flag, int op)
             else
                 BIT_CLEAR((unsigned char *)(data->data), flag);
 
-            if (this->free_pair.key) { /* the free pair is in use */
-                pair = mem_get0(THIS->ctx->dict_pair_pool);
-                if (!pair) {
-                    gf_smsg("dict", GF_LOG_ERROR, ENOMEM, LG_MSG_NO_MEMORY,
-                            "dict pair", NULL);
-                    ret = -ENOMEM;
-                    goto err;
-                }
-            } else { /* use the free pair */
-                pair = &this->free_pair;
-            }
-
-            pair->key = (char *)GF_MALLOC(strlen(key) + 1, gf_common_mt_char);
-            if (!pair->key) {
+            ret = dict_set_lk(this, key, strlen(key), data, _gf_false);
+            if (ret) {
                 gf_smsg("dict", GF_LOG_ERROR, ENOMEM, LG_MSG_NO_MEMORY,
                         "dict pair", NULL);
                 ret = -ENOMEM;
                 goto err;
             }
-            strcpy(pair->key, key);
-            pair->key_hash = hash;
-            pair->value = data_ref(data);
-            this->totkvlen += (strlen(key) + 1 + data->len);
-#if !DICT_LIST_IMP
-            hashval = hash % this->hash_size;
-#endif
-            pair->hash_next = this->members[hashval];
-            this->members[hashval] = pair;
-
-            pair->next = this->members_list;
-            pair->prev = NULL;
-            if (this->members_list)
-                this->members_list->prev = pair;
-            this->members_list = pair;
-            this->count++;
-
-            if (this->max_count < this->count)
-                this->max_count = this->count;
         }
     }
 
@@ -2265,16 +2331,6 @@ err:
     if (key && this)
         UNLOCK(&this->lock);
 
-    if (pair) {
-        if (pair->key) {
-            GF_FREE(pair->key);
-            pair->key = NULL;
-        }
-        if (pair != &this->free_pair) {
-            mem_put(pair);
-        }
-    }
-
     if (data)
         data_destroy(data);
 
@@ -2908,8 +2964,6 @@ dict_rename_key(dict_t *this, char *key, char *replace_key)
 {
     data_pair_t *pair = NULL;
     int ret = -EINVAL;
-    uint32_t hash = 0;
-    uint32_t replacekey_hash = 0;
     int replacekey_len = 0;
 
     /* replacing a key by itself is a NO-OP */
@@ -2923,20 +2977,16 @@ dict_rename_key(dict_t *this, char *key, char *replace_key)
     }
 
     replacekey_len = strlen(replace_key);
-#if !DICT_LIST_IMP
-    hash = (uint32_t)XXH64(key, strlen(key), 0);
-    replacekey_hash = (uint32_t)XXH64(replace_key, replacekey_len, 0);
-#endif
 
     LOCK(&this->lock);
     {
         /* no need to data_ref(pair->value), dict_set_lk() does it */
-        pair = dict_lookup_common(this, key, hash);
+        pair = dict_lookup_common(this, key, strlen(key));
         if (!pair)
             ret = -ENODATA;
         else
             ret = dict_set_lk(this, replace_key, replacekey_len, pair->value,
-                              replacekey_hash, 1);
+                              1);
     }
     UNLOCK(&this->lock);
 
@@ -3030,7 +3080,7 @@ dict_serialize_lk(dict_t *this, char *buf)
             goto out;
         }
 
-        keylen = strlen(pair->key);
+        keylen = pair->keylen;
         netword = hton32(keylen);
         memcpy(buf, &netword, sizeof(netword));
         buf += DICT_DATA_HDR_KEY_LEN;
@@ -3122,19 +3172,9 @@ out:
     return ret;
 }
 
-/**
- * dict_unserialize - unserialize a buffer into a dict
- *
- * @buf:  buf containing serialized dict
- * @size: size of the @buf
- * @fill: dict to fill in
- *
- * @return: success: 0
- *          failure: -errno
- */
-
-int32_t
-dict_unserialize(char *orig_buf, int32_t size, dict_t **fill)
+static int32_t
+dict_unserialize_common(char *orig_buf, int32_t size, dict_t **fill,
+                        data_buf_t *shared)
 {
     char *buf = orig_buf;
     int ret = -1;
@@ -3243,16 +3283,22 @@ dict_unserialize(char *orig_buf, int32_t size, dict_t **fill)
                              (long)(orig_buf + size), (long)(buf + vallen));
             goto out;
         }
-        value = get_new_data();
+        if (shared) {
+            value = data_from_buf(shared, buf, vallen, GF_DATA_TYPE_STR_OLD);
+        } else {
+            value = get_new_data();
+            if (value) {
+                value->len = vallen;
+                value->data = gf_memdup(buf, vallen);
+                value->data_type = GF_DATA_TYPE_STR_OLD;
+                value->is_static = _gf_false;
+            }
+        }
 
         if (!value) {
             ret = -1;
             goto out;
         }
-        value->len = vallen;
-        value->data = gf_memdup(buf, vallen);
-        value->data_type = GF_DATA_TYPE_STR_OLD;
-        value->is_static = _gf_false;
         buf += vallen;
 
         ret = dict_addn(*fill, key, keylen, value);
@@ -3265,6 +3311,56 @@ out:
     return ret;
 }
 
+/**
+ * dict_unserialize - unserialize a buffer into a dict
+ *
+ * @buf:  buf containing serialized dict
+ * @size: size of the @buf
+ * @fill: dict to fill in
+ *
+ * @return: success: 0
+ *          failure: -errno
+ */
+
+int32_t
+dict_unserialize(char *orig_buf, int32_t size, dict_t **fill)
+{
+    return dict_unserialize_common(orig_buf, size, fill, NULL);
+}
+
+/**
+ * dict_unserialize_adopt - unserialize a buffer into a dict without copying
+ *                          the values out of it
+ *
+ * @buf:  malloc()ed buf containing serialized dict. It is owned by the
+ *        values of @fill from now on, whether this succeeds or not.
+ * @size: size of the @buf
+ * @fill: dict to fill in
+ *
+ * @return: success: 0
+ *          failure: -errno
+ */
+
+int32_t
+dict_unserialize_adopt(char *buf, int32_t size, dict_t **fill)
+{
+    data_buf_t *shared = NULL;
+    int32_t ret = -1;
+
+    shared = data_buf_new(1);
+    if (!shared) {
+        free(buf);
+        return -1;
+    }
+    data_buf_adopt(shared, buf);
+
+    ret = dict_unserialize_common(buf, size, fill, shared);
+
+    data_buf_unref(shared);
+
+    return ret;
+}
+
 /**
  * dict_allocate_and_serialize - serialize a dictionary into an allocated buffer
  *
@@ -3536,7 +3632,6 @@ int
 dict_has_key_from_array(dict_t *dict, char **strings, gf_boolean_t *result)
 {
     int i = 0;
-    uint32_t hash = 0;
 
     if (!dict || !strings || !result)
         return -EINVAL;
@@ -3544,10 +3639,7 @@ dict_has_key_from_array(dict_t *dict, char **strings, gf_boolean_t *result)
     LOCK(&dict->lock);
     {
         for (i = 0; strings[i]; i++) {
-#if !DICT_LIST_IMP
-            hash = (uint32_t)XXH64(strings[i], strlen(strings[i]), 0);
-#endif
-            if (dict_lookup_common(dict, strings[i], hash)) {
+            if (dict_lookup_common(dict, strings[i], strlen(strings[i]))) {
                 *result = _gf_true;
                 goto unlock;
             }
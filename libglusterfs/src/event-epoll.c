@@ -963,6 +963,34 @@ event_pool_destroy_epoll(struct event_pool *event_pool)
     return ret;
 }
 
+/* Called from the handler of an error event that turned out not to be an
+ * error of the fd (MSG_ZEROCOPY completions are reported as EPOLLERR), so
+ * that its next events are delivered once it is handled. */
+static int
+event_clear_error_epoll(struct event_pool *event_pool, int fd, int idx,
+                        int gen)
+{
+    struct event_slot_epoll *slot = NULL;
+
+    slot = event_slot_get(event_pool, idx);
+    if (!slot) {
+        gf_smsg("epoll", GF_LOG_ERROR, 0, LG_MSG_SLOT_NOT_FOUND, "fd=%d", fd,
+                "idx=%d", idx, NULL);
+        return -1;
+    }
+
+    LOCK(&slot->lock);
+    {
+        if (gen == slot->gen)
+            slot->handled_error = 0;
+    }
+    UNLOCK(&slot->lock);
+
+    event_slot_unref(event_pool, slot, idx);
+
+    return 0;
+}
+
 static int
 event_handled_epoll(struct event_pool *event_pool, int fd, int idx, int gen)
 {
@@ -1028,6 +1056,7 @@ struct event_ops event_ops_epoll = {
     .event_reconfigure_threads = event_reconfigure_threads_epoll,
     .event_pool_destroy = event_pool_destroy_epoll,
     .event_handled = event_handled_epoll,
+    .event_clear_error = event_clear_error_epoll,
 };
 
 #endif
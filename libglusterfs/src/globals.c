@@ -300,6 +300,7 @@ glusterfs_cleanup(void *ptr)
         GF_FREE(thread_syncopctx.groups);
     }
 
+    iobuf_cache_thread_destructor();
     mem_pool_thread_destructor(NULL);
 }
 
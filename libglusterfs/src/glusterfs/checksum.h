@@ -19,4 +19,7 @@ gf_rsync_strong_checksum(unsigned char *buf, size_t len, unsigned char *sum);
 
 void
 gf_rsync_md5_checksum(unsigned char *data, size_t len, unsigned char *md5);
+
+void
+gf_rsync_xxh64_checksum(unsigned char *data, size_t len, unsigned char *xxh64);
 #endif /* __CHECKSUM_H__ */
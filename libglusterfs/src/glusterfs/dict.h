@@ -20,6 +20,7 @@
 typedef struct _data data_t;
 typedef struct _dict dict_t;
 typedef struct _data_pair data_pair_t;
+typedef struct _data_buf data_buf_t;
 
 #define dict_set_sizen(this, key, value) dict_setn(this, key, SLEN(key), value)
 
@@ -81,6 +82,31 @@ typedef struct _data_pair data_pair_t;
                                                                                \
     } while (0)
 
+/* Like GF_PROTOCOL_DICT_UNSERIALIZE, but the values point into @buff instead
+ * of being copied out of it. @buff has to come from malloc() (XDR decoding)
+ * and belongs to the dict afterwards, it is reset to NULL for the caller. */
+#define GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(xl, to, buff, len, ret, ope, labl)  \
+    do {                                                                       \
+        char *_buf = NULL;                                                     \
+                                                                               \
+        if (!len)                                                              \
+            break;                                                             \
+        to = dict_new();                                                       \
+        GF_VALIDATE_OR_GOTO(xl->name, to, labl);                               \
+                                                                               \
+        _buf = buff;                                                           \
+        buff = NULL;                                                           \
+        ret = dict_unserialize_adopt(_buf, len, &to);                          \
+        if (ret < 0) {                                                         \
+            gf_msg(xl->name, GF_LOG_WARNING, 0, LG_MSG_DICT_UNSERIAL_FAILED,   \
+                   "failed to unserialize dictionary (%s)", (#to));            \
+                                                                               \
+            ope = EINVAL;                                                      \
+            goto labl;                                                         \
+        }                                                                      \
+                                                                               \
+    } while (0)
+
 #define dict_foreach_inline(d, c) for (c = d->members_list; c; c = c->next)
 
 #define DICT_KEY_VALUE_MAX_SIZE 1048576
@@ -97,30 +123,42 @@ struct _data {
     gf_dict_data_type_t data_type;
     uint32_t len;
     gf_boolean_t is_static;
+    data_buf_t *buf; /* set when @data points into a shared buffer */
 };
 
+/* Pairs and key bytes kept inside dict_t itself. Most dicts (xdata in
+ * particular) never outgrow them and need no allocation besides the dict. */
+#define DICT_INLINE_PAIRS 8
+#define DICT_INLINE_KEY_BYTES 256
+
 struct _data_pair {
-    struct _data_pair *hash_next;
     struct _data_pair *prev;
     struct _data_pair *next;
     data_t *value;
     char *key;
-    uint32_t key_hash;
+    uint32_t key_hash; /* only valid while the dict has a hash table */
+    uint32_t keylen;
 };
 
 struct _dict {
     uint64_t max_count;
-    int32_t hash_size;
     int32_t count;
     gf_atomic_t refcount;
-    data_pair_t **members;
     data_pair_t *members_list;
     char *extra_stdfree;
     gf_lock_t lock;
-    data_pair_t *members_internal;
-    data_pair_t free_pair;
+    /* open addressing index of all the pairs, only built once the inline
+     * pairs are exhausted */
+    data_pair_t **table;
+    uint32_t table_size; /* power of two, 0 without a table */
+    uint32_t table_fill; /* used slots, tombstones included */
+    uint32_t inline_map; /* bit i set if inline_pairs[i] is in use */
+    uint32_t keys_used;  /* bytes of inline_keys handed out */
     /* Variable to store total keylen + value->len */
     uint32_t totkvlen;
+    /* left uninitialized until used, keep them last */
+    data_pair_t inline_pairs[DICT_INLINE_PAIRS];
+    char inline_keys[DICT_INLINE_KEY_BYTES];
 };
 
 typedef gf_boolean_t (*dict_match_t)(dict_t *d, char *k, data_t *v, void *data);
@@ -163,6 +201,8 @@ int32_t
 dict_serialize(dict_t *dict, char *buf);
 int32_t
 dict_unserialize(char *buf, int32_t size, dict_t **fill);
+int32_t
+dict_unserialize_adopt(char *buf, int32_t size, dict_t **fill);
 
 int32_t
 dict_allocate_and_serialize(dict_t *this, char **buf, u_int *length);
@@ -189,6 +229,16 @@ data_t *
 strn_to_data(char *value, const int vallen);
 data_t *
 data_from_dynptr(void *value, int32_t len);
+
+data_buf_t *
+data_buf_new(int max);
+int
+data_buf_adopt(data_buf_t *buf, char *stdbuf);
+void
+data_buf_unref(data_buf_t *buf);
+data_t *
+data_from_buf(data_buf_t *buf, char *value, int32_t len,
+              gf_dict_data_type_t type);
 data_t *
 bin_to_data(void *value, int32_t len);
 data_t *
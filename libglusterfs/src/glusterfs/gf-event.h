@@ -111,6 +111,8 @@ struct event_ops {
     int (*event_pool_destroy)(struct event_pool *event_pool);
     int (*event_handled)(struct event_pool *event_pool, int fd, int idx,
                          int gen);
+    int (*event_clear_error)(struct event_pool *event_pool, int fd, int idx,
+                             int gen);
 };
 
 struct event_pool *
@@ -136,5 +138,7 @@ int
 gf_event_dispatch_destroy(struct event_pool *event_pool);
 int
 gf_event_handled(struct event_pool *event_pool, int fd, int idx, int gen);
+int
+gf_event_clear_error(struct event_pool *event_pool, int fd, int idx, int gen);
 
 #endif /* _GF_EVENT_H_ */
@@ -592,6 +592,10 @@ struct _cmd_args {
     bool global_threading;
     bool brick_mux;
 
+    /* iobuf arena layout */
+    int iobuf_hugepages; /* gf_iobuf_hugepages_t */
+    bool iobuf_numa;
+
     uint32_t fuse_dev_eperm_ratelimit_ns;
 };
 typedef struct _cmd_args cmd_args_t;
@@ -19,6 +19,14 @@
 
 #define DEFAULT_INODE_MEMPOOL_ENTRIES 32 * 1024
 #define INODE_PATH_FMT "<gfid:%s>"
+
+/* number of locks the buckets of each hash of an inode table are striped
+ * over, bucket i being covered by lock (i % INODE_TABLE_HASH_STRIPES) */
+#define INODE_TABLE_HASH_STRIPES 64
+
+/* lru entries retired with table->lock held before the background
+ * pruning drops it so that other threads can get in */
+#define INODE_PRUNE_BATCH 256
 struct _inode_table;
 typedef struct _inode_table inode_table_t;
 
@@ -43,6 +51,10 @@ struct _inode_table {
     uint32_t lru_limit;     /* maximum LRU cache size */
     struct list_head *inode_hash; /* buckets for inode hash table */
     struct list_head *name_hash;  /* buckets for dentry hash table */
+    /* Lookups only take the stripe of the bucket they walk. Changes to a
+       bucket take table->lock first and then the stripe. */
+    gf_lock_t inode_hash_lock[INODE_TABLE_HASH_STRIPES];
+    gf_lock_t name_hash_lock[INODE_TABLE_HASH_STRIPES];
     struct list_head active; /* list of inodes currently active (in an fop) */
     uint32_t active_size;    /* count of inodes in active list */
     struct list_head lru;    /* list of inodes recently used.
@@ -66,6 +78,13 @@ struct _inode_table {
     /* flag to indicate whether the cleanup of the inode
        table started or not */
     gf_boolean_t cleanup_started;
+
+    /* The lru list is pruned by a background job instead of the thread
+       which crossed lru_limit, unless it has grown past the hard budget. */
+    struct _inode_reaper *reaper;
+    pthread_cond_t reaper_cond; /* signalled when the job is done */
+    gf_boolean_t reaper_queued; /* the job is queued or running */
+    gf_boolean_t reaper_again;  /* more to prune since the job started */
 };
 
 struct _dentry {
@@ -74,6 +93,7 @@ struct _dentry {
     inode_t *inode;              /* inode of this directory entry */
     char *name;                  /* name of the directory entry */
     inode_t *parent;             /* directory of the entry */
+    int bucket;                  /* index in name_hash, if hashed */
 };
 
 struct _inode_ctx {
@@ -91,10 +111,10 @@ struct _inode_ctx {
         uint64_t value2;
         void *ptr2;
     };
-    int ref; /* This is for debugging inode ref leaks,
-                basically helps in identifying the xlator
-                causing th ref leak, it is printed in
-                statedump */
+    gf_atomic_int32_t ref; /* This is for debugging inode ref leaks,
+                              basically helps in identifying the xlator
+                              causing th ref leak, it is printed in
+                              statedump */
 };
 
 struct _inode {
@@ -104,12 +124,13 @@ struct _inode {
     gf_atomic_t nlookup;
     uint32_t fd_count;            /* Open fd count */
     uint32_t active_fd_count;     /* Active open fd count */
-    uint32_t ref;                 /* reference count on this inode */
+    gf_atomic_uint32_t ref;       /* reference count on this inode */
     ia_type_t ia_type;            /* what kind of file */
     struct list_head fd_list;     /* list of open files on this inode */
     struct list_head dentry_list; /* list of directory entries for this inode */
     struct list_head hash;        /* hash table pointers */
     struct list_head list;        /* active/lru/purge */
+    int bucket;                   /* index in inode_hash, if hashed */
 
     struct _inode_ctx *_ctx; /* replacement for dict_t *(inode->ctx) */
     bool in_invalidate_list; /* Set if inode is in table invalidate list */
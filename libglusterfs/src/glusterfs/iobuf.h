@@ -38,6 +38,15 @@
 
 #define GF_IOBUF_ALIGN_SIZE 512
 
+/* only arenas whose size is a multiple of this are backed by hugetlb pages */
+#define GF_IOBUF_HUGEPAGE_SIZE (2 * 1024 * 1024)
+
+typedef enum {
+    GF_IOBUF_HUGEPAGES_OFF = 0,
+    GF_IOBUF_HUGEPAGES_THP,     /* madvise(MADV_HUGEPAGE) the arenas */
+    GF_IOBUF_HUGEPAGES_HUGETLB, /* MAP_HUGETLB, THP when that fails */
+} gf_iobuf_hugepages_t;
+
 /* one allocatable unit for the consumers of the IOBUF API */
 /* each unit hosts @page_size bytes of memory */
 struct iobuf;
@@ -65,6 +74,10 @@ struct iobuf {
     };
     struct iobuf_arena *iobuf_arena;
 
+    /* link in a per-thread iobuf cache, the iobuf stays on the active list
+     * of its arena while it is cached */
+    struct list_head cache_list;
+
     gf_lock_t lock;  /* for ->ptr and ->ref */
     gf_atomic_t ref; /* 0 == passive, >0 == active */
 
@@ -101,6 +114,9 @@ struct iobuf_arena {
     int active_cnt;
     int passive_cnt;
     int max_active; /* max active buffers at a given time */
+    int pinned;     /* memory registered with the kernel, never purge */
+    int numa_node;  /* preferred node of the memory, -1 if none */
+    gf_iobuf_hugepages_t hugepages; /* how the memory is backed */
 };
 
 struct iobuf_pool {
@@ -122,6 +138,13 @@ struct iobuf_pool {
 
     uint64_t request_misses; /* mostly the requests for higher
                                value of iobufs */
+    gf_iobuf_hugepages_t hugepages; /* backing of newly mapped arenas */
+    int numa_nodes; /* > 1 if arenas are allocated per NUMA node */
+    /* per-thread cache hits and misses are collected here once a thread
+     * stops using the pool, see iobuf_stats_dump() for the live values */
+    gf_atomic_t cache_hits;   /* iobufs served from a per-thread cache */
+    gf_atomic_t cache_misses; /* per-thread cache refills from the pool */
+    gf_atomic_t cache_sweeps; /* idle cached iobufs given back by sweeper */
     int arena_cnt;
     int rdma_device_count;
     struct list_head *mr_list[GF_RDMA_DEVICE_COUNT];
@@ -155,8 +178,14 @@ struct iobref {
     struct iobuf **iobrefs;
     int allocated;
     int used;
+    /* read end of a pipe holding a payload that the transport moved out of
+     * the socket with splice(2), -1 if there is none */
+    int splice_fd;
+    size_t splice_len;
 };
 
+#define iobref_spliced(iobref) ((iobref) && ((iobref)->splice_fd >= 0))
+
 struct iobref *
 iobref_new(void);
 struct iobref *
@@ -174,6 +203,9 @@ size_t
 iobuf_size(struct iobuf *iobuf);
 size_t
 iobref_size(struct iobref *iobref);
+struct iobuf *
+iobref_splice_to_iobuf(struct iobuf_pool *iobuf_pool, struct iobref *iobref,
+                       size_t *size);
 void
 iobuf_stats_dump(struct iobuf_pool *iobuf_pool);
 
@@ -189,4 +221,17 @@ iobuf_copy(struct iobuf_pool *iobuf_pool, const struct iovec *iovec_src,
            int iovcnt, struct iobref **iobref, struct iobuf **iobuf,
            struct iovec *iov_dst);
 
+void
+iobuf_pool_set_layout(struct iobuf_pool *iobuf_pool,
+                      gf_iobuf_hugepages_t hugepages, int numa);
+
+void
+iobuf_cache_sweep(void);
+void
+iobuf_cache_thread_destructor(void);
+
+int
+iobuf_pool_pin_arenas(struct iobuf_pool *iobuf_pool, struct iovec *iov,
+                      int count);
+
 #endif /* !_IOBUF_H_ */
@@ -863,6 +863,11 @@ struct _xlator {
     uint32_t parent_down;
 };
 
+/* xlator_api_t flags */
+/* The xlator looks at the bytes of WRITE payloads, not only at their length.
+ * A payload spliced by the transport is copied in before reaching it. */
+#define GF_XLATOR_READS_WRITE_PAYLOAD 0x00000001
+
 /* This would be the only structure which needs to be exported by
    the translators. For the backward compatibility, in 4.x series
    even the old exported fields will be supported */
@@ -17,6 +17,7 @@
 #include "glusterfs/list.h"
 #include <assert.h>
 #include "glusterfs/libglusterfs-messages.h"
+#include "glusterfs/async.h"
 
 /* TODO:
    move latest accessed dentry to list_head of inode
@@ -135,6 +136,11 @@ __inode_unref(inode_t *inode, bool clear);
 static int
 inode_table_prune(inode_table_t *table);
 
+typedef struct _inode_reaper {
+    gf_async_t async;
+    inode_table_t *table;
+} inode_reaper_t;
+
 void
 fd_dump(struct list_head *head, char *prefix);
 
@@ -161,16 +167,11 @@ hash_gfid(uuid_t uuid, int mod)
     return ((uuid[15] + (uuid[14] << 8)) % mod);
 }
 
-static void
-__dentry_hash(dentry_t *dentry, const int hash)
-{
-    inode_table_t *table = NULL;
-
-    table = dentry->inode->table;
+#define inode_hash_stripe(table, bucket)                                       \
+    (&(table)->inode_hash_lock[(bucket) % INODE_TABLE_HASH_STRIPES])
 
-    list_del_init(&dentry->hash);
-    list_add(&dentry->hash, &table->name_hash[hash]);
-}
+#define name_hash_stripe(table, bucket)                                        \
+    (&(table)->name_hash_lock[(bucket) % INODE_TABLE_HASH_STRIPES])
 
 static int
 __is_dentry_hashed(dentry_t *dentry)
@@ -181,7 +182,35 @@ __is_dentry_hashed(dentry_t *dentry)
 static void
 __dentry_unhash(dentry_t *dentry)
 {
-    list_del_init(&dentry->hash);
+    inode_table_t *table = NULL;
+
+    if (!__is_dentry_hashed(dentry))
+        return;
+
+    table = dentry->inode->table;
+
+    LOCK(name_hash_stripe(table, dentry->bucket));
+    {
+        list_del_init(&dentry->hash);
+    }
+    UNLOCK(name_hash_stripe(table, dentry->bucket));
+}
+
+static void
+__dentry_hash(dentry_t *dentry, const int hash)
+{
+    inode_table_t *table = NULL;
+
+    table = dentry->inode->table;
+
+    __dentry_unhash(dentry);
+
+    LOCK(name_hash_stripe(table, hash));
+    {
+        list_add(&dentry->hash, &table->name_hash[hash]);
+        dentry->bucket = hash;
+    }
+    UNLOCK(name_hash_stripe(table, hash));
 }
 
 static void
@@ -282,25 +311,40 @@ __is_dentry_cyclic(dentry_t *dentry)
     return ret;
 }
 
-static void
-__inode_unhash(inode_t *inode)
-{
-    list_del_init(&inode->hash);
-}
-
 static int
 __is_inode_hashed(inode_t *inode)
 {
     return !list_empty(&inode->hash);
 }
 
+static void
+__inode_unhash(inode_t *inode)
+{
+    inode_table_t *table = inode->table;
+
+    if (!__is_inode_hashed(inode))
+        return;
+
+    LOCK(inode_hash_stripe(table, inode->bucket));
+    {
+        list_del_init(&inode->hash);
+    }
+    UNLOCK(inode_hash_stripe(table, inode->bucket));
+}
+
 static void
 __inode_hash(inode_t *inode, const int hash)
 {
     inode_table_t *table = inode->table;
 
-    list_del_init(&inode->hash);
-    list_add(&inode->hash, &table->inode_hash[hash]);
+    __inode_unhash(inode);
+
+    LOCK(inode_hash_stripe(table, hash));
+    {
+        list_add(&inode->hash, &table->inode_hash[hash]);
+        inode->bucket = hash;
+    }
+    UNLOCK(inode_hash_stripe(table, hash));
 }
 
 static dentry_t *
@@ -461,11 +505,24 @@ out:
     return set_idx;
 }
 
+/* per xlator ref accounting, only used by statedump */
+static void
+inode_xl_ref_add(inode_t *inode, int32_t delta)
+{
+    int index = 0;
+    xlator_t *this = THIS;
+
+    index = __inode_get_xl_index(inode, this);
+    if (index >= 0) {
+        inode->_ctx[index].xl_key = this;
+        GF_ATOMIC_ADD(inode->_ctx[index].ref, delta);
+    }
+}
+
 static inode_t *
 __inode_unref(inode_t *inode, bool clear)
 {
-    int index = 0;
-    xlator_t *this = NULL;
+    uint32_t ref = 0;
     uint64_t nlookup = 0;
 
     /*
@@ -480,7 +537,7 @@ __inode_unref(inode_t *inode, bool clear)
      * as __inode_unref is called after acquiding
      * the inode table's lock.
      */
-    if (inode->table->cleanup_started && !inode->ref)
+    if (inode->table->cleanup_started && !GF_ATOMIC_GET(inode->ref))
         /*
          * There is a good chance that, the inode
          * on which unref came has already been
@@ -510,24 +567,18 @@ __inode_unref(inode_t *inode, bool clear)
          */
         return inode;
 
-    this = THIS;
-
     if (clear && inode->in_invalidate_list) {
         inode->in_invalidate_list = false;
         inode->table->invalidate_size--;
         __inode_activate(inode);
     }
-    GF_ASSERT(inode->ref);
+    GF_ASSERT(GF_ATOMIC_GET(inode->ref));
 
-    --inode->ref;
+    ref = GF_ATOMIC_DEC(inode->ref);
 
-    index = __inode_get_xl_index(inode, this);
-    if (index >= 0) {
-        inode->_ctx[index].xl_key = this;
-        inode->_ctx[index].ref--;
-    }
+    inode_xl_ref_add(inode, -1);
 
-    if (!inode->ref && !inode->in_invalidate_list) {
+    if (!ref && !inode->in_invalidate_list) {
         inode->table->active_size--;
 
         nlookup = GF_ATOMIC_GET(inode->nlookup);
@@ -543,14 +594,9 @@ __inode_unref(inode_t *inode, bool clear)
 static inode_t *
 __inode_ref(inode_t *inode, bool is_invalidate)
 {
-    int index = 0;
-    xlator_t *this = NULL;
-
     if (!inode)
         return NULL;
 
-    this = THIS;
-
     /*
      * Root inode should always be in active list of inode table. So unrefs
      * on root inode are no-ops. If we do not allow unrefs but allow refs,
@@ -559,10 +605,10 @@ __inode_ref(inode_t *inode, bool is_invalidate)
      * in inode table increases which is wrong. So just keep the ref
      * count as 1 always
      */
-    if (__is_root_gfid(inode->gfid) && inode->ref)
+    if (__is_root_gfid(inode->gfid) && GF_ATOMIC_GET(inode->ref))
         return inode;
 
-    if (!inode->ref) {
+    if (!GF_ATOMIC_GET(inode->ref)) {
         if (inode->in_invalidate_list) {
             inode->in_invalidate_list = false;
             inode->table->invalidate_size--;
@@ -581,17 +627,57 @@ __inode_ref(inode_t *inode, bool is_invalidate)
         }
     }
 
-    inode->ref++;
+    GF_ATOMIC_INC(inode->ref);
 
-    index = __inode_get_xl_index(inode, this);
-    if (index >= 0) {
-        inode->_ctx[index].xl_key = this;
-        inode->_ctx[index].ref++;
-    }
+    inode_xl_ref_add(inode, 1);
 
     return inode;
 }
 
+/* The lists of the table only change when the refcount of an inode moves
+ * between 0 and 1, which is always done with table->lock held. Other updates
+ * are done here with a plain compare-and-swap, which never crosses that
+ * boundary. Both return false when the caller has to take the lock. */
+static bool
+inode_ref_fast(inode_t *inode)
+{
+    uint32_t ref = GF_ATOMIC_GET(inode->ref);
+
+    while (ref) {
+        /* the root stays at 1, see __inode_ref () */
+        if (__is_root_gfid(inode->gfid))
+            return true;
+
+        if (GF_ATOMIC_CMP_SWAP(inode->ref, ref, ref + 1)) {
+            inode_xl_ref_add(inode, 1);
+            return true;
+        }
+        ref = GF_ATOMIC_GET(inode->ref);
+    }
+
+    return false;
+}
+
+static bool
+inode_unref_fast(inode_t *inode)
+{
+    uint32_t ref = 0;
+
+    if (__is_root_gfid(inode->gfid))
+        return true;
+
+    ref = GF_ATOMIC_GET(inode->ref);
+    while (ref > 1) {
+        if (GF_ATOMIC_CMP_SWAP(inode->ref, ref, ref - 1)) {
+            inode_xl_ref_add(inode, -1);
+            return true;
+        }
+        ref = GF_ATOMIC_GET(inode->ref);
+    }
+
+    return false;
+}
+
 inode_t *
 inode_unref(inode_t *inode)
 {
@@ -600,6 +686,9 @@ inode_unref(inode_t *inode)
     if (!inode)
         return NULL;
 
+    if (inode_unref_fast(inode))
+        return inode;
+
     table = inode->table;
 
     pthread_mutex_lock(&table->lock);
@@ -621,6 +710,9 @@ inode_ref(inode_t *inode)
     if (!inode)
         return NULL;
 
+    if (inode_ref_fast(inode))
+        return inode;
+
     table = inode->table;
 
     pthread_mutex_lock(&table->lock);
@@ -671,6 +763,7 @@ inode_create(inode_table_t *table)
     newi->table = table;
 
     LOCK_INIT(&newi->lock);
+    GF_ATOMIC_INIT(newi->ref, 0);
 
     INIT_LIST_HEAD(&newi->fd_list);
     INIT_LIST_HEAD(&newi->list);
@@ -732,15 +825,16 @@ static inode_t *
 __inode_ref_reduce_by_n(inode_t *inode, uint64_t nref)
 {
     uint64_t nlookup = 0;
+    uint32_t ref = 0;
 
-    GF_ASSERT(inode->ref >= nref);
+    GF_ASSERT(GF_ATOMIC_GET(inode->ref) >= nref);
 
-    inode->ref -= nref;
+    if (nref)
+        ref = GF_ATOMIC_SUB(inode->ref, nref);
+    else
+        GF_ATOMIC_SWAP(inode->ref, 0);
 
-    if (!nref)
-        inode->ref = 0;
-
-    if (!inode->ref) {
+    if (!ref) {
         inode->table->active_size--;
 
         nlookup = GF_ATOMIC_GET(inode->nlookup);
@@ -794,6 +888,7 @@ inode_grep(inode_table_t *table, inode_t *parent, const char *name)
 {
     inode_t *inode = NULL;
     dentry_t *dentry = NULL;
+    bool found = false;
 
     if (!table || !parent || !name) {
         gf_msg_callingfn(THIS->name, GF_LOG_WARNING, EINVAL, LG_MSG_INVALID_ARG,
@@ -804,6 +899,24 @@ inode_grep(inode_table_t *table, inode_t *parent, const char *name)
 
     int hash = hash_dentry(parent, name, table->dentry_hashsize);
 
+    LOCK(name_hash_stripe(table, hash));
+    {
+        dentry = __dentry_grep(table, parent, name, hash);
+        if (dentry) {
+            inode = dentry->inode;
+            if (inode && !inode_ref_fast(inode)) {
+                inode = NULL;
+                found = true;
+            }
+        }
+    }
+    UNLOCK(name_hash_stripe(table, hash));
+
+    if (!found)
+        return inode;
+
+    /* The inode is not in use: bringing it back from the lru list needs
+       the table lock, under which the dentry may be gone already. */
     pthread_mutex_lock(&table->lock);
     {
         dentry = __dentry_grep(table, parent, name, hash);
@@ -880,7 +993,7 @@ inode_grep_for_gfid(inode_table_t *table, inode_t *parent, const char *name,
 
     int hash = hash_dentry(parent, name, table->dentry_hashsize);
 
-    pthread_mutex_lock(&table->lock);
+    LOCK(name_hash_stripe(table, hash));
     {
         dentry = __dentry_grep(table, parent, name, hash);
         if (dentry) {
@@ -892,7 +1005,7 @@ inode_grep_for_gfid(inode_table_t *table, inode_t *parent, const char *name,
             }
         }
     }
-    pthread_mutex_unlock(&table->lock);
+    UNLOCK(name_hash_stripe(table, hash));
 
     return ret;
 }
@@ -933,6 +1046,7 @@ inode_t *
 inode_find(inode_table_t *table, uuid_t gfid)
 {
     inode_t *inode = NULL;
+    bool found = false;
 
     if (!table) {
         gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0,
@@ -944,6 +1058,20 @@ inode_find(inode_table_t *table, uuid_t gfid)
 
     int hash = hash_gfid(gfid, table->inode_hashsize);
 
+    LOCK(inode_hash_stripe(table, hash));
+    {
+        inode = __inode_find(table, gfid, hash);
+        if (inode && !inode_ref_fast(inode)) {
+            inode = NULL;
+            found = true;
+        }
+    }
+    UNLOCK(inode_hash_stripe(table, hash));
+
+    if (!found)
+        return inode;
+
+    /* same as in inode_grep () */
     pthread_mutex_lock(&table->lock);
     {
         inode = __inode_find(table, gfid, hash);
@@ -1549,32 +1677,58 @@ inode_table_set_lru_limit(inode_table_t *table, uint32_t lru_limit)
     return;
 }
 
+static void
+inode_table_purge(struct list_head *purge)
+{
+    inode_t *del = NULL;
+    inode_t *tmp = NULL;
+
+    list_for_each_entry_safe(del, tmp, purge, list)
+    {
+        list_del_init(&del->list);
+        inode_forget_atomic(del, 0);
+        __inode_destroy(del);
+    }
+}
+
+/* Retires the lru entries above lru_limit and destroys whatever is in the
+ * purge list. table->lock is dropped every INODE_PRUNE_BATCH entries and
+ * the inodes retired so far are destroyed without it. */
 static int
-inode_table_prune(inode_table_t *table)
+inode_table_reap(inode_table_t *table)
 {
     int ret = 0;
     int ret1 = 0;
     struct list_head purge = {
         0,
     };
-    inode_t *del = NULL;
     inode_t *tmp = NULL;
     inode_t *entry = NULL;
     uint64_t nlookup = 0;
     int64_t lru_size = 0;
-
-    if (!table)
-        return -1;
+    int batch = 0;
 
     INIT_LIST_HEAD(&purge);
 
     pthread_mutex_lock(&table->lock);
     {
-        if (!table->lru_limit)
-            goto purge_list;
-
         lru_size = table->lru_size;
-        while (lru_size > (table->lru_limit)) {
+        while (table->lru_limit && (lru_size > table->lru_limit)) {
+            if (batch == INODE_PRUNE_BATCH) {
+                list_splice_init(&table->purge, &purge);
+                table->purge_size = 0;
+                pthread_mutex_unlock(&table->lock);
+
+                inode_table_purge(&purge);
+                INIT_LIST_HEAD(&purge);
+                batch = 0;
+
+                pthread_mutex_lock(&table->lock);
+                if (lru_size > table->lru_size)
+                    lru_size = table->lru_size;
+                continue;
+            }
+
             if (list_empty(&table->lru)) {
                 GF_ASSERT(0);
                 gf_msg_callingfn(THIS->name, GF_LOG_WARNING, 0,
@@ -1586,6 +1740,7 @@ inode_table_prune(inode_table_t *table)
             }
 
             lru_size--;
+            batch++;
             entry = list_entry(table->lru.next, inode_t, list);
             GF_ASSERT(entry->in_lru_list);
             /* The logic of invalidation is required only if invalidator_fn
@@ -1610,7 +1765,6 @@ inode_table_prune(inode_table_t *table)
             ret++;
         }
 
-    purge_list:
         list_splice_init(&table->purge, &purge);
         table->purge_size = 0;
     }
@@ -1636,14 +1790,95 @@ inode_table_prune(inode_table_t *table)
     }
 
     /* Just so that if purge list is handled too, then clear it off */
-    list_for_each_entry_safe(del, tmp, &purge, list)
+    inode_table_purge(&purge);
+
+    return ret;
+}
+
+static gf_boolean_t
+__inode_table_needs_prune(inode_table_t *table)
+{
+    return (table->purge_size ||
+            (table->lru_limit && (table->lru_size > table->lru_limit)));
+}
+
+/* Past this the lru list has outgrown what the reaper keeps up with, and
+ * the thread which finds it so prunes by itself. */
+static gf_boolean_t
+__inode_table_over_budget(inode_table_t *table)
+{
+    uint32_t budget = max(table->lru_limit, INODE_PRUNE_BATCH);
+
+    return ((table->purge_size > budget) ||
+            (table->lru_limit &&
+             (table->lru_size > table->lru_limit + budget)));
+}
+
+static void
+inode_table_reaper(xlator_t *xl, gf_async_t *async)
+{
+    inode_reaper_t *reaper = NULL;
+    inode_table_t *table = NULL;
+    gf_boolean_t again = _gf_false;
+
+    reaper = caa_container_of(async, inode_reaper_t, async);
+    table = reaper->table;
+
+    do {
+        inode_table_reap(table);
+
+        pthread_mutex_lock(&table->lock);
+        {
+            again = table->reaper_again && !table->cleanup_started;
+            table->reaper_again = _gf_false;
+            if (!again) {
+                table->reaper_queued = _gf_false;
+                pthread_cond_broadcast(&table->reaper_cond);
+            }
+        }
+        pthread_mutex_unlock(&table->lock);
+    } while (again);
+}
+
+/* Called after every change which can leave something to prune. Mostly
+ * there is nothing to do, otherwise the work is handed to the reaper of
+ * the table so that the fop which crossed lru_limit isn't delayed by it. */
+static int
+inode_table_prune(inode_table_t *table)
+{
+    gf_boolean_t reap = _gf_false;
+    gf_boolean_t queue = _gf_false;
+
+    if (!table)
+        return -1;
+
+    /* Unlocked check, a stale value only delays pruning to the next call */
+    if (!__inode_table_needs_prune(table))
+        return 0;
+
+    pthread_mutex_lock(&table->lock);
     {
-        list_del_init(&del->list);
-        inode_forget_atomic(del, 0);
-        __inode_destroy(del);
+        if (!__inode_table_needs_prune(table)) {
+            /* somebody else got to it */
+        } else if (table->cleanup_started || !table->reaper ||
+                   __inode_table_over_budget(table)) {
+            reap = _gf_true;
+        } else if (table->reaper_queued) {
+            table->reaper_again = _gf_true;
+        } else {
+            table->reaper_queued = _gf_true;
+            queue = _gf_true;
+        }
     }
+    pthread_mutex_unlock(&table->lock);
 
-    return ret;
+    if (queue)
+        gf_async(&table->reaper->async, table->xl, inode_table_reaper);
+
+    if (reap)
+        return inode_table_reap(table);
+
+    return 0;
 }
 
 static void
@@ -1757,9 +1992,21 @@ inode_table_with_invalidator(uint32_t lru_limit, xlator_t *xl,
 
     new->cleanup_started = _gf_false;
 
+    for (i = 0; i < INODE_TABLE_HASH_STRIPES; i++) {
+        LOCK_INIT(&new->inode_hash_lock[i]);
+        LOCK_INIT(&new->name_hash_lock[i]);
+    }
+
     __inode_table_init_root(new);
 
     pthread_mutex_init(&new->lock, NULL);
+    pthread_cond_init(&new->reaper_cond, NULL);
+
+    /* without it the table is pruned synchronously as before */
+    new->reaper = GF_CALLOC(1, sizeof(*new->reaper),
+                            gf_common_mt_inode_table_t);
+    if (new->reaper)
+        new->reaper->table = new;
 
     ret = 0;
 out:
@@ -1881,6 +2128,7 @@ void
 inode_table_destroy(inode_table_t *inode_table)
 {
     inode_t *trav = NULL;
+    int i = 0;
 
     if (inode_table == NULL)
         return;
@@ -1910,6 +2158,10 @@ inode_table_destroy(inode_table_t *inode_table)
     pthread_mutex_lock(&inode_table->lock);
     {
         inode_table->cleanup_started = _gf_true;
+        /* The reaper must not touch the table once it is freed */
+        while (inode_table->reaper_queued)
+            pthread_cond_wait(&inode_table->reaper_cond, &inode_table->lock);
+
         /* Process lru list first as we need to unset their dentry
          * entries (the ones which may not be unset during
          * '__inode_passivate' as they were hashed) which in turn
@@ -1949,14 +2201,14 @@ inode_table_destroy(inode_table_t *inode_table)
                                  LG_MSG_REF_COUNT,
                                  "Active inode(%p) with refcount"
                                  "(%d) found during cleanup",
-                                 trav, trav->ref);
+                                 trav, GF_ATOMIC_GET(trav->ref));
             inode_forget_atomic(trav, 0);
             __inode_ref_reduce_by_n(trav, 0);
         }
     }
     pthread_mutex_unlock(&inode_table->lock);
 
-    inode_table_prune(inode_table);
+    inode_table_reap(inode_table);
 
     GF_FREE(inode_table->inode_hash);
     GF_FREE(inode_table->name_hash);
@@ -1968,6 +2220,13 @@ inode_table_destroy(inode_table_t *inode_table)
         mem_pool_destroy(inode_table->fd_mem_pool);
 
     pthread_mutex_destroy(&inode_table->lock);
+    pthread_cond_destroy(&inode_table->reaper_cond);
+    GF_FREE(inode_table->reaper);
+
+    for (i = 0; i < INODE_TABLE_HASH_STRIPES; i++) {
+        LOCK_DESTROY(&inode_table->inode_hash_lock[i]);
+        LOCK_DESTROY(&inode_table->name_hash_lock[i]);
+    }
 
     GF_FREE(inode_table->name);
     GF_FREE(inode_table);
@@ -2446,7 +2705,7 @@ inode_dump(inode_t *inode, char *prefix)
         gf_proc_dump_write("nlookup", "%" PRIu64, nlookup);
         gf_proc_dump_write("fd-count", "%u", inode->fd_count);
         gf_proc_dump_write("active-fd-count", "%u", inode->active_fd_count);
-        gf_proc_dump_write("ref", "%u", inode->ref);
+        gf_proc_dump_write("ref", "%u", GF_ATOMIC_GET(inode->ref));
         gf_proc_dump_write("invalidate-sent", "%d", inode->invalidate_sent);
         gf_proc_dump_write("ia_type", "%d", inode->ia_type);
         if (inode->_ctx) {
@@ -2459,7 +2718,7 @@ inode_dump(inode_t *inode, char *prefix)
             for (i = 0; i < inode->table->ctxcount; i++) {
                 inode_ctx[i] = inode->_ctx[i];
                 xl = inode_ctx[i].xl_key;
-                ref = inode_ctx[i].ref;
+                ref = GF_ATOMIC_GET(inode_ctx[i].ref);
                 if (ref != 0 && xl) {
                     gf_proc_dump_build_key(key, "ref_by_xl:", "%s", xl->name);
                     gf_proc_dump_write(key, "%d", ref);
@@ -2559,7 +2818,7 @@ inode_dump_to_dict(inode_t *inode, char *prefix, dict_t *dict)
         goto out;
 
     snprintf(key, sizeof(key), "%s.ref", prefix);
-    ret = dict_set_uint32(dict, key, inode->ref);
+    ret = dict_set_uint32(dict, key, GF_ATOMIC_GET(inode->ref));
     if (ret)
         goto out;
 
@@ -12,6 +12,14 @@
 #include "glusterfs/statedump.h"
 #include <stdio.h>
 #include "glusterfs/libglusterfs-messages.h"
+#ifdef GF_LINUX_HOST_OS
+#include <sys/syscall.h>
+#include "glusterfs/syscall.h"
+#endif
+
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
 
 /*
   TODO: implement destroy margins and prefetching of arenas
@@ -58,6 +66,130 @@ gf_iobuf_get_pagesize(const size_t page_size, int *index)
     return -1;
 }
 
+static const char *gf_iobuf_hugepages_str[] = {
+    [GF_IOBUF_HUGEPAGES_OFF] = "off",
+    [GF_IOBUF_HUGEPAGES_THP] = "thp",
+    [GF_IOBUF_HUGEPAGES_HUGETLB] = "hugetlb",
+};
+
+/* NUMA node the calling thread is running on, -1 if unknown */
+static int
+iobuf_numa_node(void)
+{
+#if defined(GF_LINUX_HOST_OS) && defined(SYS_getcpu)
+    unsigned int node = 0;
+
+    if (syscall(SYS_getcpu, NULL, &node, NULL) == 0)
+        return node;
+#endif
+    return -1;
+}
+
+/* Number of NUMA nodes of the system, 1 if it can't be found out */
+static int
+iobuf_numa_node_count(void)
+{
+    char buf[64] = {
+        0,
+    };
+    char *last = NULL;
+    FILE *fp = NULL;
+    int count = 1;
+
+    /* a node list such as "0" or "0-3" */
+    fp = fopen("/sys/devices/system/node/possible", "r");
+    if (!fp)
+        return count;
+
+    if (fgets(buf, sizeof(buf), fp)) {
+        last = strrchr(buf, '-');
+        if (!last)
+            last = strrchr(buf, ',');
+        count = (last ? atoi(last + 1) : atoi(buf)) + 1;
+    }
+    fclose(fp);
+
+    return count;
+}
+
+/* Asks the kernel to place the (not yet faulted) memory of @iobuf_arena on
+ * @node. This is only a preference, the memory comes from another node when
+ * @node is short of free pages. */
+static void
+iobuf_arena_bind_node(struct iobuf_arena *iobuf_arena, int node)
+{
+    iobuf_arena->numa_node = -1;
+
+#if defined(GF_LINUX_HOST_OS) && defined(SYS_mbind)
+    unsigned long nodemask[4] = {
+        0,
+    };
+    const int bits = sizeof(unsigned long) * 8;
+
+    if (node < 0 || node >= sizeof(nodemask) * 8)
+        return;
+
+    nodemask[node / bits] |= 1UL << (node % bits);
+    if (syscall(SYS_mbind, iobuf_arena->mem_base, iobuf_arena->arena_size,
+                MPOL_PREFERRED, nodemask, sizeof(nodemask) * 8 + 1, 0) != 0) {
+        gf_msg_debug("iobuf", errno, "mbind() of arena %p to node %d failed",
+                     iobuf_arena->mem_base, node);
+        return;
+    }
+
+    iobuf_arena->numa_node = node;
+#endif
+}
+
+static void
+iobuf_arena_advise_thp(struct iobuf_arena *iobuf_arena)
+{
+#ifdef MADV_HUGEPAGE
+    if (iobuf_arena->arena_size % GF_IOBUF_HUGEPAGE_SIZE)
+        return;
+
+    if (madvise(iobuf_arena->mem_base, iobuf_arena->arena_size,
+                MADV_HUGEPAGE) == 0)
+        iobuf_arena->hugepages = GF_IOBUF_HUGEPAGES_THP;
+#endif
+}
+
+/* Maps the memory of an arena as requested by the pool's hugepages mode.
+ * Arenas which are not a multiple of the hugepage size would waste most of
+ * their last hugepage, they always get normal pages. */
+static void *
+iobuf_arena_map(struct iobuf_pool *iobuf_pool, struct iobuf_arena *iobuf_arena)
+{
+    void *mem = MAP_FAILED;
+
+    iobuf_arena->hugepages = GF_IOBUF_HUGEPAGES_OFF;
+
+#ifdef MAP_HUGETLB
+    if ((iobuf_pool->hugepages == GF_IOBUF_HUGEPAGES_HUGETLB) &&
+        !(iobuf_arena->arena_size % GF_IOBUF_HUGEPAGE_SIZE)) {
+        mem = mmap(NULL, iobuf_arena->arena_size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mem != MAP_FAILED) {
+            iobuf_arena->hugepages = GF_IOBUF_HUGEPAGES_HUGETLB;
+            return mem;
+        }
+        gf_msg_debug("iobuf", errno,
+                     "no hugetlb pages for an arena of %zu bytes, "
+                     "using transparent hugepages",
+                     iobuf_arena->arena_size);
+    }
+#endif
+
+    mem = mmap(NULL, iobuf_arena->arena_size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem != MAP_FAILED && iobuf_pool->hugepages != GF_IOBUF_HUGEPAGES_OFF) {
+        iobuf_arena->mem_base = mem;
+        iobuf_arena_advise_thp(iobuf_arena);
+    }
+
+    return mem;
+}
+
 static void
 __iobuf_arena_init_iobufs(struct iobuf_arena *iobuf_arena)
 {
@@ -74,6 +206,7 @@ __iobuf_arena_init_iobufs(struct iobuf_arena *iobuf_arena)
     iobuf = iobuf_arena->iobufs;
     for (i = 0; i < iobuf_cnt; i++) {
         INIT_LIST_HEAD(&iobuf->list);
+        INIT_LIST_HEAD(&iobuf->cache_list);
         LOCK_INIT(&iobuf->lock);
 
         iobuf->iobuf_arena = iobuf_arena;
@@ -139,7 +272,7 @@ out:
 
 static struct iobuf_arena *
 __iobuf_arena_alloc(struct iobuf_pool *iobuf_pool, size_t page_size,
-                    int32_t num_iobufs)
+                    int32_t num_iobufs, int node)
 {
     struct iobuf_arena *iobuf_arena = NULL;
     size_t rounded_size = 0;
@@ -164,14 +297,14 @@ __iobuf_arena_alloc(struct iobuf_pool *iobuf_pool, size_t page_size,
 
     iobuf_arena->arena_size = rounded_size * num_iobufs;
 
-    iobuf_arena->mem_base = mmap(NULL, iobuf_arena->arena_size,
-                                 PROT_READ | PROT_WRITE,
-                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    iobuf_arena->mem_base = iobuf_arena_map(iobuf_pool, iobuf_arena);
     if (iobuf_arena->mem_base == MAP_FAILED) {
         gf_smsg(THIS->name, GF_LOG_WARNING, 0, LG_MSG_MAPPING_FAILED, NULL);
         goto err;
     }
 
+    iobuf_arena_bind_node(iobuf_arena, node);
+
     if (iobuf_pool->rdma_registration) {
         iobuf_pool->rdma_registration(iobuf_pool->device, iobuf_arena);
     }
@@ -197,33 +330,39 @@ out:
 
 static struct iobuf_arena *
 __iobuf_arena_unprune(struct iobuf_pool *iobuf_pool, const size_t page_size,
-                      const int index)
+                      const int index, const int node)
 {
     struct iobuf_arena *iobuf_arena = NULL;
     struct iobuf_arena *tmp = NULL;
 
     GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, out);
 
+    /* an arena of the requested node if there is one, else any */
     list_for_each_entry(tmp, &iobuf_pool->purge[index], list)
     {
-        list_del_init(&tmp->list);
-        iobuf_arena = tmp;
-        break;
+        if (!iobuf_arena || tmp->numa_node == node)
+            iobuf_arena = tmp;
+        if (iobuf_arena->numa_node == node)
+            break;
     }
+
+    if (iobuf_arena)
+        list_del_init(&iobuf_arena->list);
 out:
     return iobuf_arena;
 }
 
 static struct iobuf_arena *
 __iobuf_pool_add_arena(struct iobuf_pool *iobuf_pool, const size_t page_size,
-                       const int32_t num_pages, const int index)
+                       const int32_t num_pages, const int index, const int node)
 {
     struct iobuf_arena *iobuf_arena = NULL;
 
-    iobuf_arena = __iobuf_arena_unprune(iobuf_pool, page_size, index);
+    iobuf_arena = __iobuf_arena_unprune(iobuf_pool, page_size, index, node);
 
     if (!iobuf_arena) {
-        iobuf_arena = __iobuf_arena_alloc(iobuf_pool, page_size, num_pages);
+        iobuf_arena = __iobuf_arena_alloc(iobuf_pool, page_size, num_pages,
+                                          node);
         if (!iobuf_arena) {
             gf_smsg(THIS->name, GF_LOG_WARNING, 0, LG_MSG_ARENA_NOT_FOUND,
                     NULL);
@@ -235,6 +374,9 @@ __iobuf_pool_add_arena(struct iobuf_pool *iobuf_pool, const size_t page_size,
     return iobuf_arena;
 }
 
+static void
+iobuf_cache_pool_detach(struct iobuf_pool *iobuf_pool);
+
 /* This function destroys all the iobufs and the iobuf_pool */
 void
 iobuf_pool_destroy(struct iobuf_pool *iobuf_pool)
@@ -245,6 +387,8 @@ iobuf_pool_destroy(struct iobuf_pool *iobuf_pool)
 
     GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, out);
 
+    iobuf_cache_pool_detach(iobuf_pool);
+
     pthread_mutex_lock(&iobuf_pool->mutex);
     {
         for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++) {
@@ -309,6 +453,7 @@ iobuf_create_stdalloc_arena(struct iobuf_pool *iobuf_pool)
     iobuf_arena->iobuf_pool = iobuf_pool;
 
     iobuf_arena->page_size = 0x7fffffff;
+    iobuf_arena->numa_node = -1;
 
     list_add_tail(&iobuf_arena->list,
                   &iobuf_pool->arenas[IOBUF_ARENA_MAX_INDEX]);
@@ -338,6 +483,12 @@ iobuf_pool_new(void)
     }
 
     iobuf_pool->default_page_size = 128 * GF_UNIT_KB;
+    iobuf_pool->hugepages = GF_IOBUF_HUGEPAGES_OFF;
+    iobuf_pool->numa_nodes = 1;
+
+    GF_ATOMIC_INIT(iobuf_pool->cache_hits, 0);
+    GF_ATOMIC_INIT(iobuf_pool->cache_misses, 0);
+    GF_ATOMIC_INIT(iobuf_pool->cache_sweeps, 0);
 
     iobuf_pool->rdma_registration = NULL;
     iobuf_pool->rdma_deregistration = NULL;
@@ -354,7 +505,7 @@ iobuf_pool_new(void)
         page_size = gf_iobuf_init_config[i].pagesize;
         num_pages = gf_iobuf_init_config[i].num_pages;
 
-        if (__iobuf_pool_add_arena(iobuf_pool, page_size, num_pages, i) != NULL)
+        if (__iobuf_pool_add_arena(iobuf_pool, page_size, num_pages, i, -1))
             arena_size += page_size * num_pages;
     }
 
@@ -379,6 +530,10 @@ __iobuf_arena_prune(struct iobuf_pool *iobuf_pool,
     if (list_empty(&iobuf_pool->arenas[index]))
         goto out;
 
+    /* pinned arenas may still be referenced by the kernel */
+    if (iobuf_arena->pinned)
+        goto out;
+
     /* All cases matched, destroy */
     list_del_init(&iobuf_arena->list);
     list_del_init(&iobuf_arena->all_list);
@@ -426,21 +581,28 @@ __iobuf_select_arena(struct iobuf_pool *iobuf_pool, const size_t page_size,
 {
     struct iobuf_arena *iobuf_arena = NULL;
     struct iobuf_arena *trav = NULL;
+    int node = -1;
+
+    if (iobuf_pool->numa_nodes > 1)
+        node = iobuf_numa_node();
 
-    /* look for unused iobuf from the head-most arena */
+    /* look for unused iobuf from the head-most arena, preferably one on the
+     * NUMA node of the calling thread */
     list_for_each_entry(trav, &iobuf_pool->arenas[index], list)
     {
-        if (trav->passive_cnt) {
+        if (!trav->passive_cnt)
+            continue;
+        if (!iobuf_arena || trav->numa_node == node)
             iobuf_arena = trav;
+        if (node == -1 || iobuf_arena->numa_node == node)
             break;
-        }
     }
 
     if (!iobuf_arena) {
         /* all arenas were full, find the right count to add */
         iobuf_arena = __iobuf_pool_add_arena(
             iobuf_pool, page_size, gf_iobuf_init_config[index].num_pages,
-            index);
+            index, node);
     }
 
     return iobuf_arena;
@@ -481,6 +643,466 @@ __iobuf_get(struct iobuf_pool *iobuf_pool, const size_t page_size,
     return iobuf;
 }
 
+/* Per-thread iobuf caches
+ *
+ * Every thread keeps a small magazine of free iobufs for each page size of
+ * the pool it uses, so that most iobuf_get()/iobuf_put() calls don't need to
+ * take iobuf_pool->mutex. A miss refills half a magazine from the pool in a
+ * single critical section, and a put into a full magazine gives half of it
+ * back the same way.
+ *
+ * Cached iobufs stay accounted as active in their arena, so an arena is never
+ * purged under a cache. To avoid keeping buffers forever in threads that went
+ * idle, each slot tracks the lowest number of buffers it held since the last
+ * sweep: those were never needed and iobuf_cache_sweep(), which runs from the
+ * mem-pool sweeper thread, gives them back to the pool. The owner thread does
+ * the same every IOBUF_CACHE_TRIM_PUTS puts, so caches are also trimmed when
+ * there is no sweeper, and a cache is emptied when its thread exits.
+ *
+ * On NUMA systems a cache only holds iobufs of the node its thread runs on.
+ * When the thread moves to another node the cache is emptied, and iobufs of
+ * other nodes are not cached.
+ *
+ * Lock ordering is iobuf_cache_lock -> iobuf_pool->mutex. A cache's own lock
+ * is never held while taking any other lock.
+ */
+
+#define IOBUF_CACHE_BYTES (1 * 1024 * 1024)
+#define IOBUF_CACHE_MAX 16
+#define IOBUF_CACHE_TRIM_PUTS 4096
+
+struct iobuf_cache_slot {
+    struct list_head list; /* most recently used iobuf first */
+    int count;
+    int low; /* lowest count since the last sweep */
+    int max;
+};
+
+struct iobuf_cache {
+    /* place in iobuf_caches, protected by iobuf_cache_lock */
+    struct list_head thr_list;
+    /* protects everything below */
+    pthread_spinlock_t lock;
+    struct iobuf_pool *pool; /* only iobufs of this pool are cached */
+    int node;                /* NUMA node of the cached iobufs, -1 if any */
+    unsigned int puts;       /* since the owner last trimmed the cache */
+    uint64_t hits;
+    uint64_t misses;
+    struct iobuf_cache_slot slots[IOBUF_ARENA_MAX_INDEX];
+};
+
+static pthread_mutex_t iobuf_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct list_head iobuf_caches = {&iobuf_caches, &iobuf_caches};
+static __thread struct iobuf_cache *thread_iobuf_cache = NULL;
+
+static void
+__iobuf_put(struct iobuf *iobuf, struct iobuf_arena *iobuf_arena);
+
+/* Gives back a list of iobufs collected from caches. Takes the pool mutex */
+static void
+iobuf_cache_release(struct iobuf_pool *iobuf_pool, struct list_head *head)
+{
+    struct iobuf *iobuf = NULL;
+    struct iobuf *tmp = NULL;
+
+    if (list_empty(head))
+        return;
+
+    pthread_mutex_lock(&iobuf_pool->mutex);
+    {
+        list_for_each_entry_safe(iobuf, tmp, head, cache_list)
+        {
+            list_del_init(&iobuf->cache_list);
+            __iobuf_put(iobuf, iobuf->iobuf_arena);
+        }
+    }
+    pthread_mutex_unlock(&iobuf_pool->mutex);
+}
+
+/* Always called with cache->lock held. Moves the @count least recently used
+ * iobufs of @slot to @head */
+static void
+__iobuf_cache_slot_trim(struct iobuf_cache_slot *slot, int count,
+                        struct list_head *head)
+{
+    struct iobuf *iobuf = NULL;
+
+    while (count-- > 0 && slot->count > 0) {
+        iobuf = list_entry(slot->list.prev, struct iobuf, cache_list);
+        list_move(&iobuf->cache_list, head);
+        slot->count--;
+    }
+
+    if (slot->low > slot->count)
+        slot->low = slot->count;
+}
+
+/* Always called with cache->lock held. Moves the iobufs not used since the
+ * previous trim to @head and returns their number */
+static int
+__iobuf_cache_trim_idle(struct iobuf_cache *cache, struct list_head *head)
+{
+    struct iobuf_cache_slot *slot = NULL;
+    int count = 0;
+    int i = 0;
+
+    for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++) {
+        slot = &cache->slots[i];
+        count += min(slot->low, slot->count);
+        __iobuf_cache_slot_trim(slot, slot->low, head);
+        slot->low = slot->count;
+    }
+
+    return count;
+}
+
+/* Always called with cache->lock held. Moves all the iobufs of the cache to
+ * @head */
+static void
+__iobuf_cache_empty(struct iobuf_cache *cache, struct list_head *head)
+{
+    struct iobuf_cache_slot *slot = NULL;
+    int i = 0;
+
+    for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++) {
+        slot = &cache->slots[i];
+        __iobuf_cache_slot_trim(slot, slot->count, head);
+        slot->low = 0;
+    }
+}
+
+/* NUMA node the iobufs cached by the calling thread must come from, -1 if
+ * any will do */
+static int
+iobuf_cache_node(struct iobuf_pool *iobuf_pool)
+{
+    if (iobuf_pool->numa_nodes > 1)
+        return iobuf_numa_node();
+
+    return -1;
+}
+
+/* Always called with cache->lock held. Empties the cache into @head if its
+ * iobufs are not of @node */
+static void
+__iobuf_cache_set_node(struct iobuf_cache *cache, int node,
+                       struct list_head *head)
+{
+    if (cache->node == node)
+        return;
+
+    __iobuf_cache_empty(cache, head);
+    cache->node = node;
+}
+
+/* Always called with cache->lock held. Detaches the cache from its pool and
+ * moves all its iobufs to @head */
+static void
+__iobuf_cache_detach(struct iobuf_cache *cache, struct list_head *head)
+{
+    if (!cache->pool)
+        return;
+
+    __iobuf_cache_empty(cache, head);
+
+    GF_ATOMIC_ADD(cache->pool->cache_hits, cache->hits);
+    GF_ATOMIC_ADD(cache->pool->cache_misses, cache->misses);
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->pool = NULL;
+}
+
+/* Returns the cache of the calling thread if it can hold iobufs of
+ * @iobuf_pool, creating it on first use */
+static struct iobuf_cache *
+iobuf_cache_get(struct iobuf_pool *iobuf_pool)
+{
+    struct iobuf_cache *cache = NULL;
+    size_t max = 0;
+    int i = 0;
+
+    cache = thread_iobuf_cache;
+    if (cache) {
+        /* the pool is only changed by the owner thread or when the pool is
+         * destroyed, no lock is needed to check it */
+        if (cache->pool == iobuf_pool)
+            return cache;
+        if (cache->pool)
+            return NULL;
+
+        pthread_spin_lock(&cache->lock);
+        cache->pool = iobuf_pool;
+        pthread_spin_unlock(&cache->lock);
+
+        return cache;
+    }
+
+    cache = MALLOC(sizeof(*cache));
+    if (!cache)
+        return NULL;
+
+    INIT_LIST_HEAD(&cache->thr_list);
+    pthread_spin_init(&cache->lock, PTHREAD_PROCESS_PRIVATE);
+    cache->pool = iobuf_pool;
+    cache->node = -1;
+    cache->puts = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++) {
+        max = IOBUF_CACHE_BYTES / gf_iobuf_init_config[i].pagesize;
+
+        INIT_LIST_HEAD(&cache->slots[i].list);
+        cache->slots[i].count = 0;
+        cache->slots[i].low = 0;
+        cache->slots[i].max = min(max, IOBUF_CACHE_MAX);
+    }
+
+    pthread_mutex_lock(&iobuf_cache_lock);
+    list_add(&cache->thr_list, &iobuf_caches);
+    pthread_mutex_unlock(&iobuf_cache_lock);
+
+    thread_iobuf_cache = cache;
+
+    /* make sure the cached iobufs are given back when the thread exits */
+    gf_thread_needs_cleanup();
+
+    return cache;
+}
+
+static struct iobuf *
+iobuf_cache_get_iobuf(struct iobuf_pool *iobuf_pool, const size_t page_size,
+                      const int index)
+{
+    struct iobuf_cache *cache = NULL;
+    struct iobuf_cache_slot *slot = NULL;
+    struct iobuf *iobuf = NULL;
+    struct iobuf *extra = NULL;
+    struct list_head refill;
+    struct list_head stale;
+    int count = 0;
+    int node = -1;
+
+    cache = iobuf_cache_get(iobuf_pool);
+    if (!cache)
+        return NULL;
+
+    slot = &cache->slots[index];
+    node = iobuf_cache_node(iobuf_pool);
+    INIT_LIST_HEAD(&stale);
+
+    pthread_spin_lock(&cache->lock);
+    __iobuf_cache_set_node(cache, node, &stale);
+    if (slot->count > 0) {
+        iobuf = list_first_entry(&slot->list, struct iobuf, cache_list);
+        list_del_init(&iobuf->cache_list);
+        slot->count--;
+        if (slot->low > slot->count)
+            slot->low = slot->count;
+        cache->hits++;
+        pthread_spin_unlock(&cache->lock);
+
+        return iobuf;
+    }
+    cache->misses++;
+    pthread_spin_unlock(&cache->lock);
+
+    iobuf_cache_release(iobuf_pool, &stale);
+
+    /* Take one iobuf for the caller and up to half a magazine more, but
+     * only from arenas that still have free iobufs: filling a cache is not
+     * a reason to map a new arena. */
+    INIT_LIST_HEAD(&refill);
+
+    pthread_mutex_lock(&iobuf_pool->mutex);
+    {
+        iobuf = __iobuf_get(iobuf_pool, page_size, index);
+        while (iobuf && (count < slot->max / 2) &&
+               !list_empty(&iobuf_pool->arenas[index])) {
+            extra = __iobuf_get(iobuf_pool, page_size, index);
+            if (!extra)
+                break;
+            if ((node != -1) && (extra->iobuf_arena->numa_node != node)) {
+                /* no more free iobufs on this node */
+                __iobuf_put(extra, extra->iobuf_arena);
+                break;
+            }
+            list_add_tail(&extra->cache_list, &refill);
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&iobuf_pool->mutex);
+
+    if (count) {
+        pthread_spin_lock(&cache->lock);
+        list_splice_init(&refill, &slot->list);
+        slot->count += count;
+        pthread_spin_unlock(&cache->lock);
+    }
+
+    return iobuf;
+}
+
+/* Returns false if @iobuf can't be cached and must go back to the pool */
+static gf_boolean_t
+iobuf_cache_put_iobuf(struct iobuf_pool *iobuf_pool, struct iobuf *iobuf,
+                      const int index)
+{
+    struct iobuf_cache *cache = NULL;
+    struct iobuf_cache_slot *slot = NULL;
+    struct list_head surplus;
+    int node = -1;
+
+    cache = iobuf_cache_get(iobuf_pool);
+    if (!cache)
+        return _gf_false;
+
+    /* iobufs of another node go back to their arena */
+    node = iobuf_cache_node(iobuf_pool);
+    if ((node != -1) && (iobuf->iobuf_arena->numa_node != -1) &&
+        (iobuf->iobuf_arena->numa_node != node))
+        return _gf_false;
+
+    slot = &cache->slots[index];
+
+    /* undo iobuf_get_page_aligned() */
+    if (iobuf->free_ptr) {
+        iobuf->ptr = iobuf->free_ptr;
+        iobuf->free_ptr = NULL;
+    }
+
+    INIT_LIST_HEAD(&surplus);
+
+    pthread_spin_lock(&cache->lock);
+    __iobuf_cache_set_node(cache, node, &surplus);
+    if (slot->count >= slot->max)
+        __iobuf_cache_slot_trim(slot, (slot->max + 1) / 2, &surplus);
+    list_add(&iobuf->cache_list, &slot->list);
+    slot->count++;
+    if (++cache->puts >= IOBUF_CACHE_TRIM_PUTS) {
+        cache->puts = 0;
+        __iobuf_cache_trim_idle(cache, &surplus);
+    }
+    pthread_spin_unlock(&cache->lock);
+
+    iobuf_cache_release(iobuf_pool, &surplus);
+
+    return _gf_true;
+}
+
+/* Gives back to the pools the cached iobufs that were not used since the
+ * previous sweep */
+void
+iobuf_cache_sweep(void)
+{
+    struct iobuf_cache *cache = NULL;
+    struct iobuf_pool *iobuf_pool = NULL;
+    struct list_head idle;
+    int count = 0;
+
+    INIT_LIST_HEAD(&idle);
+
+    pthread_mutex_lock(&iobuf_cache_lock);
+    list_for_each_entry(cache, &iobuf_caches, thr_list)
+    {
+        pthread_spin_lock(&cache->lock);
+        iobuf_pool = cache->pool;
+        count = __iobuf_cache_trim_idle(cache, &idle);
+        pthread_spin_unlock(&cache->lock);
+
+        if (count) {
+            GF_ATOMIC_ADD(iobuf_pool->cache_sweeps, count);
+            iobuf_cache_release(iobuf_pool, &idle);
+        }
+    }
+    pthread_mutex_unlock(&iobuf_cache_lock);
+}
+
+/* Gives back all the iobufs of the calling thread's cache, called when the
+ * thread exits */
+void
+iobuf_cache_thread_destructor(void)
+{
+    struct iobuf_cache *cache = NULL;
+    struct iobuf_pool *iobuf_pool = NULL;
+    struct list_head cached;
+
+    cache = thread_iobuf_cache;
+    if (!cache)
+        return;
+
+    INIT_LIST_HEAD(&cached);
+
+    pthread_mutex_lock(&iobuf_cache_lock);
+    {
+        list_del_init(&cache->thr_list);
+
+        pthread_spin_lock(&cache->lock);
+        iobuf_pool = cache->pool;
+        __iobuf_cache_detach(cache, &cached);
+        pthread_spin_unlock(&cache->lock);
+
+        if (iobuf_pool)
+            iobuf_cache_release(iobuf_pool, &cached);
+    }
+    pthread_mutex_unlock(&iobuf_cache_lock);
+
+    thread_iobuf_cache = NULL;
+
+    pthread_spin_destroy(&cache->lock);
+    FREE(cache);
+}
+
+/* Detaches all the caches from a pool that is going to be destroyed */
+static void
+iobuf_cache_pool_detach(struct iobuf_pool *iobuf_pool)
+{
+    struct iobuf_cache *cache = NULL;
+    struct list_head cached;
+
+    INIT_LIST_HEAD(&cached);
+
+    pthread_mutex_lock(&iobuf_cache_lock);
+    {
+        list_for_each_entry(cache, &iobuf_caches, thr_list)
+        {
+            pthread_spin_lock(&cache->lock);
+            if (cache->pool == iobuf_pool)
+                __iobuf_cache_detach(cache, &cached);
+            pthread_spin_unlock(&cache->lock);
+        }
+
+        iobuf_cache_release(iobuf_pool, &cached);
+    }
+    pthread_mutex_unlock(&iobuf_cache_lock);
+}
+
+/* Adds up the counters of the caches currently attached to @iobuf_pool */
+static void
+iobuf_cache_stats(struct iobuf_pool *iobuf_pool, uint64_t *hits,
+                  uint64_t *misses, uint64_t *cached)
+{
+    struct iobuf_cache *cache = NULL;
+    int i = 0;
+
+    *hits = GF_ATOMIC_GET(iobuf_pool->cache_hits);
+    *misses = GF_ATOMIC_GET(iobuf_pool->cache_misses);
+    *cached = 0;
+
+    pthread_mutex_lock(&iobuf_cache_lock);
+    list_for_each_entry(cache, &iobuf_caches, thr_list)
+    {
+        pthread_spin_lock(&cache->lock);
+        if (cache->pool == iobuf_pool) {
+            *hits += cache->hits;
+            *misses += cache->misses;
+            for (i = 0; i < IOBUF_ARENA_MAX_INDEX; i++)
+                *cached += cache->slots[i].count;
+        }
+        pthread_spin_unlock(&cache->lock);
+    }
+    pthread_mutex_unlock(&iobuf_cache_lock);
+}
+
 static struct iobuf *
 iobuf_get_from_stdalloc(struct iobuf_pool *iobuf_pool, const size_t page_size)
 {
@@ -555,6 +1177,12 @@ iobuf_get2(struct iobuf_pool *iobuf_pool, size_t page_size)
         return NULL;
     }
 
+    iobuf = iobuf_cache_get_iobuf(iobuf_pool, rounded_size, index);
+    if (iobuf) {
+        iobuf_ref(iobuf);
+        return iobuf;
+    }
+
     pthread_mutex_lock(&iobuf_pool->mutex);
     {
         iobuf = __iobuf_get(iobuf_pool, rounded_size, index);
@@ -619,6 +1247,13 @@ iobuf_get(struct iobuf_pool *iobuf_pool)
         return NULL;
     }
 
+    iobuf = iobuf_cache_get_iobuf(iobuf_pool, iobuf_pool->default_page_size,
+                                  index);
+    if (iobuf) {
+        iobuf_ref(iobuf);
+        goto out;
+    }
+
     pthread_mutex_lock(&iobuf_pool->mutex);
     {
         iobuf = __iobuf_get(iobuf_pool, iobuf_pool->default_page_size, index);
@@ -690,6 +1325,7 @@ iobuf_put(struct iobuf *iobuf)
 {
     struct iobuf_arena *iobuf_arena = NULL;
     struct iobuf_pool *iobuf_pool = NULL;
+    int index = 0;
 
     GF_VALIDATE_OR_GOTO("iobuf", iobuf, out);
 
@@ -706,6 +1342,10 @@ iobuf_put(struct iobuf *iobuf)
         return;
     }
 
+    index = gf_iobuf_get_arena_index(iobuf_arena->page_size);
+    if (index != -1 && iobuf_cache_put_iobuf(iobuf_pool, iobuf, index))
+        goto out;
+
     pthread_mutex_lock(&iobuf_pool->mutex);
     {
         __iobuf_put(iobuf, iobuf_arena);
@@ -760,6 +1400,8 @@ iobref_new()
 
     iobref->allocated = 16;
     iobref->used = 0;
+    iobref->splice_fd = -1;
+    iobref->splice_len = 0;
 
     LOCK_INIT(&iobref->lock);
 
@@ -793,6 +1435,9 @@ iobref_destroy(struct iobref *iobref)
             iobuf_unref(iobuf);
     }
 
+    if (iobref->splice_fd >= 0)
+        sys_close(iobref->splice_fd);
+
     GF_FREE(iobref->iobrefs);
     GF_FREE(iobref);
 
@@ -976,6 +1621,73 @@ out:
     return size;
 }
 
+/* Copies the payload left in the splice pipe of @iobref into a new iobuf,
+ * which is added to @iobref, and closes the pipe. Used by consumers that
+ * can't splice the payload any further. Stops early if the pipe runs dry,
+ * @size is set to the number of bytes copied. */
+struct iobuf *
+iobref_splice_to_iobuf(struct iobuf_pool *iobuf_pool, struct iobref *iobref,
+                       size_t *size)
+{
+    struct iobuf *iobuf = NULL;
+    size_t copied = 0;
+    ssize_t ret = 0;
+    int fd = -1;
+
+    GF_VALIDATE_OR_GOTO("iobuf", iobref, out);
+
+    LOCK(&iobref->lock);
+    {
+        fd = iobref->splice_fd;
+        iobref->splice_fd = -1;
+    }
+    UNLOCK(&iobref->lock);
+
+    if (fd < 0) {
+        errno = EBADF;
+        goto out;
+    }
+
+    iobuf = iobuf_get2(iobuf_pool, iobref->splice_len);
+    if (!iobuf)
+        goto close;
+
+    while (copied < iobref->splice_len) {
+        ret = sys_read(fd, (char *)iobuf_ptr(iobuf) + copied,
+                       iobref->splice_len - copied);
+        if (ret > 0) {
+            copied += ret;
+            continue;
+        }
+        if ((ret < 0) && (errno == EINTR))
+            continue;
+        /* EAGAIN: the transport had not filled the pipe completely */
+        break;
+    }
+
+    if ((ret < 0) && (errno != EAGAIN)) {
+        iobuf_unref(iobuf);
+        iobuf = NULL;
+        goto close;
+    }
+
+    if (iobref_add(iobref, iobuf) != 0) {
+        iobuf_unref(iobuf);
+        iobuf = NULL;
+        goto close;
+    }
+    /* the iobref keeps the iobuf alive */
+    iobuf_unref(iobuf);
+
+    if (size)
+        *size = copied;
+
+close:
+    sys_close(fd);
+out:
+    return iobuf;
+}
+
 void
 iobuf_info_dump(struct iobuf *iobuf, const char *key_prefix)
 {
@@ -1022,6 +1734,11 @@ iobuf_arena_info_dump(struct iobuf_arena *iobuf_arena, const char *key_prefix)
     gf_proc_dump_write(key, "%d", iobuf_arena->max_active);
     gf_proc_dump_build_key(key, key_prefix, "page_size");
     gf_proc_dump_write(key, "%" GF_PRI_SIZET, iobuf_arena->page_size);
+    gf_proc_dump_build_key(key, key_prefix, "numa_node");
+    gf_proc_dump_write(key, "%d", iobuf_arena->numa_node);
+    gf_proc_dump_build_key(key, key_prefix, "hugepages");
+    gf_proc_dump_write(key, "%s",
+                       gf_iobuf_hugepages_str[iobuf_arena->hugepages]);
     list_for_each_entry(trav, &iobuf_arena->active_list, list)
     {
         gf_proc_dump_build_key(key, key_prefix, "active_iobuf.%d", i++);
@@ -1038,12 +1755,18 @@ iobuf_stats_dump(struct iobuf_pool *iobuf_pool)
 {
     char msg[1024];
     struct iobuf_arena *trav = NULL;
+    uint64_t cache_hits = 0;
+    uint64_t cache_misses = 0;
+    uint64_t cache_cached = 0;
     int i = 1;
     int j = 0;
     int ret = -1;
 
     GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, out);
 
+    /* iobuf_cache_lock must not be taken with the pool mutex held */
+    iobuf_cache_stats(iobuf_pool, &cache_hits, &cache_misses, &cache_cached);
+
     ret = pthread_mutex_trylock(&iobuf_pool->mutex);
 
     if (ret) {
@@ -1058,6 +1781,14 @@ iobuf_stats_dump(struct iobuf_pool *iobuf_pool)
     gf_proc_dump_write("iobuf_pool.arena_cnt", "%d", iobuf_pool->arena_cnt);
     gf_proc_dump_write("iobuf_pool.request_misses", "%" PRId64,
                        iobuf_pool->request_misses);
+    gf_proc_dump_write("iobuf_pool.hugepages", "%s",
+                       gf_iobuf_hugepages_str[iobuf_pool->hugepages]);
+    gf_proc_dump_write("iobuf_pool.numa_nodes", "%d", iobuf_pool->numa_nodes);
+    gf_proc_dump_write("iobuf_pool.cache_hits", "%" PRIu64, cache_hits);
+    gf_proc_dump_write("iobuf_pool.cache_misses", "%" PRIu64, cache_misses);
+    gf_proc_dump_write("iobuf_pool.cache_sweeps", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(iobuf_pool->cache_sweeps));
+    gf_proc_dump_write("iobuf_pool.cached", "%" PRIu64, cache_cached);
 
     for (j = 0; j < IOBUF_ARENA_MAX_INDEX; j++) {
         list_for_each_entry(trav, &iobuf_pool->arenas[j], list)
@@ -1144,3 +1875,80 @@ iobuf_copy(struct iobuf_pool *iobuf_pool, const struct iovec *iovec_src,
 out:
     return ret;
 }
+
+/* Sets how new arenas of the pool are backed and placed. Arenas that are
+ * already mapped can't be moved to hugetlb pages, they are only advised to
+ * use transparent hugepages. With @numa, and more than one NUMA node in the
+ * system, new arenas are bound to the node of the thread that needs them and
+ * threads prefer arenas of their own node.
+ */
+void
+iobuf_pool_set_layout(struct iobuf_pool *iobuf_pool,
+                      gf_iobuf_hugepages_t hugepages, int numa)
+{
+    struct iobuf_arena *trav = NULL;
+    int numa_nodes = 1;
+
+    GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, out);
+
+    if (numa) {
+        numa_nodes = iobuf_numa_node_count();
+        if (numa_nodes < 2)
+            gf_msg_debug("iobuf", 0,
+                         "single NUMA node, iobuf arenas are not bound");
+    }
+
+    pthread_mutex_lock(&iobuf_pool->mutex);
+    {
+        iobuf_pool->hugepages = hugepages;
+        iobuf_pool->numa_nodes = numa_nodes;
+
+        if (hugepages != GF_IOBUF_HUGEPAGES_OFF) {
+            list_for_each_entry(trav, &iobuf_pool->all_arenas, all_list)
+            {
+                if (trav->hugepages == GF_IOBUF_HUGEPAGES_OFF)
+                    iobuf_arena_advise_thp(trav);
+            }
+        }
+    }
+    pthread_mutex_unlock(&iobuf_pool->mutex);
+
+out:
+    return;
+}
+
+/* Marks up to @count arenas of the pool as pinned and returns their memory
+ * regions in @iov. Pinned arenas are never purged, so the regions stay valid
+ * for as long as the pool exists and can be handed over to the kernel, e.g.
+ * as io_uring fixed buffers. Returns the number of regions filled in.
+ */
+int
+iobuf_pool_pin_arenas(struct iobuf_pool *iobuf_pool, struct iovec *iov,
+                      int count)
+{
+    struct iobuf_arena *trav = NULL;
+    int i = 0;
+
+    GF_VALIDATE_OR_GOTO("iobuf", iobuf_pool, out);
+    GF_VALIDATE_OR_GOTO("iobuf", iov, out);
+
+    pthread_mutex_lock(&iobuf_pool->mutex);
+    {
+        list_for_each_entry(trav, &iobuf_pool->all_arenas, all_list)
+        {
+            if (i == count)
+                break;
+            if (!trav->mem_base || trav->mem_base == MAP_FAILED)
+                continue;
+
+            trav->pinned = 1;
+            iov[i].iov_base = trav->mem_base;
+            iov[i].iov_len = trav->arena_size;
+            i++;
+        }
+    }
+    pthread_mutex_unlock(&iobuf_pool->mutex);
+
+out:
+    return i;
+}
@@ -11,6 +11,7 @@
 #include "glusterfs/mem-pool.h"
 #include "glusterfs/common-utils.h"  // for GF_ASSERT, gf_thread_cr...
 #include "glusterfs/globals.h"       // for xlator_t, THIS
+#include "glusterfs/iobuf.h"         // for iobuf_cache_sweep
 #include <stdlib.h>
 #include <stdarg.h>
 
@@ -485,6 +486,9 @@ pool_sweeper(void *arg)
         for (i = 0; i < state.n_cold_lists; ++i) {
             free_obj_list(state.cold_lists[i]);
         }
+
+        /* Idle buffers of the per-thread iobuf caches go back too. */
+        iobuf_cache_sweep();
         (void)pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
     }
 
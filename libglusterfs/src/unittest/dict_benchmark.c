@@ -0,0 +1,167 @@
+/*
+  Copyright (c) 2021 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+/*
+ * Microbenchmark of dict_t: for dicts of a given number of keys it measures
+ * the time to create, fill, query and destroy one dict, and counts the heap
+ * allocations made on top of the dict itself (keys, hash table and pairs).
+ *
+ * Build from a configured tree with something like:
+ *
+ *   cc -O2 -include config.h -D_GNU_SOURCE -DGF_LINUX_HOST_OS \
+ *      -D_FILE_OFFSET_BITS=64 -Ilibglusterfs/src \
+ *      libglusterfs/src/unittest/dict_benchmark.c \
+ *      -Llibglusterfs/src/.libs -lglusterfs -o dict_benchmark
+ *
+ * Usage: dict_benchmark [iterations]
+ */
+
+#include "glusterfs/glusterfs.h"
+#include "glusterfs/globals.h"
+#include "glusterfs/dict.h"
+#include "glusterfs/mem-pool.h"
+#include "glusterfs/mem-types.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_MAX_KEYS 128
+
+static char keys[BENCH_MAX_KEYS][64];
+static int keylens[BENCH_MAX_KEYS];
+
+static uint64_t
+bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint64_t
+bench_heap_allocs(xlator_t *xl)
+{
+    return xl->mem_acct->rec[gf_common_mt_char].total_allocs +
+           xl->mem_acct->rec[gf_common_mt_dict_table].total_allocs;
+}
+
+static int
+bench_one(dict_t *dict, int nkeys)
+{
+    int32_t val = 0;
+    int found = 0;
+    int i = 0;
+
+    for (i = 0; i < nkeys; i++) {
+        if (dict_set_int32n(dict, keys[i], keylens[i], i) != 0)
+            return -1;
+    }
+
+    /* every key once, plus as many lookups of keys that aren't there */
+    for (i = 0; i < nkeys; i++) {
+        if (dict_get_int32n(dict, keys[i], keylens[i], &val) == 0)
+            found++;
+        if (dict_get_int32n(dict, "trusted.glusterfs.missing",
+                            SLEN("trusted.glusterfs.missing"), &val) == 0)
+            return -1;
+    }
+
+    return (found == nkeys) ? 0 : -1;
+}
+
+static int
+bench_run(xlator_t *xl, int nkeys, int iterations)
+{
+    struct mem_pool *pair_pool = xl->ctx->dict_pair_pool;
+    uint64_t start = 0;
+    uint64_t elapsed = 0;
+    uint64_t allocs = 0;
+    int64_t pairs = 0;
+    dict_t *dict = NULL;
+    int i = 0;
+
+    /* allocations and pool pairs of a single dict */
+    allocs = bench_heap_allocs(xl);
+    pairs = GF_ATOMIC_GET(pair_pool->active);
+    dict = dict_new();
+    if (!dict || bench_one(dict, nkeys))
+        return -1;
+    allocs = bench_heap_allocs(xl) - allocs;
+    pairs = GF_ATOMIC_GET(pair_pool->active) - pairs;
+    dict_unref(dict);
+
+    start = bench_now_ns();
+    for (i = 0; i < iterations; i++) {
+        dict = dict_new();
+        if (!dict || bench_one(dict, nkeys))
+            return -1;
+        dict_unref(dict);
+    }
+    elapsed = bench_now_ns() - start;
+
+    /* the values (data_t) are the same for every layout, leave them out */
+    printf("%6d keys: %9.1f ns/dict %7.1f ns/op  %3" PRIu64
+           " heap allocs  %3" PRId64 " pool pairs\n",
+           nkeys, (double)elapsed / iterations,
+           (double)elapsed / iterations / (3 * nkeys), allocs, pairs);
+
+    return 0;
+}
+
+int
+main(int argc, char *argv[])
+{
+    static const int sizes[] = {1, 2, 4, 8, 9, 16, 32, 128};
+    glusterfs_ctx_t *ctx = NULL;
+    xlator_t *xl = NULL;
+    int iterations = 200000;
+    int i = 0;
+
+    if (argc > 1)
+        iterations = atoi(argv[1]);
+    if (iterations <= 0)
+        iterations = 1;
+
+    ctx = glusterfs_ctx_new();
+    if (!ctx || glusterfs_globals_init(ctx))
+        return 1;
+
+    xl = THIS;
+    xl->ctx = ctx;
+    ctx->mem_acct_enable = 1;
+    if (xlator_mem_acct_init(xl, gf_common_mt_end))
+        return 1;
+
+    ctx->dict_pool = mem_pool_new(dict_t, 32);
+    ctx->dict_pair_pool = mem_pool_new(data_pair_t, 512);
+    ctx->dict_data_pool = mem_pool_new(data_t, 512);
+    if (!ctx->dict_pool || !ctx->dict_pair_pool || !ctx->dict_data_pool)
+        return 1;
+
+    /* xdata style keys */
+    for (i = 0; i < BENCH_MAX_KEYS; i++)
+        keylens[i] = snprintf(keys[i], sizeof(keys[i]),
+                              "trusted.glusterfs.bench-%03d", i);
+
+    printf("dict_t: %zu bytes, %d inline pairs, %d inline key bytes\n",
+           sizeof(dict_t), DICT_INLINE_PAIRS, DICT_INLINE_KEY_BYTES);
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        if (bench_run(xl, sizes[i], iterations / sizes[i] + 1)) {
+            fprintf(stderr, "dict with %d keys failed\n", sizes[i]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
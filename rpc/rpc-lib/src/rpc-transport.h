@@ -189,6 +189,11 @@ struct rpc_transport {
 
     uint64_t total_bytes_read;
     uint64_t total_bytes_write;
+    /* MSG_ZEROCOPY sends, those the kernel reported done and, of these,
+     * the ones it copied anyway */
+    uint64_t total_zerocopy_sends;
+    uint64_t total_zerocopy_completed;
+    uint64_t total_zerocopy_copied;
     uint32_t xid; /* RPC/XID used for callbacks */
     int32_t outstanding_rpc_count;
 
@@ -32,6 +32,22 @@
 #include <errno.h>
 #include <rpc/xdr.h>
 #include <sys/ioctl.h>
+
+#ifdef GF_LINUX_HOST_OS
+#include <linux/errqueue.h>
+#if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY) &&                          \
+    defined(SO_EE_ORIGIN_ZEROCOPY)
+#define GF_SOCKET_ZEROCOPY 1
+#endif
+#endif
+
+/* Replies with less payload than this are cheaper to copy than to pin. */
+#define GF_SOCKET_ZEROCOPY_MIN (16 * GF_UNIT_KB)
+/* The kernel is done with the pages of an entry once its last send has
+ * completed. */
+#define __socket_zc_after(a, b) ((int32_t)((a) - (b)) > 0)
+#define __socket_zc_completed(priv, entry)                                    \
+    __socket_zc_after((priv)->zc_done, (entry)->zc_last)
 #define GF_LOG_ERRNO(errno) ((errno == ENOTCONN) ? GF_LOG_DEBUG : GF_LOG_ERROR)
 #define SA(ptr) ((struct sockaddr *)ptr)
 
@@ -659,10 +675,41 @@ __does_socket_rwv_error_need_logging(socket_private_t *priv, int write)
  * > 0 = incomplete
  */
 
+static ssize_t
+__socket_zerocopy_writev(rpc_transport_t *this, const struct iovec *vector,
+                         int count)
+{
+    socket_private_t *priv = this->private;
+    ssize_t ret = -1;
+#ifdef GF_SOCKET_ZEROCOPY
+    struct msghdr msg = {
+        0,
+    };
+
+    msg.msg_iov = (struct iovec *)vector;
+    msg.msg_iovlen = count;
+
+    ret = sendmsg(priv->sock, &msg, MSG_ZEROCOPY);
+    if (ret >= 0) {
+        /* every successful send gets a sequence number, the completion
+         * notifications refer to it */
+        priv->zc_seq++;
+        this->total_zerocopy_sends++;
+        return ret;
+    }
+    if (errno != ENOBUFS)
+        return ret;
+    /* out of option memory to pin more pages, copy this one */
+#endif
+    ret = sys_writev(priv->sock, vector, count);
+
+    return ret;
+}
+
 static int
 __socket_rwv(rpc_transport_t *this, struct iovec *vector, int count,
              struct iovec **pending_vector, int *pending_count, size_t *bytes,
-             int write)
+             int write, int zerocopy)
 {
     socket_private_t *priv = NULL;
     int sock = -1;
@@ -705,6 +752,9 @@ __socket_rwv(rpc_transport_t *this, struct iovec *vector, int count,
             if (priv->use_ssl) {
                 ret = ssl_write_one(this, opvector->iov_base,
                                     opvector->iov_len);
+            } else if (zerocopy) {
+                ret = __socket_zerocopy_writev(this, opvector,
+                                               IOV_MIN(opcount));
             } else {
                 ret = sys_writev(sock, opvector, IOV_MIN(opcount));
             }
@@ -804,15 +854,16 @@ __socket_readv(rpc_transport_t *this, struct iovec *vector, int count,
                struct iovec **pending_vector, int *pending_count, size_t *bytes)
 {
     return __socket_rwv(this, vector, count, pending_vector, pending_count,
-                        bytes, 0);
+                        bytes, 0, 0);
 }
 
 static int
 __socket_writev(rpc_transport_t *this, struct iovec *vector, int count,
-                struct iovec **pending_vector, int *pending_count)
+                struct iovec **pending_vector, int *pending_count,
+                int zerocopy)
 {
     return __socket_rwv(this, vector, count, pending_vector, pending_count,
-                        NULL, 1);
+                        NULL, 1, zerocopy);
 }
 
 static int
@@ -1199,6 +1250,7 @@ socket_set_last_frag_header_size(uint32_t size, char *haddr)
 static struct ioq *
 __socket_ioq_new(rpc_transport_t *this, rpc_transport_msg_t *msg)
 {
+    socket_private_t *priv = this->private;
     struct ioq *entry = NULL;
     int count = 0;
     uint32_t size = 0;
@@ -1255,6 +1307,13 @@ __socket_ioq_new(rpc_transport_t *this, rpc_transport_msg_t *msg)
     if (msg->iobref != NULL)
         entry->iobref = iobref_ref(msg->iobref);
 
+    /* the pages must stay untouched until the kernel reports the send as
+     * completed, which the iobref guarantees for the payload */
+    if (priv->zerocopy && entry->iobref &&
+        (iov_length(msg->progpayload, msg->progpayloadcount) >=
+         GF_SOCKET_ZEROCOPY_MIN))
+        entry->zerocopy = _gf_true;
+
     INIT_LIST_HEAD(&entry->list);
 
     return entry;
@@ -1276,29 +1335,189 @@ out:
     return;
 }
 
+static int
+__socket_zerocopy_reap(rpc_transport_t *this);
+
 static void
-__socket_ioq_flush(socket_private_t *priv)
+__socket_ioq_flush(rpc_transport_t *this)
 {
+    socket_private_t *priv = this->private;
     struct ioq *entry = NULL;
 
     while (!list_empty(&priv->ioq)) {
         entry = priv->ioq_next;
         __socket_ioq_entry_free(entry);
     }
+
+    /* the kernel keeps sending from the pinned pages after the socket is
+     * closed, they must not go back to the iobuf pool before that is
+     * over. Whatever hasn't completed yet is kept until fini(). */
+    if (!list_empty(&priv->zc_pending)) {
+        __socket_zerocopy_reap(this);
+        list_append_init(&priv->zc_pending, &priv->zc_closed);
+    }
+    priv->zc_seq = 0;
+    priv->zc_done = 0;
+    priv->zc_held_start = 0;
+    priv->zc_held_end = 0;
+}
+
+/* Marks the MSG_ZEROCOPY sends [start, end) as completed. zc_done only ever
+ * moves forward; a range past a gap is held back until the gap is filled. */
+static void
+__socket_zerocopy_complete(socket_private_t *priv, uint32_t start,
+                           uint32_t end)
+{
+    if (__socket_zc_after(start, priv->zc_done)) {
+        if (priv->zc_held_start == priv->zc_held_end) {
+            priv->zc_held_start = start;
+            priv->zc_held_end = end;
+        } else if (!__socket_zc_after(start, priv->zc_held_end) &&
+                   !__socket_zc_after(priv->zc_held_start, end)) {
+            /* overlaps or touches the held range */
+            if (__socket_zc_after(priv->zc_held_start, start))
+                priv->zc_held_start = start;
+            if (__socket_zc_after(end, priv->zc_held_end))
+                priv->zc_held_end = end;
+        } else if (__socket_zc_after(priv->zc_held_start, start)) {
+            /* only one range is held, keep the one closer to zc_done. The
+             * entries of the other one are freed with the socket. */
+            priv->zc_held_start = start;
+            priv->zc_held_end = end;
+        }
+        return;
+    }
+
+    if (__socket_zc_after(end, priv->zc_done))
+        priv->zc_done = end;
+
+    if ((priv->zc_held_start != priv->zc_held_end) &&
+        !__socket_zc_after(priv->zc_held_start, priv->zc_done)) {
+        if (__socket_zc_after(priv->zc_held_end, priv->zc_done))
+            priv->zc_done = priv->zc_held_end;
+        priv->zc_held_start = 0;
+        priv->zc_held_end = 0;
+    }
+}
+
+/* Reads the MSG_ZEROCOPY completion notifications from the socket error
+ * queue and frees the ioq entries the kernel is done with. Returns the
+ * number of notifications read. */
+static int
+__socket_zerocopy_reap(rpc_transport_t *this)
+{
+    int reaped = 0;
+#ifdef GF_SOCKET_ZEROCOPY
+    socket_private_t *priv = this->private;
+    struct sock_extended_err *serr = NULL;
+    struct cmsghdr *cmsg = NULL;
+    struct ioq *entry = NULL;
+    struct ioq *tmp = NULL;
+    struct msghdr msg;
+    char control[128];
+    uint32_t sends = 0;
+    int ret = 0;
+
+    for (;;) {
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        ret = recvmsg(priv->sock, &msg, MSG_ERRQUEUE);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!((cmsg->cmsg_level == SOL_IP) &&
+                  (cmsg->cmsg_type == IP_RECVERR)) &&
+                !((cmsg->cmsg_level == SOL_IPV6) &&
+                  (cmsg->cmsg_type == IPV6_RECVERR)))
+                continue;
+
+            serr = (struct sock_extended_err *)CMSG_DATA(cmsg);
+            if ((serr->ee_errno != 0) ||
+                (serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY))
+                continue;
+
+            /* sends of [ee_info, ee_data] completed; TCP reports them in
+             * order, possibly coalesced */
+            reaped++;
+            __socket_zerocopy_complete(priv, serr->ee_info,
+                                       serr->ee_data + 1);
+            sends = serr->ee_data - serr->ee_info + 1;
+            this->total_zerocopy_completed += sends;
+            if (serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED)
+                this->total_zerocopy_copied += sends;
+
+            if ((serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) &&
+                priv->zerocopy) {
+                /* the device can't send from our pages (or it is a
+                 * loopback connection), pinning them is pure overhead */
+                gf_log(this->name, GF_LOG_DEBUG,
+                       "zerocopy sends to %s got copied, disabling them",
+                       this->peerinfo.identifier);
+                priv->zerocopy = _gf_false;
+            }
+        }
+    }
+
+    list_for_each_entry_safe(entry, tmp, &priv->zc_pending, list)
+    {
+        if (!__socket_zc_completed(priv, entry))
+            break;
+        __socket_ioq_entry_free(entry);
+    }
+#endif
+    return reaped;
+}
+
+static void
+__socket_zerocopy_enable(rpc_transport_t *this)
+{
+#ifdef GF_SOCKET_ZEROCOPY
+    socket_private_t *priv = this->private;
+    int on = 1;
+
+    if (setsockopt(priv->sock, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) !=
+        0) {
+        gf_log(this->name, GF_LOG_DEBUG,
+               "could not enable zerocopy sends on socket %d (%s)",
+               priv->sock, strerror(errno));
+        return;
+    }
+
+    gf_log(this->name, GF_LOG_DEBUG, "enabled zerocopy sends on socket %d",
+           priv->sock);
+    priv->zerocopy = _gf_true;
+#endif
 }
 
 static int
 __socket_ioq_churn_entry(rpc_transport_t *this, struct ioq *entry)
 {
+    socket_private_t *priv = this->private;
+    uint32_t zc_seq = priv->zc_seq;
     int ret = -1;
 
     ret = __socket_writev(this, entry->pending_vector, entry->pending_count,
-                          &entry->pending_vector, &entry->pending_count);
+                          &entry->pending_vector, &entry->pending_count,
+                          (entry->zerocopy && priv->zerocopy));
+
+    if (priv->zc_seq != zc_seq) {
+        entry->zc_used = _gf_true;
+        entry->zc_last = priv->zc_seq - 1;
+    }
 
     if (ret == 0) {
         /* current entry was completely written */
         GF_ASSERT(entry->pending_count == 0);
-        __socket_ioq_entry_free(entry);
+        if (entry->zc_used && !__socket_zc_completed(priv, entry))
+            list_move_tail(&entry->list, &priv->zc_pending);
+        else
+            __socket_ioq_entry_free(entry);
     }
 
     return ret;
@@ -1332,6 +1551,18 @@ __socket_ioq_churn(rpc_transport_t *this)
     return ret;
 }
 
+static int
+__socket_sock_error(int sock)
+{
+    int error = 0;
+    socklen_t len = sizeof(error);
+
+    if (getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &len) != 0)
+        return errno;
+
+    return error;
+}
+
 static gf_boolean_t
 socket_event_poll_err(rpc_transport_t *this, int gen, int idx)
 {
@@ -1343,7 +1574,7 @@ socket_event_poll_err(rpc_transport_t *this, int gen, int idx)
     pthread_mutex_lock(&priv->out_lock);
     {
         if ((priv->gen == gen) && (priv->idx == idx) && (priv->sock >= 0)) {
-            __socket_ioq_flush(priv);
+            __socket_ioq_flush(this);
             __socket_reset(this);
             socket_closed = _gf_true;
         }
@@ -1462,6 +1693,182 @@ out:
     return ret;
 }
 
+/* Payloads smaller than this are cheaper to copy than to splice. */
+#define GF_SOCKET_SPLICE_MIN (64 * GF_UNIT_KB)
+/* Largest pipe a payload pipe may grow to. */
+#define GF_SOCKET_SPLICE_PIPE_MAX (16 * GF_UNIT_MB)
+
+/* Sets up a pipe to receive the @size bytes of payload of the current
+ * request with splice(2), so that they never get copied to user space.
+ * The read end of the pipe is handed over to consumers through the
+ * iobref of the request (see iobref_spliced()). Returns -1 if the payload
+ * has to be read the usual way. */
+static int
+__socket_splice_payload_init(rpc_transport_t *this, size_t size)
+{
+#ifdef F_SETPIPE_SZ
+    socket_private_t *priv = NULL;
+    struct gf_sock_incoming *in = NULL;
+    int pipefd[2] = {-1, -1};
+    int ret = -1;
+
+    priv = this->private;
+    in = &priv->incoming;
+
+    if (!priv->splice_payload || priv->use_ssl || (size < GF_SOCKET_SPLICE_MIN))
+        goto out;
+
+    if (in->iobref == NULL) {
+        in->iobref = iobref_new();
+        if (in->iobref == NULL)
+            goto out;
+    }
+
+    if (pipe2(pipefd, O_CLOEXEC | O_NONBLOCK) != 0) {
+        gf_log(this->name, GF_LOG_DEBUG, "pipe2 failed (%s)", strerror(errno));
+        goto out;
+    }
+
+    /* pipe capacity is counted in pages, and the data of each skb may take
+     * a page of its own, so leave some room for partially filled pages */
+    if (fcntl(pipefd[1], F_SETPIPE_SZ, size * 2) < 0) {
+        gf_log(this->name, GF_LOG_DEBUG,
+               "could not size the payload pipe to %zu bytes (%s)", size * 2,
+               strerror(errno));
+        sys_close(pipefd[0]);
+        sys_close(pipefd[1]);
+        goto out;
+    }
+
+    in->iobref->splice_fd = pipefd[0];
+    in->iobref->splice_len = size;
+    in->splice_pipe = pipefd[1];
+
+    in->payload_vector.iov_base = NULL;
+    in->payload_vector.iov_len = size;
+    ret = 0;
+out:
+    return ret;
+#else
+    return -1;
+#endif
+}
+
+/* The payload pipe is full while the socket still has data: copy what
+ * has been spliced so far into an iobuf and read the rest of the payload
+ * the usual way. */
+static int
+__socket_splice_payload_abort(rpc_transport_t *this)
+{
+    socket_private_t *priv = NULL;
+    struct gf_sock_incoming *in = NULL;
+    struct iobuf *iobuf = NULL;
+    size_t copied = 0;
+
+    priv = this->private;
+    in = &priv->incoming;
+
+    sys_close(in->splice_pipe);
+    in->splice_pipe = -1;
+
+    iobuf = iobref_splice_to_iobuf(this->ctx->iobuf_pool, in->iobref, &copied);
+    if (!iobuf)
+        return -1;
+
+    gf_log(this->name, GF_LOG_DEBUG,
+           "payload pipe full after %zu bytes, copying the remaining "
+           "payload",
+           copied);
+
+    in->payload_vector.iov_base = iobuf_ptr(iobuf);
+    in->frag.fragcurrent = (char *)iobuf_ptr(iobuf) + copied;
+
+    return 0;
+}
+
+/* Moves the payload of the current request from the socket into its pipe.
+ * Returns 1 if the rest of the payload has to be read into an iobuf, 0 when
+ * done or when the socket has no more data for now (check frag->bytes_read)
+ * and -1 on errors. */
+static int
+__socket_splice_payload(rpc_transport_t *this)
+{
+#ifdef F_SETPIPE_SZ
+    socket_private_t *priv = NULL;
+    struct gf_sock_incoming *in = NULL;
+    struct gf_sock_incoming_frag *frag = NULL;
+    size_t remaining = 0;
+    ssize_t ret = 0;
+    int avail = 0;
+    int pipe_size = 0;
+
+    priv = this->private;
+    in = &priv->incoming;
+    frag = &in->frag;
+
+    remaining = RPC_FRAGSIZE(in->fraghdr) - frag->bytes_read;
+
+    /* part of the payload may already sit in the read-ahead buffer */
+    if (in->ra_served < in->ra_read) {
+        ret = sys_write(in->splice_pipe, &in->ra_buf[in->ra_served],
+                        min(remaining, in->ra_read - in->ra_served));
+        if (ret < 0) {
+            gf_log(this->name, GF_LOG_WARNING,
+                   "writing to the payload pipe failed (%s)", strerror(errno));
+            return -1;
+        }
+        in->ra_served += ret;
+        frag->bytes_read += ret;
+        remaining -= ret;
+    }
+
+    while (remaining > 0) {
+        ret = splice(priv->sock, NULL, in->splice_pipe, NULL, remaining,
+                     SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (ret > 0) {
+            this->total_bytes_read += ret;
+            frag->bytes_read += ret;
+            remaining -= ret;
+            continue;
+        }
+
+        if (ret == 0) {
+            gf_log(this->name, GF_LOG_DEBUG, "EOF on socket %d (errno:%d:%s)",
+                   priv->sock, ENODATA, strerror(ENODATA));
+            errno = ENODATA;
+            return -1;
+        }
+
+        if (errno == EINTR)
+            continue;
+
+        if (errno != EAGAIN) {
+            gf_log(this->name, GF_LOG_WARNING,
+                   "splicing from socket failed. Error (%s), peer (%s)",
+                   strerror(errno), this->peerinfo.identifier);
+            return -1;
+        }
+
+        /* EAGAIN is either an empty socket, which is fine, or a full
+         * pipe, which can only be fixed by growing the pipe */
+        if ((ioctl(priv->sock, FIONREAD, &avail) != 0) || (avail == 0))
+            return 0;
+
+        pipe_size = fcntl(in->splice_pipe, F_GETPIPE_SZ);
+        if ((pipe_size <= 0) || (pipe_size >= GF_SOCKET_SPLICE_PIPE_MAX) ||
+            (fcntl(in->splice_pipe, F_SETPIPE_SZ, pipe_size * 2) < 0))
+            return 1;
+    }
+
+    sys_close(in->splice_pipe);
+    in->splice_pipe = -1;
+
+    return 0;
+#else
+    return 1;
+#endif
+}
+
 #define rpc_cred_addr(buf) (buf + RPC_MSGTYPE_SIZE + RPC_CALL_BODY_SIZE - 4)
 
 #define rpc_verf_addr(fragcurrent) (fragcurrent - 4)
@@ -1586,8 +1993,16 @@ __socket_read_vectored_request(rpc_transport_t *this,
 
         case SP_STATE_READ_PROGHDR_XDATA:
         sp_state_read_proghdr_xdata:
+            size = RPC_FRAGSIZE(in->fraghdr) - frag->bytes_read;
+            /* only payloads that arrive in a single fragment get spliced */
+            if ((in->payload_vector.iov_base == NULL) &&
+                RPC_LASTFRAG(in->fraghdr) &&
+                (__socket_splice_payload_init(this, size) == 0)) {
+                request->vector_state = SP_STATE_SPLICING_PROG;
+                goto sp_state_splicing_prog;
+            }
+
             if (in->payload_vector.iov_base == NULL) {
-                size = RPC_FRAGSIZE(in->fraghdr) - frag->bytes_read;
                 iobuf = iobuf_get2(this->ctx->iobuf_pool, size);
                 if (!iobuf) {
                     ret = -1;
@@ -1616,6 +2031,7 @@ __socket_read_vectored_request(rpc_transport_t *this,
             /* fall through */
 
         case SP_STATE_READING_PROG:
+        sp_state_reading_prog:
             /* now read the remaining rpc msg into buffer pointed by
              * fragcurrent
              */
@@ -1632,6 +2048,24 @@ __socket_read_vectored_request(rpc_transport_t *this,
                                                   in->payload_vector.iov_base);
             }
             break;
+
+        case SP_STATE_SPLICING_PROG:
+        sp_state_splicing_prog:
+            ret = __socket_splice_payload(this);
+            if (ret > 0) {
+                ret = __socket_splice_payload_abort(this);
+                if (ret < 0)
+                    break;
+
+                request->vector_state = SP_STATE_READING_PROG;
+                goto sp_state_reading_prog;
+            }
+
+            remaining_size = RPC_FRAGSIZE(in->fraghdr) - frag->bytes_read;
+
+            if ((ret < 0) || (remaining_size == 0))
+                request->vector_state = SP_STATE_VECTORED_REQUEST_INIT;
+            break;
     }
 
     return ret;
@@ -2295,6 +2729,11 @@ __socket_reset_priv(socket_private_t *priv)
         in->request_info = NULL;
     }
 
+    if (in->splice_pipe >= 0) {
+        sys_close(in->splice_pipe);
+        in->splice_pipe = -1;
+    }
+
     memset(&in->payload_vector, 0, sizeof(in->payload_vector));
 }
 
@@ -2434,7 +2873,8 @@ __socket_proto_state_machine(rpc_transport_t *this,
 
                     count++;
 
-                    if (in->payload_vector.iov_base != NULL) {
+                    if ((in->payload_vector.iov_base != NULL) ||
+                        iobref_spliced(in->iobref)) {
                         vector[count] = in->payload_vector;
                         count++;
                     }
@@ -2890,6 +3330,22 @@ socket_event_handler(int fd, int idx, int gen, void *data, int poll_in,
            (priv->is_server ? "server" : "client"), priv->sock, poll_in,
            poll_out, poll_err);
 
+    /* MSG_ZEROCOPY completions are queued on the socket error queue and
+     * reported as POLLERR, without anything being wrong with the socket */
+    if (poll_err && !(poll_err & POLLHUP)) {
+        pthread_mutex_lock(&priv->out_lock);
+        {
+            if ((priv->zc_seq != priv->zc_done) &&
+                (__socket_zerocopy_reap(this) > 0) &&
+                (__socket_sock_error(priv->sock) == 0))
+                poll_err = 0;
+        }
+        pthread_mutex_unlock(&priv->out_lock);
+
+        if (!poll_err)
+            gf_event_clear_error(ctx->event_pool, fd, idx, gen);
+    }
+
     if (!poll_err) {
         if (!socket_is_connected(priv)) {
             gf_log(this->name, GF_LOG_TRACE,
@@ -3166,9 +3622,16 @@ socket_server_event_handler(int fd, int idx, int gen, void *data, int poll_in,
         new_priv->sock = new_sock;
 
         new_priv->ssl_enabled = priv->ssl_enabled;
+        /* socket_init() read the options the listener started with, the
+         * listener's own values follow reconfigure() */
+        new_priv->splice_payload = priv->splice_payload;
+        new_priv->zerocopy_send = priv->zerocopy_send;
         new_priv->connected = 1;
         new_priv->is_server = _gf_true;
 
+        if (new_priv->zerocopy_send && !new_priv->use_ssl)
+            __socket_zerocopy_enable(new_trans);
+
         /*
          * This is the first ref on the newly accepted
          * transport.
@@ -4032,6 +4495,11 @@ reconfigure(rpc_transport_t *this, dict_t *options)
 
     priv->windowsize = (int)windowsize;
 
+    priv->splice_payload = dict_get_str_boolean(
+        options, "transport.socket.splice-payload", _gf_false);
+    priv->zerocopy_send = dict_get_str_boolean(
+        options, "transport.socket.zerocopy-send", _gf_false);
+
     data = dict_get_sizen(options, "non-blocking-io");
     if (data) {
         optstr = data_to_str(data);
@@ -4471,7 +4939,10 @@ socket_init(rpc_transport_t *this)
     priv->ssl_accepted = _gf_false;
     priv->ssl_connected = _gf_false;
     priv->windowsize = GF_DEFAULT_SOCKET_WINDOW_SIZE;
+    priv->incoming.splice_pipe = -1;
     INIT_LIST_HEAD(&priv->ioq);
+    INIT_LIST_HEAD(&priv->zc_pending);
+    INIT_LIST_HEAD(&priv->zc_closed);
     pthread_mutex_init(&priv->notify.lock, NULL);
     pthread_cond_init(&priv->notify.cond, NULL);
 
@@ -4593,6 +5064,11 @@ socket_init(rpc_transport_t *this)
         }
     }
 
+    priv->splice_payload = dict_get_str_boolean(
+        this->options, "transport.socket.splice-payload", _gf_false);
+    priv->zerocopy_send = dict_get_str_boolean(
+        this->options, "transport.socket.zerocopy-send", _gf_false);
+
     priv->windowsize = (int)windowsize;
 
     priv->ssl_enabled = _gf_false;
@@ -4615,6 +5091,7 @@ void
 fini(rpc_transport_t *this)
 {
     socket_private_t *priv = NULL;
+    struct ioq *entry = NULL;
 
     if (!this)
         return;
@@ -4624,11 +5101,15 @@ fini(rpc_transport_t *this)
         if (priv->sock >= 0) {
             pthread_mutex_lock(&priv->out_lock);
             {
-                __socket_ioq_flush(priv);
+                __socket_ioq_flush(this);
                 __socket_reset(this);
             }
             pthread_mutex_unlock(&priv->out_lock);
         }
+        while (!list_empty(&priv->zc_closed)) {
+            entry = list_first_entry(&priv->zc_closed, struct ioq, list);
+            __socket_ioq_entry_free(entry);
+        }
         gf_log(this->name, GF_LOG_TRACE, "transport %p destroyed", this);
 
         pthread_mutex_destroy(&priv->out_lock);
@@ -4740,6 +5221,20 @@ struct volume_options options[] = {
      .op_version = {GD_OP_VERSION_3_10_2},
      .default_value = "9"},
     {.key = {"transport.socket.read-fail-log"}, .type = GF_OPTION_TYPE_BOOL},
+    {.key = {"transport.socket.splice-payload"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_10_0},
+     .description = "Move large WRITE payloads from the socket to the brick "
+                    "with splice(2) instead of copying them through user "
+                    "space. Not used with SSL."},
+    {.key = {"transport.socket.zerocopy-send"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_10_0},
+     .description = "Send large replies, like READ data, with MSG_ZEROCOPY "
+                    "on accepted connections. Only pays off with NICs that "
+                    "can transmit from user pages. Not used with SSL."},
     {.key = {SSL_ENABLED_OPT}, .type = GF_OPTION_TYPE_BOOL},
     {.key = {SSL_OWN_CERT_OPT}, .type = GF_OPTION_TYPE_STR},
     {.key = {SSL_PRIVATE_KEY_OPT}, .type = GF_OPTION_TYPE_STR},
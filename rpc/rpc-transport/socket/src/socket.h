@@ -84,6 +84,7 @@ typedef enum {
                                     the only "consumer" of this state)
                                  */
     SP_STATE_READING_PROG,
+    SP_STATE_SPLICING_PROG, /* payload is moved to a pipe with splice(2) */
 } sp_rpcfrag_vectored_request_state_t;
 
 typedef enum {
@@ -109,7 +110,10 @@ struct ioq {
     int pending_count;
     struct iobref *iobref;
     uint32_t fraghdr;
-    char _pad[4];
+    uint32_t zc_last;      /* sequence of the last MSG_ZEROCOPY send */
+    gf_boolean_t zerocopy; /* payload is worth sending with MSG_ZEROCOPY */
+    gf_boolean_t zc_used;  /* some of the entry went out with MSG_ZEROCOPY */
+    char _pad[2];
 };
 
 typedef struct {
@@ -185,7 +189,7 @@ struct gf_sock_incoming {
     uint32_t fraghdr;
     msg_type_t msg_type;
     sp_rpcrecord_state_t record_state;
-    char _pad[4];
+    int splice_pipe; /* write end of the payload pipe, -1 if none */
 };
 
 typedef struct {
@@ -270,7 +274,19 @@ typedef struct {
                             * socket_event_handler() for
                             * newly accepted socket
                             */
-    char _pad[4];
+    gf_boolean_t splice_payload; /* splice large request payloads */
+    gf_boolean_t zerocopy_send;  /* send large replies with MSG_ZEROCOPY */
+    gf_boolean_t zerocopy;       /* SO_ZEROCOPY is enabled on the socket */
+    char _pad[1];
+    /* fully sent ioq entries whose pages the kernel may still be using */
+    struct list_head zc_pending;
+    /* zc_pending entries of closed connections, freed in fini() */
+    struct list_head zc_closed;
+    uint32_t zc_seq;  /* sequence of the next MSG_ZEROCOPY send */
+    uint32_t zc_done; /* sends before this sequence have completed */
+    /* completed sends past a gap, [zc_held_start, zc_held_end) */
+    uint32_t zc_held_start;
+    uint32_t zc_held_end;
 } socket_private_t;
 
 #endif
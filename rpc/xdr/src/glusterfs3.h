@@ -678,6 +678,50 @@ gfx_stat_from_iattx(struct gfx_iattx *gf_stat, struct iatt *iatt)
     gf_stat->mode = st_mode_from_ia(iatt->ia_prot, iatt->ia_type);
 }
 
+/* XDR sizes of the fixed length members of gfx_value, see glusterfs4-xdr.x:
+   16 bytes of gfid, 12 hypers and 9 ints for the iatt, 3 hypers and 3 ints
+   for the mdata */
+#define GFX_IATTX_XDR_SIZE (16 + 12 * 8 + 9 * 4)
+#define GFX_MDATA_IATT_XDR_SIZE (3 * 8 + 3 * 4)
+
+/* what xdr_sizeof () would return for an encoded pair, without encoding it */
+static inline ssize_t
+gfx_dict_pair_xdr_size(gfx_dict_pair *xpair)
+{
+    /* key length, padded key and the type of the value */
+    ssize_t size = 4 + gf_roof(xpair->key.key_len, 4) + 4;
+
+    switch (xpair->value.type) {
+        case GF_DATA_TYPE_INT:
+        case GF_DATA_TYPE_UINT:
+        case GF_DATA_TYPE_DOUBLE:
+            size += 8;
+            break;
+        case GF_DATA_TYPE_STR:
+            size += 4 +
+                    gf_roof(xpair->value.gfx_value_u.val_string.val_string_len,
+                            4);
+            break;
+        case GF_DATA_TYPE_IATT:
+            size += GFX_IATTX_XDR_SIZE;
+            break;
+        case GF_DATA_TYPE_MDATA:
+            size += GFX_MDATA_IATT_XDR_SIZE;
+            break;
+        case GF_DATA_TYPE_GFUUID:
+            size += 16;
+            break;
+        case GF_DATA_TYPE_PTR:
+        case GF_DATA_TYPE_STR_OLD:
+            size += 4 + gf_roof(xpair->value.gfx_value_u.other.other_len, 4);
+            break;
+        default:
+            break;
+    }
+
+    return size;
+}
+
 /* dict_to_xdr () */
 static inline int
 dict_to_xdr(dict_t *this, gfx_dict *dict)
@@ -718,7 +762,7 @@ dict_to_xdr(dict_t *this, gfx_dict *dict)
         xpair = &dict->pairs.pairs_val[index];
 
         xpair->key.key_val = dpair->key;
-        xpair->key.key_len = strlen(dpair->key) + 1;
+        xpair->key.key_len = dpair->keylen + 1;
         xpair->value.type = dpair->value->data_type;
         switch (dpair->value->data_type) {
                 /* Add more type here */
@@ -787,6 +831,9 @@ dict_to_xdr(dict_t *this, gfx_dict *dict)
                        "key '%s' is not sent on wire", dpair->key);
                 break;
         }
+        /* only pairs which moved index on get encoded */
+        if (xpair != &dict->pairs.pairs_val[index])
+            size += gfx_dict_pair_xdr_size(xpair);
         dpair = dpair->next;
     }
 
@@ -796,10 +843,10 @@ dict_to_xdr(dict_t *this, gfx_dict *dict)
     /* This is required mainly in the RPC layer to understand the
        boundary for proper payload. Hence only send the size of
        variable XDR size. ie, the formula should be:
-       xdr_size = total size - (xdr_size + count + pairs.pairs_len))  */
-    size = xdr_sizeof((xdrproc_t)xdr_gfx_dict, dict);
-
-    dict->xdr_size = (size > 12) ? (size - 12) : 0;
+       xdr_size = total size - (xdr_size + count + pairs.pairs_len))
+       which is the sum of the encoded pairs, added up above instead of
+       going through xdr_sizeof () again */
+    dict->xdr_size = size;
 
     ret = 0;
 out:
@@ -810,6 +857,32 @@ out:
     return ret;
 }
 
+/* Hand a value decoded by XDR over to the dict as it is instead of copying
+   it. Only done for values which carry their own '\0', as the copies always
+   had one appended. */
+static inline int
+xdr_to_dict_adopt(dict_t *this, char *key, data_buf_t *shared, char *val,
+                  unsigned int len, gf_dict_data_type_t type)
+{
+    data_t *data = NULL;
+    int ret = -1;
+
+    if (data_buf_adopt(shared, val)) {
+        free(val);
+        return -1;
+    }
+
+    data = data_from_buf(shared, val, len, type);
+    if (!data)
+        return -1;
+
+    ret = dict_set(this, key, data);
+    if (ret < 0)
+        data_destroy(data);
+
+    return ret;
+}
+
 static inline int
 xdr_to_dict(gfx_dict *dict, dict_t **to)
 {
@@ -819,9 +892,11 @@ xdr_to_dict(gfx_dict *dict, dict_t **to)
     char *value = NULL;
     gfx_dict_pair *xpair = NULL;
     dict_t *this = NULL;
+    data_buf_t *shared = NULL;
     unsigned char *uuid = NULL;
     struct iatt *iatt = NULL;
     struct mdata_iatt *mdata_iatt = NULL;
+    unsigned int len = 0;
 
     if (!to || !dict)
         goto out;
@@ -836,6 +911,12 @@ xdr_to_dict(gfx_dict *dict, dict_t **to)
     if (!this)
         goto out;
 
+    if (dict->pairs.pairs_len) {
+        shared = data_buf_new(dict->pairs.pairs_len);
+        if (!shared)
+            goto out;
+    }
+
     for (index = 0; index < dict->pairs.pairs_len; index++) {
         ret = -1;
         xpair = &dict->pairs.pairs_val[index];
@@ -856,6 +937,13 @@ xdr_to_dict(gfx_dict *dict, dict_t **to)
                                       xpair->value.gfx_value_u.value_dbl);
                 break;
             case GF_DATA_TYPE_STR:
+                value = xpair->value.gfx_value_u.val_string.val_string_val;
+                len = xpair->value.gfx_value_u.val_string.val_string_len;
+                if (len && value[len - 1] == '\0') {
+                    ret = xdr_to_dict_adopt(this, key, shared, value, len,
+                                            GF_DATA_TYPE_STR);
+                    break;
+                }
                 value = GF_MALLOC(
                     xpair->value.gfx_value_u.val_string.val_string_len + 1,
                     gf_common_mt_char);
@@ -915,6 +1003,13 @@ xdr_to_dict(gfx_dict *dict, dict_t **to)
                 break;
             case GF_DATA_TYPE_PTR:
             case GF_DATA_TYPE_STR_OLD:
+                value = xpair->value.gfx_value_u.other.other_val;
+                len = xpair->value.gfx_value_u.other.other_len;
+                if (len && value[len - 1] == '\0') {
+                    ret = xdr_to_dict_adopt(this, key, shared, value, len,
+                                            GF_DATA_TYPE_PTR);
+                    break;
+                }
                 value = GF_MALLOC(xpair->value.gfx_value_u.other.other_len + 1,
                                   gf_common_mt_char);
                 if (!value) {
@@ -951,6 +1046,10 @@ out:
     if (this)
         dict_unref(this);
 
+    /* the adopted buffers now live as long as the values in them */
+    if (shared)
+        data_buf_unref(shared);
+
     return ret;
 }
 
@@ -0,0 +1,45 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# Diff data self-heal with several blocks in flight, each one checksummed in
+# 128KB pieces by a single request.
+
+cleanup
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 3 $H0:$B0/${V0}{0..2}
+TEST $CLI volume set $V0 cluster.data-self-heal off
+TEST $CLI volume set $V0 cluster.metadata-self-heal off
+TEST $CLI volume set $V0 cluster.entry-self-heal off
+TEST $CLI volume set $V0 cluster.data-self-heal-algorithm diff
+TEST $CLI volume set $V0 cluster.self-heal-window-size 8
+TEST $CLI volume set $V0 cluster.data-self-heal-pipeline 4
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 1
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 2
+
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=16
+
+# Scattered writes missed by brick2, some of them smaller than a block
+TEST kill_brick $V0 $H0 $B0/${V0}2
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "0" afr_child_up_status $V0 2
+TEST dd if=/dev/urandom of=$M0/file bs=4k seek=300 count=1 conv=notrunc
+TEST dd if=/dev/urandom of=$M0/file bs=128k seek=41 count=3 conv=notrunc
+TEST dd if=/dev/urandom of=$M0/file bs=1M seek=15 count=2 conv=notrunc
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 2
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+EXPECT "$(md5sum < $B0/${V0}0/file)" echo "$(md5sum < $B0/${V0}2/file)"
+EXPECT "$(md5sum < $B0/${V0}1/file)" echo "$(md5sum < $B0/${V0}2/file)"
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup
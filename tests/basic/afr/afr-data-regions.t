@@ -0,0 +1,91 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# Writes missed by a brick record the regions they touched, and data
+# self-heal only heals those regions.
+
+# Counter $2 of the regions xattr of a file: one per brick followed by one
+# per region
+function region_count {
+        local value=$(get_hex_xattr trusted.afr.regions.1048576 $1)
+        if [ -z "$value" ]; then
+                echo 0
+                return
+        fi
+        echo $((16#${value:$((8 * $2)):8}))
+}
+
+function region_md5 {
+        dd if=$1 bs=1M skip=$2 count=1 2>/dev/null | md5sum | awk '{print $1}'
+}
+
+cleanup
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 replica 3 $H0:$B0/${V0}{0..2}
+TEST $CLI volume set $V0 cluster.data-self-heal off
+TEST $CLI volume set $V0 cluster.metadata-self-heal off
+TEST $CLI volume set $V0 cluster.entry-self-heal off
+TEST $CLI volume set $V0 cluster.data-self-heal-algorithm diff
+TEST $CLI volume set $V0 cluster.data-region-size 1MB
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 1
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 2
+
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=8
+TEST dd if=/dev/urandom of=$B0/head bs=1M count=1
+TEST dd if=/dev/urandom of=$B0/tail bs=1M count=1
+zero_md5=$(dd if=/dev/zero bs=1M count=1 2>/dev/null | md5sum | awk '{print $1}')
+
+# Only regions 0 and 6 are written while brick2 is down
+TEST kill_brick $V0 $H0 $B0/${V0}2
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "0" afr_child_up_status $V0 2
+TEST dd if=$B0/head of=$M0/file bs=1M count=1 conv=notrunc
+TEST dd if=$B0/tail of=$M0/file bs=1M seek=6 count=1 conv=notrunc
+for i in 0 1; do
+        EXPECT_WITHIN $IO_WAIT_TIMEOUT "^[1-9]" region_count $B0/${V0}$i/file 2
+        EXPECT "^0$" region_count $B0/${V0}$i/file 1
+        EXPECT_WITHIN $IO_WAIT_TIMEOUT "^[1-9]" region_count $B0/${V0}$i/file 3
+        EXPECT "^0$" region_count $B0/${V0}$i/file 6
+        EXPECT_WITHIN $IO_WAIT_TIMEOUT "^[1-9]" region_count $B0/${V0}$i/file 9
+done
+
+# Region 3 of the file on brick2 is changed behind the back of AFR. As it
+# wasn't written, heal must not touch it.
+TEST dd if=/dev/zero of=$B0/${V0}2/file bs=1M seek=3 count=1 conv=notrunc
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status $V0 2
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "Y" glustershd_up_status
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 2
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+EXPECT "$zero_md5" region_md5 $B0/${V0}2/file 3
+EXPECT "$(region_md5 $B0/head 0)" region_md5 $B0/${V0}2/file 0
+EXPECT "$(region_md5 $B0/tail 0)" region_md5 $B0/${V0}2/file 6
+for i in 0 1; do
+        EXPECT "^0$" region_count $B0/${V0}$i/file 2
+        EXPECT "^0$" region_count $B0/${V0}$i/file 3
+        EXPECT "^0$" region_count $B0/${V0}$i/file 9
+done
+
+# Without the option, the whole file is healed, including region 3
+TEST $CLI volume set $V0 cluster.data-region-size 0
+TEST dd if=/dev/urandom of=$B0/data bs=1M count=1
+TEST kill_brick $V0 $H0 $B0/${V0}2
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "0" afr_child_up_status $V0 2
+TEST dd if=$B0/data of=$M0/file bs=1M count=1 conv=notrunc
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "1" afr_child_up_status_in_shd $V0 2
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+EXPECT "$(md5sum < $B0/${V0}0/file)" echo "$(md5sum < $B0/${V0}2/file)"
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup
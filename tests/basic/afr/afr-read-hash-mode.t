@@ -9,6 +9,12 @@ function reads_brick_count {
         $CLI volume profile $V0 info incremental | grep -w READ | wc -l
 }
 
+function get_mount_read_latency {
+        local sd=$(generate_mount_statedump $V0)
+        grep "^read_latency\[$1\]=" $sd | cut -f2 -d'=' | tail -1
+        cleanup_mount_statedump $V0
+}
+
 TEST glusterd
 TEST pidof glusterd
 TEST $CLI volume create $V0 replica 3 arbiter 1 $H0:$B0/${V0}{0..2}
@@ -52,5 +58,17 @@ TEST [ $count -eq 2 ]
 # Check that the arbiter did not serve any reads
 arbiter_reads=$($CLI volume top $V0 read brick $H0:$B0/${V0}2|grep FILE|awk '{print $1}')
 TEST [ -z $arbiter_reads ]
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# read-hash-mode=6: an unmeasured brick is tried before the reads settle on
+# the fastest one, so both data bricks get a read latency, but not the
+# arbiter.
+TEST glusterfs --entry-timeout=0 --attribute-timeout=0 -s $H0 --volfile-id $V0 $M0
+TEST $CLI volume set $V0 cluster.read-hash-mode 6
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "6" mount_get_option_value $M0 $V0-replicate-0 read-hash-mode
+TEST dd if=$M0/FILE of=/dev/null bs=1M
+EXPECT "^[1-9]" get_mount_read_latency 0
+EXPECT "^[1-9]" get_mount_read_latency 1
+EXPECT "^0$" get_mount_read_latency 2
 
 cleanup;
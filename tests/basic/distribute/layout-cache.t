@@ -0,0 +1,66 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# A directory layout checked on all the subvolumes is revalidated on a single
+# subvolume while the layout cache is valid.
+
+# Lookups received by all the bricks since the last clear
+function get_cumulative_lookup_count {
+        $CLI volume profile $V0 info | sed -n '/^Cumulative/,/^Interval/p' | \
+                grep -w LOOKUP | awk '{n += $8} END {print n + 0}'
+}
+
+function stat_dir {
+        for i in {1..10}; do
+                stat $M0/dir > /dev/null || return 1
+        done
+}
+
+cleanup;
+
+TEST glusterd;
+TEST pidof glusterd;
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1,2};
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 cluster.layout-cache-timeout 600
+TEST ! $CLI volume set $V0 cluster.layout-cache-timeout 3601
+TEST $CLI volume start $V0;
+TEST $CLI volume profile $V0 start
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 --entry-timeout=0 \
+        --attribute-timeout=0 $M0;
+
+TEST mkdir $M0/dir
+TEST touch $M0/dir/file{1..10}
+
+# The first revalidation goes to all the subvolumes and caches the layout
+TEST stat_dir
+TEST $CLI volume profile $V0 info clear
+TEST stat_dir
+TEST [ $(get_cumulative_lookup_count) -lt 20 ]
+
+# Files are still found where the layout says
+for i in {1..10}; do
+        TEST stat $M0/dir/file$i
+done
+
+# Without the cache, every revalidation goes to both subvolumes
+TEST $CLI volume set $V0 cluster.layout-cache-timeout 0
+TEST stat_dir
+TEST $CLI volume profile $V0 info clear
+TEST stat_dir
+TEST [ $(get_cumulative_lookup_count) -ge 20 ]
+
+# Layouts changed by a fix-layout are seen by the client
+TEST $CLI volume set $V0 cluster.layout-cache-timeout 600
+TEST stat_dir
+TEST $CLI volume add-brick $V0 $H0:$B0/${V0}3
+TEST $CLI volume rebalance $V0 fix-layout start
+EXPECT_WITHIN $REBALANCE_TIMEOUT "fix-layout completed" fix-layout_status_field $V0
+TEST touch $M0/dir/new{1..20}
+TEST [ -n "$(ls $B0/${V0}3/dir)" ]
+EXPECT "30" echo $(ls $M0/dir | wc -l)
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
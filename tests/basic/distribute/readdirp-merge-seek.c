@@ -0,0 +1,126 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+/* Lists a directory with getdents64() using buffers of different sizes,
+ * which must return the same entries in the same order, and then goes on
+ * reading from the offsets of some of them, which must continue with the
+ * entry that followed. */
+
+struct linux_dirent64 {
+    unsigned long long d_ino;
+    long long d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
+#define MAX_ENTRIES 65536
+
+static char *names[MAX_ENTRIES];
+static long long offsets[MAX_ENTRIES];
+
+/* Reads from the current position of fd, up to max entries. With record
+ * set, the entries are saved, otherwise they are checked against the saved
+ * ones starting at index first. Returns the number of entries read. */
+static int
+list(int fd, size_t bufsize, int first, int max, int record)
+{
+    char *buf = malloc(bufsize);
+    struct linux_dirent64 *d = NULL;
+    int count = 0;
+    long n = 0;
+    long pos = 0;
+
+    if (!buf)
+        return -1;
+
+    while (count < max) {
+        n = syscall(SYS_getdents64, fd, buf, bufsize);
+        if (n < 0) {
+            perror("getdents64");
+            count = -1;
+            break;
+        }
+        if (n == 0)
+            break;
+
+        for (pos = 0; (pos < n) && (count < max); pos += d->d_reclen) {
+            d = (struct linux_dirent64 *)(buf + pos);
+            if (record) {
+                if (first + count >= MAX_ENTRIES) {
+                    fprintf(stderr, "too many entries\n");
+                    free(buf);
+                    return -1;
+                }
+                names[first + count] = strdup(d->d_name);
+                offsets[first + count] = d->d_off;
+            } else if (!names[first + count] ||
+                       strcmp(names[first + count], d->d_name) != 0) {
+                fprintf(stderr, "entry %d is %s instead of %s\n",
+                        first + count, d->d_name,
+                        names[first + count] ? names[first + count] : "none");
+                free(buf);
+                return -1;
+            }
+            count++;
+        }
+    }
+
+    free(buf);
+    return count;
+}
+
+int
+main(int argc, char *argv[])
+{
+    int fd = -1;
+    int total = 0;
+    int count = 0;
+    int i = 0;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <directory>\n", argv[0]);
+        return 1;
+    }
+
+    fd = open(argv[1], O_RDONLY | O_DIRECTORY);
+    if (fd < 0) {
+        perror("open");
+        return 1;
+    }
+
+    total = list(fd, 65536, 0, MAX_ENTRIES, 1);
+    if (total <= 0)
+        return 1;
+
+    /* the order doesn't depend on how many entries a request returns */
+    if ((lseek(fd, 0, SEEK_SET) != 0) ||
+        (list(fd, 512, 0, MAX_ENTRIES, 0) != total))
+        return 1;
+
+    /* every offset continues with the next entry */
+    for (i = 0; i + 1 < total; i += 37) {
+        if (lseek(fd, offsets[i], SEEK_SET) != offsets[i]) {
+            perror("lseek");
+            return 1;
+        }
+        count = (total - i - 1 < 10) ? total - i - 1 : 10;
+        if (list(fd, 4096, i + 1, count, 0) != count)
+            return 1;
+    }
+
+    /* and the last one ends the directory */
+    if ((lseek(fd, offsets[total - 1], SEEK_SET) != offsets[total - 1]) ||
+        (list(fd, 4096, total, MAX_ENTRIES, 0) != 0))
+        return 1;
+
+    close(fd);
+    printf("%d\n", total);
+
+    return 0;
+}
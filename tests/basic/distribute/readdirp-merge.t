@@ -0,0 +1,82 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# With readdirp-merge a directory is read from all the subvolumes at the same
+# time and their entries are interleaved. Every entry must be listed once, and
+# linkto files not at all. Reading from the offset of any entry continues with
+# the next one.
+
+function list_dir {
+        ls -a $M0/dir | grep -v '^\.\.\?$' | sort
+}
+
+# Number of bricks holding files among the first entries listed, which all
+# come from the first subvolume when they are read one after another.
+function first_entries_bricks {
+        local names=$(ls -f $M0/dir | head -40)
+        local count=0
+        local i n
+
+        for i in {1..4}; do
+                for n in $names; do
+                        if [ -n "$(find $B0/${V0}$i/dir -maxdepth 1 -type f \
+                                   -name $n ! -perm -1000)" ]; then
+                                count=$((count + 1))
+                                break
+                        fi
+                done
+        done
+        echo $count
+}
+
+cleanup;
+
+TEST glusterd;
+TEST pidof glusterd;
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1..4};
+TEST $CLI volume set $V0 performance.readdir-ahead on
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 cluster.readdirp-merge on
+TEST $CLI volume start $V0;
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0;
+
+TEST mkdir $M0/dir
+TEST touch $M0/dir/file{1..1000}
+TEST mkdir $M0/dir/subdir{1..50}
+
+# Renames leave linkto files on the new hashed subvolumes
+for i in {1..100}; do
+        mv $M0/dir/file$i $M0/dir/renamed$i
+done
+
+EXPECT "1050" echo $(list_dir | wc -l)
+EXPECT "0" echo $(list_dir | uniq -d | wc -l)
+EXPECT "100" echo $(list_dir | grep -c '^renamed')
+EXPECT "50" echo $(find $M0/dir -mindepth 1 -type d | wc -l)
+merged=$(list_dir | md5sum)
+
+# The first entries already come from all the subvolumes
+EXPECT "4" first_entries_bricks
+
+TEST build_tester $(dirname $0)/readdirp-merge-seek.c
+EXPECT "1052" $(dirname $0)/readdirp-merge-seek $M0/dir
+
+# The same entries are listed reading the subvolumes one after another
+TEST $CLI volume set $V0 cluster.readdirp-merge off
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0;
+EXPECT "$merged" echo "$(list_dir | md5sum)"
+
+TEST $CLI volume set $V0 cluster.readdirp-merge on
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 $M0;
+
+# rm -rf needs complete listings to empty the directory
+TEST rm -rf $M0/dir
+TEST ! stat $M0/dir
+TEST rm -f $(dirname $0)/readdirp-merge-seek
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
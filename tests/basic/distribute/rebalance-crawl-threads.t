@@ -0,0 +1,62 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+. $(dirname $0)/../../dht.rc
+
+# Rebalance crawls the directories with several threads. The checkpoints
+# of the subtrees it has completely processed are gone once it completes.
+
+function checkpoint_count {
+        getfattr -d -m "trusted.distribute.rebal-checkpoint." -e hex $1 2>/dev/null | grep -c "^trusted"
+}
+
+cleanup;
+
+TEST glusterd;
+TEST pidof glusterd;
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1,2};
+TEST $CLI volume set $V0 cluster.rebal-crawl-threads 4
+TEST $CLI volume set $V0 cluster.rebal-checkpoint on
+TEST ! $CLI volume set $V0 cluster.rebal-crawl-threads 0
+TEST $CLI volume start $V0;
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 --entry-timeout=0 $M0;
+
+for i in {1..5}; do
+        for j in {1..5}; do
+                TEST mkdir -p $M0/dir$i/sub$j/leaf
+                for k in {1..4}; do
+                        echo "$i $j $k" > $M0/dir$i/sub$j/leaf/file$k
+                done
+        done
+done
+
+TEST $CLI volume add-brick $V0 $H0:$B0/${V0}3;
+TEST $CLI volume rebalance $V0 start force;
+EXPECT_WITHIN $REBALANCE_TIMEOUT "0" rebalance_completed;
+
+# Every directory got a layout on the new brick and no checkpoint is left
+for i in {1..5}; do
+        for j in {1..5}; do
+                for d in $B0/${V0}3/dir$i $B0/${V0}3/dir$i/sub$j \
+                         $B0/${V0}3/dir$i/sub$j/leaf; do
+                        TEST getfattr -n trusted.glusterfs.dht -e hex $d
+                        EXPECT "0" checkpoint_count $d
+                done
+        done
+done
+EXPECT "0" checkpoint_count $B0/${V0}1
+EXPECT "0" checkpoint_count $B0/${V0}1/dir1/sub1/leaf
+
+# Some files were migrated to the new brick and kept their data
+TEST [ -n "$(find $B0/${V0}3 -name 'file*' -size +0)" ]
+for i in {1..5}; do
+        for j in {1..5}; do
+                for k in {1..4}; do
+                        EXPECT "$i $j $k" cat $M0/dir$i/sub$j/leaf/file$k
+                done
+        done
+done
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
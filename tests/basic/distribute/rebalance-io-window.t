@@ -0,0 +1,44 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+. $(dirname $0)/../../dht.rc
+
+# Rebalance migrates several blocks of a file at a time, with blocks growing
+# up to rebalance-max-block-size. Regular and sparse files must keep their
+# data.
+
+cleanup;
+
+TEST glusterd;
+TEST pidof glusterd;
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1,2};
+TEST $CLI volume set $V0 cluster.rebalance-io-window 4
+TEST $CLI volume set $V0 cluster.rebalance-max-block-size 4MB
+TEST ! $CLI volume set $V0 cluster.rebalance-io-window 17
+TEST ! $CLI volume set $V0 cluster.rebalance-max-block-size 32MB
+TEST $CLI volume start $V0;
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 --entry-timeout=0 $M0;
+
+for i in {1..10}; do
+        TEST dd if=/dev/urandom of=$M0/file$i bs=1M count=$((i * 3 + 1))
+        TEST dd if=/dev/urandom of=$M0/sparse$i bs=1M seek=$((i * 5)) count=3
+        TEST dd if=/dev/urandom of=$M0/sparse$i bs=1k seek=$((i * 9000)) count=1 conv=notrunc
+        md5[$i]=$(md5sum < $M0/file$i)
+        sparse_md5[$i]=$(md5sum < $M0/sparse$i)
+done
+
+TEST $CLI volume add-brick $V0 $H0:$B0/${V0}3;
+TEST $CLI volume rebalance $V0 start force;
+EXPECT_WITHIN $REBALANCE_TIMEOUT "0" rebalance_completed;
+
+# Some files were migrated to the new brick
+TEST [ -n "$(find $B0/${V0}3 -maxdepth 1 -name 'file*' -size +0)" ]
+
+for i in {1..10}; do
+        EXPECT "${md5[$i]}" echo "$(md5sum < $M0/file$i)"
+        EXPECT "${sparse_md5[$i]}" echo "$(md5sum < $M0/sparse$i)"
+done
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
@@ -0,0 +1,37 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+. $(dirname $0)/../../dht.rc
+
+# Rebalance doesn't send the blocks of zeroes of a file to a destination
+# that already reads as zeroes. The migrated files must keep their data.
+
+cleanup;
+
+TEST glusterd;
+TEST pidof glusterd;
+TEST $CLI volume create $V0 $H0:$B0/${V0}{1,2};
+TEST $CLI volume start $V0;
+TEST glusterfs --volfile-id=$V0 --volfile-server=$H0 --entry-timeout=0 $M0;
+
+# Files made of zeroes with some random blocks, without holes
+for i in {1..10}; do
+        TEST dd if=/dev/zero of=$M0/file$i bs=1M count=4
+        TEST dd if=/dev/urandom of=$M0/file$i bs=1M seek=$((i % 4)) count=1 conv=notrunc
+        md5[$i]=$(md5sum < $M0/file$i)
+done
+
+TEST $CLI volume add-brick $V0 $H0:$B0/${V0}3;
+TEST $CLI volume rebalance $V0 start force;
+EXPECT_WITHIN $REBALANCE_TIMEOUT "0" rebalance_completed;
+
+# Some files were migrated to the new brick
+TEST [ -n "$(find $B0/${V0}3 -maxdepth 1 -name 'file*' -size +0)" ]
+
+for i in {1..10}; do
+        EXPECT "${md5[$i]}" echo "$(md5sum < $M0/file$i)"
+done
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup;
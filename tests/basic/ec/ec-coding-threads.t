@@ -0,0 +1,45 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+TESTS_EXPECTED_IN_LOOP=42
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 6 redundancy 2 $H0:$B0/${V0}{0..5}
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume start $V0
+
+TEST dd if=/dev/urandom of=$B0/src bs=1M count=16
+src_md5=$(md5sum < $B0/src | cut -d' ' -f1)
+
+# Large writes and reads are split among the coding threads. The data
+# must be the same whatever the number of threads, also when reading
+# needs the redundancy.
+for threads in 0 1 8; do
+    TEST $CLI volume set $V0 disperse.coding-threads $threads
+    TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+    EXPECT_WITHIN $CHILD_UP_TIMEOUT "6" ec_child_up_count $V0 0
+
+    TEST dd if=$B0/src of=$M0/file-$threads bs=1M conv=fsync
+    EXPECT "$src_md5" echo $(md5sum < $M0/file-$threads | cut -d' ' -f1)
+
+    TEST kill_brick $V0 $H0 $B0/${V0}0
+    TEST kill_brick $V0 $H0 $B0/${V0}1
+    EXPECT_WITHIN $CHILD_UP_TIMEOUT "4" ec_child_up_count $V0 0
+    EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+    TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+    EXPECT_WITHIN $CHILD_UP_TIMEOUT "4" ec_child_up_count $V0 0
+    EXPECT "$src_md5" echo $(md5sum < $M0/file-$threads | cut -d' ' -f1)
+
+    EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+    TEST $CLI volume start $V0 force
+done
+
+cleanup
@@ -6,7 +6,7 @@ REDUNDANCY=2
 . $(dirname $0)/../../include.rc
 . $(dirname $0)/../../volume.rc
 
-TESTS_EXPECTED_IN_LOOP=96
+TESTS_EXPECTED_IN_LOOP=145
 
 function check_contents
 {
@@ -16,7 +16,7 @@ function check_contents
     TEST cp $src $M0/file
     TEST [ -f $M0/file ]
 
-    for ext in none x64 sse avx; do
+    for ext in none x64 sse avx avx512; do
         EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
         TEST $CLI volume set $V0 disperse.cpu-extensions $ext
         TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
@@ -47,7 +47,7 @@ EXPECT_WITHIN $PROCESS_UP_TIMEOUT 'Started' volinfo_field $V0 'Status'
 TEST dd if=/dev/urandom of=$tmp/file bs=1048576 count=1
 cs_file=$(sha1sum $tmp/file | awk '{ print $1 }')
 
-for ext in none x64 sse avx; do
+for ext in none x64 sse avx avx512; do
     TEST $CLI volume set $V0 disperse.cpu-extensions $ext
     TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
     EXPECT_WITHIN $CHILD_UP_TIMEOUT "$DISPERSE" ec_child_up_count $V0 0
@@ -0,0 +1,93 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# Data heal of a file by several tasks, each one locking only the range it
+# heals, and skipping the ranges that were not written while the brick was
+# down.
+
+# Counter of a dirty range (16MB of each fragment) in the xattr of a file
+function dirty_range_count {
+        local value=$(get_hex_xattr trusted.ec.dirty-ranges $1)
+        if [ -z "$value" ]; then
+                echo 0
+                return
+        fi
+        echo $((16#${value:$((16 * ($2 + 1))):16}))
+}
+
+function region_md5 {
+        dd if=$1 bs=1M skip=$2 count=1 2>/dev/null | md5sum | awk '{print $1}'
+}
+
+cleanup
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 3 redundancy 1 $H0:$B0/${V0}{0..2}
+TEST $CLI volume set $V0 disperse.heal-range-tasks 4
+TEST $CLI volume set $V0 disperse.heal-dirty-ranges on
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+
+# 80MB file, 40MB per fragment: dirty ranges 0, 1 and 2
+TEST dd if=/dev/urandom of=$M0/file bs=1M count=80
+TEST dd if=/dev/urandom of=$B0/head bs=1M count=1
+TEST dd if=/dev/urandom of=$B0/tail bs=1M count=1
+zero_md5=$(dd if=/dev/zero bs=1M count=1 2>/dev/null | md5sum | awk '{print $1}')
+
+# Only ranges 0 and 2 are written while brick2 is down
+TEST kill_brick $V0 $H0 $B0/${V0}2
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+TEST dd if=$B0/head of=$M0/file bs=1M count=1 conv=notrunc
+TEST dd if=$B0/tail of=$M0/file bs=1M seek=70 count=1 conv=notrunc
+EXPECT_WITHIN $IO_WAIT_TIMEOUT "^[1-9]" dirty_range_count $B0/${V0}0/file 0
+EXPECT "^0$" dirty_range_count $B0/${V0}0/file 1
+EXPECT_WITHIN $IO_WAIT_TIMEOUT "^[1-9]" dirty_range_count $B0/${V0}0/file 2
+
+# Range 1 of the fragment on brick2 is changed behind the back of EC. As it
+# wasn't written, heal must not touch it.
+TEST dd if=/dev/zero of=$B0/${V0}2/file bs=1M seek=20 count=1 conv=notrunc
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+EXPECT "$zero_md5" region_md5 $B0/${V0}2/file 20
+for i in 0 1 2; do
+        EXPECT "^0$" dirty_range_count $B0/${V0}$i/file 0
+        EXPECT "^0$" dirty_range_count $B0/${V0}$i/file 2
+done
+
+# The written ranges come from brick2 when brick1 is down
+TEST kill_brick $V0 $H0 $B0/${V0}1
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+EXPECT "$(region_md5 $B0/head 0)" region_md5 $M0/file 0
+EXPECT "$(region_md5 $B0/tail 0)" region_md5 $M0/file 70
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+
+# Without dirty ranges the whole file is healed by the range tasks
+TEST $CLI volume set $V0 disperse.heal-dirty-ranges off
+TEST dd if=/dev/urandom of=$B0/data bs=1M count=20
+TEST kill_brick $V0 $H0 $B0/${V0}2
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+TEST cp $B0/data $M0/data
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+
+TEST kill_brick $V0 $H0 $B0/${V0}0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+EXPECT "$(md5sum < $B0/data)" echo "$(md5sum < $M0/data)"
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup
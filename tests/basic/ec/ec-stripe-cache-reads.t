@@ -0,0 +1,68 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# Small reads of stripes just written through the same client are answered
+# from the stripe cache while the inode lock is held.
+
+function get_mount_stripe_cache {
+        local field=$1
+        local sd=$(generate_mount_statedump $V0)
+        local val=$(grep "^$field=" $sd | cut -f2 -d'=' | tail -1)
+        cleanup_mount_statedump $V0
+        echo $val
+}
+
+cleanup
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 3 redundancy 1 $H0:$B0/${V0}{0..2}
+TEST $CLI volume heal $V0 disable
+TEST $CLI volume set $V0 performance.stat-prefetch off
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.open-behind off
+TEST $CLI volume set $V0 disperse.eager-lock-timeout 60
+TEST $CLI volume set $V0 disperse.stripe-cache 4
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 --direct-io-mode=yes $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+
+TEST dd if=/dev/urandom of=$B0/test_file bs=2000 count=1
+md5_1000=$(head -c 1000 $B0/test_file | md5sum)
+md5_2000=$(md5sum < $B0/test_file)
+md5_tail=$(tail -c 976 $B0/test_file | md5sum)
+
+# The write leaves its only stripe in the cache, so the read that follows
+# doesn't need the bricks, even if it uses another fd.
+TEST dd if=$B0/test_file of=$M0/file1 bs=1000 count=1
+EXPECT "$md5_1000" echo "$(dd if=$M0/file1 bs=1000 count=1 | md5sum)"
+EXPECT "1" get_mount_stripe_cache "cached-reads"
+EXPECT "0" get_mount_stripe_cache "uncached-reads"
+
+# Only the last, partially written, stripe is cached. Reads that need the
+# first stripe go to the bricks.
+TEST dd if=$B0/test_file of=$M0/file2 bs=2000 count=1
+EXPECT "$md5_2000" echo "$(dd if=$M0/file2 bs=2000 count=1 | md5sum)"
+EXPECT "1" get_mount_stripe_cache "uncached-reads"
+EXPECT "$md5_tail" echo "$(dd if=$M0/file2 bs=1024 skip=1 count=1 | md5sum)"
+EXPECT "2" get_mount_stripe_cache "cached-reads"
+EXPECT "1" get_mount_stripe_cache "uncached-reads"
+
+# A budget of 0 disables the cache.
+TEST $CLI volume set $V0 disperse.stripe-cache-size 0
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=/$V0 --volfile-server=$H0 --direct-io-mode=yes $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+TEST dd if=$B0/test_file of=$M0/file3 bs=1000 count=1
+EXPECT "$md5_1000" echo "$(dd if=$M0/file3 bs=1000 count=1 | md5sum)"
+EXPECT "0" get_mount_stripe_cache "cached-reads"
+EXPECT "1" get_mount_stripe_cache "uncached-reads"
+EXPECT "0" get_mount_stripe_cache "memory-used"
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+cleanup
@@ -0,0 +1,83 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+# Checks the layout of files created with disperse.systematic on and off,
+# and that both can be read and healed.
+
+function fragment_md5 {
+        dd if=$1 bs=512 skip=$2 count=1 2>/dev/null | md5sum | cut -d' ' -f1
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+TEST $CLI volume create $V0 disperse 3 redundancy 1 $H0:$B0/${V0}{0..2}
+# The systematic code is opt-in
+EXPECT "off" volume_get_field $V0 disperse.systematic
+TEST $CLI volume set $V0 disperse.systematic on
+TEST $CLI volume heal $V0 disable
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+
+TEST dd if=/dev/urandom of=$B0/src bs=64k count=16
+src_md5=$(md5sum < $B0/src | cut -d' ' -f1)
+TEST cp $B0/src $M0/sys
+EXPECT "0001080301000200" get_hex_xattr trusted.ec.config $B0/${V0}0/sys
+
+# The data bricks hold the data itself, 512 bytes each in turn
+EXPECT "$(fragment_md5 $B0/src 0)" fragment_md5 $B0/${V0}0/sys 0
+EXPECT "$(fragment_md5 $B0/src 1)" fragment_md5 $B0/${V0}1/sys 0
+EXPECT "$(fragment_md5 $B0/src 2)" fragment_md5 $B0/${V0}0/sys 1
+EXPECT "$src_md5" echo $(md5sum < $M0/sys | cut -d' ' -f1)
+
+# Existing files keep their layout when the option changes
+TEST $CLI volume set $V0 disperse.systematic off
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "0" mount_get_option_value $M0 $V0-disperse-0 systematic
+TEST cp $B0/src $M0/orig
+EXPECT "0000080301000200" get_hex_xattr trusted.ec.config $B0/${V0}0/orig
+TEST $CLI volume set $V0 disperse.systematic on
+EXPECT_WITHIN $CONFIG_UPDATE_TIMEOUT "1" mount_get_option_value $M0 $V0-disperse-0 systematic
+
+# Degraded reads decode both layouts
+TEST kill_brick $V0 $H0 $B0/${V0}0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+EXPECT "$src_md5" echo $(md5sum < $M0/sys | cut -d' ' -f1)
+EXPECT "$src_md5" echo $(md5sum < $M0/orig | cut -d' ' -f1)
+
+# Files healed to a brick keep the layout of the other bricks
+TEST dd if=/dev/urandom of=$M0/sys bs=4k count=4 seek=3 conv=notrunc
+TEST dd if=/dev/urandom of=$M0/orig bs=4k count=4 seek=3 conv=notrunc
+TEST $CLI volume set $V0 disperse.systematic off
+TEST cp $B0/src $M0/new
+sys_md5=$(md5sum < $M0/sys | cut -d' ' -f1)
+orig_md5=$(md5sum < $M0/orig | cut -d' ' -f1)
+
+TEST $CLI volume start $V0 force
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "3" ec_child_up_count $V0 0
+TEST $CLI volume heal $V0 enable
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "[0-9][0-9]*" get_shd_process_pid
+TEST $CLI volume heal $V0
+EXPECT_WITHIN $HEAL_TIMEOUT "^0$" get_pending_heal_count $V0
+EXPECT "0001080301000200" get_hex_xattr trusted.ec.config $B0/${V0}0/sys
+EXPECT "0000080301000200" get_hex_xattr trusted.ec.config $B0/${V0}0/orig
+EXPECT "0000080301000200" get_hex_xattr trusted.ec.config $B0/${V0}0/new
+
+# Read everything back without the redundancy brick
+TEST kill_brick $V0 $H0 $B0/${V0}2
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "2" ec_child_up_count $V0 0
+EXPECT "$sys_md5" echo $(md5sum < $M0/sys | cut -d' ' -f1)
+EXPECT "$orig_md5" echo $(md5sum < $M0/orig | cut -d' ' -f1)
+EXPECT "$src_md5" echo $(md5sum < $M0/new | cut -d' ' -f1)
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup
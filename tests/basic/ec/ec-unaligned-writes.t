@@ -0,0 +1,48 @@
+#!/bin/bash
+
+. $(dirname $0)/../../include.rc
+. $(dirname $0)/../../volume.rc
+
+TESTS_EXPECTED_IN_LOOP=16
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+# 6 data fragments, so the stripe is 3072 bytes and 4KiB writes are never
+# stripe aligned
+TEST $CLI volume create $V0 disperse 8 redundancy 2 $H0:$B0/${V0}{0..7}
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 disperse.stripe-cache 0
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "8" ec_child_up_count $V0 0
+
+TEST dd if=/dev/urandom of=$B0/ref bs=64k count=4
+TEST cp $B0/ref $M0/file
+
+# Writes whose head and tail are in the same, adjacent or distant stripes
+for spec in "4096 1000" "3000 100" "3000 300" "6100 200" "1 4096" \
+            "3071 3074" "9000 6000" "0 7000"; do
+    set -- $spec
+    TEST dd if=/dev/urandom of=$B0/chunk bs=$2 count=1
+    dd if=$B0/chunk of=$B0/ref bs=1 seek=$1 conv=notrunc 2>/dev/null
+    TEST dd if=$B0/chunk of=$M0/file bs=$2 seek=$1 oflag=seek_bytes \
+         conv=notrunc,fsync
+done
+
+ref_md5=$(md5sum < $B0/ref | cut -d' ' -f1)
+EXPECT "$ref_md5" echo $(md5sum < $M0/file | cut -d' ' -f1)
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+EXPECT_WITHIN $CHILD_UP_TIMEOUT "8" ec_child_up_count $V0 0
+EXPECT "$ref_md5" echo $(md5sum < $M0/file | cut -d' ' -f1)
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup
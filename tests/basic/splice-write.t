@@ -0,0 +1,72 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+# Writes of brick0 that posix took from the splice pipe
+function spliced_writes {
+        get_value_from_brick_statedump $V0 $H0 $B0/${V0}0 spliced_writes
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 replica 2 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 performance.write-behind off
+TEST $CLI volume start $V0
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$B0/src bs=1M count=8
+src_md5=$(md5sum < $B0/src | cut -d' ' -f1)
+TEST dd if=$B0/src of=$M0/copied bs=1M conv=fsync
+EXPECT "^0$" spliced_writes
+
+# Set on the running volume, the option reaches the connections accepted
+# from then on. Large writes take the splice path, small ones are copied as
+# usual.
+TEST $CLI volume set $V0 server.splice-write on
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST dd if=$B0/src of=$M0/big bs=1M conv=fsync
+EXPECT "^[1-9][0-9]*$" spliced_writes
+spliced=$(spliced_writes)
+TEST dd if=$B0/src of=$M0/small bs=4k count=16 conv=fsync
+EXPECT "^$spliced$" spliced_writes
+
+EXPECT "$src_md5" echo $(md5sum < $B0/${V0}0/big | cut -d' ' -f1)
+EXPECT "$src_md5" echo $(md5sum < $B0/${V0}1/big | cut -d' ' -f1)
+EXPECT "$src_md5" echo $(md5sum < $M0/big | cut -d' ' -f1)
+
+small_md5=$(head -c 65536 $B0/src | md5sum | cut -d' ' -f1)
+EXPECT "$small_md5" echo $(md5sum < $B0/${V0}0/small | cut -d' ' -f1)
+
+# Switching it off again takes effect for new connections.
+TEST $CLI volume set $V0 server.splice-write off
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST dd if=$B0/src of=$M0/big2 bs=1M conv=fsync
+EXPECT "$src_md5" echo $(md5sum < $B0/${V0}0/big2 | cut -d' ' -f1)
+EXPECT "^$spliced$" spliced_writes
+
+# Compressed payloads are spliced too, and decompressed by the brick-side
+# cdc from a copy of the pipe.
+TEST $CLI volume set $V0 server.splice-write on
+TEST $CLI volume set $V0 network.compression on
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+TEST dd if=$B0/src of=$M0/compressed bs=1M conv=fsync
+EXPECT "$src_md5" echo $(md5sum < $B0/${V0}0/compressed | cut -d' ' -f1)
+EXPECT "$src_md5" echo $(md5sum < $M0/compressed | cut -d' ' -f1)
+TEST $CLI volume set $V0 network.compression off
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+# Not allowed on disperse volumes.
+TEST $CLI volume create $V1 disperse 3 redundancy 1 $H0:$B0/${V1}{0,1,2} force
+TEST ! $CLI volume set $V1 server.splice-write on
+TEST $CLI volume set $V1 server.splice-write off
+
+cleanup
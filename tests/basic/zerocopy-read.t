@@ -0,0 +1,56 @@
+#!/bin/bash
+
+. $(dirname $0)/../include.rc
+. $(dirname $0)/../volume.rc
+
+# Sums a zerocopy counter of the statedumps of both bricks
+function zerocopy_count {
+        local count=0
+        local value
+        local b
+
+        for b in $B0/${V0}{0,1}; do
+                value=$(get_value_from_brick_statedump $V0 $H0 $b \
+                        "server.total-zerocopy-$1")
+                count=$((count + ${value:-0}))
+        done
+        echo $count
+}
+
+cleanup
+
+TEST glusterd
+TEST pidof glusterd
+
+TEST $CLI volume create $V0 $H0:$B0/${V0}{0,1}
+TEST $CLI volume set $V0 performance.io-cache off
+TEST $CLI volume set $V0 performance.read-ahead off
+TEST $CLI volume set $V0 performance.quick-read off
+TEST $CLI volume start $V0
+
+# Set on the running bricks, the connections accepted afterwards use it.
+TEST $CLI volume set $V0 server.zerocopy-read on
+
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+TEST dd if=/dev/urandom of=$B0/src bs=1M count=8
+TEST cp $B0/src $M0/file
+
+# Drop the client side caches so that the data is read back from the bricks.
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+TEST $GFS --volfile-id=$V0 --volfile-server=$H0 $M0
+
+src_md5=$(md5sum < $B0/src | cut -d' ' -f1)
+EXPECT "$src_md5" echo $(dd if=$M0/file bs=128k 2>/dev/null | md5sum | cut -d' ' -f1)
+EXPECT "$src_md5" echo $(dd if=$M0/file bs=4k 2>/dev/null | md5sum | cut -d' ' -f1)
+
+# The bricks sent with MSG_ZEROCOPY and reaped all the completions.
+# Loopback copies the pages, which the completions report.
+sends=$(zerocopy_count sends)
+TEST [ $sends -gt 0 ]
+EXPECT_WITHIN $PROCESS_UP_TIMEOUT "$sends" zerocopy_count completed
+TEST [ $(zerocopy_count copied) -gt 0 ]
+
+EXPECT_WITHIN $UMOUNT_TIMEOUT "Y" force_umount $M0
+
+cleanup
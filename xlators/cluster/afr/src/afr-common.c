@@ -820,6 +820,7 @@ __afr_inode_ctx_get(xlator_t *this, inode_t *inode, afr_inode_ctx_t **ctx)
     }
 
     ictx->spb_choice = -1;
+    ictx->latency_read_child = -1;
     ictx->read_subvol = 0;
     ictx->write_subvol = 0;
     ictx->lock_count = 0;
@@ -2274,6 +2275,64 @@ afr_least_latency_times_pending_reads_child(afr_private_t *priv,
     return child;
 }
 
+static int64_t
+afr_child_read_latency(afr_private_t *priv, int child, time_t now)
+{
+    if (now - priv->read_latency_time[child] > AFR_READ_LATENCY_EXPIRY)
+        return 0;
+    return priv->read_latency[child];
+}
+
+/* Child with the lowest average read latency. The reads of an inode stay
+ * on the same child, to benefit from its page cache, until another one is
+ * faster by more than read-latency-hysteresis percent. */
+static int
+afr_adaptive_latency_child(xlator_t *this, inode_t *inode,
+                           unsigned char *readable)
+{
+    afr_private_t *priv = this->private;
+    afr_inode_ctx_t *ctx = NULL;
+    time_t now = gf_time();
+    int64_t latency = 0;
+    int64_t least_latency = 0;
+    int child = -1;
+    int i = 0;
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (AFR_IS_ARBITER_BRICK(priv, i) || !readable[i])
+            continue;
+
+        latency = afr_child_read_latency(priv, i, now);
+        if (child == -1 || latency < least_latency) {
+            least_latency = latency;
+            child = i;
+        }
+    }
+
+    if (child == -1)
+        return child;
+
+    LOCK(&inode->lock);
+    {
+        if (__afr_inode_ctx_get(this, inode, &ctx) < 0)
+            goto unlock;
+
+        i = ctx->latency_read_child;
+        if (i >= 0 && i != child && readable[i] &&
+            !AFR_IS_ARBITER_BRICK(priv, i)) {
+            latency = afr_child_read_latency(priv, i, now);
+            if (latency * 100 <=
+                least_latency * (100 + priv->read_latency_hysteresis))
+                child = i;
+        }
+        ctx->latency_read_child = child;
+    }
+unlock:
+    UNLOCK(&inode->lock);
+
+    return child;
+}
+
 int
 afr_hash_child(afr_read_subvol_args_t *args, afr_private_t *priv,
                unsigned char *readable)
@@ -2320,6 +2379,9 @@ afr_hash_child(afr_read_subvol_args_t *args, afr_private_t *priv,
         case AFR_READ_POLICY_LOAD_LATENCY_HYBRID:
             child = afr_least_latency_times_pending_reads_child(priv, readable);
             break;
+        case AFR_READ_POLICY_ADAPTIVE_LATENCY:
+            /* Needs the inode, see afr_read_subvol_select_by_policy() */
+            break;
     }
 
     return child;
@@ -2351,7 +2413,10 @@ afr_read_subvol_select_by_policy(inode_t *inode, xlator_t *this,
     }
 
     /* second preference - use hashed mode */
-    read_subvol = afr_hash_child(&local_args, priv, readable);
+    if (priv->hash_mode == AFR_READ_POLICY_ADAPTIVE_LATENCY)
+        read_subvol = afr_adaptive_latency_child(this, inode, readable);
+    else
+        read_subvol = afr_hash_child(&local_args, priv, readable);
     if (read_subvol >= 0 && readable[read_subvol])
         return read_subvol;
 
@@ -2780,6 +2845,35 @@ afr_is_xattr_ignorable(char *key)
     return _gf_false;
 }
 
+void
+afr_regions_key(uint64_t region_size, char *key, size_t size)
+{
+    snprintf(key, size, AFR_REGIONS_PREFIX "%" PRIu64, region_size);
+}
+
+/* Bitmap of the regions touched by [offset, offset + len). A len of 0
+ * extends to the end of the file. */
+uint64_t
+afr_regions_mask(uint64_t region_size, off_t offset, off_t len)
+{
+    uint64_t first = 0;
+    uint64_t last = 0;
+    uint64_t mask = 0;
+
+    if (len == 0)
+        return ~0ULL;
+
+    first = offset / region_size;
+    last = (offset + len - 1) / region_size;
+    if (last - first >= AFR_DATA_REGIONS - 1)
+        return ~0ULL;
+
+    for (; first <= last; first++)
+        mask |= 1ULL << (first % AFR_DATA_REGIONS);
+
+    return mask;
+}
+
 static gf_boolean_t
 afr_xattr_match_needed(dict_t *this, char *key1, data_t *value1, void *data)
 {
@@ -5665,6 +5759,8 @@ afr_priv_dump(xlator_t *this)
                            GF_ATOMIC_GET(priv->pending_reads[i]));
         sprintf(key, "child_latency[%d]", i);
         gf_proc_dump_write(key, "%" PRId64, priv->child_latency[i]);
+        sprintf(key, "read_latency[%d]", i);
+        gf_proc_dump_write(key, "%" PRId64, priv->read_latency[i]);
         sprintf(key, "halo_child_up[%d]", i);
         gf_proc_dump_write(key, "%d", priv->halo_child_up[i]);
     }
@@ -5680,6 +5776,10 @@ afr_priv_dump(xlator_t *this)
     gf_proc_dump_write("healers", "%d", priv->healers);
     gf_proc_dump_write("read-hash-mode", "%d", priv->hash_mode);
     gf_proc_dump_write("use-anonymous-inode", "%d", priv->use_anon_inode);
+    gf_proc_dump_write("data-self-heal-pipeline", "%u",
+                       priv->data_self_heal_pipeline);
+    gf_proc_dump_write("data-region-size", "%" PRIu64,
+                       priv->data_region_size);
     if (priv->quorum_count == AFR_QUORUM_AUTO) {
         gf_proc_dump_write("quorum-type", "auto");
     } else if (priv->quorum_count == 0) {
@@ -6685,6 +6785,8 @@ afr_priv_destroy(afr_private_t *priv)
     GF_FREE(priv->child_up);
     GF_FREE(priv->halo_child_up);
     GF_FREE(priv->child_latency);
+    GF_FREE(priv->read_latency);
+    GF_FREE(priv->read_latency_time);
     LOCK_DESTROY(&priv->lock);
 
     GF_FREE(priv);
@@ -30,6 +30,34 @@ afr_pending_read_decrement(afr_private_t *priv, int child_index)
     GF_ATOMIC_DEC(priv->pending_reads[child_index]);
 }
 
+/* Adds the latency of a successful read to the average of its child. */
+void
+afr_read_latency_update(afr_private_t *priv, afr_local_t *local, int op_ret)
+{
+    struct timespec now;
+    int child = local->read_subvol;
+    int64_t sample = 0;
+    int64_t latency = 0;
+
+    if (op_ret < 0 || child < 0 || child >= priv->child_count ||
+        local->read_start.tv_sec == 0)
+        return;
+
+    timespec_now(&now);
+    sample = max(gf_tsdiff(&local->read_start, &now) / 1000, 1);
+
+    /* Concurrent updates may lose a sample, which doesn't matter for an
+     * average. */
+    latency = priv->read_latency[child];
+    if (latency == 0 ||
+        gf_time() - priv->read_latency_time[child] > AFR_READ_LATENCY_EXPIRY)
+        latency = sample;
+    else
+        latency += (sample - latency) / AFR_READ_LATENCY_WEIGHT;
+    priv->read_latency[child] = latency;
+    priv->read_latency_time[child] = gf_time();
+}
+
 void
 afr_read_txn_wind(call_frame_t *frame, xlator_t *this, int subvol)
 {
@@ -42,6 +70,10 @@ afr_read_txn_wind(call_frame_t *frame, xlator_t *this, int subvol)
     afr_pending_read_decrement(priv, local->read_subvol);
     local->read_subvol = subvol;
     afr_pending_read_increment(priv, subvol);
+    if (priv->hash_mode == AFR_READ_POLICY_ADAPTIVE_LATENCY)
+        timespec_now(&local->read_start);
+    else
+        local->read_start.tv_sec = 0;
     local->readfn(frame, this, subvol);
 }
 
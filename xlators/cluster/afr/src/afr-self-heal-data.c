@@ -16,6 +16,7 @@
 #include <glusterfs/events.h>
 
 #define HAS_HOLES(i) ((i->ia_blocks * 512) < (i->ia_size))
+#define AFR_SH_DATA_BLOCK_SIZE (128 * 1024)
 static int
 __checksum_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
                int op_errno, uint32_t weak, uint8_t *strong, dict_t *xdata)
@@ -35,6 +36,7 @@ __checksum_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
             xdata, "buf-has-zeroes", _gf_false);
         replies[i].fips_mode_rchecksum = dict_get_str_boolean(
             xdata, "fips-mode-rchecksum", _gf_false);
+        replies[i].xdata = dict_ref(xdata);
     }
     if (strong) {
         if (replies[i].fips_mode_rchecksum) {
@@ -225,6 +227,135 @@ __afr_selfheal_data_read_write(call_frame_t *frame, xlator_t *this, fd_t *fd,
     return ret;
 }
 
+/* Heals the blocks of a range whose checksums, all received in a single
+ * rchecksum request, differ between the source and the sinks. */
+static int
+__afr_selfheal_data_diff_blocks(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                                int source, unsigned char *healed_sinks,
+                                off_t offset, size_t size,
+                                struct afr_reply *replies)
+{
+    afr_private_t *priv = NULL;
+    afr_local_t *local = NULL;
+    unsigned char *wind_subvols = NULL;
+    unsigned char *heal = NULL;
+    unsigned char *checksums = NULL;
+    unsigned char *sink_checksums = NULL;
+    dict_t *xdata = NULL;
+    size_t digest_len = GF_XXH64_DIGEST_LENGTH;
+    size_t range_digest_len = MD5_DIGEST_LENGTH;
+    int count = size / AFR_SH_DATA_BLOCK_SIZE;
+    int len = 0;
+    int sink_len = 0;
+    int ret = 0;
+    int i = 0;
+    int j = 0;
+    int k = 0;
+
+    priv = this->private;
+    local = frame->local;
+
+    heal = alloca0(count);
+    wind_subvols = alloca0(priv->child_count);
+    for (i = 0; i < priv->child_count; i++) {
+        if (i == source || healed_sinks[i])
+            wind_subvols[i] = 1;
+    }
+
+    xdata = dict_new();
+    if (!xdata ||
+        dict_set_int32_sizen(xdata, "check-zero-filled", 1) ||
+        dict_set_uint32(xdata, "rchecksum-block-size",
+                        AFR_SH_DATA_BLOCK_SIZE)) {
+        memset(heal, 1, count);
+        goto heal;
+    }
+
+    AFR_ONLIST(wind_subvols, frame, __checksum_cbk, rchecksum, fd, offset, size,
+               xdata);
+
+    /* Without the checksums of the source nothing can be compared, so the
+     * whole range is healed. */
+    if (!local->replies[source].valid || local->replies[source].op_ret != 0) {
+        memset(heal, 1, count);
+        goto heal;
+    }
+
+    /* Writing zeroes to non-sparse files keeps the disk usage of the bricks
+     * in sync. */
+    if (!HAS_HOLES((&replies[source].poststat)) &&
+        local->replies[source].buf_has_zeroes) {
+        memset(heal, 1, count);
+        goto heal;
+    }
+
+    if (local->replies[source].fips_mode_rchecksum) {
+        digest_len = SHA256_DIGEST_LENGTH;
+        range_digest_len = SHA256_DIGEST_LENGTH;
+    }
+
+    if (!local->replies[source].xdata ||
+        dict_get_ptr_and_len(local->replies[source].xdata, "rchecksum-blocks",
+                             (void **)&checksums, &len))
+        checksums = NULL;
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (!healed_sinks[i])
+            continue;
+
+        if (!local->replies[i].valid || local->replies[i].op_ret != 0) {
+            memset(heal, 1, count);
+            break;
+        }
+
+        sink_checksums = NULL;
+        if (checksums && local->replies[i].xdata &&
+            dict_get_ptr_and_len(local->replies[i].xdata, "rchecksum-blocks",
+                                 (void **)&sink_checksums, &sink_len))
+            sink_checksums = NULL;
+
+        /* Bricks that don't know about block checksums still return the
+         * checksum of the whole range, which tells whether the sink needs
+         * any of it. */
+        if (!checksums || !sink_checksums || sink_len != len) {
+            if (memcmp(local->replies[source].checksum,
+                       local->replies[i].checksum, range_digest_len)) {
+                memset(heal, 1, count);
+                break;
+            }
+            continue;
+        }
+
+        for (j = 0; j < count && (j + 1) * digest_len <= len; j++) {
+            if (memcmp(checksums + j * digest_len,
+                       sink_checksums + j * digest_len, digest_len))
+                heal[j] = 1;
+        }
+    }
+
+heal:
+    if (xdata)
+        dict_unref(xdata);
+
+    for (j = 0; j < count; j = k) {
+        for (k = j; k < count && heal[k]; k++)
+            ;
+        if (k == j) {
+            k++;
+            continue;
+        }
+
+        ret = __afr_selfheal_data_read_write(
+            frame, this, fd, source, healed_sinks,
+            offset + j * AFR_SH_DATA_BLOCK_SIZE,
+            (k - j) * AFR_SH_DATA_BLOCK_SIZE, replies, AFR_SELFHEAL_DATA_DIFF);
+        if (ret < 0)
+            break;
+    }
+
+    return ret;
+}
+
 static gf_boolean_t
 afr_source_sinks_locked(xlator_t *this, unsigned char *locked_on, int source,
                         unsigned char *healed_sinks)
@@ -266,6 +397,13 @@ afr_selfheal_data_block(call_frame_t *frame, xlator_t *this, fd_t *fd,
             goto unlock;
         }
 
+        if (type == AFR_SELFHEAL_DATA_DIFF &&
+            size > AFR_SH_DATA_BLOCK_SIZE) {
+            ret = __afr_selfheal_data_diff_blocks(
+                frame, this, fd, source, healed_sinks, offset, size, replies);
+            goto unlock;
+        }
+
         if (type == AFR_SELFHEAL_DATA_DIFF &&
             __afr_can_skip_data_block_heal(frame, this, fd, source,
                                            healed_sinks, offset, size,
@@ -331,16 +469,122 @@ afr_data_self_heal_type_get(afr_private_t *priv, unsigned char *healed_sinks,
     return type;
 }
 
+/* State shared by the tasks healing the blocks of a file concurrently. */
+typedef struct {
+    gf_lock_t lock;
+    syncbarrier_t barrier;
+    call_frame_t *frame;
+    xlator_t *this;
+    fd_t *fd;
+    struct afr_reply *replies;
+    unsigned char *healed_sinks;
+    uint64_t region_size;
+    uint64_t regions;
+    off_t offset;
+    off_t size;
+    size_t block;
+    int source;
+    int type;
+    int error;
+} afr_selfheal_data_pipe_t;
+
+static gf_boolean_t
+afr_selfheal_data_next(afr_selfheal_data_pipe_t *pipe, off_t *offset)
+{
+    gf_boolean_t found = _gf_false;
+
+    LOCK(&pipe->lock);
+    {
+        while (!pipe->error && pipe->offset < pipe->size) {
+            *offset = pipe->offset;
+            pipe->offset += pipe->block;
+
+            if (!pipe->region_size ||
+                (afr_regions_mask(pipe->region_size, *offset, pipe->block) &
+                 pipe->regions)) {
+                found = _gf_true;
+                break;
+            }
+        }
+    }
+    UNLOCK(&pipe->lock);
+
+    return found;
+}
+
+static int
+afr_selfheal_data_run(void *data)
+{
+    afr_selfheal_data_pipe_t *pipe = data;
+    afr_private_t *priv = pipe->this->private;
+    call_frame_t *iter_frame = NULL;
+    off_t off = 0;
+    int ret = 0;
+
+    iter_frame = afr_copy_frame(pipe->frame);
+    if (!iter_frame) {
+        ret = -ENOMEM;
+        goto out;
+    }
+
+    while (afr_selfheal_data_next(pipe, &off)) {
+        if (AFR_COUNT(pipe->healed_sinks, priv->child_count) == 0) {
+            ret = -ENOTCONN;
+            goto out;
+        }
+
+        ret = afr_selfheal_data_block(iter_frame, pipe->this, pipe->fd,
+                                      pipe->source, pipe->healed_sinks, off,
+                                      pipe->block, pipe->type, pipe->replies);
+        if (ret < 0)
+            goto out;
+
+        AFR_STACK_RESET(iter_frame);
+        if (iter_frame->local == NULL) {
+            ret = -ENOTCONN;
+            goto out;
+        }
+    }
+    ret = 0;
+
+out:
+    if (ret < 0) {
+        LOCK(&pipe->lock);
+        {
+            if (!pipe->error)
+                pipe->error = ret;
+        }
+        UNLOCK(&pipe->lock);
+    }
+
+    if (iter_frame)
+        AFR_STACK_DESTROY(iter_frame);
+    return ret;
+}
+
+static int
+afr_selfheal_data_run_done(int ret, call_frame_t *frame, void *data)
+{
+    afr_selfheal_data_pipe_t *pipe = data;
+
+    syncbarrier_wake(&pipe->barrier);
+
+    return 0;
+}
+
 static int
 afr_selfheal_data_do(call_frame_t *frame, xlator_t *this, fd_t *fd, int source,
-                     unsigned char *healed_sinks, struct afr_reply *replies)
+                     unsigned char *healed_sinks, struct afr_reply *replies,
+                     uint64_t region_size, uint64_t regions)
 {
     afr_private_t *priv = NULL;
-    off_t off = 0;
-    size_t block = 0;
-    int type = AFR_SELFHEAL_DATA_FULL;
+    afr_selfheal_data_pipe_t pipe = {
+        0,
+    };
+    uint64_t blocks = 0;
+    uint32_t tasks = 0;
+    uint32_t started = 0;
     int ret = -1;
-    call_frame_t *iter_frame = NULL;
     unsigned char arbiter_sink_status = 0;
 
     gf_msg(this->name, GF_LOG_INFO, 0, AFR_MSG_SELF_HEAL_INFO,
@@ -352,39 +596,55 @@ afr_selfheal_data_do(call_frame_t *frame, xlator_t *this, fd_t *fd, int source,
         healed_sinks[ARBITER_BRICK_INDEX] = 0;
     }
 
-    block = 128 * 1024 * priv->data_self_heal_window_size;
+    pipe.block = AFR_SH_DATA_BLOCK_SIZE * priv->data_self_heal_window_size;
     if (HAS_HOLES((&replies[source].poststat))) {
         /*Reduce the possibility of data-block allocations in case of files
          * with holes. Correct way to fix it would be to use seek fop while
          * healing data*/
-        block = 128 * 1024;
+        pipe.block = AFR_SH_DATA_BLOCK_SIZE;
     }
 
-    type = afr_data_self_heal_type_get(priv, healed_sinks, source, replies);
-
-    iter_frame = afr_copy_frame(frame);
-    if (!iter_frame) {
-        ret = -ENOMEM;
+    pipe.type = afr_data_self_heal_type_get(priv, healed_sinks, source,
+                                            replies);
+    pipe.frame = frame;
+    pipe.this = this;
+    pipe.fd = fd;
+    pipe.replies = replies;
+    pipe.healed_sinks = healed_sinks;
+    pipe.region_size = region_size;
+    pipe.regions = regions;
+    pipe.size = replies[source].poststat.ia_size;
+    pipe.source = source;
+    ret = syncbarrier_init(&pipe.barrier);
+    if (ret) {
+        ret = -errno;
         goto out;
     }
+    LOCK_INIT(&pipe.lock);
+
+    /* Each task heals one block at a time, so that the checksums and
+     * transfers of several blocks are in flight. */
+    tasks = priv->data_self_heal_pipeline;
+    blocks = (pipe.size + pipe.block - 1) / pipe.block;
+    if (tasks > blocks)
+        tasks = blocks;
+    while (started + 1 < tasks) {
+        if (synctask_new(this->ctx->env, afr_selfheal_data_run,
+                         afr_selfheal_data_run_done, NULL, &pipe) != 0)
+            break;
+        started++;
+    }
 
-    for (off = 0; off < replies[source].poststat.ia_size; off += block) {
-        if (AFR_COUNT(healed_sinks, priv->child_count) == 0) {
-            ret = -ENOTCONN;
-            goto out;
-        }
+    afr_selfheal_data_run(&pipe);
+    if (started > 0)
+        syncbarrier_wait(&pipe.barrier, started);
 
-        ret = afr_selfheal_data_block(iter_frame, this, fd, source,
-                                      healed_sinks, off, block, type, replies);
-        if (ret < 0)
-            goto out;
+    LOCK_DESTROY(&pipe.lock);
+    syncbarrier_destroy(&pipe.barrier);
 
-        AFR_STACK_RESET(iter_frame);
-        if (iter_frame->local == NULL) {
-            ret = -ENOTCONN;
-            goto out;
-        }
-    }
+    ret = pipe.error;
+    if (ret < 0)
+        goto out;
 
     ret = afr_selfheal_data_fsync(frame, this, fd, healed_sinks);
 
@@ -392,8 +652,6 @@ out:
     if (arbiter_sink_status)
         healed_sinks[ARBITER_BRICK_INDEX] = arbiter_sink_status;
 
-    if (iter_frame)
-        AFR_STACK_DESTROY(iter_frame);
     return ret;
 }
 
@@ -658,6 +916,141 @@ __afr_selfheal_data_prepare(call_frame_t *frame, xlator_t *this, inode_t *inode,
     return source;
 }
 
+/* Regions that the sources recorded as written while the sinks missed the
+ * writes. The records are only trusted if they account for all the pending
+ * changes the sources hold against the sinks, otherwise the whole file is
+ * healed. */
+static uint64_t
+afr_selfheal_data_regions(xlator_t *this, uint64_t region_size,
+                          unsigned char *sources, unsigned char *healed_sinks,
+                          struct afr_reply *replies)
+{
+    afr_private_t *priv = this->private;
+    char key[AFR_REGIONS_KEY_SIZE];
+    int32_t *regions = NULL;
+    int **matrix = NULL;
+    unsigned char *blamed = NULL;
+    gf_boolean_t blames = _gf_false;
+    uint64_t mask = 0;
+    int len = 0;
+    int i = 0;
+    int j = 0;
+
+    matrix = ALLOC_MATRIX(priv->child_count, int);
+    blamed = alloca0(priv->child_count);
+    afr_selfheal_extract_xattr(this, replies, AFR_DATA_TRANSACTION, NULL,
+                               matrix);
+    afr_regions_key(region_size, key, sizeof(key));
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (!sources[i])
+            continue;
+
+        blames = _gf_false;
+        for (j = 0; j < priv->child_count; j++) {
+            if (healed_sinks[j] && matrix[i][j] > 0)
+                blamed[j] = blames = _gf_true;
+        }
+        if (!blames)
+            continue;
+
+        if (!replies[i].xdata ||
+            dict_get_ptr_and_len(replies[i].xdata, key, (void **)&regions,
+                                 &len) ||
+            len != (priv->child_count + AFR_DATA_REGIONS) * sizeof(*regions))
+            return ~0ULL;
+
+        for (j = 0; j < priv->child_count; j++) {
+            if (healed_sinks[j] && matrix[i][j] > (int)ntoh32(regions[j]))
+                return ~0ULL;
+        }
+
+        for (j = 0; j < AFR_DATA_REGIONS; j++) {
+            if (regions[priv->child_count + j])
+                mask |= 1ULL << j;
+        }
+    }
+
+    for (j = 0; j < priv->child_count; j++) {
+        if (healed_sinks[j] && !blamed[j])
+            return ~0ULL;
+    }
+
+    return mask;
+}
+
+/* Drops the records accounted for by the heal. The region counters of a
+ * brick are kept while it still has records for bricks that weren't healed.
+ */
+static void
+afr_selfheal_data_reset_regions(call_frame_t *frame, xlator_t *this,
+                                inode_t *inode, uint64_t region_size,
+                                unsigned char *healed_sinks,
+                                struct afr_reply *replies,
+                                unsigned char *locked_on)
+{
+    afr_private_t *priv = this->private;
+    char key[AFR_REGIONS_KEY_SIZE];
+    dict_t *xattr = NULL;
+    int32_t *regions = NULL;
+    int32_t *delta = NULL;
+    gf_boolean_t keep = _gf_false;
+    gf_boolean_t changed = _gf_false;
+    int count = priv->child_count + AFR_DATA_REGIONS;
+    int len = 0;
+    int i = 0;
+    int j = 0;
+
+    afr_regions_key(region_size, key, sizeof(key));
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (!locked_on[i] || !replies[i].valid || replies[i].op_ret ||
+            !replies[i].xdata)
+            continue;
+
+        if (dict_get_ptr_and_len(replies[i].xdata, key, (void **)&regions,
+                                 &len) ||
+            len != count * sizeof(*regions))
+            continue;
+
+        delta = GF_CALLOC(count, sizeof(*delta), gf_afr_mt_int32_t);
+        if (!delta)
+            return;
+
+        keep = _gf_false;
+        changed = _gf_false;
+        for (j = 0; j < priv->child_count; j++) {
+            if (!regions[j])
+                continue;
+            if (healed_sinks[j]) {
+                delta[j] = hton32(-ntoh32(regions[j]));
+                changed = _gf_true;
+            } else {
+                keep = _gf_true;
+            }
+        }
+
+        for (j = priv->child_count; !keep && j < count; j++) {
+            if (regions[j]) {
+                delta[j] = hton32(-ntoh32(regions[j]));
+                changed = _gf_true;
+            }
+        }
+
+        xattr = dict_new();
+        if (!changed || !xattr || dict_set_bin(xattr, key, delta, len)) {
+            GF_FREE(delta);
+        } else {
+            afr_selfheal_post_op(frame, this, inode, i, xattr, NULL);
+        }
+
+        if (xattr) {
+            dict_unref(xattr);
+            xattr = NULL;
+        }
+    }
+}
+
 static int
 __afr_selfheal_data(call_frame_t *frame, xlator_t *this, fd_t *fd,
                     unsigned char *locked_on)
@@ -674,8 +1067,11 @@ __afr_selfheal_data(call_frame_t *frame, xlator_t *this, fd_t *fd,
     gf_boolean_t did_sh = _gf_true;
     gf_boolean_t is_arbiter_the_only_sink = _gf_false;
     gf_boolean_t empty_file = _gf_false;
+    uint64_t region_size = 0;
+    uint64_t regions = ~0ULL;
 
     priv = this->private;
+    region_size = priv->data_region_size;
 
     sources = alloca0(priv->child_count);
     sinks = alloca0(priv->child_count);
@@ -712,6 +1108,10 @@ __afr_selfheal_data(call_frame_t *frame, xlator_t *this, fd_t *fd,
 
         source = ret;
 
+        if (region_size)
+            regions = afr_selfheal_data_regions(this, region_size, sources,
+                                                healed_sinks, locked_replies);
+
         if (AFR_IS_ARBITER_BRICK(priv, source)) {
             empty_file = afr_is_file_empty_on_all_children(priv,
                                                            locked_replies);
@@ -745,7 +1145,7 @@ unlock:
         goto out;
 
     ret = afr_selfheal_data_do(frame, this, fd, source, healed_sinks,
-                               locked_replies);
+                               locked_replies, region_size, regions);
     if (ret)
         goto out;
 restore_time:
@@ -761,6 +1161,10 @@ restore_time:
             goto skip_undo_pending;
         }
     }
+    if (region_size)
+        afr_selfheal_data_reset_regions(frame, this, fd->inode, region_size,
+                                        healed_sinks, locked_replies,
+                                        data_lock);
     ret = afr_selfheal_undo_pending(
         frame, this, fd->inode, sources, sinks, healed_sinks, undid_pending,
         AFR_DATA_TRANSACTION, locked_replies, data_lock);
@@ -1366,6 +1366,47 @@ afr_handle_failure_using_thin_arbiter(call_frame_t *frame, xlator_t *this)
     afr_ta_decide_post_op_state(frame, this);
 }
 
+/* Record the region written by a data transaction that some bricks missed,
+ * so that data self-heal can restrict itself to the written regions. */
+static int
+afr_changelog_set_regions(xlator_t *this, afr_local_t *local, dict_t *xattr)
+{
+    afr_private_t *priv = this->private;
+    char key[AFR_REGIONS_KEY_SIZE];
+    int32_t *regions = NULL;
+    uint64_t region_size = priv->data_region_size;
+    uint64_t mask = 0;
+    int count = priv->child_count + AFR_DATA_REGIONS;
+    int i = 0;
+    int ret = 0;
+
+    if (!region_size)
+        return 0;
+
+    regions = GF_CALLOC(count, sizeof(*regions), gf_afr_mt_int32_t);
+    if (!regions)
+        return -ENOMEM;
+
+    for (i = 0; i < priv->child_count; i++) {
+        if (local->transaction.failed_subvols[i])
+            regions[i] = hton32(1);
+    }
+
+    mask = afr_regions_mask(region_size, local->transaction.start,
+                            local->transaction.len);
+    for (i = 0; i < AFR_DATA_REGIONS; i++) {
+        if (mask & (1ULL << i))
+            regions[priv->child_count + i] = hton32(1);
+    }
+
+    afr_regions_key(region_size, key, sizeof(key));
+    ret = dict_set_bin(xattr, key, regions, count * sizeof(*regions));
+    if (ret)
+        GF_FREE(regions);
+
+    return ret;
+}
+
 void
 afr_changelog_post_op_do(call_frame_t *frame, xlator_t *this)
 {
@@ -1427,6 +1468,14 @@ afr_changelog_post_op_do(call_frame_t *frame, xlator_t *this)
         goto out;
     }
 
+    if (!nothing_failed && local->transaction.type == AFR_DATA_TRANSACTION) {
+        ret = afr_changelog_set_regions(this, local, xattr);
+        if (ret) {
+            afr_changelog_post_op_fail(frame, this, ENOMEM);
+            goto out;
+        }
+    }
+
     if (need_undirty)
         local->dirty[idx] = hton32(-1);
     else
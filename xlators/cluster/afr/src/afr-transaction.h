@@ -45,6 +45,9 @@ afr_pending_read_increment(afr_private_t *priv, int child_index);
 void
 afr_pending_read_decrement(afr_private_t *priv, int child_index);
 
+void
+afr_read_latency_update(afr_private_t *priv, afr_local_t *local, int op_ret);
+
 call_frame_t *
 afr_transaction_detach_fop_frame(call_frame_t *frame);
 gf_boolean_t
@@ -198,6 +198,12 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("data-self-heal-window-size",
                      priv->data_self_heal_window_size, options, uint32, out);
 
+    GF_OPTION_RECONF("data-self-heal-pipeline", priv->data_self_heal_pipeline,
+                     options, uint32, out);
+
+    GF_OPTION_RECONF("data-region-size", priv->data_region_size, options,
+                     size_uint64, out);
+
     GF_OPTION_RECONF("data-self-heal-algorithm", data_self_heal_algorithm,
                      options, str, out);
     set_data_self_heal_algorithm(priv, data_self_heal_algorithm);
@@ -232,6 +238,9 @@ reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("read-hash-mode", priv->hash_mode, options, uint32, out);
 
+    GF_OPTION_RECONF("read-latency-hysteresis", priv->read_latency_hysteresis,
+                     options, uint32, out);
+
     if (read_subvol) {
         index = xlator_subvolume_index(this, read_subvol);
         if (index == -1) {
@@ -493,6 +502,9 @@ init(xlator_t *this)
 
     GF_OPTION_INIT("read-hash-mode", priv->hash_mode, uint32, out);
 
+    GF_OPTION_INIT("read-latency-hysteresis", priv->read_latency_hysteresis,
+                   uint32, out);
+
     priv->favorite_child = -1;
 
     GF_OPTION_INIT("favorite-child-policy", fav_child_policy, str, out);
@@ -519,6 +531,12 @@ init(xlator_t *this)
     GF_OPTION_INIT("data-self-heal-window-size",
                    priv->data_self_heal_window_size, uint32, out);
 
+    GF_OPTION_INIT("data-self-heal-pipeline", priv->data_self_heal_pipeline,
+                   uint32, out);
+
+    GF_OPTION_INIT("data-region-size", priv->data_region_size, size_uint64,
+                   out);
+
     GF_OPTION_INIT("metadata-self-heal", priv->metadata_self_heal, bool, out);
 
     GF_OPTION_INIT("entry-self-heal", priv->entry_self_heal, bool, out);
@@ -586,9 +604,15 @@ init(xlator_t *this)
                                     gf_afr_mt_child_latency_t);
     priv->halo_child_up = GF_CALLOC(sizeof(unsigned char), child_count,
                                     gf_afr_mt_char);
+    priv->read_latency = GF_CALLOC(sizeof(*priv->read_latency), child_count,
+                                   gf_afr_mt_child_latency_t);
+    priv->read_latency_time = GF_CALLOC(sizeof(*priv->read_latency_time),
+                                        child_count,
+                                        gf_afr_mt_child_latency_t);
 
     if (!priv->child_up || !priv->child_latency || !priv->halo_child_up ||
-        !priv->anon_inode) {
+        !priv->anon_inode || !priv->read_latency ||
+        !priv->read_latency_time) {
         ret = -ENOMEM;
         goto out;
     }
@@ -843,7 +867,7 @@ struct volume_options options[] = {
     {.key = {"read-hash-mode"},
      .type = GF_OPTION_TYPE_INT,
      .min = 0,
-     .max = 5,
+     .max = 6,
      .default_value = "1",
      .op_version = {2},
      .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
@@ -859,7 +883,21 @@ struct volume_options options[] = {
          "3 = brick having the least outstanding read requests.\n"
          "4 = brick having the least network ping latency.\n"
          "5 = Hybrid mode between 3 and 4, ie least value among "
-         "network-latency multiplied by outstanding-read-requests."},
+         "network-latency multiplied by outstanding-read-requests.\n"
+         "6 = brick having the least average read latency, keeping "
+         "the reads of a file on the same brick while no other one is "
+         "faster by read-latency-hysteresis percent."},
+    {.key = {"read-latency-hysteresis"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 1000,
+     .default_value = "20",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"replicate"},
+     .description = "With read-hash-mode 6, percentage by which the "
+                    "average read latency of another brick must be lower "
+                    "for the reads of a file to move to it."},
     {
         .key = {"choose-local"},
         .type = GF_OPTION_TYPE_BOOL,
@@ -987,6 +1025,31 @@ struct volume_options options[] = {
      .tags = {"replicate"},
      .description = "Maximum number of 128KB blocks per file for which "
                     "self-heal process would be applied simultaneously."},
+    {.key = {"data-self-heal-pipeline"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 64,
+     .default_value = "1",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"replicate"},
+     .description = "Number of blocks of a file that data self-heal "
+                    "checksums and heals concurrently. With the diff "
+                    "algorithm, a single checksum request covers all the "
+                    "128KB blocks of a self-heal window."},
+    {.key = {"data-region-size"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .min = 0,
+     .max = 1 * GF_UNIT_TB,
+     .default_value = "0",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC,
+     .tags = {"replicate"},
+     .description = "Size of the regions of a file whose writes are "
+                    "recorded when a brick misses them. Data self-heal "
+                    "then only heals the regions that were written. "
+                    "Offsets wrap around every 64 regions. 0 disables "
+                    "the recording."},
     {.key = {"metadata-self-heal"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "off",
@@ -28,6 +28,15 @@
 #define AFR_DIRTY_DEFAULT AFR_XATTR_PREFIX ".dirty"
 #define AFR_DIRTY (((afr_private_t *)(THIS->private))->afr_dirty)
 
+/* Regions of a file written while some brick missed the writes. The value
+ * has one counter of recorded transactions per brick, followed by
+ * AFR_DATA_REGIONS counters of data-region-size bytes each (offsets wrap
+ * around in bigger files). The region size is part of the name, so that a
+ * change of the option doesn't mix both. */
+#define AFR_REGIONS_PREFIX AFR_XATTR_PREFIX ".regions."
+#define AFR_REGIONS_KEY_SIZE (SLEN(AFR_REGIONS_PREFIX) + 21)
+#define AFR_DATA_REGIONS 64
+
 #define AFR_LOCKEE_COUNT_MAX 3
 #define AFR_DOM_COUNT_MAX 3
 #define AFR_NUM_CHANGE_LOGS 3              /*data + metadata + entry*/
@@ -41,6 +50,11 @@
 #define AFR_LK_HEAL_DOM "afr.lock-heal.domain"
 
 #define AFR_HALO_MAX_LATENCY 99999
+/* Weight of a new sample in the read latency average is 1 / this. */
+#define AFR_READ_LATENCY_WEIGHT 8
+/* Seconds after which the read latency of an unused child is forgotten,
+ * so that it gets a chance to be measured again. */
+#define AFR_READ_LATENCY_EXPIRY 30
 #define AFR_ANON_DIR_PREFIX ".glusterfs-anonymous-inode"
 
 #define PFLAG_PENDING (1 << 0)
@@ -114,6 +128,7 @@ typedef enum {
     AFR_READ_POLICY_LESS_LOAD,
     AFR_READ_POLICY_LEAST_LATENCY,
     AFR_READ_POLICY_LOAD_LATENCY_HYBRID,
+    AFR_READ_POLICY_ADAPTIVE_LATENCY,
 } afr_read_hash_mode_t;
 
 typedef enum {
@@ -199,6 +214,10 @@ typedef struct _afr_private {
     afr_data_self_heal_type_t data_self_heal_algorithm;
     unsigned int data_self_heal_window_size; /* max number of pipelined
                                                 read/writes */
+    uint32_t data_self_heal_pipeline; /* blocks of a file healed
+                                         concurrently */
+    uint64_t data_region_size; /* granularity of the written regions
+                                  recorded for data heal, 0 to disable */
 
     struct list_head heal_waiting; /*queue for files that need heal*/
     uint32_t heal_wait_qlen; /*configurable queue length for heal_waiting*/
@@ -219,6 +238,12 @@ typedef struct _afr_private {
     gf_boolean_t metadata_splitbrain_forced_heal; /* on/off */
     int read_child;                               /* read-subvolume */
     gf_atomic_t *pending_reads; /*No. of pending read cbks per child.*/
+    int64_t *read_latency;      /* Average read latency per child, in
+                                   microseconds. 0 if unknown. */
+    time_t *read_latency_time;  /* Last update of read_latency */
+    uint32_t read_latency_hysteresis; /* % by which another child must be
+                                         faster to move the reads of an
+                                         inode to it */
 
     gf_timer_t *timer; /* launched when parent up is received */
 
@@ -460,6 +485,9 @@ typedef struct _afr_inode_ctx {
        (i.e, without O_SYNC or O_DSYNC)
     */
     gf_boolean_t witnessed_unstable_write;
+
+    /* child chosen by the adaptive latency read policy */
+    int latency_read_child;
 } afr_inode_ctx_t;
 
 typedef struct _afr_local {
@@ -549,6 +577,7 @@ typedef struct _afr_local {
     dict_t *dict;
 
     int read_subvol; /* Current read subvolume */
+    struct timespec read_start; /* When the read was sent to read_subvol */
 
     int optimistic_change_log;
 
@@ -1116,9 +1145,11 @@ afr_cleanup_fd_ctx(xlator_t *this, fd_t *fd);
             __local = frame->local;                                            \
             __this = frame->this;                                              \
             afr_handle_inconsistent_fop(frame, &__op_ret, &__op_errno);        \
-            if (__local && __local->is_read_txn)                               \
+            if (__local && __local->is_read_txn) {                             \
+                afr_read_latency_update(__this->private, __local, __op_ret);   \
                 afr_pending_read_decrement(__this->private,                    \
                                            __local->read_subvol);              \
+            }                                                                  \
             if (__local && __local->xdata_req &&                               \
                 afr_is_lock_mode_mandatory(__local->xdata_req))                \
                 afr_dom_lock_release(frame);                                   \
@@ -1258,6 +1289,12 @@ afr_xattrs_are_equal(dict_t *dict1, dict_t *dict2);
 gf_boolean_t
 afr_is_xattr_ignorable(char *key);
 
+void
+afr_regions_key(uint64_t region_size, char *key, size_t size);
+
+uint64_t
+afr_regions_mask(uint64_t region_size, off_t offset, off_t len);
+
 int
 afr_get_heal_info(call_frame_t *frame, xlator_t *this, loc_t *loc);
 
@@ -494,6 +494,17 @@ out:
     return ret;
 }
 
+/* Bricks were added or removed if the volume commit hash changes, cached
+ * directory layouts can't be trusted anymore */
+static void
+dht_vol_commit_hash_set(dht_conf_t *conf, uint32_t vol_commit_hash)
+{
+    if (conf->vol_commit_hash != vol_commit_hash) {
+        conf->vol_commit_hash = vol_commit_hash;
+        GF_ATOMIC_INC(conf->layout_cache_gen);
+    }
+}
+
 static int
 dht_discover_complete(xlator_t *this, call_frame_t *discover_frame)
 {
@@ -587,7 +598,7 @@ dht_discover_complete(xlator_t *this, call_frame_t *discover_frame)
         ret = dict_get_uint32(local->xattr, conf->commithash_xattr_name,
                               &vol_commit_hash);
         if (ret == 0) {
-            conf->vol_commit_hash = vol_commit_hash;
+            dht_vol_commit_hash_set(conf, vol_commit_hash);
         }
     }
 
@@ -1672,7 +1683,7 @@ dht_revalidate_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
         ret = dict_get_uint32(xattr, conf->commithash_xattr_name,
                               &vol_commit_hash);
         if (ret == 0) {
-            conf->vol_commit_hash = vol_commit_hash;
+            dht_vol_commit_hash_set(conf, vol_commit_hash);
         }
     }
 
@@ -1969,6 +1980,14 @@ unlock:
             local->op_ret = -1;
             local->op_errno = ESTALE;
         }
+
+        /* All the subvolumes agree with the layout */
+        if (IA_ISDIR(local->stbuf.ia_type) && (local->op_ret == 0) &&
+            !local->op_errno && local->layout) {
+            local->layout->cache_gen = local->layout_cache_gen;
+            local->layout->cache_time = gf_time();
+        }
+
         /* Delete mds xattr at the time of STACK UNWIND */
         if (local->xattr)
             GF_REMOVE_INTERNAL_XATTR(conf->mds_xattr_key, local->xattr);
@@ -1982,6 +2001,88 @@ err:
     return ret;
 }
 
+static int
+dht_do_revalidate(call_frame_t *frame, xlator_t *this, loc_t *loc);
+
+/* Revalidation of a directory whose layout is cached, on its MDS subvolume
+ * only. Anything unexpected falls back to a revalidation on all the
+ * subvolumes. */
+static int
+dht_revalidate_cached_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                          int op_ret, int op_errno, inode_t *inode,
+                          struct iatt *stbuf, dict_t *xattr,
+                          struct iatt *postparent)
+{
+    dht_local_t *local = NULL;
+    xlator_t *prev = NULL;
+    dht_conf_t *conf = NULL;
+    int32_t mds_xattr_val[1] = {0};
+    int errst = 0;
+
+    local = frame->local;
+    prev = cookie;
+    conf = this->private;
+
+    if ((op_ret == -1) || (stbuf->ia_type != IA_IFDIR) ||
+        !dict_get(xattr, conf->mds_xattr_key) ||
+        (dht_dict_get_array(xattr, conf->mds_xattr_key, mds_xattr_val, 1,
+                            &errst) < 0) ||
+        errst ||
+        dht_layout_dir_mismatch(this, local->layout, prev, &local->loc,
+                                xattr)) {
+        gf_msg_debug(this->name, op_errno,
+                     "%s: cached layout not confirmed by %s, revalidating "
+                     "on all subvolumes",
+                     local->loc.path, prev->name);
+
+        local->layout_cache_miss = 1;
+        inode_unref(local->inode);
+        local->inode = NULL;
+        dht_do_revalidate(frame, this, &local->loc);
+        return 0;
+    }
+
+    gf_uuid_copy(local->stbuf.ia_gfid, stbuf->ia_gfid);
+    dht_iatt_merge(this, &local->stbuf, stbuf);
+    dht_iatt_merge(this, &local->postparent, postparent);
+    local->op_ret = 0;
+    local->xattr = dict_ref(xattr);
+
+    if (local->loc.parent) {
+        dht_inode_ctx_time_update(local->loc.parent, this, &local->postparent,
+                                  1);
+    }
+
+    DHT_STRIP_PHASE1_FLAGS(&local->stbuf);
+    dht_set_fixed_dir_stat(&local->postparent);
+
+    GF_REMOVE_INTERNAL_XATTR(conf->mds_xattr_key, local->xattr);
+
+    DHT_STACK_UNWIND(lookup, frame, local->op_ret, local->op_errno,
+                     local->inode, &local->stbuf, local->xattr,
+                     &local->postparent);
+    return 0;
+}
+
+/* A directory layout checked on all the subvolumes is trusted for
+ * layout-cache-timeout seconds, unless a subvolume went up or down, the
+ * volume commit hash changed or a layout change was notified. */
+static gf_boolean_t
+dht_layout_cache_valid(xlator_t *this, dht_layout_t *layout, loc_t *loc)
+{
+    dht_conf_t *conf = this->private;
+    uint32_t timeout = conf->layout_cache_timeout;
+
+    if (!timeout || !layout->cache_time || __is_root_gfid(loc->inode->gfid))
+        return _gf_false;
+
+    if ((layout->gen != conf->gen) ||
+        (layout->cache_gen != GF_ATOMIC_GET(conf->layout_cache_gen)))
+        return _gf_false;
+
+    return (gf_time() - layout->cache_time) < timeout;
+}
+
 static int
 dht_lookup_linkfile_create_cbk(call_frame_t *frame, void *cooie, xlator_t *this,
                                int32_t op_ret, int32_t op_errno, inode_t *inode,
@@ -3114,7 +3215,7 @@ dht_lookup_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
         ret = dict_get_uint32(xattr, conf->commithash_xattr_name,
                               &vol_commit_hash);
         if (ret == 0) {
-            conf->vol_commit_hash = vol_commit_hash;
+            dht_vol_commit_hash_set(conf, vol_commit_hash);
         }
     }
 
@@ -3438,6 +3539,17 @@ dht_do_revalidate(call_frame_t *frame, xlator_t *this, loc_t *loc)
                          local->loc.path);
         }
         local->mds_subvol = mds_subvol;
+
+        if (mds_subvol && !local->layout_cache_miss &&
+            dht_layout_cache_valid(this, layout, loc)) {
+            local->call_cnt = 1;
+            STACK_WIND_COOKIE(frame, dht_revalidate_cached_cbk, mds_subvol,
+                              mds_subvol, mds_subvol->fops->lookup, loc,
+                              local->xattr_req);
+            return 0;
+        }
+
+        local->layout_cache_gen = GF_ATOMIC_GET(conf->layout_cache_gen);
         local->call_cnt = conf->subvolume_cnt;
 
         /* local->call_cnt will change as responses are processed. Always use a
@@ -6713,20 +6825,16 @@ dht_queue_readdirp(call_frame_t *frame, xlator_t *xl, off_t offset,
     }
 }
 
-/* Posix returns op_errno = ENOENT to indicate that there are no more
- * entries
- */
+/* Moves to 'entries' the entries read from 'prev' that DHT must return: no
+ * linkto files, and directories only from one subvolume. Returns their number
+ * or -1 on failure. 'next_offset' is the offset to continue reading 'prev'. */
 static int
-dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
-                 int op_errno, gf_dirent_t *orig_entries, dict_t *xdata)
+dht_readdirp_filter(xlator_t *this, dht_local_t *local, xlator_t *prev,
+                    gf_dirent_t *orig_entries, gf_dirent_t *entries,
+                    off_t *next_offset)
 {
-    dht_local_t *local = NULL;
-    gf_dirent_t entries;
     gf_dirent_t *orig_entry = NULL;
     gf_dirent_t *entry = NULL;
-    xlator_t *prev = NULL;
-    xlator_t *next_subvol = NULL;
-    off_t next_offset = 0;
     int count = 0;
     dht_layout_t *layout = NULL;
     dht_conf_t *conf = NULL;
@@ -6739,23 +6847,10 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
     inode_t *inode = NULL;
     gf_boolean_t skip_hashed_check = _gf_false;
 
-    INIT_LIST_HEAD(&entries.list);
-
-    prev = cookie;
-    local = frame->local;
-    GF_VALIDATE_OR_GOTO(this->name, local->fd, unwind);
-
     itable = local->fd->inode->table;
-
     conf = this->private;
-    GF_VALIDATE_OR_GOTO(this->name, conf, unwind);
-
     methods = &(conf->methods);
 
-    if (op_ret <= 0) {
-        goto done;
-    }
-
     /* Why aren't we skipping DHT entirely in case of a single subvol?
      * Because if this was a larger volume earlier and all but one subvol
      * was removed, there might be stale linkto files on the subvol.
@@ -6777,7 +6872,7 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
      * "directory not empty" errors*/
 
     if (layout == NULL)
-        goto done;
+        return 0;
 
     if (conf->readdir_optimize == _gf_true)
         readdir_optimize = 1;
@@ -6786,7 +6881,7 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
 
     list_for_each_entry(orig_entry, (&orig_entries->list), list)
     {
-        next_offset = orig_entry->d_off;
+        *next_offset = orig_entry->d_off;
 
         gf_msg_debug(this->name, 0, "%s: entry = %s, type = %d", prev->name,
                      orig_entry->d_name, orig_entry->d_type);
@@ -6841,7 +6936,7 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
     list:
         entry = gf_dirent_for_name(orig_entry->d_name);
         if (!entry) {
-            goto unwind;
+            return -1;
         }
 
         /* Do this if conf->search_unhashed is set to "auto" */
@@ -6922,10 +7017,48 @@ dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
         gf_msg_debug(this->name, 0, "%s: Adding entry = %s", prev->name,
                      entry->d_name);
 
-        list_add_tail(&entry->list, &entries.list);
+        list_add_tail(&entry->list, &entries->list);
         count++;
     }
 
+    return count;
+}
+
+/* Posix returns op_errno = ENOENT to indicate that there are no more
+ * entries
+ */
+static int
+dht_readdirp_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
+                 int op_errno, gf_dirent_t *orig_entries, dict_t *xdata)
+{
+    dht_local_t *local = NULL;
+    gf_dirent_t entries;
+    xlator_t *prev = NULL;
+    xlator_t *next_subvol = NULL;
+    off_t next_offset = 0;
+    int count = 0;
+    dht_conf_t *conf = NULL;
+    int ret = 0;
+
+    INIT_LIST_HEAD(&entries.list);
+
+    prev = cookie;
+    local = frame->local;
+    GF_VALIDATE_OR_GOTO(this->name, local->fd, unwind);
+
+    conf = this->private;
+    GF_VALIDATE_OR_GOTO(this->name, conf, unwind);
+
+    if (op_ret <= 0) {
+        goto done;
+    }
+
+    count = dht_readdirp_filter(this, local, prev, orig_entries, &entries,
+                                &next_offset);
+    if (count < 0) {
+        goto unwind;
+    }
+
 done:
 
     /* We need to ensure that only the last subvolume's end-of-directory
@@ -7166,6 +7299,454 @@ unwind:
     return 0;
 }
 
+/* With readdirp-merge, all the subvolumes of a directory are read at the same
+ * time. Their entries are buffered in the fd context, one reply of each
+ * subvolume at most, and the subvolumes take turns to return one entry each,
+ * so all of them are being read while the directory is listed. Whenever the
+ * buffer of a subvolume has been returned, it is read again along with any
+ * other whose buffer is empty. The offset of an entry tells the reply that
+ * returned it and its index there. The positions of the subvolumes before
+ * each reply are kept, so reading can go on from any recent offset. */
+
+static void
+dht_readdirp_merge_wind(call_frame_t *frame, xlator_t *this);
+
+/* Ends the request being served and returns the first one queued behind it,
+ * to be resumed once the caller is done with its own. */
+static call_stub_t *
+dht_readdirp_merge_done(dht_readdirp_merge_t *merge)
+{
+    call_stub_t *stub = NULL;
+
+    LOCK(&merge->lock);
+    {
+        merge->busy = _gf_false;
+        if (!list_empty(&merge->waiting)) {
+            stub = list_first_entry(&merge->waiting, call_stub_t, list);
+            list_del_init(&stub->list);
+        }
+    }
+    UNLOCK(&merge->lock);
+
+    return stub;
+}
+
+static void
+dht_readdirp_merge_unwind(call_frame_t *frame, int op_ret, int op_errno,
+                          gf_dirent_t *entries)
+{
+    dht_local_t *local = frame->local;
+    call_stub_t *stub = NULL;
+
+    stub = dht_readdirp_merge_done(local->merge);
+
+    /* Check dht_readdirp_cbk() comments for an explanation of this. */
+    if (uatomic_sub_return(&local->queue, 1) >= 0) {
+        frame->local = NULL;
+    }
+
+    DHT_STACK_UNWIND(readdirp, frame, op_ret, op_errno, entries, NULL);
+
+    /* The stub holds a reference on the fd, so merge is still there */
+    if (stub) {
+        call_resume(stub);
+    }
+}
+
+/* Records the positions of the subvolumes before the first entry of a reply
+ * and starts a new sequence number for it. */
+static int
+__dht_readdirp_merge_snap(dht_readdirp_merge_t *merge)
+{
+    dht_merge_snap_t *snap = NULL;
+    dht_merge_subvol_t *sv = NULL;
+    int slot = 0;
+    int i = 0;
+
+    if (!merge->snaps) {
+        merge->snaps = GF_CALLOC(DHT_MERGE_SNAPS, sizeof(*merge->snaps),
+                                 gf_dht_mt_merge_snap_t);
+        if (!merge->snaps)
+            return -1;
+    }
+
+    snap = GF_MALLOC(sizeof(*snap) + merge->count * sizeof(snap->subvols[0]),
+                     gf_dht_mt_merge_snap_t);
+    if (!snap)
+        return -1;
+
+    snap->turn = merge->turn;
+    snap->entries = 0;
+    for (i = 0; i < merge->count; i++) {
+        sv = &merge->subvols[i];
+        snap->subvols[i].pos = sv->pos;
+        snap->subvols[i].done = sv->eof && list_empty(&sv->entries.list);
+    }
+
+    merge->seq++;
+    slot = merge->seq % DHT_MERGE_SNAPS;
+    GF_FREE(merge->snaps[slot]);
+    merge->snaps[slot] = snap;
+
+    return 0;
+}
+
+/* Goes back to the positions before the reply that returned the entry at
+ * 'yoff', to return the entries after it. Fails if the offset isn't one of
+ * a recent reply. */
+static int
+dht_readdirp_merge_seek(dht_readdirp_merge_t *merge, off_t yoff)
+{
+    dht_merge_snap_t *snap = NULL;
+    dht_merge_subvol_t *sv = NULL;
+    uint64_t seq = (uint64_t)yoff >> DHT_MERGE_INDEX_BITS;
+    int index = yoff & DHT_MERGE_INDEX_MASK;
+    int i = 0;
+
+    if (!merge->snaps || (seq == 0) || (seq > merge->seq) ||
+        (merge->seq - seq >= DHT_MERGE_SNAPS)) {
+        return -1;
+    }
+
+    snap = merge->snaps[seq % DHT_MERGE_SNAPS];
+    if (!snap || (index == 0) || (index > snap->entries)) {
+        return -1;
+    }
+
+    dht_readdirp_merge_reset(merge);
+    for (i = 0; i < merge->count; i++) {
+        sv = &merge->subvols[i];
+        sv->pos = snap->subvols[i].pos;
+        sv->offset = sv->pos;
+        sv->eof = snap->subvols[i].done;
+    }
+    merge->turn = snap->turn;
+    merge->skip = index;
+    merge->offset = yoff;
+
+    return 0;
+}
+
+/* Returns the buffered entries, up to the size requested, or reads more from
+ * the subvolumes once the one whose turn it is has no more buffered. */
+static void
+dht_readdirp_merge_next(call_frame_t *frame, xlator_t *this)
+{
+    dht_local_t *local = frame->local;
+    dht_readdirp_merge_t *merge = local->merge;
+    dht_merge_subvol_t *sv = NULL;
+    gf_dirent_t entries;
+    gf_dirent_t *entry = NULL;
+    size_t filled = 0;
+    int count = 0;
+    int op_errno = 0;
+    int i = 0;
+    gf_boolean_t eof = _gf_false;
+
+    INIT_LIST_HEAD(&entries.list);
+
+    if (local->op_errno) {
+        dht_readdirp_merge_unwind(frame, -1, local->op_errno, NULL);
+        return;
+    }
+
+    LOCK(&merge->lock);
+    {
+        while (count < DHT_MERGE_INDEX_MASK) {
+            /* Subvolumes with nothing left lose their turn */
+            for (i = 0; i < merge->count; i++) {
+                sv = &merge->subvols[merge->turn];
+                if (!sv->eof || !list_empty(&sv->entries.list)) {
+                    break;
+                }
+                merge->turn = (merge->turn + 1) % merge->count;
+            }
+            if (i == merge->count) {
+                eof = _gf_true;
+                break;
+            }
+
+            if (list_empty(&sv->entries.list)) {
+                break;
+            }
+
+            entry = list_first_entry(&sv->entries.list, gf_dirent_t, list);
+            if (merge->skip == 0) {
+                if ((count > 0) &&
+                    (filled + gf_dirent_size(entry->d_name) > local->size)) {
+                    break;
+                }
+                if ((count == 0) && __dht_readdirp_merge_snap(merge)) {
+                    op_errno = ENOMEM;
+                    break;
+                }
+            }
+
+            list_del_init(&entry->list);
+            sv->pos = entry->d_off;
+            merge->turn = (merge->turn + 1) % merge->count;
+
+            if (merge->skip > 0) {
+                merge->skip--;
+                gf_dirent_entry_free(entry);
+                continue;
+            }
+
+            filled += gf_dirent_size(entry->d_name);
+            count++;
+
+            entry->d_off = DHT_MERGE_COOKIE(merge->seq, count);
+            list_add_tail(&entry->list, &entries.list);
+            merge->offset = entry->d_off;
+        }
+
+        if (count > 0) {
+            merge->snaps[merge->seq % DHT_MERGE_SNAPS]->entries = count;
+        }
+    }
+    UNLOCK(&merge->lock);
+
+    if (op_errno) {
+        dht_readdirp_merge_unwind(frame, -1, op_errno, NULL);
+        return;
+    }
+
+    if ((count > 0) || eof) {
+        dht_readdirp_merge_unwind(frame, count, eof ? ENOENT : 0, &entries);
+        gf_dirent_free(&entries);
+        return;
+    }
+
+    dht_readdirp_merge_wind(frame, this);
+}
+
+static int
+dht_readdirp_merge_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
+                       int op_ret, int op_errno, gf_dirent_t *orig_entries,
+                       dict_t *xdata)
+{
+    dht_local_t *local = frame->local;
+    dht_readdirp_merge_t *merge = local->merge;
+    dht_merge_subvol_t *sv = NULL;
+    xlator_t *prev = cookie;
+    gf_dirent_t entries;
+    off_t next_offset = 0;
+    int count = 0;
+    int this_call_cnt = 0;
+
+    INIT_LIST_HEAD(&entries.list);
+
+    /* Without a layout the entries are skipped, as in dht_readdirp_cbk() */
+    if ((op_ret > 0) && local->layout) {
+        count = dht_readdirp_filter(this, local, prev, orig_entries, &entries,
+                                    &next_offset);
+    }
+
+    if (count < 0) {
+        /* The subvolume will be read again from the same offset */
+        gf_dirent_free(&entries);
+        local->op_errno = ENOMEM;
+    } else {
+        sv = &merge->subvols[dht_subvol_cnt(this, prev)];
+
+        LOCK(&merge->lock);
+        {
+            list_splice_init(&entries.list, &sv->entries.list);
+            if (op_ret > 0) {
+                sv->offset = next_offset;
+            }
+
+            /* Errors end the subvolume, as in dht_readdirp_cbk() */
+            if ((op_ret <= 0) || (op_errno == ENOENT) || (next_offset == 0)) {
+                sv->eof = _gf_true;
+            }
+        }
+        UNLOCK(&merge->lock);
+
+        gf_msg_debug(this->name, op_errno, "%s: %d entries buffered%s",
+                     prev->name, count, sv->eof ? ", end of directory" : "");
+    }
+
+    this_call_cnt = dht_frame_return(frame);
+    if (is_last_call(this_call_cnt)) {
+        dht_readdirp_merge_next(frame, this);
+    }
+
+    return 0;
+}
+
+/* Reads all the subvolumes whose buffered entries have been returned. */
+static void
+dht_readdirp_merge_round(call_frame_t *frame, xlator_t *this)
+{
+    dht_local_t *local = frame->local;
+    dht_conf_t *conf = this->private;
+    dht_readdirp_merge_t *merge = local->merge;
+    dht_merge_subvol_t *sv = NULL;
+    xlator_t *subvol = NULL;
+    int *wind = NULL;
+    int call_cnt = 0;
+    int i = 0;
+
+    wind = GF_MALLOC(merge->count * sizeof(*wind), gf_dht_mt_int32_t);
+    if (!wind) {
+        local->op_errno = ENOMEM;
+        dht_readdirp_merge_next(frame, this);
+        return;
+    }
+
+    LOCK(&merge->lock);
+    {
+        for (i = 0; i < merge->count; i++) {
+            sv = &merge->subvols[i];
+            if (sv->eof || !list_empty(&sv->entries.list)) {
+                continue;
+            }
+
+            if (!conf->subvolume_status[i]) {
+                sv->eof = _gf_true;
+                continue;
+            }
+
+            wind[call_cnt++] = i;
+        }
+    }
+    UNLOCK(&merge->lock);
+
+    if (call_cnt == 0) {
+        GF_FREE(wind);
+        dht_readdirp_merge_next(frame, this);
+        return;
+    }
+
+    local->call_cnt = call_cnt;
+    local->op_errno = 0;
+
+    /* Only the callback of a subvolume changes its offset, and neither the
+     * frame nor merge must be touched after the last wind. */
+    for (i = 0; i < call_cnt; i++) {
+        subvol = conf->subvolumes[wind[i]];
+
+        STACK_WIND_COOKIE(frame, dht_readdirp_merge_cbk, subvol, subvol,
+                          subvol->fops->readdirp, local->fd, local->size,
+                          merge->subvols[wind[i]].offset, local->xattr);
+    }
+
+    GF_FREE(wind);
+}
+
+/* Check dht_queue_readdir() comments for an explanation of this. */
+static void
+dht_readdirp_merge_wind(call_frame_t *frame, xlator_t *this)
+{
+    dht_local_t *local = frame->local;
+    int32_t queue;
+
+    if (uatomic_add_return(&local->queue, 1) == 1) {
+        do {
+            dht_readdirp_merge_round(frame, this);
+        } while ((queue = uatomic_sub_return(&local->queue, 1)) > 0);
+
+        if (queue < 0) {
+            dht_local_wipe(local);
+        }
+    }
+}
+
+static int
+dht_readdirp_merge(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+                   off_t yoff, dict_t *dict)
+{
+    dht_local_t *local = NULL;
+    dht_conf_t *conf = this->private;
+    dht_readdirp_merge_t *merge = NULL;
+    call_stub_t *stub = NULL;
+    gf_boolean_t busy = _gf_false;
+    int op_errno = ENOMEM;
+    int ret = 0;
+
+    merge = dht_fd_ctx_merge_get(this, fd);
+    if (!merge) {
+        DHT_STACK_UNWIND(readdirp, frame, -1, op_errno, NULL, NULL);
+        return 0;
+    }
+
+    /* Requests on the same fd, from several threads or from readdir-ahead,
+     * are served one at a time, as they share the buffered entries. */
+    LOCK(&merge->lock);
+    {
+        busy = merge->busy;
+        if (busy) {
+            stub = fop_readdirp_stub(frame, dht_readdirp_merge, fd, size,
+                                     yoff, dict);
+            if (stub) {
+                list_add_tail(&stub->list, &merge->waiting);
+            }
+        } else {
+            merge->busy = _gf_true;
+        }
+    }
+    UNLOCK(&merge->lock);
+
+    if (busy) {
+        if (!stub) {
+            DHT_STACK_UNWIND(readdirp, frame, -1, op_errno, NULL, NULL);
+        }
+        return 0;
+    }
+
+    local = dht_local_init(frame, NULL, NULL, GF_FOP_READDIRP);
+    if (!local) {
+        goto err;
+    }
+
+    local->fd = fd_ref(fd);
+    local->size = size;
+    local->first_up_subvol = dht_first_up_subvol(this);
+    local->layout = dht_layout_get(this, fd->inode);
+    local->merge = merge;
+
+    /* Directories are filtered here, GF_READDIR_SKIP_DIRS is not sent as
+     * the request is shared by all the subvolumes. */
+    local->xattr = (dict) ? dict_ref(dict) : dict_new();
+    if (!local->xattr) {
+        goto err;
+    }
+
+    ret = dict_set_uint32(local->xattr, conf->link_xattr_name, 256);
+    if (ret)
+        gf_msg(this->name, GF_LOG_WARNING, 0, DHT_MSG_DICT_SET_FAILED,
+               "Failed to set dictionary value : key = %s",
+               conf->link_xattr_name);
+
+    /* The buffered entries follow the last one returned. Any other offset
+     * goes back to the positions recorded for its reply. */
+    if ((uint64_t)yoff != merge->offset) {
+        if (yoff == 0) {
+            dht_readdirp_merge_reset(merge);
+        } else if (dht_readdirp_merge_seek(merge, yoff)) {
+            gf_msg_debug(this->name, 0, "unknown offset %" PRId64, yoff);
+            op_errno = EINVAL;
+            goto err;
+        }
+    }
+
+    dht_readdirp_merge_next(frame, this);
+
+    return 0;
+
+err:
+    stub = dht_readdirp_merge_done(merge);
+
+    DHT_STACK_UNWIND(readdirp, frame, -1, op_errno, NULL, NULL);
+
+    if (stub) {
+        call_resume(stub);
+    }
+
+    return 0;
+}
+
 static int
 dht_do_readdir(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
                off_t yoff, int whichop, dict_t *dict)
@@ -7284,6 +7865,15 @@ int
 dht_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
              off_t yoff, dict_t *dict)
 {
+    dht_conf_t *conf = this->private;
+
+    /* Anonymous fds don't keep the state of the merged stream */
+    if (conf && conf->readdirp_merge && (conf->subvolume_cnt > 1) &&
+        !fd->anonymous) {
+        dht_readdirp_merge(frame, this, fd, size, yoff, dict);
+        return 0;
+    }
+
     dht_do_readdir(frame, this, fd, size, yoff, GF_FOP_READDIRP, dict);
     return 0;
 }
@@ -11132,9 +11722,13 @@ dht_notify(xlator_t *this, int event, void *data, ...)
              * when a layout xattr is changed by the rebalance process
              * notify all the md-cache clients to invalidate the existing
              * stat cache and send the lookup next time*/
-            if (up_ci->dict && dict_get(up_ci->dict, conf->xattr_name))
+            if (up_ci->dict && dict_get(up_ci->dict, conf->xattr_name)) {
                 up_ci->flags |= UP_EXPLICIT_LOOKUP;
 
+                /* The cached directory layouts may be stale now */
+                GF_ATOMIC_INC(conf->layout_cache_gen);
+            }
+
             /* TODO: Instead of invalidating iatt, update the new
              * hashed/cached subvolume in dht inode_ctx */
             if (IS_DHT_LINKFILE_MODE(&up_ci->stat))
@@ -11379,6 +11973,12 @@ dht_release(xlator_t *this, fd_t *fd)
     return dht_fd_ctx_destroy(this, fd);
 }
 
+int32_t
+dht_releasedir(xlator_t *this, fd_t *fd)
+{
+    return dht_fd_ctx_destroy(this, fd);
+}
+
 static int
 dht_pt_mkdir_cbk(call_frame_t *frame, void *cookie, xlator_t *this, int op_ret,
                  int op_errno, inode_t *inode, struct iatt *stbuf,
@@ -25,6 +25,7 @@
 
 #define GF_XATTR_FIX_LAYOUT_KEY "distribute.fix.layout"
 #define GF_XATTR_FILE_MIGRATE_KEY "trusted.distribute.migrate-data"
+#define GF_XATTR_REBAL_CHECKPOINT_PREFIX "trusted.distribute.rebal-checkpoint."
 #define DHT_MDS_STR "mds"
 #define GF_DHT_LOOKUP_UNHASHED_OFF 0
 #define GF_DHT_LOOKUP_UNHASHED_ON 1
@@ -85,6 +86,12 @@ struct dht_layout {
      * bricks are made or lost.
      */
     int gen;
+    /*
+     * When the layout of the directory was last checked on all the
+     * subvolumes, and the layout cache generation at that time.
+     */
+    time_t cache_time;
+    uint32_t cache_gen;
     int type;
     gf_atomic_t ref; /* use with dht_conf_t->layout_lock */
     uint32_t search_unhashed;
@@ -337,6 +344,7 @@ struct dht_local {
     xlator_t *queue_xl;
     off_t queue_offset;
     int32_t queue;
+    struct dht_readdirp_merge *merge;
 
     /* inodelks during filerename for backward compatibility */
     dht_lock_t **rename_inodelk_backward_compatible;
@@ -353,6 +361,8 @@ struct dht_local {
     /* This is use only for directory operation */
     int32_t valid;
     int32_t mds_heal_fresh_lookup;
+    /* layout cache generation when the revalidation started */
+    uint32_t layout_cache_gen;
     short lock_type;
     char need_selfheal;
     char need_xattr_heal;
@@ -361,6 +371,8 @@ struct dht_local {
        {lookup,revalidate}_cbk */
     char return_estale;
     char need_lookup_everywhere;
+    /* revalidate the layout on all the subvolumes */
+    char layout_cache_miss;
     /* fd open check */
     gf_boolean_t fd_checked;
     gf_boolean_t linked;
@@ -430,6 +442,19 @@ struct gf_defrag_pattern_list {
     gf_defrag_pattern_list_t *next;
 };
 
+/* A directory of the rebalance crawl. It is complete, and its subtree can
+ * be checkpointed, once the directory itself, its subdirectories and the
+ * files it queued for migration are done. The checkpoints of the completed
+ * subdirectories wait in done until the directory's own replaces them. */
+typedef struct gf_defrag_crawl_dir {
+    struct list_head list;
+    struct list_head done;
+    struct gf_defrag_crawl_dir *parent;
+    loc_t loc;
+    gf_atomic_t pending;
+    gf_boolean_t failed;
+} gf_defrag_crawl_dir_t;
+
 struct dht_container {
     union {
         struct list_head list;
@@ -443,6 +468,8 @@ struct dht_container {
     loc_t *parent_loc;
     dict_t *migrate_data;
     int local_subvol_index;
+    gf_defrag_crawl_dir_t *dir;
+    gf_boolean_t failed;
 };
 
 typedef struct nodeuuid_info {
@@ -504,6 +531,17 @@ struct gf_defrag_info_ {
     gf_boolean_t stats;
     /* lock migration flag */
     gf_boolean_t lock_migration_enabled;
+
+    /* Directory crawl */
+    struct list_head crawl_queue;
+    pthread_mutex_t crawl_mutex;
+    pthread_cond_t crawl_cond;
+    int32_t crawl_thread_count;
+    int32_t crawl_busy;
+    gf_boolean_t crawl_checkpoint;
+    /* xattr marking the subtrees crawled by this rebalance, NULL when
+     * checkpoints are disabled */
+    char *checkpoint_key;
 };
 
 typedef struct gf_defrag_info_ gf_defrag_info_t;
@@ -596,8 +634,17 @@ struct dht_conf {
 
     gf_boolean_t force_migration;
 
+    /* Blocks of a file migrated concurrently, and their maximum size */
+    uint32_t rebal_io_window;
+    uint64_t rebal_max_block_size;
+
     gf_boolean_t lookup_optimize;
 
+    /* Directory layouts checked on all the subvolumes are trusted for
+     * layout_cache_timeout seconds, until layout_cache_gen changes */
+    uint32_t layout_cache_timeout;
+    gf_atomic_t layout_cache_gen;
+
     gf_boolean_t unhashed_sticky_bit;
 
     gf_boolean_t assert_no_child_down;
@@ -607,6 +654,9 @@ struct dht_conf {
     /* Request to filter directory entries in readdir request */
     gf_boolean_t readdir_optimize;
 
+    /* Read directories from all the subvolumes at once */
+    gf_boolean_t readdirp_merge;
+
     gf_boolean_t rsync_regex_valid;
 
     gf_boolean_t extra_regex_valid;
@@ -665,8 +715,52 @@ typedef struct dht_migrate_info {
     GF_REF_DECL;
 } dht_migrate_info_t;
 
+/* Entries of one subvolume read by a merged readdirp and not yet returned */
+typedef struct dht_merge_subvol {
+    gf_dirent_t entries;
+    off_t offset; /* to read the next entries from */
+    off_t pos;    /* of the last entry returned */
+    gf_boolean_t eof;
+} dht_merge_subvol_t;
+
+/* Positions of the subvolumes before the first entry of a merged readdirp
+ * reply, from which the offset of any of its entries is resumed */
+typedef struct dht_merge_snap {
+    int turn;
+    int entries;
+    struct {
+        off_t pos;
+        gf_boolean_t done;
+    } subvols[];
+} dht_merge_snap_t;
+
+/* The offset of an entry returned by a merged readdirp is the sequence
+ * number of its reply and its index in it. Only the positions of the last
+ * DHT_MERGE_SNAPS replies are kept. */
+#define DHT_MERGE_SNAPS 1024
+#define DHT_MERGE_INDEX_BITS 16
+#define DHT_MERGE_INDEX_MASK ((1 << DHT_MERGE_INDEX_BITS) - 1)
+#define DHT_MERGE_COOKIE(seq, index)                                           \
+    ((off_t)(((uint64_t)(seq) << DHT_MERGE_INDEX_BITS) | (index)))
+
+/* State of a directory listed with readdirp-merge. Only one readdirp at a
+ * time uses it, the others wait in 'waiting'. */
+typedef struct dht_readdirp_merge {
+    gf_lock_t lock;
+    struct list_head waiting;
+    uint64_t offset; /* of the last entry returned */
+    uint64_t seq;    /* of the last reply */
+    dht_merge_snap_t **snaps;
+    int count;
+    int turn; /* subvolume returning the next entry */
+    int skip; /* entries to drop to resume from an offset */
+    gf_boolean_t busy;
+    dht_merge_subvol_t subvols[];
+} dht_readdirp_merge_t;
+
 typedef struct dht_fd_ctx {
     uint64_t opened_on_dst;
+    dht_readdirp_merge_t *merge;
     GF_REF_DECL;
 } dht_fd_ctx_t;
 
@@ -1231,9 +1325,18 @@ dht_fd_open_on_dst(xlator_t *this, fd_t *fd, xlator_t *dst);
 int32_t
 dht_fd_ctx_destroy(xlator_t *this, fd_t *fd);
 
+dht_readdirp_merge_t *
+dht_fd_ctx_merge_get(xlator_t *this, fd_t *fd);
+
+void
+dht_readdirp_merge_reset(dht_readdirp_merge_t *merge);
+
 int32_t
 dht_release(xlator_t *this, fd_t *fd);
 
+int32_t
+dht_releasedir(xlator_t *this, fd_t *fd);
+
 int32_t
 dht_set_fixed_dir_stat(struct iatt *stat);
 
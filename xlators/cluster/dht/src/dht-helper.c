@@ -12,9 +12,40 @@
 #include "dht-lock.h"
 #include "glusterfs/compat-errno.h"  // for ENODATA on BSD
 
+void
+dht_readdirp_merge_reset(dht_readdirp_merge_t *merge)
+{
+    int i = 0;
+
+    for (i = 0; i < merge->count; i++) {
+        gf_dirent_free(&merge->subvols[i].entries);
+        merge->subvols[i].offset = 0;
+        merge->subvols[i].pos = 0;
+        merge->subvols[i].eof = _gf_false;
+    }
+
+    merge->offset = 0;
+    merge->turn = 0;
+    merge->skip = 0;
+}
+
 static void
 dht_free_fd_ctx(dht_fd_ctx_t *fd_ctx)
 {
+    int i = 0;
+
+    if (fd_ctx->merge) {
+        dht_readdirp_merge_reset(fd_ctx->merge);
+        if (fd_ctx->merge->snaps) {
+            for (i = 0; i < DHT_MERGE_SNAPS; i++) {
+                GF_FREE(fd_ctx->merge->snaps[i]);
+            }
+            GF_FREE(fd_ctx->merge->snaps);
+        }
+        LOCK_DESTROY(&fd_ctx->merge->lock);
+        GF_FREE(fd_ctx->merge);
+    }
+
     GF_FREE(fd_ctx);
 }
 
@@ -137,6 +168,53 @@ out:
     return fd_ctx;
 }
 
+/* The state lives as long as the fd context, i.e. until the directory is
+ * released, so it can be used while holding a reference on the fd. */
+dht_readdirp_merge_t *
+dht_fd_ctx_merge_get(xlator_t *this, fd_t *fd)
+{
+    dht_conf_t *conf = this->private;
+    dht_fd_ctx_t *fd_ctx = NULL;
+    dht_readdirp_merge_t *merge = NULL;
+    uint64_t value = 0;
+    int i = 0;
+
+    LOCK(&fd->lock);
+    {
+        if ((__fd_ctx_get(fd, this, &value) < 0) || (value == 0)) {
+            if (__dht_fd_ctx_set(this, fd, NULL) < 0) {
+                goto unlock;
+            }
+            __fd_ctx_get(fd, this, &value);
+        }
+
+        fd_ctx = (dht_fd_ctx_t *)(uintptr_t)value;
+        if (!fd_ctx->merge) {
+            merge = GF_CALLOC(1,
+                              sizeof(*merge) + conf->subvolume_cnt *
+                                                   sizeof(merge->subvols[0]),
+                              gf_dht_mt_fd_ctx_t);
+            if (!merge) {
+                goto unlock;
+            }
+
+            LOCK_INIT(&merge->lock);
+            INIT_LIST_HEAD(&merge->waiting);
+            merge->count = conf->subvolume_cnt;
+            for (i = 0; i < merge->count; i++) {
+                INIT_LIST_HEAD(&merge->subvols[i].entries.list);
+            }
+
+            fd_ctx->merge = merge;
+        }
+        merge = fd_ctx->merge;
+    }
+unlock:
+    UNLOCK(&fd->lock);
+
+    return merge;
+}
+
 gf_boolean_t
 dht_fd_open_on_dst(xlator_t *this, fd_t *fd, xlator_t *dst)
 {
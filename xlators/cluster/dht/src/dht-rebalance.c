@@ -10,6 +10,7 @@
 
 #include "dht-common.h"
 #include <glusterfs/syscall.h>
+#include <glusterfs/byte-order.h>
 #include <fnmatch.h>
 #include <signal.h>
 #include <glusterfs/events.h>
@@ -39,6 +40,9 @@ static int
 dht_migrate_file(xlator_t *this, loc_t *loc, xlator_t *cached_subvol,
                  xlator_t *hashed_subvol, int flag, int *fop_errno);
 
+static void
+gf_defrag_crawl_dir_put(xlator_t *this, gf_defrag_crawl_dir_t *dir);
+
 uint64_t g_totalfiles = 0;
 uint64_t g_totalsize = 0;
 
@@ -69,6 +73,12 @@ void
 gf_defrag_free_container(struct dht_container *container)
 {
     if (container) {
+        if (container->dir) {
+            if (container->failed)
+                container->dir->failed = _gf_true;
+            gf_defrag_crawl_dir_put(container->this, container->dir);
+        }
+
         gf_dirent_entry_free(container->df_entry);
 
         if (container->parent_loc) {
@@ -558,10 +568,12 @@ out:
 static int
 __dht_rebalance_create_dst_file(xlator_t *this, xlator_t *to, xlator_t *from,
                                 loc_t *loc, struct iatt *stbuf, fd_t **dst_fd,
-                                int *fop_errno, int file_has_holes)
+                                int *fop_errno, int file_has_holes,
+                                gf_boolean_t *dst_zeroed)
 {
     int ret = -1;
     int ret2 = -1;
+    gf_boolean_t dst_empty = _gf_false;
     fd_t *fd = NULL;
     struct iatt new_stbuf = {
         0,
@@ -644,6 +656,7 @@ __dht_rebalance_create_dst_file(xlator_t *this, xlator_t *to, xlator_t *from,
             goto out;
         }
     }
+    dst_empty = (-ret == ENOENT) || (!ret && (new_stbuf.ia_size == 0));
     if ((ret < 0) && (-ret != ENOENT)) {
         /* File exists in destination, but not accessible */
         gf_msg(THIS->name, GF_LOG_WARNING, -ret, DHT_MSG_MIGRATE_FILE_FAILED,
@@ -726,7 +739,9 @@ __dht_rebalance_create_dst_file(xlator_t *this, xlator_t *to, xlator_t *from,
     if (stbuf->ia_size > 0) {
         if (conf->use_fallocate && !file_has_holes) {
             ret = syncop_fallocate(to, fd, 0, 0, stbuf->ia_size, NULL, NULL);
-            if (ret < 0) {
+            if (ret >= 0) {
+                *dst_zeroed = dst_empty;
+            } else {
                 if (ret == -EOPNOTSUPP || ret == -EINVAL || ret == -ENOSYS) {
                     conf->use_fallocate = _gf_false;
                 } else {
@@ -759,6 +774,8 @@ __dht_rebalance_create_dst_file(xlator_t *this, xlator_t *to, xlator_t *from,
                 gf_msg(this->name, GF_LOG_WARNING, -ret,
                        DHT_MSG_MIGRATE_FILE_FAILED,
                        "ftruncate failed for %s on %s", loc->path, to->name);
+            } else if (file_has_holes) {
+                *dst_zeroed = dst_empty;
             }
         }
     }
@@ -1034,80 +1051,130 @@ dht_rebalance_sparse_segment(xlator_t *subvol, fd_t *fd, off_t *offset,
     return 1;
 }
 
-static int
-__dht_rebalance_migrate_data(xlator_t *this, xlator_t *from, xlator_t *to,
-                             fd_t *src, fd_t *dst, uint64_t ia_size,
-                             int hole_exists, int *fop_errno)
+/* State shared by the tasks migrating the data of a file concurrently. */
+typedef struct {
+    synclock_t lock;
+    syncbarrier_t barrier;
+    xlator_t *this;
+    xlator_t *from;
+    xlator_t *to;
+    fd_t *src;
+    fd_t *dst;
+    uint64_t ia_size;
+    off_t offset;           /* start of the next block */
+    size_t data_block_size; /* remaining size of the current data segment */
+    size_t block_size;      /* size of the next block */
+    int hole_exists;
+    gf_boolean_t dst_zeroed;
+    gf_boolean_t done;
+    int ret;
+    int fop_errno;
+} dht_migrate_data_t;
+
+static void
+dht_rebalance_migrate_fail(dht_migrate_data_t *mig, int fop_errno)
+{
+    synclock_lock(&mig->lock);
+    if (mig->ret == 0) {
+        mig->ret = -1;
+        mig->fop_errno = fop_errno;
+    }
+    mig->done = _gf_true;
+    synclock_unlock(&mig->lock);
+}
+
+/* Returns the next block of the file to migrate, 0 when there is none. */
+static size_t
+dht_rebalance_migrate_next(dht_migrate_data_t *mig, off_t *offset)
 {
+    dht_conf_t *conf = mig->this->private;
+    size_t size = 0;
     int ret = 0;
-    int count = 0;
-    off_t offset = 0;
-    struct iovec *vector = NULL;
-    struct iobref *iobref = NULL;
-    uint64_t total = 0;
-    size_t read_size = 0;
-    size_t data_block_size = 0;
-    dict_t *xdata = NULL;
-    dht_conf_t *conf = NULL;
 
-    conf = this->private;
+    synclock_lock(&mig->lock);
+
+    if (mig->done)
+        goto unlock;
 
-    /* if file size is '0', no need to enter this loop */
-    while (total < ia_size) {
+    if (!mig->hole_exists) {
         /* This is a regular file - read it sequentially */
-        if (!hole_exists) {
-            data_block_size = ia_size - total;
-        } else {
-            /* This is a sparse file - read only the data segments in the file
-             */
-
-            /* If the previous data block is fully copied, find the next data
-             * segment starting at the offset of the last read and written
-             * byte. */
-            if (data_block_size <= 0) {
-                ret = dht_rebalance_sparse_segment(from, src, &offset,
-                                                   &data_block_size);
-                if (ret <= 0) {
-                    *fop_errno = -ret;
-                    break;
-                }
+        if (mig->offset >= mig->ia_size) {
+            mig->done = _gf_true;
+            goto unlock;
+        }
+        mig->data_block_size = mig->ia_size - mig->offset;
+    } else if (mig->data_block_size <= 0) {
+        /* This is a sparse file - read only the data segments in the file.
+         * If the previous data block is fully copied, find the next data
+         * segment starting at the end of the last block. */
+        ret = dht_rebalance_sparse_segment(mig->from, mig->src, &mig->offset,
+                                           &mig->data_block_size);
+        if (ret <= 0) {
+            if (ret < 0) {
+                mig->ret = -1;
+                mig->fop_errno = -ret;
             }
+            mig->done = _gf_true;
+            goto unlock;
         }
+    }
 
-        /* Calculate how much data needs to be read and written. If the data
-         * segment's length is bigger than DHT_REBALANCE_BLKSIZE, read and
-         * write DHT_REBALANCE_BLKSIZE data length and the rest in the
-         * next iteration(s) */
-        read_size = ((data_block_size > DHT_REBALANCE_BLKSIZE)
-                         ? DHT_REBALANCE_BLKSIZE
-                         : data_block_size);
+    /* If the data segment's length is bigger than the block size, migrate
+     * a block and the rest in the next one(s). Blocks grow while the file
+     * goes on, up to rebalance-max-block-size. */
+    size = min(mig->data_block_size, mig->block_size);
+    *offset = mig->offset;
+    mig->offset += size;
+    mig->data_block_size -= size;
+    if (mig->block_size < conf->rebal_max_block_size)
+        mig->block_size = min(mig->block_size * 2,
+                              conf->rebal_max_block_size);
 
-        /* Calculate the remaining size of the data block - maybe there's no
-         * need to seek for data in the next iteration */
-        data_block_size -= read_size;
+unlock:
+    synclock_unlock(&mig->lock);
 
-        ret = syncop_readv(from, src, read_size, offset, 0, &vector, &count,
-                           &iobref, NULL, NULL, NULL);
+    return size;
+}
+
+static int
+dht_rebalance_migrate_block(dht_migrate_data_t *mig, off_t offset,
+                            size_t size, dict_t **xdata)
+{
+    dht_conf_t *conf = mig->this->private;
+    struct iovec *vector = NULL;
+    struct iobref *iobref = NULL;
+    int count = 0;
+    int ret = 0;
+
+    while (size > 0) {
+        ret = syncop_readv(mig->from, mig->src, size, offset, 0, &vector,
+                           &count, &iobref, NULL, NULL, NULL);
 
         if (!ret || (ret < 0)) {
             if (!ret) {
                 /* File was probably truncated*/
-                ret = -1;
-                *fop_errno = ENOSPC;
+                dht_rebalance_migrate_fail(mig, ENOSPC);
             } else {
-                *fop_errno = -ret;
+                dht_rebalance_migrate_fail(mig, -ret);
             }
+            ret = -1;
             break;
         }
 
+        /* The destination already reads as zeroes, allocated by fallocate
+         * or as a hole in a sparse file. Blocks of zeroes don't need to be
+         * sent to it. */
+        if (mig->dst_zeroed && (iov_0filled(vector, count) == 0))
+            goto next;
+
         if (!conf->force_migration) {
-            if (!xdata) {
-                xdata = dict_new();
-                if (!xdata) {
+            if (!*xdata) {
+                *xdata = dict_new();
+                if (!*xdata) {
                     gf_msg("dht", GF_LOG_ERROR, 0, DHT_MSG_MIGRATE_FILE_FAILED,
                            "insufficient memory");
+                    dht_rebalance_migrate_fail(mig, ENOMEM);
                     ret = -1;
-                    *fop_errno = ENOMEM;
                     break;
                 }
 
@@ -1121,26 +1188,27 @@ __dht_rebalance_migrate_data(xlator_t *this, xlator_t *from, xlator_t *to,
                  * https://github.com/gluster/glusterfs/issues/308
                  * for more details.
                  */
-                ret = dict_set_int32_sizen(xdata, GF_AVOID_OVERWRITE, 1);
+                ret = dict_set_int32_sizen(*xdata, GF_AVOID_OVERWRITE, 1);
                 if (ret) {
                     gf_msg("dht", GF_LOG_ERROR, 0, ENOMEM,
                            "failed to set dict");
+                    dht_rebalance_migrate_fail(mig, ENOMEM);
                     ret = -1;
-                    *fop_errno = ENOMEM;
                     break;
                 }
             }
         }
 
-        ret = syncop_writev(to, dst, vector, count, offset, iobref, 0, NULL,
-                            NULL, xdata, NULL);
+        ret = syncop_writev(mig->to, mig->dst, vector, count, offset, iobref,
+                            0, NULL, NULL, *xdata, NULL);
         if (ret < 0) {
-            *fop_errno = -ret;
+            dht_rebalance_migrate_fail(mig, -ret);
             break;
         }
 
+    next:
         offset += ret;
-        total += ret;
+        size -= min(size, (size_t)ret);
 
         GF_FREE(vector);
         if (iobref)
@@ -1153,16 +1221,94 @@ __dht_rebalance_migrate_data(xlator_t *this, xlator_t *from, xlator_t *to,
         iobref_unref(iobref);
     GF_FREE(vector);
 
-    if (ret >= 0)
-        ret = 0;
-    else
-        ret = -1;
+    return (ret < 0) ? -1 : 0;
+}
+
+static int
+dht_rebalance_migrate_run(void *data)
+{
+    dht_migrate_data_t *mig = data;
+    dict_t *xdata = NULL;
+    off_t offset = 0;
+    size_t size = 0;
+
+    while ((size = dht_rebalance_migrate_next(mig, &offset)) > 0) {
+        if (dht_rebalance_migrate_block(mig, offset, size, &xdata) < 0)
+            break;
+    }
 
-    if (xdata) {
+    if (xdata)
         dict_unref(xdata);
+
+    return 0;
+}
+
+static int
+dht_rebalance_migrate_run_done(int ret, call_frame_t *frame, void *data)
+{
+    dht_migrate_data_t *mig = data;
+
+    syncbarrier_wake(&mig->barrier);
+
+    return 0;
+}
+
+static int
+__dht_rebalance_migrate_data(xlator_t *this, xlator_t *from, xlator_t *to,
+                             fd_t *src, fd_t *dst, uint64_t ia_size,
+                             int hole_exists, gf_boolean_t dst_zeroed,
+                             int *fop_errno)
+{
+    dht_migrate_data_t mig = {
+        0,
+    };
+    dht_conf_t *conf = NULL;
+    uint64_t blocks = 0;
+    uint32_t tasks = 0;
+    uint32_t started = 0;
+
+    conf = this->private;
+
+    /* if file size is '0', no need to migrate anything */
+    if (ia_size == 0)
+        return 0;
+
+    mig.this = this;
+    mig.from = from;
+    mig.to = to;
+    mig.src = src;
+    mig.dst = dst;
+    mig.ia_size = ia_size;
+    mig.block_size = DHT_REBALANCE_BLKSIZE;
+    mig.hole_exists = hole_exists;
+    mig.dst_zeroed = dst_zeroed;
+    synclock_init(&mig.lock, SYNC_LOCK_DEFAULT);
+    syncbarrier_init(&mig.barrier);
+
+    /* Each task migrates one block at a time, so that up to
+     * rebalance-io-window reads and writes of the file are in flight. */
+    tasks = conf->rebal_io_window;
+    blocks = (ia_size + DHT_REBALANCE_BLKSIZE - 1) / DHT_REBALANCE_BLKSIZE;
+    if (tasks > blocks)
+        tasks = blocks;
+    while (started + 1 < tasks) {
+        if (synctask_new(this->ctx->env, dht_rebalance_migrate_run,
+                         dht_rebalance_migrate_run_done, NULL, &mig) != 0)
+            break;
+        started++;
     }
 
-    return ret;
+    dht_rebalance_migrate_run(&mig);
+    if (started > 0)
+        syncbarrier_wait(&mig.barrier, started);
+
+    synclock_destroy(&mig.lock);
+    syncbarrier_destroy(&mig.barrier);
+
+    if (mig.ret < 0)
+        *fop_errno = mig.fop_errno;
+
+    return mig.ret;
 }
 
 static int
@@ -1499,6 +1645,7 @@ dht_migrate_file(xlator_t *this, loc_t *loc, xlator_t *cached_subvol,
     dict_t *xattr = NULL;
     dict_t *xattr_rsp = NULL;
     int file_has_holes = 0;
+    gf_boolean_t dst_zeroed = _gf_false;
     dht_conf_t *conf = this->private;
     int rcvd_enoent_from_src = 0;
     struct gf_flock flock = {
@@ -1673,7 +1820,7 @@ dht_migrate_file(xlator_t *this, loc_t *loc, xlator_t *cached_subvol,
     /* create the destination, with required modes/xattr */
     ret = __dht_rebalance_create_dst_file(this, hashed_subvol, cached_subvol,
                                           loc, &stbuf, &dst_fd, fop_errno,
-                                          file_has_holes);
+                                          file_has_holes, &dst_zeroed);
     if (ret) {
         gf_msg(this->name, GF_LOG_ERROR, 0, 0,
                "Create dst failed"
@@ -1719,9 +1866,10 @@ dht_migrate_file(xlator_t *this, loc_t *loc, xlator_t *cached_subvol,
          * destination. We need to do update this only post migration
          * as in case of failure the linkto needs to point to the source
          * subvol */
+        dst_zeroed = _gf_false;
         ret = __dht_rebalance_create_dst_file(
             this, hashed_subvol, cached_subvol, loc, &stbuf, &dst_fd, fop_errno,
-            file_has_holes);
+            file_has_holes, &dst_zeroed);
         if (ret) {
             gf_log(this->name, GF_LOG_ERROR,
                    "Create dst failed"
@@ -1811,7 +1959,7 @@ dht_migrate_file(xlator_t *this, loc_t *loc, xlator_t *cached_subvol,
 
     ret = __dht_rebalance_migrate_data(this, cached_subvol, hashed_subvol,
                                        src_fd, dst_fd, stbuf.ia_size,
-                                       file_has_holes, fop_errno);
+                                       file_has_holes, dst_zeroed, fop_errno);
     if (ret) {
         gf_msg(this->name, GF_LOG_ERROR, 0, DHT_MSG_MIGRATE_FILE_FAILED,
                "Migrate file failed: %s: failed to migrate data", loc->path);
@@ -2713,6 +2861,7 @@ gf_defrag_migrate_single_file(void *opaque)
         }
         UNLOCK(&defrag->lock);
 
+        rebal_entry->failed = _gf_true;
         ret = 0;
 
         gf_log(this->name, GF_LOG_ERROR, "Child loc build failed");
@@ -2825,6 +2974,8 @@ gf_defrag_migrate_single_file(void *opaque)
                          " %s due to space constraints",
                          entry_loc.path);
 
+            rebal_entry->failed = _gf_true;
+
             /* For remove-brick case if the source is not one of the
              * removed-brick, do not mark the error as failure */
             if (conf->decommission_subvols_cnt) {
@@ -2858,6 +3009,7 @@ gf_defrag_migrate_single_file(void *opaque)
                          "migrate-data skipped for"
                          " hardlink %s ",
                          entry_loc.path);
+            rebal_entry->failed = _gf_true;
             LOCK(&defrag->lock);
             {
                 defrag->skipped += 1;
@@ -2876,6 +3028,8 @@ gf_defrag_migrate_single_file(void *opaque)
                    DHT_MSG_MIGRATE_FILE_FAILED, "migrate-data failed for %s",
                    entry_loc.path);
 
+            rebal_entry->failed = _gf_true;
+
             LOCK(&defrag->lock);
             {
                 defrag->total_failures += 1;
@@ -3164,16 +3318,28 @@ int static gf_defrag_get_entry(xlator_t *this, int i,
             continue;
 
         if (IA_ISDIR(df_entry->d_stat.ia_type)) {
-            defrag->size_processed += df_entry->d_stat.ia_size;
+            LOCK(&defrag->lock);
+            {
+                defrag->size_processed += df_entry->d_stat.ia_size;
+            }
+            UNLOCK(&defrag->lock);
             continue;
         }
 
-        defrag->num_files_lookedup++;
+        LOCK(&defrag->lock);
+        {
+            defrag->num_files_lookedup++;
+        }
+        UNLOCK(&defrag->lock);
 
         if (defrag->defrag_pattern &&
             (gf_defrag_pattern_match(defrag, df_entry->d_name,
                                      df_entry->d_stat.ia_size) == _gf_false)) {
-            defrag->size_processed += df_entry->d_stat.ia_size;
+            LOCK(&defrag->lock);
+            {
+                defrag->size_processed += df_entry->d_stat.ia_size;
+            }
+            UNLOCK(&defrag->lock);
             continue;
         }
 
@@ -3268,7 +3434,8 @@ out:
 
 int
 gf_defrag_process_dir(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
-                      dict_t *migrate_data, int *perrno)
+                      gf_defrag_crawl_dir_t *dir, dict_t *migrate_data,
+                      int *perrno)
 {
     int ret = -1;
     dht_conf_t *conf = NULL;
@@ -3493,6 +3660,10 @@ gf_defrag_process_dir(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                 continue;
             }
 
+            /* The directory is complete once its files are migrated */
+            container->dir = dir;
+            GF_ATOMIC_INC(dir->pending);
+
             /* Q this entry in the dfq */
             pthread_mutex_lock(&defrag->dfq_mutex);
             {
@@ -3530,9 +3701,12 @@ out:
 
     /* It does not matter if it errored out - this number is
      * used to calculate rebalance estimated time to complete.
-     * No locking required as dirs are processed by a single thread.
      */
-    defrag->num_dirs_processed++;
+    LOCK(&defrag->lock);
+    {
+        defrag->num_dirs_processed++;
+    }
+    UNLOCK(&defrag->lock);
     return ret;
 }
 
@@ -3542,6 +3716,7 @@ gf_defrag_settle_hash(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
 {
     int ret;
     dht_conf_t *conf = NULL;
+    dict_t *settle = NULL;
     /*
      * Now we're ready to update the directory commit hash for the volume
      * root, so that hash miscompares and broadcast lookups can stop.
@@ -3569,14 +3744,23 @@ gf_defrag_settle_hash(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
         return 0;
     }
 
-    ret = dict_set_uint32(fix_layout, "new-commit-hash",
-                          defrag->new_commit_hash);
+    /* fix_layout is shared by the crawler threads, the new commit hash
+     * must only be sent for this directory */
+    settle = dict_copy_with_ref(fix_layout, NULL);
+    if (!settle) {
+        gf_log(this->name, GF_LOG_ERROR, "Failed to copy fix-layout dict");
+        return -1;
+    }
+
+    ret = dict_set_uint32(settle, "new-commit-hash", defrag->new_commit_hash);
     if (ret) {
         gf_log(this->name, GF_LOG_ERROR, "Failed to set new-commit-hash");
+        dict_unref(settle);
         return -1;
     }
 
-    ret = syncop_setxattr(this, loc, fix_layout, 0, NULL, NULL);
+    ret = syncop_setxattr(this, loc, settle, 0, NULL, NULL);
+    dict_unref(settle);
     if (ret) {
         gf_msg(this->name, GF_LOG_ERROR, -ret, DHT_MSG_LAYOUT_FIX_FAILED,
                "fix layout on %s failed", loc->path);
@@ -3589,43 +3773,137 @@ gf_defrag_settle_hash(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
         return -1;
     }
 
-    /* TBD: find more efficient solution than adding/deleting every time */
-    dict_del(fix_layout, "new-commit-hash");
-
     return 0;
 }
 
-int
-gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
-                     dict_t *fix_layout, dict_t *migrate_data)
+/* State shared by the threads crawling the directories of the volume. The
+ * queue of directories to crawl is in defrag. */
+typedef struct {
+    xlator_t *this;
+    dict_t *fix_layout;
+    dict_t *migrate_data;
+    dict_t *xattr_req;
+    int ret;
+} gf_defrag_crawl_t;
+
+/* Counts a failure of the crawl, which can happen on several threads at
+ * once. */
+static void
+gf_defrag_crawl_failed(gf_defrag_info_t *defrag)
 {
-    int ret = -1;
-    loc_t entry_loc = {
-        0,
-    };
-    fd_t *fd = NULL;
-    gf_dirent_t entries;
-    gf_dirent_t *tmp = NULL;
-    gf_dirent_t *entry = NULL;
-    gf_boolean_t free_entries = _gf_false;
-    off_t offset = 0;
+    LOCK(&defrag->lock);
+    {
+        defrag->total_failures += 1;
+    }
+    UNLOCK(&defrag->lock);
+}
+
+/* Removes the checkpoint of a directory, once it is covered by the one of
+ * its parent or the rebalance has completed. */
+static void
+gf_defrag_crawl_uncheckpoint(xlator_t *this, gf_defrag_info_t *defrag,
+                             loc_t *loc)
+{
+    int ret = 0;
+
+    ret = syncop_removexattr(this, loc, defrag->checkpoint_key, NULL, NULL);
+    if (ret && (-ret != ENOENT) && (-ret != ESTALE) && (-ret != ENODATA)) {
+        gf_msg(this->name, GF_LOG_WARNING, -ret, DHT_MSG_REMOVE_XATTR_FAILED,
+               "Failed to remove rebalance checkpoint from %s", loc->path);
+    }
+}
+
+/* Drops a reference on a directory of the crawl. Once the whole subtree of
+ * the directory has been processed without failure, it is checkpointed, so
+ * that a restarted rebalance with the same commit hash skips it, and the
+ * checkpoints of its subdirectories are removed. The root isn't marked:
+ * when it completes, so does the crawl, and no checkpoint is left. */
+static void
+gf_defrag_crawl_dir_put(xlator_t *this, gf_defrag_crawl_dir_t *dir)
+{
+    dht_conf_t *conf = this->private;
+    gf_defrag_info_t *defrag = conf->defrag;
+    gf_defrag_crawl_dir_t *parent = NULL;
+    gf_defrag_crawl_dir_t *child = NULL;
+    gf_defrag_crawl_dir_t *tmp = NULL;
+    gf_boolean_t checkpoint = _gf_false;
+    dict_t *xattr = NULL;
+    uint32_t value = 0;
+    int ret = 0;
+
+    while (dir && (GF_ATOMIC_DEC(dir->pending) == 0)) {
+        parent = dir->parent;
+        checkpoint = !dir->failed && defrag->checkpoint_key &&
+                     (defrag->defrag_status == GF_DEFRAG_STATUS_STARTED);
+
+        if (checkpoint && parent) {
+            ret = -ENOMEM;
+            value = hton32(conf->vol_commit_hash);
+            xattr = dict_new();
+            if (xattr && (dict_set_static_bin(xattr, defrag->checkpoint_key,
+                                              &value, sizeof(value)) == 0)) {
+                ret = syncop_setxattr(this, &dir->loc, xattr, 0, NULL, NULL);
+            }
+            if (xattr)
+                dict_unref(xattr);
+
+            if (ret && (-ret != ENOENT) && (-ret != ESTALE)) {
+                gf_msg(this->name, GF_LOG_WARNING, -ret,
+                       DHT_MSG_SET_XATTR_FAILED,
+                       "Failed to set rebalance checkpoint on %s",
+                       dir->loc.path);
+                dir->failed = _gf_true;
+                checkpoint = _gf_false;
+            }
+        }
+
+        /* The subdirectories keep their checkpoints if this directory
+         * couldn't get one. */
+        list_for_each_entry_safe(child, tmp, &dir->done, list)
+        {
+            if (checkpoint)
+                gf_defrag_crawl_uncheckpoint(this, defrag, &child->loc);
+            list_del_init(&child->list);
+            loc_wipe(&child->loc);
+            GF_FREE(child);
+        }
+
+        if (dir->failed && parent)
+            parent->failed = _gf_true;
+
+        if (checkpoint && parent) {
+            LOCK(&defrag->lock);
+            {
+                list_add_tail(&dir->list, &parent->done);
+            }
+            UNLOCK(&defrag->lock);
+        } else {
+            loc_wipe(&dir->loc);
+            GF_FREE(dir);
+        }
+
+        dir = parent;
+    }
+}
+
+/* Returns 1 if the directory doesn't need to be crawled because it is gone
+ * or not a directory, and 2 if its subtree was already processed. */
+static int
+gf_defrag_crawl_lookup(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
+                       dict_t *xattr_req)
+{
+    dht_conf_t *conf = this->private;
     struct iatt iatt = {
         0,
     };
-    struct iatt entry_iatt = {
-        0,
-    };
+    dict_t *xattr_rsp = NULL;
     inode_t *linked_inode = NULL, *inode = NULL;
-    dht_conf_t *conf = NULL;
-    int perrno = 0;
-
-    conf = this->private;
-    if (!conf) {
-        ret = -1;
-        goto out;
-    }
+    void *value = NULL;
+    uint32_t hash = 0;
+    int len = 0;
+    int ret = 0;
 
-    ret = syncop_lookup(this, loc, &iatt, NULL, NULL, NULL);
+    ret = syncop_lookup(this, loc, &iatt, NULL, xattr_req, &xattr_rsp);
     if (ret) {
         if (-ret == ENOENT || -ret == ESTALE) {
             gf_msg(this->name, GF_LOG_INFO, -ret, DHT_MSG_DIR_LOOKUP_FAILED,
@@ -3633,34 +3911,101 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                    "Skipping",
                    loc->path);
             if (conf->decommission_subvols_cnt) {
-                defrag->total_failures++;
+                gf_defrag_crawl_failed(defrag);
             }
-            ret = 0;
+            ret = 1;
         } else {
             gf_msg(this->name, GF_LOG_ERROR, -ret, DHT_MSG_DIR_LOOKUP_FAILED,
                    "lookup failed for:%s", loc->path);
 
-            defrag->total_failures++;
+            gf_defrag_crawl_failed(defrag);
 
             if (conf->decommission_in_progress) {
                 defrag->defrag_status = GF_DEFRAG_STATUS_FAILED;
-                ret = -1;
             }
+            ret = -1;
         }
         goto out;
     }
 
+    if (iatt.ia_type != IA_IFDIR) {
+        ret = 1;
+        goto out;
+    }
+
     linked_inode = inode_link(loc->inode, loc->parent, loc->name, &iatt);
 
     inode = loc->inode;
     loc->inode = linked_inode;
     inode_unref(inode);
 
+    if (defrag->checkpoint_key && xattr_rsp &&
+        (dict_get_ptr_and_len(xattr_rsp, defrag->checkpoint_key, &value,
+                              &len) == 0) &&
+        (len == sizeof(hash))) {
+        memcpy(&hash, value, sizeof(hash));
+        if (ntoh32(hash) == conf->vol_commit_hash) {
+            gf_msg_debug(this->name, 0,
+                         "Skipping %s, already processed by this rebalance",
+                         loc->path);
+            ret = 2;
+            goto out;
+        }
+    }
+
+out:
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+
+    return ret;
+}
+
+static void
+gf_defrag_crawl_push(gf_defrag_info_t *defrag, gf_defrag_crawl_dir_t *dir)
+{
+    pthread_mutex_lock(&defrag->crawl_mutex);
+    {
+        /* Depth first, to keep the queue short */
+        list_add(&dir->list, &defrag->crawl_queue);
+        pthread_cond_signal(&defrag->crawl_cond);
+    }
+    pthread_mutex_unlock(&defrag->crawl_mutex);
+}
+
+/* Fixes the layout of a directory, which has already been looked up, and
+ * queues its files for migration. Its subdirectories are looked up and
+ * queued for the crawler threads. */
+int
+gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag,
+                     gf_defrag_crawl_dir_t *dir, dict_t *fix_layout,
+                     dict_t *migrate_data, dict_t *xattr_req)
+{
+    int ret = -1;
+    loc_t *loc = &dir->loc;
+    loc_t entry_loc = {
+        0,
+    };
+    fd_t *fd = NULL;
+    gf_dirent_t entries;
+    gf_dirent_t *tmp = NULL;
+    gf_dirent_t *entry = NULL;
+    gf_boolean_t free_entries = _gf_false;
+    off_t offset = 0;
+    gf_defrag_crawl_dir_t *child = NULL;
+    dht_conf_t *conf = NULL;
+    int perrno = 0;
+
+    conf = this->private;
+    if (!conf) {
+        ret = -1;
+        goto out;
+    }
+
     fd = fd_create(loc->inode, defrag->pid);
     if (!fd) {
         gf_log(this->name, GF_LOG_ERROR, "Failed to create fd");
 
-        defrag->total_failures++;
+        gf_defrag_crawl_failed(defrag);
         ret = -1;
         goto out;
     }
@@ -3669,7 +4014,7 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
     if (ret) {
         if (-ret == ENOENT || -ret == ESTALE) {
             if (conf->decommission_subvols_cnt) {
-                defrag->total_failures++;
+                gf_defrag_crawl_failed(defrag);
             }
             ret = 0;
             goto out;
@@ -3680,7 +4025,7 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                "err:%d",
                loc->path, -ret);
 
-        defrag->total_failures++;
+        gf_defrag_crawl_failed(defrag);
         ret = -1;
         goto out;
     }
@@ -3693,7 +4038,7 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
         if (ret < 0) {
             if (-ret == ENOENT || -ret == ESTALE) {
                 if (conf->decommission_subvols_cnt) {
-                    defrag->total_failures++;
+                    gf_defrag_crawl_failed(defrag);
                 }
                 ret = 0;
                 goto out;
@@ -3704,7 +4049,7 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                    "path %s. Aborting fix-layout",
                    loc->path);
 
-            defrag->total_failures++;
+            gf_defrag_crawl_failed(defrag);
             ret = -1;
             goto out;
         }
@@ -3738,7 +4083,8 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                        " build failed for entry: %s",
                        entry->d_name);
 
-                defrag->total_failures++;
+                gf_defrag_crawl_failed(defrag);
+                dir->failed = _gf_true;
 
                 if (conf->decommission_in_progress) {
                     defrag->defrag_status = GF_DEFRAG_STATUS_FAILED;
@@ -3749,43 +4095,65 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                 }
             }
 
-            if (DT_UNKNOWN == entry->d_type) {
-                ret = syncop_lookup(this, &entry_loc, &entry_iatt, NULL, NULL,
-                                    NULL);
-                if ((ret == 0) && (entry_iatt.ia_type != IA_IFDIR)) {
-                    continue;
-                }
-                /*If it is directory, gf_defrag_fix_layout() call will again do
-                 * one more lookup. Not optimizing this part as all modern
-                 * filesystems populate entry->d_type. We can optimize it when
-                 * such a filesystem is found.*/
+            /* The subdirectory is looked up, and so healed to any newly
+             * added brick, before the layout of this directory is fixed.
+             * Entries of type DT_UNKNOWN which aren't directories are
+             * skipped. */
+            ret = gf_defrag_crawl_lookup(this, defrag, &entry_loc, xattr_req);
+
+            if (defrag->defrag_status != GF_DEFRAG_STATUS_STARTED) {
+                goto out;
             }
 
-            /* A return value of 2 means, either process_dir or
-             * lookup of a dir failed. Hence, don't commit hash
-             * for the current directory*/
+            if (ret == 1)
+                continue;
 
-            ret = gf_defrag_fix_layout(this, defrag, &entry_loc, fix_layout,
-                                       migrate_data);
+            /* A checkpointed subdirectory is skipped, and its checkpoint
+             * goes along with those of the subdirectories crawled now. */
+            if (ret == 2) {
+                child = GF_CALLOC(1, sizeof(*child), gf_dht_mt_crawl_dir_t);
+                if (child) {
+                    INIT_LIST_HEAD(&child->done);
+                    child->loc = entry_loc;
+                    memset(&entry_loc, 0, sizeof(entry_loc));
+                    LOCK(&defrag->lock);
+                    {
+                        list_add_tail(&child->list, &dir->done);
+                    }
+                    UNLOCK(&defrag->lock);
+                }
+                continue;
+            }
 
-            if (defrag->defrag_status != GF_DEFRAG_STATUS_STARTED) {
-                goto out;
+            if (!ret) {
+                child = GF_CALLOC(1, sizeof(*child), gf_dht_mt_crawl_dir_t);
+                if (!child)
+                    ret = -1;
             }
 
             if (ret) {
                 gf_msg(this->name, GF_LOG_ERROR, 0, DHT_MSG_LAYOUT_FIX_FAILED,
                        "Fix layout failed for %s", entry_loc.path);
 
+                dir->failed = _gf_true;
+
                 if (conf->decommission_in_progress) {
                     defrag->defrag_status = GF_DEFRAG_STATUS_FAILED;
 
                     goto out;
                 } else {
-                    /* Let's not commit-hash if
-                     * gf_defrag_fix_layout failed*/
                     continue;
                 }
             }
+
+            INIT_LIST_HEAD(&child->done);
+            child->loc = entry_loc;
+            memset(&entry_loc, 0, sizeof(entry_loc));
+            child->parent = dir;
+            GF_ATOMIC_INIT(child->pending, 1);
+            GF_ATOMIC_INC(dir->pending);
+
+            gf_defrag_crawl_push(defrag, child);
         }
 
         gf_dirent_free(&entries);
@@ -3819,7 +4187,7 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                    "renamed or removed",
                    loc->path);
             if (conf->decommission_subvols_cnt) {
-                defrag->total_failures++;
+                gf_defrag_crawl_failed(defrag);
             }
             ret = 0;
             goto out;
@@ -3827,7 +4195,8 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
             gf_msg(this->name, GF_LOG_ERROR, -ret, DHT_MSG_LAYOUT_FIX_FAILED,
                    "Setxattr failed for %s", loc->path);
 
-            defrag->total_failures++;
+            gf_defrag_crawl_failed(defrag);
+            dir->failed = _gf_true;
 
             if (conf->decommission_in_progress) {
                 defrag->defrag_status = GF_DEFRAG_STATUS_FAILED;
@@ -3838,7 +4207,8 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
     }
 
     if (defrag->cmd != GF_DEFRAG_CMD_START_LAYOUT_FIX) {
-        ret = gf_defrag_process_dir(this, defrag, loc, migrate_data, &perrno);
+        ret = gf_defrag_process_dir(this, defrag, loc, dir, migrate_data,
+                                    &perrno);
 
         if (defrag->defrag_status != GF_DEFRAG_STATUS_STARTED) {
             goto out;
@@ -3849,7 +4219,8 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
                 ret = 0;
                 goto out;
             } else {
-                defrag->total_failures++;
+                gf_defrag_crawl_failed(defrag);
+                dir->failed = _gf_true;
 
                 gf_msg(this->name, GF_LOG_ERROR, 0,
                        DHT_MSG_DEFRAG_PROCESS_DIR_FAILED,
@@ -3867,7 +4238,8 @@ gf_defrag_fix_layout(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
     gf_msg_trace(this->name, 0, "fix layout called on %s", loc->path);
 
     if (gf_defrag_settle_hash(this, defrag, loc, fix_layout) != 0) {
-        defrag->total_failures++;
+        gf_defrag_crawl_failed(defrag);
+        dir->failed = _gf_true;
 
         gf_msg(this->name, GF_LOG_ERROR, 0, DHT_MSG_SETTLE_HASH_FAILED,
                "Settle hash failed for %s", loc->path);
@@ -3893,6 +4265,185 @@ out:
     return ret;
 }
 
+static void
+gf_defrag_crawl_dir(gf_defrag_crawl_t *crawl, gf_defrag_crawl_dir_t *dir)
+{
+    xlator_t *this = crawl->this;
+    dht_conf_t *conf = this->private;
+    gf_defrag_info_t *defrag = conf->defrag;
+    int ret = 0;
+
+    if (defrag->defrag_status != GF_DEFRAG_STATUS_STARTED) {
+        dir->failed = _gf_true;
+        goto out;
+    }
+
+    ret = gf_defrag_fix_layout(this, defrag, dir, crawl->fix_layout,
+                               crawl->migrate_data, crawl->xattr_req);
+    if (ret) {
+        dir->failed = _gf_true;
+
+        if (!dir->parent) {
+            crawl->ret = -1;
+            goto out;
+        }
+
+        gf_msg(this->name, GF_LOG_ERROR, 0, DHT_MSG_LAYOUT_FIX_FAILED,
+               "Fix layout failed for %s", dir->loc.path);
+
+        if (conf->decommission_in_progress) {
+            defrag->defrag_status = GF_DEFRAG_STATUS_FAILED;
+        }
+    }
+
+out:
+    gf_defrag_crawl_dir_put(this, dir);
+}
+
+/* Takes directories from the crawl queue until it is empty and no other
+ * thread is crawling a directory, which could queue more of them. */
+static void *
+gf_defrag_crawl_task(void *opaque)
+{
+    gf_defrag_crawl_t *crawl = opaque;
+    dht_conf_t *conf = crawl->this->private;
+    gf_defrag_info_t *defrag = conf->defrag;
+    gf_defrag_crawl_dir_t *dir = NULL;
+
+    pthread_mutex_lock(&defrag->crawl_mutex);
+    while (_gf_true) {
+        while (list_empty(&defrag->crawl_queue) && defrag->crawl_busy) {
+            pthread_cond_wait(&defrag->crawl_cond, &defrag->crawl_mutex);
+        }
+
+        if (list_empty(&defrag->crawl_queue))
+            break;
+
+        dir = list_entry(defrag->crawl_queue.next, typeof(*dir), list);
+        list_del_init(&dir->list);
+        defrag->crawl_busy++;
+        pthread_mutex_unlock(&defrag->crawl_mutex);
+
+        gf_defrag_crawl_dir(crawl, dir);
+
+        pthread_mutex_lock(&defrag->crawl_mutex);
+        defrag->crawl_busy--;
+        if (!defrag->crawl_busy && list_empty(&defrag->crawl_queue)) {
+            pthread_cond_broadcast(&defrag->crawl_cond);
+        }
+    }
+    pthread_mutex_unlock(&defrag->crawl_mutex);
+
+    return NULL;
+}
+
+static void *
+gf_defrag_crawl_thread(void *opaque)
+{
+    gf_defrag_crawl_t *crawl = opaque;
+    pid_t pid = GF_CLIENT_PID_DEFRAG;
+    gf_lkowner_t lkowner;
+
+    THIS = crawl->this;
+    syncopctx_setfspid(&pid);
+    set_lk_owner_from_ptr(&lkowner, &lkowner);
+    syncopctx_setfslkowner(&lkowner);
+
+    return gf_defrag_crawl_task(crawl);
+}
+
+/* Crawls the directories under loc with rebal-crawl-threads threads, fixing
+ * their layout and queueing their files for migration. */
+static int
+gf_defrag_crawl(xlator_t *this, gf_defrag_info_t *defrag, loc_t *loc,
+                dict_t *fix_layout, dict_t *migrate_data)
+{
+    gf_defrag_crawl_t crawl = {
+        0,
+    };
+    gf_defrag_crawl_dir_t *root = NULL;
+    pthread_t *tid = NULL;
+    int count = 0;
+    int i = 0;
+    int ret = -1;
+
+    crawl.this = this;
+    crawl.fix_layout = fix_layout;
+    crawl.migrate_data = migrate_data;
+
+    if (defrag->checkpoint_key) {
+        crawl.xattr_req = dict_new();
+        if (!crawl.xattr_req ||
+            dict_set_uint32(crawl.xattr_req, defrag->checkpoint_key,
+                            sizeof(uint32_t))) {
+            gf_log(this->name, GF_LOG_ERROR,
+                   "Failed to set dict for key: %s", defrag->checkpoint_key);
+            goto out;
+        }
+    }
+
+    root = GF_CALLOC(1, sizeof(*root), gf_dht_mt_crawl_dir_t);
+    if (!root)
+        goto out;
+    INIT_LIST_HEAD(&root->done);
+    GF_ATOMIC_INIT(root->pending, 1);
+
+    ret = loc_copy(&root->loc, loc);
+    if (ret) {
+        gf_log(this->name, GF_LOG_ERROR, "loc_copy failed");
+        goto out;
+    }
+
+    ret = gf_defrag_crawl_lookup(this, defrag, &root->loc, crawl.xattr_req);
+    if (ret == 2) {
+        /* The whole volume was already processed */
+        gf_defrag_crawl_uncheckpoint(this, defrag, &root->loc);
+        ret = 0;
+        goto out;
+    }
+    if (ret) {
+        ret = (ret == 1) ? 0 : -1;
+        goto out;
+    }
+
+    list_add(&root->list, &defrag->crawl_queue);
+    root = NULL;
+
+    tid = GF_CALLOC(defrag->crawl_thread_count, sizeof(pthread_t),
+                    gf_common_mt_pthread_t);
+    if (tid) {
+        for (count = 0; count < defrag->crawl_thread_count - 1; count++) {
+            if (gf_thread_create(&tid[count], NULL, gf_defrag_crawl_thread,
+                                 &crawl, "dhtcrawl%d",
+                                 (count + 1) & 0x3ff) != 0) {
+                gf_msg(this->name, GF_LOG_WARNING, 0, 0,
+                       "Crawler thread[%d] creation failed", count);
+                break;
+            }
+        }
+    }
+
+    gf_defrag_crawl_task(&crawl);
+
+    for (i = 0; i < count; i++) {
+        pthread_join(tid[i], NULL);
+    }
+
+    ret = crawl.ret;
+out:
+    if (root) {
+        loc_wipe(&root->loc);
+        GF_FREE(root);
+    }
+
+    GF_FREE(tid);
+
+    if (crawl.xattr_req)
+        dict_unref(crawl.xattr_req);
+
+    return ret;
+}
+
 int
 dht_init_local_subvols_and_nodeuuids(xlator_t *this, dht_conf_t *conf,
                                      loc_t *loc)
@@ -4309,7 +4860,7 @@ gf_defrag_start_crawl(void *data)
     if (ret) {
         gf_log(this->name, GF_LOG_ERROR, "Failed to set %s",
                conf->commithash_xattr_name);
-        defrag->total_failures++;
+        gf_defrag_crawl_failed(defrag);
         ret = -1;
         goto out;
     }
@@ -4320,7 +4871,7 @@ gf_defrag_start_crawl(void *data)
                "Failed to set commit hash on %s. "
                "Rebalance cannot proceed.",
                loc.path);
-        defrag->total_failures++;
+        gf_defrag_crawl_failed(defrag);
         ret = -1;
         goto out;
     }
@@ -4333,7 +4884,7 @@ gf_defrag_start_crawl(void *data)
                "Failed to start rebalance:"
                "Failed to set dictionary value: key = %s",
                GF_XATTR_FIX_LAYOUT_KEY);
-        defrag->total_failures++;
+        gf_defrag_crawl_failed(defrag);
         ret = -1;
         goto out;
     }
@@ -4344,7 +4895,7 @@ gf_defrag_start_crawl(void *data)
     if (ret) {
         gf_msg(this->name, GF_LOG_ERROR, -ret, DHT_MSG_REBALANCE_FAILED,
                "fix layout on %s failed", loc.path);
-        defrag->total_failures++;
+        gf_defrag_crawl_failed(defrag);
         ret = -1;
         goto out;
     }
@@ -4354,7 +4905,7 @@ gf_defrag_start_crawl(void *data)
 
         migrate_data = dict_new();
         if (!migrate_data) {
-            defrag->total_failures++;
+            gf_defrag_crawl_failed(defrag);
             ret = -1;
             goto out;
         }
@@ -4362,7 +4913,7 @@ gf_defrag_start_crawl(void *data)
             migrate_data, GF_XATTR_FILE_MIGRATE_KEY,
             (defrag->cmd == GF_DEFRAG_CMD_START_FORCE) ? "force" : "non-force");
         if (ret) {
-            defrag->total_failures++;
+            gf_defrag_crawl_failed(defrag);
             ret = -1;
             goto out;
         }
@@ -4390,14 +4941,20 @@ gf_defrag_start_crawl(void *data)
         }
     }
 
-    ret = gf_defrag_fix_layout(this, defrag, &loc, fix_layout, migrate_data);
+    if (defrag->crawl_checkpoint && conf->vol_commit_hash) {
+        gf_asprintf(&defrag->checkpoint_key,
+                    GF_XATTR_REBAL_CHECKPOINT_PREFIX "%s",
+                    uuid_utoa(defrag->node_uuid));
+    }
+
+    ret = gf_defrag_crawl(this, defrag, &loc, fix_layout, migrate_data);
     if (ret) {
         ret = -1;
         goto out;
     }
 
     if (gf_defrag_settle_hash(this, defrag, &loc, fix_layout) != 0) {
-        defrag->total_failures++;
+        gf_defrag_crawl_failed(defrag);
         ret = -1;
         goto out;
     }
@@ -4438,6 +4995,7 @@ out:
 
     dht_send_rebalance_event(this, defrag->cmd, defrag->defrag_status);
 
+    GF_FREE(defrag->checkpoint_key);
     GF_FREE(defrag);
     conf->defrag = NULL;
 
@@ -452,6 +452,9 @@ dht_reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("lookup-optimize", conf->lookup_optimize, options, bool,
                      out);
 
+    GF_OPTION_RECONF("layout-cache-timeout", conf->layout_cache_timeout,
+                     options, uint32, out);
+
     GF_OPTION_RECONF("min-free-disk", conf->min_free_disk, options,
                      percent_or_size, out);
     /* option can be any one of percent or bytes */
@@ -467,6 +470,8 @@ dht_reconfigure(xlator_t *this, dict_t *options)
 
     GF_OPTION_RECONF("readdir-optimize", conf->readdir_optimize, options, bool,
                      out);
+    GF_OPTION_RECONF("readdirp-merge", conf->readdirp_merge, options, bool,
+                     out);
     GF_OPTION_RECONF("randomize-hash-range-by-gfid", conf->randomize_by_gfid,
                      options, bool, out);
 
@@ -476,6 +481,12 @@ dht_reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("force-migration", conf->force_migration, options, bool,
                      out);
 
+    GF_OPTION_RECONF("rebalance-io-window", conf->rebal_io_window, options,
+                     uint32, out);
+
+    GF_OPTION_RECONF("rebalance-max-block-size", conf->rebal_max_block_size,
+                     options, size_uint64, out);
+
     GF_OPTION_RECONF("ensure-durability", conf->ensure_durability, options,
                      bool, out);
 
@@ -646,6 +657,7 @@ dht_init(xlator_t *this)
     LOCK_INIT(&conf->layout_lock);
     LOCK_INIT(&conf->lock);
     synclock_init(&conf->link_lock, SYNC_LOCK_DEFAULT);
+    GF_ATOMIC_INIT(conf->layout_cache_gen, 0);
 
     /* We get the commit-hash to set only for rebalance process */
     if (dict_get_uint32(this->options, "commit-hash", &commit_hash) == 0) {
@@ -706,6 +718,10 @@ dht_init(xlator_t *this)
         pthread_mutex_init(&defrag->fc_mutex, 0);
         pthread_cond_init(&defrag->fc_wakeup_cond, 0);
 
+        INIT_LIST_HEAD(&defrag->crawl_queue);
+        pthread_mutex_init(&defrag->crawl_mutex, 0);
+        pthread_cond_init(&defrag->crawl_cond, 0);
+
         defrag->global_error = 0;
     }
 
@@ -730,6 +746,9 @@ dht_init(xlator_t *this)
 
     GF_OPTION_INIT("lookup-optimize", conf->lookup_optimize, bool, err);
 
+    GF_OPTION_INIT("layout-cache-timeout", conf->layout_cache_timeout, uint32,
+                   err);
+
     GF_OPTION_INIT("unhashed-sticky-bit", conf->unhashed_sticky_bit, bool, err);
 
     GF_OPTION_INIT("use-readdirp", conf->use_readdirp, bool, err);
@@ -747,10 +766,17 @@ dht_init(xlator_t *this)
 
     GF_OPTION_INIT("readdir-optimize", conf->readdir_optimize, bool, err);
 
+    GF_OPTION_INIT("readdirp-merge", conf->readdirp_merge, bool, err);
+
     GF_OPTION_INIT("lock-migration", conf->lock_migration_enabled, bool, err);
 
     GF_OPTION_INIT("force-migration", conf->force_migration, bool, err);
 
+    GF_OPTION_INIT("rebalance-io-window", conf->rebal_io_window, uint32, err);
+
+    GF_OPTION_INIT("rebalance-max-block-size", conf->rebal_max_block_size,
+                   size_uint64, err);
+
     GF_OPTION_INIT("ensure-durability", conf->ensure_durability, bool, err);
 
     if (defrag) {
@@ -825,6 +851,12 @@ dht_init(xlator_t *this)
             if (ret == -1)
                 goto err;
         }
+
+        GF_OPTION_INIT("rebal-crawl-threads", defrag->crawl_thread_count,
+                       int32, err);
+
+        GF_OPTION_INIT("rebal-checkpoint", defrag->crawl_checkpoint, bool,
+                       err);
     }
 
     GF_OPTION_INIT("xattr-name", conf->xattr_name, str, err);
@@ -916,6 +948,20 @@ struct volume_options dht_options[] = {
      .op_version = {GD_OP_VERSION_3_7_2},
      .level = OPT_STATUS_ADVANCED,
      .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"layout-cache-timeout"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = 3600,
+     .default_value = "0",
+     .description =
+         "Time in seconds during which the layout of a directory, once "
+         "checked on all the subvolumes, is revalidated with a lookup on "
+         "a single subvolume. Subvolumes going up or down, a new "
+         "volume commit hash or a notification of a layout change (with "
+         "features.cache-invalidation) end it earlier. 0 disables it.",
+     .op_version = {GD_OP_VERSION_10_0},
+     .level = OPT_STATUS_ADVANCED,
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
     {.key = {"min-free-disk"},
      .type = GF_OPTION_TYPE_PERCENT_OR_SIZET,
      .default_value = "10%",
@@ -1004,6 +1050,19 @@ struct volume_options dht_options[] = {
      .op_version = {1},
      .level = OPT_STATUS_ADVANCED,
      .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"readdirp-merge"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .description =
+         "This option if set to ON reads a directory from all the "
+         "subvolumes at the same time and interleaves their entries, "
+         "keeping at most one reply of each one in memory, instead of "
+         "reading them one after another. The offsets of the entries are "
+         "only valid on the fd that returned them, for its last 1024 "
+         "replies. Anonymous fds, as used by gNFS, are not read this way.",
+     .op_version = {GD_OP_VERSION_10_0},
+     .level = OPT_STATUS_ADVANCED,
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
     {.key = {"rsync-hash-regex"},
      .type = GF_OPTION_TYPE_STR,
      /* Setting a default here doesn't work.  See dht_init_regex. */
@@ -1103,6 +1162,51 @@ struct volume_options dht_options[] = {
      .level = OPT_STATUS_ADVANCED,
      .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
 
+    {.key = {"rebal-crawl-threads"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 64,
+     .default_value = "1",
+     .description = "Number of threads crawling the directories of the "
+                    "volume during rebalance. Each one fixes the layout of "
+                    "a directory and queues its files for migration",
+     .op_version = {GD_OP_VERSION_10_0},
+     .level = OPT_STATUS_ADVANCED,
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+
+    {.key = {"rebal-checkpoint"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .description = "If enabled, rebalance marks the directories whose "
+                    "whole subtree has been processed, so that it skips "
+                    "them if it is restarted",
+     .op_version = {GD_OP_VERSION_10_0},
+     .level = OPT_STATUS_ADVANCED,
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+
+    {.key = {"rebalance-io-window"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 16,
+     .default_value = "1",
+     .description = "Number of blocks of a file that rebalance reads and "
+                    "writes concurrently while migrating it",
+     .op_version = {GD_OP_VERSION_10_0},
+     .level = OPT_STATUS_ADVANCED,
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+
+    {.key = {"rebalance-max-block-size"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .min = 1 * GF_UNIT_MB,
+     .max = 16 * GF_UNIT_MB,
+     .default_value = "1MB",
+     .description = "Maximum size of the blocks used to migrate a file. "
+                    "Blocks start at 1MB and grow up to this size while "
+                    "the file is copied",
+     .op_version = {GD_OP_VERSION_10_0},
+     .level = OPT_STATUS_ADVANCED,
+     .flags = OPT_FLAG_CLIENT_OPT | OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+
     {.key = {"ensure-durability"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "on",
@@ -0,0 +1,114 @@
+/*
+  Copyright (c) 2021 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+#include <errno.h>
+
+#include "ec-code-intel.h"
+
+/* A whole EC_METHOD_WORD_SIZE word fits in one zmm register, so each bit
+ * of the word takes a single load, store or xor. EVEX operations also
+ * take a separate destination, which turns xor3 into one instruction. */
+
+static void
+ec_code_avx512_prolog(ec_code_builder_t *builder)
+{
+    builder->loop = builder->address;
+}
+
+static void
+ec_code_avx512_epilog(ec_code_builder_t *builder)
+{
+    ec_code_intel_op_add_i2r(builder, 64, REG_DX);
+    ec_code_intel_op_add_i2r(builder, 64, REG_DI);
+    ec_code_intel_op_test_i2r(builder, builder->width - 1, REG_DX);
+    ec_code_intel_op_jne(builder, builder->loop);
+
+    /* avoid the penalty of dirty upper halves in later SSE code */
+    ec_code_intel_op_vzeroupper(builder);
+    ec_code_intel_op_ret(builder, 0);
+}
+
+static void
+ec_code_avx512_load(ec_code_builder_t *builder, uint32_t dst, uint32_t idx,
+                    uint32_t bit)
+{
+    if (builder->linear) {
+        ec_code_intel_op_mov_m2zmm(
+            builder, REG_SI, REG_DX, 1,
+            idx * builder->width * builder->bits + bit * builder->width, dst);
+    } else {
+        if (builder->base != idx) {
+            ec_code_intel_op_mov_m2r(builder, REG_SI, REG_NULL, 0, idx * 8,
+                                     REG_AX);
+            builder->base = idx;
+        }
+        ec_code_intel_op_mov_m2zmm(builder, REG_AX, REG_DX, 1,
+                                   bit * builder->width, dst);
+    }
+}
+
+static void
+ec_code_avx512_store(ec_code_builder_t *builder, uint32_t src, uint32_t bit)
+{
+    ec_code_intel_op_mov_zmm2m(builder, src, REG_DI, REG_NULL, 0,
+                               bit * builder->width);
+}
+
+static void
+ec_code_avx512_copy(ec_code_builder_t *builder, uint32_t dst, uint32_t src)
+{
+    ec_code_intel_op_mov_zmm2zmm(builder, src, dst);
+}
+
+static void
+ec_code_avx512_xor2(ec_code_builder_t *builder, uint32_t dst, uint32_t src)
+{
+    ec_code_intel_op_xor_zmm2zmm(builder, dst, src, dst);
+}
+
+static void
+ec_code_avx512_xor3(ec_code_builder_t *builder, uint32_t dst, uint32_t src1,
+                    uint32_t src2)
+{
+    ec_code_intel_op_xor_zmm2zmm(builder, src1, src2, dst);
+}
+
+static void
+ec_code_avx512_xorm(ec_code_builder_t *builder, uint32_t dst, uint32_t idx,
+                    uint32_t bit)
+{
+    if (builder->linear) {
+        ec_code_intel_op_xor_m2zmm(
+            builder, REG_SI, REG_DX, 1,
+            idx * builder->width * builder->bits + bit * builder->width, dst);
+    } else {
+        if (builder->base != idx) {
+            ec_code_intel_op_mov_m2r(builder, REG_SI, REG_NULL, 0, idx * 8,
+                                     REG_AX);
+            builder->base = idx;
+        }
+        ec_code_intel_op_xor_m2zmm(builder, REG_AX, REG_DX, 1,
+                                   bit * builder->width, dst);
+    }
+}
+
+static char *ec_code_avx512_needed_flags[] = {"avx512f", NULL};
+
+ec_code_gen_t ec_code_gen_avx512 = {.name = "avx512",
+                                    .flags = ec_code_avx512_needed_flags,
+                                    .width = 64,
+                                    .prolog = ec_code_avx512_prolog,
+                                    .epilog = ec_code_avx512_epilog,
+                                    .load = ec_code_avx512_load,
+                                    .store = ec_code_avx512_store,
+                                    .copy = ec_code_avx512_copy,
+                                    .xor2 = ec_code_avx512_xor2,
+                                    .xor3 = ec_code_avx512_xor3,
+                                    .xorm = ec_code_avx512_xorm};
@@ -90,6 +90,52 @@ ec_code_intel_vex(ec_code_intel_t *intel, gf_boolean_t w, gf_boolean_t l,
     }
 }
 
+/* EVEX prefix for 512 bits operations. Registers can go up to 31, so the
+ * extra bits are taken from the modrm and sib fields before they are
+ * reduced to 3 bits, and memory offsets are scaled by the operand size
+ * when they fit in a byte (disp8 * N compression). */
+static void
+ec_code_intel_evex(ec_code_intel_t *intel, gf_boolean_t w,
+                   ec_code_vex_opcode_t opcode, ec_code_vex_prefix_t prefix,
+                   uint32_t reg)
+{
+    uint32_t r, x, b;
+
+    r = intel->modrm.reg;
+    x = 0;
+    if (intel->modrm.mod == 3) {
+        b = intel->modrm.rm;
+        x = b >> 1;
+    } else if (intel->sib.present) {
+        x = intel->sib.index;
+        b = intel->sib.base;
+    } else {
+        b = intel->modrm.rm;
+    }
+    intel->modrm.reg &= 7;
+    intel->modrm.rm &= 7;
+    intel->sib.index &= 7;
+    intel->sib.base &= 7;
+
+    if ((intel->modrm.mod != 3) && (intel->offset.bytes == 1)) {
+        if ((intel->offset.value & 63) == 0) {
+            intel->offset.value = (int32_t)intel->offset.value / 64;
+        } else {
+            intel->modrm.mod = 2;
+            intel->offset.bytes = 4;
+        }
+    }
+
+    intel->vex.bytes = 4;
+    intel->vex.data[0] = 0x62;
+    intel->vex.data[1] = ((((r >> 3) & 1) << 7) | (((x >> 3) & 1) << 6) |
+                          (((b >> 3) & 1) << 5) | (((r >> 4) & 1) << 4)) ^
+                         0xF0;
+    intel->vex.data[1] |= opcode;
+    intel->vex.data[2] = (w << 7) | ((~reg & 0x0F) << 3) | 0x04 | prefix;
+    intel->vex.data[3] = 0x40 | ((~reg & 0x10) >> 1);
+}
+
 static void
 ec_code_intel_modrm_reg(ec_code_intel_t *intel, uint32_t rm, uint32_t reg)
 {
@@ -592,3 +638,98 @@ ec_code_intel_op_xor_m2avx(ec_code_builder_t *builder, ec_code_intel_reg_t base,
 
     ec_code_intel_emit(builder, &intel);
 }
+
+void
+ec_code_intel_op_vzeroupper(ec_code_builder_t *builder)
+{
+    ec_code_intel_t intel;
+
+    ec_code_intel_init(&intel);
+
+    ec_code_intel_op_1(&intel, 0x77, 0);
+    ec_code_intel_vex(&intel, _gf_false, _gf_false, VEX_OPCODE_0F,
+                      VEX_PREFIX_NONE, VEX_REG_NONE);
+
+    ec_code_intel_emit(builder, &intel);
+}
+
+void
+ec_code_intel_op_mov_zmm2zmm(ec_code_builder_t *builder, uint32_t src,
+                             uint32_t dst)
+{
+    ec_code_intel_t intel;
+
+    ec_code_intel_init(&intel);
+
+    ec_code_intel_modrm_reg(&intel, src, dst);
+    ec_code_intel_op_1(&intel, 0x6F, 0);
+    ec_code_intel_evex(&intel, _gf_true, VEX_OPCODE_0F, VEX_PREFIX_F3,
+                       VEX_REG_NONE);
+
+    ec_code_intel_emit(builder, &intel);
+}
+
+void
+ec_code_intel_op_mov_zmm2m(ec_code_builder_t *builder, uint32_t src,
+                           ec_code_intel_reg_t base, ec_code_intel_reg_t index,
+                           uint32_t scale, int32_t offset)
+{
+    ec_code_intel_t intel;
+
+    ec_code_intel_init(&intel);
+
+    ec_code_intel_modrm_mem(&intel, src, base, index, scale, offset);
+    ec_code_intel_op_1(&intel, 0x7F, 0);
+    ec_code_intel_evex(&intel, _gf_true, VEX_OPCODE_0F, VEX_PREFIX_F3,
+                       VEX_REG_NONE);
+
+    ec_code_intel_emit(builder, &intel);
+}
+
+void
+ec_code_intel_op_mov_m2zmm(ec_code_builder_t *builder, ec_code_intel_reg_t base,
+                           ec_code_intel_reg_t index, uint32_t scale,
+                           int32_t offset, uint32_t dst)
+{
+    ec_code_intel_t intel;
+
+    ec_code_intel_init(&intel);
+
+    ec_code_intel_modrm_mem(&intel, dst, base, index, scale, offset);
+    ec_code_intel_op_1(&intel, 0x6F, 0);
+    ec_code_intel_evex(&intel, _gf_true, VEX_OPCODE_0F, VEX_PREFIX_F3,
+                       VEX_REG_NONE);
+
+    ec_code_intel_emit(builder, &intel);
+}
+
+void
+ec_code_intel_op_xor_zmm2zmm(ec_code_builder_t *builder, uint32_t src1,
+                             uint32_t src2, uint32_t dst)
+{
+    ec_code_intel_t intel;
+
+    ec_code_intel_init(&intel);
+
+    ec_code_intel_modrm_reg(&intel, src2, dst);
+    ec_code_intel_op_1(&intel, 0xEF, 0);
+    ec_code_intel_evex(&intel, _gf_true, VEX_OPCODE_0F, VEX_PREFIX_66, src1);
+
+    ec_code_intel_emit(builder, &intel);
+}
+
+void
+ec_code_intel_op_xor_m2zmm(ec_code_builder_t *builder, ec_code_intel_reg_t base,
+                           ec_code_intel_reg_t index, uint32_t scale,
+                           int32_t offset, uint32_t dst)
+{
+    ec_code_intel_t intel;
+
+    ec_code_intel_init(&intel);
+
+    ec_code_intel_modrm_mem(&intel, dst, base, index, scale, offset);
+    ec_code_intel_op_1(&intel, 0xEF, 0);
+    ec_code_intel_evex(&intel, _gf_true, VEX_OPCODE_0F, VEX_PREFIX_66, dst);
+
+    ec_code_intel_emit(builder, &intel);
+}
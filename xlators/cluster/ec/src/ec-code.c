@@ -34,6 +34,10 @@
 #include "ec-code-avx.h"
 #endif
 
+#ifdef USE_EC_DYNAMIC_AVX512
+#include "ec-code-avx512.h"
+#endif
+
 #define EC_CODE_SIZE (1024 * 64)
 #define EC_CODE_ALIGN 4096
 
@@ -57,6 +61,9 @@ struct _ec_code_proc {
 };
 
 static ec_code_gen_t *ec_code_gen_table[] = {
+#ifdef USE_EC_DYNAMIC_AVX512
+    &ec_code_gen_avx512,
+#endif
 #ifdef USE_EC_DYNAMIC_AVX
     &ec_code_gen_avx,
 #endif
@@ -13,6 +13,7 @@
 #include "libxlator.h"
 #include <glusterfs/byte-order.h>
 
+#include "ec.h"
 #include "ec-types.h"
 #include "ec-helpers.h"
 #include "ec-common.h"
@@ -247,6 +248,7 @@ ec_value_ignore(char *key)
         (strcmp(key, GLUSTERFS_ENTRYLK_COUNT) == 0) ||
         (strncmp(key, GF_XATTR_CLRLK_CMD, SLEN(GF_XATTR_CLRLK_CMD)) == 0) ||
         (strcmp(key, DHT_IATT_IN_XDATA_KEY) == 0) ||
+        (strcmp(key, EC_XATTR_DIRTY_RANGES) == 0) ||
         (strncmp(key, EC_QUOTA_PREFIX, SLEN(EC_QUOTA_PREFIX)) == 0) ||
         (fnmatch(MARKER_XATTR_PREFIX ".*." XTIME, key, 0) == 0) ||
         (fnmatch(GF_XATTR_MARKER_KEY ".*", key, 0) == 0) ||
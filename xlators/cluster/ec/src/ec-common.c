@@ -188,6 +188,12 @@ ec_lock_conflict(ec_lock_link_t *l1, ec_lock_link_t *l2)
 uint32_t
 ec_select_first_by_read_policy(ec_t *ec, ec_fop_data_t *fop)
 {
+    /* Reading from the data bricks of a systematic file needs no decoding,
+     * only interleaving the fragments. */
+    if ((fop->id == GF_FOP_READ) &&
+        ec_get_inode_systematic(fop, fop->fd->inode)) {
+        return 0;
+    }
     if (ec->read_policy == EC_ROUND_ROBIN) {
         return ec->idx;
     } else if (ec->read_policy == EC_GFID_HASH) {
@@ -1151,7 +1157,8 @@ ec_config_check(xlator_t *xl, ec_config_t *config)
 
     ec = xl->private;
     if ((config->version != EC_CONFIG_VERSION) ||
-        (config->algorithm != EC_CONFIG_ALGORITHM) ||
+        ((config->algorithm != EC_CONFIG_ALGORITHM) &&
+         (config->algorithm != EC_CONFIG_ALGORITHM_SYSTEMATIC)) ||
         (config->gf_word_size != EC_GF_BITS) || (config->bricks != ec->nodes) ||
         (config->redundancy != ec->redundancy) ||
         (config->chunk_size != EC_METHOD_CHUNK_SIZE)) {
@@ -1593,6 +1600,35 @@ out:
     return found;
 }
 
+/* Algorithm of the files created from now on */
+uint8_t
+ec_config_algorithm(ec_t *ec)
+{
+    return ec->systematic ? EC_CONFIG_ALGORITHM_SYSTEMATIC
+                          : EC_CONFIG_ALGORITHM;
+}
+
+/* Tells how the data of a file is encoded. Regular files always have their
+ * config once the inode is locked. */
+gf_boolean_t
+ec_get_inode_systematic(ec_fop_data_t *fop, inode_t *inode)
+{
+    ec_inode_t *ctx;
+    gf_boolean_t systematic = _gf_false;
+
+    LOCK(&inode->lock);
+    {
+        ctx = __ec_inode_get(inode, fop->xl);
+        if ((ctx != NULL) && ctx->have_config) {
+            systematic = (ctx->config.algorithm ==
+                          EC_CONFIG_ALGORITHM_SYSTEMATIC);
+        }
+    }
+    UNLOCK(&inode->lock);
+
+    return systematic;
+}
+
 gf_boolean_t
 ec_get_inode_size(ec_fop_data_t *fop, inode_t *inode, uint64_t *size)
 {
@@ -1648,20 +1684,51 @@ ec_set_inode_size(ec_fop_data_t *fop, inode_t *inode, uint64_t size)
     return found;
 }
 
+void
+ec_stripe_cache_touch(ec_t *ec, ec_stripe_t *stripe, gf_boolean_t used)
+{
+    LOCK(&ec->stripes.lock);
+
+    if (used) {
+        list_move_tail(&stripe->global, &ec->stripes.lru);
+    } else {
+        list_move(&stripe->global, &ec->stripes.lru);
+    }
+
+    UNLOCK(&ec->stripes.lock);
+}
+
 static void
-ec_release_stripe_cache(ec_inode_t *ctx)
+ec_release_stripe_cache(ec_t *ec, ec_inode_t *ctx)
 {
     ec_stripe_list_t *stripe_cache = NULL;
     ec_stripe_t *stripe = NULL;
+    struct list_head list;
+
+    INIT_LIST_HEAD(&list);
 
     stripe_cache = &ctx->stripe_cache;
-    while (!list_empty(&stripe_cache->lru)) {
-        stripe = list_first_entry(&stripe_cache->lru, ec_stripe_t, lru);
-        list_del(&stripe->lru);
-        GF_FREE(stripe);
+    if (!list_empty(&stripe_cache->lru)) {
+        LOCK(&ec->stripes.lock);
+
+        while (!list_empty(&stripe_cache->lru)) {
+            stripe = list_first_entry(&stripe_cache->lru, ec_stripe_t, lru);
+            list_move_tail(&stripe->lru, &list);
+            list_del(&stripe->global);
+            ec->stripes.size -= EC_STRIPE_MEM_SIZE(ec);
+        }
+
+        UNLOCK(&ec->stripes.lock);
     }
     stripe_cache->count = 0;
     stripe_cache->max = 0;
+    stripe_cache->have_iatt = _gf_false;
+
+    while (!list_empty(&list)) {
+        stripe = list_first_entry(&list, ec_stripe_t, lru);
+        list_del(&stripe->lru);
+        GF_FREE(stripe);
+    }
 }
 
 void
@@ -1676,7 +1743,7 @@ ec_clear_inode_info(ec_fop_data_t *fop, inode_t *inode)
         goto unlock;
     }
 
-    ec_release_stripe_cache(ctx);
+    ec_release_stripe_cache(fop->xl->private, ctx);
     ctx->have_info = _gf_false;
     ctx->have_config = _gf_false;
     ctx->have_version = _gf_false;
@@ -1687,6 +1754,7 @@ ec_clear_inode_info(ec_fop_data_t *fop, inode_t *inode)
     memset(ctx->post_version, 0, sizeof(ctx->post_version));
     ctx->pre_size = ctx->post_size = 0;
     memset(ctx->dirty, 0, sizeof(ctx->dirty));
+    ctx->dirty_ranges = 0;
 
 unlock:
     UNLOCK(&inode->lock);
@@ -2140,6 +2208,14 @@ ec_lock_next_owner(ec_lock_link_t *link, ec_cbk_data_t *cbk,
 
     lock->release |= release;
 
+    /* Remember which ranges have been touched, even if the fop failed. If
+     * some brick doesn't get the next version update, self-heal will only
+     * need to repair these ranges. */
+    if (link->update[EC_DATA_TXN]) {
+        ctx->dirty_ranges |= ec_dirty_ranges_mask(link->fl_start,
+                                                  link->fl_end);
+    }
+
     if ((fop->error == 0) && (cbk != NULL) && (cbk->op_ret >= 0)) {
         if (link->update[0]) {
             ctx->post_version[0]++;
@@ -2369,6 +2445,21 @@ ec_update_size_version_done(call_frame_t *frame, void *cookie, xlator_t *this,
     return 0;
 }
 
+static int32_t
+ec_dirty_ranges_set(dict_t *dict, uint64_t version, uint64_t ranges)
+{
+    uint64_t counters[EC_DIRTY_RANGES_SIZE];
+    int32_t i;
+
+    counters[0] = version;
+    for (i = 0; i < EC_DIRTY_RANGES; i++) {
+        counters[i + 1] = (ranges >> i) & 1;
+    }
+
+    return ec_dict_set_array(dict, EC_XATTR_DIRTY_RANGES, counters,
+                             EC_DIRTY_RANGES_SIZE);
+}
+
 void
 ec_update_size_version(ec_lock_link_t *link, uint64_t *version, uint64_t size,
                        uint64_t *dirty)
@@ -2376,6 +2467,7 @@ ec_update_size_version(ec_lock_link_t *link, uint64_t *version, uint64_t size,
     ec_fop_data_t *fop;
     ec_lock_t *lock;
     ec_inode_t *ctx;
+    ec_t *ec;
     dict_t *dict = NULL;
     uintptr_t update_on = 0;
     int32_t err = -ENOMEM;
@@ -2383,6 +2475,7 @@ ec_update_size_version(ec_lock_link_t *link, uint64_t *version, uint64_t size,
     fop = link->fop;
     lock = link->lock;
     ctx = lock->ctx;
+    ec = fop->xl->private;
 
     ec_trace("UPDATE", fop, "version=%ld/%ld, size=%ld, dirty=%ld/%ld",
              version[0], version[1], size, dirty[0], dirty[1]);
@@ -2420,6 +2513,19 @@ ec_update_size_version(ec_lock_link_t *link, uint64_t *version, uint64_t size,
         }
     }
 
+    /* When the new data version of a file won't reach all bricks, account
+     * the ranges written since the last update on the bricks that get it. */
+    if ((version[EC_DATA_TXN] != 0) &&
+        (lock->loc.inode->ia_type == IA_IFREG) &&
+        ((ec->node_mask & ~lock->good_mask) != 0)) {
+        err = ec_dirty_ranges_set(dict, version[EC_DATA_TXN],
+                                  ctx->dirty_ranges);
+        if (err != 0) {
+            goto out;
+        }
+    }
+    ctx->dirty_ranges = 0;
+
     /* If config information is not known, we request it now. */
     if ((lock->loc.inode->ia_type == IA_IFREG) && !ctx->have_config) {
         /* A failure requesting this xattr is ignored because it's not
@@ -2874,15 +2980,22 @@ ec_update_stripe(ec_t *ec, ec_stripe_list_t *stripe_cache, ec_stripe_t *stripe,
             memcpy(stripe->data, fop->vector[0].iov_base + base,
                    ec->stripe_size);
             list_move_tail(&stripe->lru, &stripe_cache->lru);
+            ec_stripe_cache_touch(ec, stripe, _gf_true);
 
             GF_ATOMIC_INC(ec->stats.stripe_cache.updates);
-        }
-    } else {
-        stripe->frag_offset = -1;
-        list_move(&stripe->lru, &stripe_cache->lru);
 
-        GF_ATOMIC_INC(ec->stats.stripe_cache.invals);
+            return;
+        }
     }
+
+    /* Stripes are filled with the data of a write before it reaches the
+     * bricks (see ec_add_stripe_in_cache()). If that data has not been
+     * written, they must be dropped so that no read is answered with it. */
+    stripe->frag_offset = -1;
+    list_move(&stripe->lru, &stripe_cache->lru);
+    ec_stripe_cache_touch(ec, stripe, _gf_false);
+
+    GF_ATOMIC_INC(ec->stats.stripe_cache.invals);
 }
 
 static void
@@ -2940,6 +3053,49 @@ out:
     UNLOCK(&inode->lock);
 }
 
+/* Reads answered from the stripe cache need the attributes of the file. They
+ * are taken from the last read or write done while the inode is locked. Any
+ * other fop that modifies the inode makes them stale, so they are
+ * forgotten. */
+static void
+ec_update_cached_iatt(ec_fop_data_t *fop)
+{
+    ec_cbk_data_t *cbk = fop->answer;
+    struct iatt *iatt = NULL;
+    ec_lock_link_t *link;
+    ec_lock_t *lock;
+    int32_t i;
+
+    if ((fop->error == 0) && (cbk != NULL) && (cbk->op_ret >= 0)) {
+        if (fop->id == GF_FOP_READ) {
+            iatt = &cbk->iatt[0];
+        } else if (fop->id == GF_FOP_WRITE) {
+            iatt = &cbk->iatt[1];
+        }
+    }
+
+    for (i = 0; i < fop->lock_count; i++) {
+        link = &fop->locks[i];
+        if ((iatt == NULL) && !link->update[EC_DATA_TXN] &&
+            !link->update[EC_METADATA_TXN]) {
+            continue;
+        }
+
+        lock = link->lock;
+
+        LOCK(&lock->loc.inode->lock);
+
+        if (iatt != NULL) {
+            lock->ctx->stripe_cache.iatt = *iatt;
+            lock->ctx->stripe_cache.have_iatt = _gf_true;
+        } else {
+            lock->ctx->stripe_cache.have_iatt = _gf_false;
+        }
+
+        UNLOCK(&lock->loc.inode->lock);
+    }
+}
+
 void
 ec_lock_reuse(ec_fop_data_t *fop)
 {
@@ -2968,6 +3124,7 @@ ec_lock_reuse(ec_fop_data_t *fop)
         release = _gf_true;
     }
     ec_update_cached_stripes(fop);
+    ec_update_cached_iatt(fop);
 
     for (i = 0; i < fop->lock_count; i++) {
         ec_lock_next_owner(&fop->locks[i], cbk, release);
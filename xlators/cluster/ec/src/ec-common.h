@@ -22,9 +22,14 @@ typedef enum { EC_DATA_TXN, EC_METADATA_TXN } ec_txn_t;
 #define EC_CONFIG_VERSION 0
 
 #define EC_CONFIG_ALGORITHM 0
+/* The first fragments of each stripe are the data itself */
+#define EC_CONFIG_ALGORITHM_SYSTEMATIC 1
 
 #define EC_FLAG_LOCK_SHARED 0x0001
 
+/* Memory accounted to the global stripe cache for each cached stripe */
+#define EC_STRIPE_MEM_SIZE(ec) (sizeof(ec_stripe_t) + (ec)->stripe_size)
+
 #define QUORUM_CBK(fn, fop, frame, cookie, this, op_ret, op_errno, params...)  \
     do {                                                                       \
         ec_t *__ec = fop->xl->private;                                         \
@@ -165,6 +170,12 @@ ec_unlock(ec_fop_data_t *fop);
 void
 ec_lock_release(ec_t *ec, inode_t *inode);
 
+gf_boolean_t
+ec_config_check(xlator_t *xl, ec_config_t *config);
+uint8_t
+ec_config_algorithm(ec_t *ec);
+gf_boolean_t
+ec_get_inode_systematic(ec_fop_data_t *fop, inode_t *inode);
 gf_boolean_t
 ec_get_inode_size(ec_fop_data_t *fop, inode_t *inode, uint64_t *size);
 gf_boolean_t
@@ -176,6 +187,9 @@ __ec_set_inode_size(ec_fop_data_t *fop, inode_t *inode, uint64_t size);
 void
 ec_clear_inode_info(ec_fop_data_t *fop, inode_t *inode);
 
+void
+ec_stripe_cache_touch(ec_t *ec, ec_stripe_t *stripe, gf_boolean_t used);
+
 void
 ec_flush_size_version(ec_fop_data_t *fop);
 
@@ -142,7 +142,7 @@ ec_manager_create(ec_fop_data_t *fop, int32_t state)
             ec = fop->xl->private;
 
             config.version = EC_CONFIG_VERSION;
-            config.algorithm = EC_CONFIG_ALGORITHM;
+            config.algorithm = ec_config_algorithm(ec);
             config.gf_word_size = EC_GF_BITS;
             config.bricks = ec->nodes;
             config.redundancy = ec->redundancy;
@@ -711,7 +711,7 @@ ec_manager_mknod(ec_fop_data_t *fop, int32_t state)
                 ec = fop->xl->private;
 
                 config.version = EC_CONFIG_VERSION;
-                config.algorithm = EC_CONFIG_ALGORITHM;
+                config.algorithm = ec_config_algorithm(ec);
                 config.gf_word_size = EC_GF_BITS;
                 config.bricks = ec->nodes;
                 config.redundancy = ec->redundancy;
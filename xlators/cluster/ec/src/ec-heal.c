@@ -197,6 +197,25 @@ ec_heal_avoid(ec_fop_data_t *fop)
     UNLOCK(&heal->lock);
 }
 
+/* State shared by the tasks healing the data of a file. Each task takes the
+ * next block that needs to be healed and only locks its range, so several
+ * blocks of the same file are healed at the same time. */
+struct _ec_heal_ranges {
+    gf_lock_t lock;
+    syncbarrier_t barrier; /* woken when a task finishes */
+    call_frame_t *frame;
+    ec_t *ec;
+    fd_t *fd;
+    uint64_t offset; /* next block to heal */
+    uint64_t size;
+    uint64_t block;
+    uint64_t dirty; /* EC_DIRTY_RANGES that need to be healed */
+    uintptr_t good;
+    uintptr_t bad;
+    uint32_t locked; /* tasks holding the lock of a range */
+    int32_t error;
+};
+
 int32_t
 ec_heal_lock_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
                  int32_t op_ret, int32_t op_errno, dict_t *xdata)
@@ -205,13 +224,50 @@ ec_heal_lock_cbk(call_frame_t *frame, void *cookie, xlator_t *this,
     ec_heal_t *heal = fop->data;
 
     if (op_ret >= 0) {
+        if (heal->ranges != NULL) {
+            LOCK(&heal->ranges->lock);
+
+            heal->ranges->locked++;
+            heal->locked = _gf_true;
+        }
+
         GF_ASSERT(
             ec_set_inode_size(heal->fop, heal->fd->inode, heal->total_size));
+
+        if (heal->ranges != NULL) {
+            UNLOCK(&heal->ranges->lock);
+        }
     }
 
     return 0;
 }
 
+static void
+ec_heal_clear_inode_info(ec_heal_t *heal, inode_t *inode)
+{
+    ec_heal_ranges_t *ranges = heal->ranges;
+
+    if (ranges == NULL) {
+        ec_clear_inode_info(heal->fop, inode);
+
+        return;
+    }
+
+    /* Other tasks may still hold the lock of their range and need the
+     * size of the inode. The last one to unlock removes it. */
+    LOCK(&ranges->lock);
+
+    if (heal->locked) {
+        heal->locked = _gf_false;
+        ranges->locked--;
+    }
+    if (ranges->locked == 0) {
+        ec_clear_inode_info(heal->fop, inode);
+    }
+
+    UNLOCK(&ranges->lock);
+}
+
 void
 ec_heal_lock(ec_heal_t *heal, int32_t type, fd_t *fd, loc_t *loc, off_t offset,
              size_t size)
@@ -229,9 +285,9 @@ ec_heal_lock(ec_heal_t *heal, int32_t type, fd_t *fd, loc_t *loc, off_t offset,
     if (type == F_UNLCK) {
         /* Remove inode size information before unlocking it. */
         if (fd == NULL) {
-            ec_clear_inode_info(heal->fop, heal->loc.inode);
+            ec_heal_clear_inode_info(heal, heal->loc.inode);
         } else {
-            ec_clear_inode_info(heal->fop, heal->fd->inode);
+            ec_heal_clear_inode_info(heal, heal->fd->inode);
         }
         cbk = ec_lock_unlocked;
     } else {
@@ -1174,6 +1230,7 @@ ec_create_name(call_frame_t *frame, ec_t *ec, inode_t *parent, char *name,
     dict_t *xdata = NULL;
     char *linkname = NULL;
     ec_config_t config;
+    ec_config_t source;
 
     /* There should be just one gfid key */
     EC_REPLIES_ALLOC(replies, ec->nodes);
@@ -1277,12 +1334,23 @@ ec_create_name(call_frame_t *frame, ec_t *ec, inode_t *parent, char *name,
         case IA_IFREG:
             ec_set_new_entry_dirty(ec, &loc, ia, frame, ec->xl, on);
             config.version = EC_CONFIG_VERSION;
-            config.algorithm = EC_CONFIG_ALGORITHM;
+            config.algorithm = ec_config_algorithm(ec);
             config.gf_word_size = EC_GF_BITS;
             config.bricks = ec->nodes;
             config.redundancy = ec->redundancy;
             config.chunk_size = EC_METHOD_CHUNK_SIZE;
 
+            /* The new fragments must be encoded like the existing ones. */
+            for (i = 0; i < ec->nodes; i++) {
+                if (name_data.same[i] &&
+                    (ec_dict_del_config(lookup_replies[i].xdata,
+                                        EC_XATTR_CONFIG, &source) == 0) &&
+                    ec_config_check(ec->xl, &source)) {
+                    config = source;
+                    break;
+                }
+            }
+
             ret = ec_dict_set_config(xdata, EC_XATTR_CONFIG, &config);
             if (ret != 0) {
                 goto out;
@@ -1336,6 +1404,7 @@ __ec_heal_name(call_frame_t *frame, ec_t *ec, inode_t *parent, char *name,
     char gfid[64] = {0};
     unsigned char *same = NULL;
     unsigned char *gfidless = NULL;
+    dict_t *xattr_req = NULL;
 
     EC_REPLIES_ALLOC(replies, ec->nodes);
     loc.parent = inode_ref(parent);
@@ -1355,11 +1424,18 @@ __ec_heal_name(call_frame_t *frame, ec_t *ec, inode_t *parent, char *name,
         goto out;
     }
 
+    /* Needed to create missing files with the same config. */
+    xattr_req = dict_new();
+    if (!xattr_req || dict_set_uint64(xattr_req, EC_XATTR_CONFIG, 0)) {
+        ret = -ENOMEM;
+        goto out;
+    }
+
     output = alloca0(ec->nodes);
     gfidless = alloca0(ec->nodes);
     enoent = alloca0(ec->nodes);
     ret = cluster_lookup(ec->xl_list, participants, ec->nodes, replies, output,
-                         frame, ec->xl, &loc, NULL);
+                         frame, ec->xl, &loc, xattr_req);
     for (i = 0; i < ec->nodes; i++) {
         if (!replies[i].valid)
             continue;
@@ -1429,6 +1505,8 @@ out:
     loc_wipe(&loc);
     if (xdata)
         dict_unref(xdata);
+    if (xattr_req)
+        dict_unref(xattr_req);
     if (gfid_db)
         dict_unref(gfid_db);
     return ret;
@@ -1789,7 +1867,7 @@ __ec_heal_data_prepare(call_frame_t *frame, ec_t *ec, fd_t *fd,
                        unsigned char *locked_on, uint64_t *versions,
                        uint64_t *dirty, uint64_t *size, unsigned char *sources,
                        unsigned char *healed_sinks, unsigned char *trim,
-                       struct iatt *stbuf)
+                       struct iatt *stbuf, uint64_t *ranges)
 {
     default_args_cbk_t *replies = NULL;
     default_args_cbk_t *fstat_replies = NULL;
@@ -1797,6 +1875,7 @@ __ec_heal_data_prepare(call_frame_t *frame, ec_t *ec, fd_t *fd,
     unsigned char *fstat_output = NULL;
     dict_t *xattrs = NULL;
     uint64_t zero_array[2] = {0};
+    uint64_t zero_ranges[EC_DIRTY_RANGES_SIZE] = {0};
     int source = 0;
     int ret = 0;
     uint64_t zero_value = 0;
@@ -1817,6 +1896,12 @@ __ec_heal_data_prepare(call_frame_t *frame, ec_t *ec, fd_t *fd,
         ret = -ENOMEM;
         goto out;
     }
+    if ((ranges != NULL) &&
+        dict_set_static_bin(xattrs, EC_XATTR_DIRTY_RANGES, zero_ranges,
+                            sizeof(zero_ranges))) {
+        ret = -ENOMEM;
+        goto out;
+    }
 
     ret = cluster_fxattrop(ec->xl_list, locked_on, ec->nodes, replies, output,
                            frame, ec->xl, fd, GF_XATTROP_ADD_ARRAY64, xattrs,
@@ -1830,6 +1915,11 @@ __ec_heal_data_prepare(call_frame_t *frame, ec_t *ec, fd_t *fd,
         replies[i].valid = output[i];
         if (output[i])
             replies[i].stat = fstat_replies[i].stat;
+        /* Bricks without the xattr have nothing pending to be healed. */
+        if (ranges && output[i])
+            (void)ec_dict_get_array(replies[i].xattr, EC_XATTR_DIRTY_RANGES,
+                                    &ranges[i * EC_DIRTY_RANGES_SIZE],
+                                    EC_DIRTY_RANGES_SIZE);
     }
 
     if (EC_COUNT(output, ec->nodes) <= ec->fragments) {
@@ -1948,13 +2038,17 @@ int32_t
 ec_manager_heal_block(ec_fop_data_t *fop, int32_t state)
 {
     ec_heal_t *heal = fop->data;
+    ec_t *ec = fop->xl->private;
     heal->fop = fop;
 
     switch (state) {
         case EC_STATE_INIT:
             ec_owner_set(fop->frame, fop->frame->root);
 
-            ec_heal_inodelk(heal, F_WRLCK, 1, 0, 0);
+            /* Only the range being healed is locked. Offset and size are
+             * multiples of the stripe size. */
+            ec_heal_inodelk(heal, F_WRLCK, 1, heal->offset / ec->fragments,
+                            heal->size / ec->fragments);
 
             return EC_STATE_HEAL_DATA_COPY;
 
@@ -1968,7 +2062,8 @@ ec_manager_heal_block(ec_fop_data_t *fop, int32_t state)
         case -EC_STATE_HEAL_DATA_COPY:
         case -EC_STATE_HEAL_DATA_UNLOCK:
         case EC_STATE_HEAL_DATA_UNLOCK:
-            ec_heal_inodelk(heal, F_UNLCK, 1, 0, 0);
+            ec_heal_inodelk(heal, F_UNLCK, 1, heal->offset / ec->fragments,
+                            heal->size / ec->fragments);
 
             return EC_STATE_REPORT;
 
@@ -2055,63 +2150,183 @@ ec_sync_heal_block(call_frame_t *frame, xlator_t *this, ec_heal_t *heal)
     return 0;
 }
 
-int
-ec_rebuild_data(call_frame_t *frame, ec_t *ec, fd_t *fd, uint64_t size,
-                unsigned char *sources, unsigned char *healed_sinks)
+/* Gets the next block that needs to be healed. Returns false when there's
+ * nothing left or the heal has failed. */
+static gf_boolean_t
+ec_heal_range_next(ec_heal_ranges_t *ranges, ec_heal_t *heal)
+{
+    ec_t *ec = ranges->ec;
+    uint64_t mask;
+    gf_boolean_t found = _gf_false;
+
+    LOCK(&ranges->lock);
+
+    /* Sinks that failed in any task are not healed anymore. */
+    ranges->bad &= heal->bad;
+    heal->bad = ranges->bad;
+
+    /* A read returning no data means that the end of file has been
+     * reached. */
+    if (heal->done) {
+        ranges->offset = ranges->size;
+    }
+
+    /* We immediately abort any heal if a shutdown request has been
+     * received to avoid delays. The healing of this file will be
+     * restarted by another SHD or other client that accesses the
+     * file. */
+    if (ec->shutdown && (ranges->error == 0)) {
+        gf_msg_debug(ec->xl->name, 0,
+                     "Cancelling heal because "
+                     "EC is stopping.");
+        ranges->error = -ENOTCONN;
+    }
+
+    while ((ranges->error == 0) && (ranges->offset < ranges->size)) {
+        heal->offset = ranges->offset;
+        ranges->offset += ranges->block;
+
+        mask = ec_dirty_ranges_mask(
+            heal->offset / ec->fragments,
+            (heal->offset + ranges->block) / ec->fragments - 1);
+        if ((mask & ranges->dirty) != 0) {
+            found = _gf_true;
+            break;
+        }
+    }
+
+    UNLOCK(&ranges->lock);
+
+    return found;
+}
+
+static int
+ec_heal_range_run(ec_heal_ranges_t *ranges)
 {
+    ec_t *ec = ranges->ec;
     ec_heal_t *heal = NULL;
-    int ret = 0;
     syncbarrier_t barrier;
+    int ret = 0;
 
-    if (syncbarrier_init(&barrier))
-        return -ENOMEM;
+    if (syncbarrier_init(&barrier)) {
+        ret = -ENOMEM;
+        goto out;
+    }
 
     heal = alloca0(sizeof(*heal));
-    heal->fd = fd_ref(fd);
+    heal->fd = fd_ref(ranges->fd);
     heal->xl = ec->xl;
     heal->data = &barrier;
+    heal->ranges = ranges;
+    heal->total_size = ranges->size;
+    heal->size = ranges->block;
+    heal->bad = ranges->bad;
+    heal->good = ranges->good;
+    heal->iatt.ia_type = IA_IFREG;
+    LOCK_INIT(&heal->lock);
+
+    while (ec_heal_range_next(ranges, heal)) {
+        gf_msg_debug(ec->xl->name, 0,
+                     "%s: good: %lX, bad: %lX, offset: %" PRIu64
+                     " bsize: %" PRIu64,
+                     uuid_utoa(ranges->fd->inode->gfid), heal->good, heal->bad,
+                     heal->offset, heal->size);
+        ret = ec_sync_heal_block(ranges->frame, ec->xl, heal);
+        if (ret < 0)
+            break;
+    }
+
+    fd_unref(heal->fd);
+    LOCK_DESTROY(&heal->lock);
+    syncbarrier_destroy(&barrier);
+
+out:
+    LOCK(&ranges->lock);
+
+    if (heal != NULL) {
+        ranges->bad &= heal->bad;
+    }
+    if ((ret < 0) && (ranges->error == 0)) {
+        ranges->error = ret;
+    }
+
+    UNLOCK(&ranges->lock);
+
+    return ret;
+}
+
+static int
+ec_heal_range_task(void *data)
+{
+    return ec_heal_range_run(data);
+}
+
+static int
+ec_heal_range_task_done(int ret, call_frame_t *frame, void *data)
+{
+    ec_heal_ranges_t *ranges = data;
+
+    syncbarrier_wake(&ranges->barrier);
+
+    return 0;
+}
+
+int
+ec_rebuild_data(call_frame_t *frame, ec_t *ec, fd_t *fd, uint64_t size,
+                unsigned char *sources, unsigned char *healed_sinks,
+                uint64_t dirty)
+{
+    ec_heal_ranges_t ranges;
+    uint64_t blocks;
+    uint32_t tasks;
+    uint32_t started = 0;
+    int ret = 0;
+
+    memset(&ranges, 0, sizeof(ranges));
+    if (syncbarrier_init(&ranges.barrier))
+        return -ENOMEM;
+
+    LOCK_INIT(&ranges.lock);
+    ranges.frame = frame;
+    ranges.ec = ec;
+    ranges.fd = fd;
     ec_adjust_size_up(ec, &size, _gf_false);
-    heal->total_size = size;
-    heal->size = (128 * GF_UNIT_KB * (ec->self_heal_window_size));
+    ranges.size = size;
+    ranges.block = (128 * GF_UNIT_KB * (ec->self_heal_window_size));
     /* We need to adjust the size to a multiple of the stripe size of the
      * volume. Otherwise writes would need to fill gaps (head and/or tail)
      * with existent data from the bad bricks. This could be garbage on a
      * damaged file or it could fail if there aren't enough bricks. */
-    heal->size -= heal->size % ec->stripe_size;
-    heal->bad = ec_char_array_to_mask(healed_sinks, ec->nodes);
-    heal->good = ec_char_array_to_mask(sources, ec->nodes);
-    heal->iatt.ia_type = IA_IFREG;
-    LOCK_INIT(&heal->lock);
-
-    for (heal->offset = 0; (heal->offset < size) && !heal->done;
-         heal->offset += heal->size) {
-        /* We immediately abort any heal if a shutdown request has been
-         * received to avoid delays. The healing of this file will be
-         * restarted by another SHD or other client that accesses the
-         * file. */
-        if (ec->shutdown) {
-            gf_msg_debug(ec->xl->name, 0,
-                         "Cancelling heal because "
-                         "EC is stopping.");
-            ret = -ENOTCONN;
+    ranges.block -= ranges.block % ec->stripe_size;
+    ranges.dirty = dirty;
+    ranges.bad = ec_char_array_to_mask(healed_sinks, ec->nodes);
+    ranges.good = ec_char_array_to_mask(sources, ec->nodes);
+
+    /* The current task also heals blocks, so only the additional ones are
+     * started, and never more than blocks there are. */
+    tasks = ec->heal_range_tasks;
+    blocks = (size + ranges.block - 1) / ranges.block;
+    if (tasks > blocks) {
+        tasks = blocks;
+    }
+    while (started + 1 < tasks) {
+        if (synctask_new(ec->xl->ctx->env, ec_heal_range_task,
+                         ec_heal_range_task_done, NULL, &ranges) != 0) {
             break;
         }
+        started++;
+    }
 
-        gf_msg_debug(ec->xl->name, 0,
-                     "%s: sources: %d, sinks: "
-                     "%d, offset: %" PRIu64 " bsize: %" PRIu64,
-                     uuid_utoa(fd->inode->gfid), EC_COUNT(sources, ec->nodes),
-                     EC_COUNT(healed_sinks, ec->nodes), heal->offset,
-                     heal->size);
-        ret = ec_sync_heal_block(frame, ec->xl, heal);
-        if (ret < 0)
-            break;
+    ec_heal_range_run(&ranges);
+    if (started > 0) {
+        syncbarrier_wait(&ranges.barrier, started);
     }
+    ret = ranges.error;
+
     memset(healed_sinks, 0, ec->nodes);
-    ec_mask_to_char_array(heal->bad, healed_sinks, ec->nodes);
-    fd_unref(heal->fd);
-    LOCK_DESTROY(&heal->lock);
-    syncbarrier_destroy(heal->data);
+    ec_mask_to_char_array(ranges.bad, healed_sinks, ec->nodes);
+    LOCK_DESTROY(&ranges.lock);
+    syncbarrier_destroy(&ranges.barrier);
     if (ret < 0)
         gf_msg_debug(ec->xl->name, 0, "%s: heal failed %s",
                      uuid_utoa(fd->inode->gfid), strerror(-ret));
@@ -2161,13 +2376,17 @@ out:
 int
 ec_data_undo_pending(call_frame_t *frame, ec_t *ec, fd_t *fd, dict_t *xattr,
                      uint64_t *versions, uint64_t *dirty, uint64_t *size,
-                     int source, gf_boolean_t erase_dirty, int idx)
+                     int source, gf_boolean_t erase_dirty, int idx,
+                     uint64_t *ranges)
 {
     uint64_t versions_xattr[2] = {0};
     uint64_t dirty_xattr[2] = {0};
     uint64_t allzero[2] = {0};
+    uint64_t ranges_xattr[EC_DIRTY_RANGES_SIZE] = {0};
     uint64_t size_xattr = 0;
+    gf_boolean_t reset_ranges = _gf_false;
     int ret = 0;
+    int i = 0;
 
     versions_xattr[EC_DATA_TXN] = hton64(versions[source] - versions[idx]);
     ret = dict_set_static_bin(xattr, EC_XATTR_VERSION, versions_xattr,
@@ -2187,11 +2406,25 @@ ec_data_undo_pending(call_frame_t *frame, ec_t *ec, fd_t *fd, dict_t *xattr,
                                   sizeof(dirty_xattr));
         if (ret < 0)
             goto out;
+
+        /* All bricks are healthy now. Forget the ranges that were pending
+         * when the heal started. */
+        if (ranges != NULL) {
+            for (i = 0; i < EC_DIRTY_RANGES_SIZE; i++) {
+                ranges_xattr[i] = -ranges[idx * EC_DIRTY_RANGES_SIZE + i];
+                if (ranges_xattr[i] != 0)
+                    reset_ranges = _gf_true;
+            }
+            ret = ec_dict_set_array(xattr, EC_XATTR_DIRTY_RANGES, ranges_xattr,
+                                    EC_DIRTY_RANGES_SIZE);
+            if (ret < 0)
+                goto out;
+        }
     }
 
     if ((memcmp(versions_xattr, allzero, sizeof(allzero)) == 0) &&
         (memcmp(dirty_xattr, allzero, sizeof(allzero)) == 0) &&
-        (size_xattr == 0)) {
+        (size_xattr == 0) && !reset_ranges) {
         ret = 0;
         goto out;
     }
@@ -2206,7 +2439,7 @@ int
 __ec_fd_data_adjust_versions(call_frame_t *frame, ec_t *ec, fd_t *fd,
                              unsigned char *sources,
                              unsigned char *healed_sinks, uint64_t *versions,
-                             uint64_t *dirty, uint64_t *size)
+                             uint64_t *dirty, uint64_t *size, uint64_t *ranges)
 {
     dict_t *xattr = NULL;
     int i = 0;
@@ -2242,7 +2475,7 @@ __ec_fd_data_adjust_versions(call_frame_t *frame, ec_t *ec, fd_t *fd,
     for (i = 0; i < ec->nodes; i++) {
         if (healed_sinks[i]) {
             ret = ec_data_undo_pending(frame, ec, fd, xattr, versions, dirty,
-                                       size, source, erase_dirty, i);
+                                       size, source, erase_dirty, i, ranges);
             if (ret < 0)
                 goto out;
         }
@@ -2254,7 +2487,7 @@ __ec_fd_data_adjust_versions(call_frame_t *frame, ec_t *ec, fd_t *fd,
     for (i = 0; i < ec->nodes; i++) {
         if (sources[i]) {
             ret = ec_data_undo_pending(frame, ec, fd, xattr, versions, dirty,
-                                       size, source, erase_dirty, i);
+                                       size, source, erase_dirty, i, ranges);
             if (ret < 0)
                 continue;
         }
@@ -2270,7 +2503,7 @@ ec_restore_time_and_adjust_versions(call_frame_t *frame, ec_t *ec, fd_t *fd,
                                     unsigned char *sources,
                                     unsigned char *healed_sinks,
                                     uint64_t *versions, uint64_t *dirty,
-                                    uint64_t *size)
+                                    uint64_t *size, uint64_t *ranges)
 {
     unsigned char *locked_on = NULL;
     unsigned char *participants = NULL;
@@ -2320,7 +2553,7 @@ ec_restore_time_and_adjust_versions(call_frame_t *frame, ec_t *ec, fd_t *fd,
         ret = __ec_heal_data_prepare(frame, ec, fd, locked_on, postsh_versions,
                                      postsh_dirty, postsh_size, postsh_sources,
                                      postsh_healed_sinks, postsh_trim,
-                                     &source_buf);
+                                     &source_buf, NULL);
         if (ret < 0)
             goto unlock;
 
@@ -2336,7 +2569,7 @@ ec_restore_time_and_adjust_versions(call_frame_t *frame, ec_t *ec, fd_t *fd,
             goto unlock;
         }
         ret = __ec_fd_data_adjust_versions(frame, ec, fd, sources, healed_sinks,
-                                           versions, dirty, size);
+                                           versions, dirty, size, ranges);
     }
 unlock:
     cluster_uninodelk(ec->xl_list, locked_on, ec->nodes, replies, output, frame,
@@ -2346,6 +2579,43 @@ unlock:
     return ret;
 }
 
+/* Returns the EC_DIRTY_RANGES that need to be healed. Unless the counters of
+ * the source account for all the versions missed by every sink, nothing is
+ * known about the ranges that changed and the whole file is healed. */
+static uint64_t
+ec_heal_dirty_ranges(ec_t *ec, uint64_t *ranges, uint64_t *versions,
+                     int source, unsigned char *healed_sinks)
+{
+    uint64_t *counters = &ranges[source * EC_DIRTY_RANGES_SIZE];
+    uint64_t missing = 0;
+    uint64_t mask = 0;
+    int i = 0;
+
+    if (!ec->heal_dirty_ranges) {
+        return ~0ULL;
+    }
+
+    for (i = 0; i < ec->nodes; i++) {
+        if (!healed_sinks[i]) {
+            continue;
+        }
+
+        missing = versions[i] & ~(1ULL << EC_SELFHEAL_BIT);
+        if ((missing >= versions[source]) ||
+            (versions[source] - missing > counters[0])) {
+            return ~0ULL;
+        }
+    }
+
+    for (i = 0; i < EC_DIRTY_RANGES; i++) {
+        if (counters[i + 1] != 0) {
+            mask |= 1ULL << i;
+        }
+    }
+
+    return mask;
+}
+
 int
 __ec_heal_data(call_frame_t *frame, ec_t *ec, fd_t *fd, unsigned char *heal_on,
                unsigned char *sources, unsigned char *healed_sinks)
@@ -2355,6 +2625,8 @@ __ec_heal_data(call_frame_t *frame, ec_t *ec, fd_t *fd, unsigned char *heal_on,
     uint64_t *versions = NULL;
     uint64_t *dirty = NULL;
     uint64_t *size = NULL;
+    uint64_t *ranges = NULL;
+    uint64_t heal_ranges = ~0ULL;
     unsigned char *trim = NULL;
     default_args_cbk_t *replies = NULL;
     int ret = 0;
@@ -2368,6 +2640,13 @@ __ec_heal_data(call_frame_t *frame, ec_t *ec, fd_t *fd, unsigned char *heal_on,
     size = alloca0(ec->nodes * sizeof(*size));
 
     EC_REPLIES_ALLOC(replies, ec->nodes);
+    ranges = GF_CALLOC(ec->nodes * EC_DIRTY_RANGES_SIZE, sizeof(*ranges),
+                       gf_common_mt_char);
+    if (!ranges) {
+        ret = -ENOMEM;
+        goto out;
+    }
+
     ret = cluster_inodelk(ec->xl_list, heal_on, ec->nodes, replies, locked_on,
                           frame, ec->xl, ec->xl->name, fd->inode, 0, 0);
     {
@@ -2382,17 +2661,21 @@ __ec_heal_data(call_frame_t *frame, ec_t *ec, fd_t *fd, unsigned char *heal_on,
         }
 
         ret = __ec_heal_data_prepare(frame, ec, fd, locked_on, versions, dirty,
-                                     size, sources, healed_sinks, trim, NULL);
+                                     size, sources, healed_sinks, trim, NULL,
+                                     ranges);
         if (ret < 0)
             goto unlock;
 
         if (EC_COUNT(healed_sinks, ec->nodes) == 0) {
-            ret = __ec_fd_data_adjust_versions(
-                frame, ec, fd, sources, healed_sinks, versions, dirty, size);
+            ret = __ec_fd_data_adjust_versions(frame, ec, fd, sources,
+                                               healed_sinks, versions, dirty,
+                                               size, ranges);
             goto unlock;
         }
 
         source = ret;
+        heal_ranges = ec_heal_dirty_ranges(ec, ranges, versions, source,
+                                           healed_sinks);
         ret = __ec_heal_mark_sinks(frame, ec, fd, versions, healed_sinks);
         if (ret < 0)
             goto unlock;
@@ -2411,18 +2694,21 @@ unlock:
 
     gf_msg_debug(ec->xl->name, 0,
                  "%s: sources: %d, sinks: "
-                 "%d",
+                 "%d, ranges: %" PRIx64,
                  uuid_utoa(fd->inode->gfid), EC_COUNT(sources, ec->nodes),
-                 EC_COUNT(healed_sinks, ec->nodes));
+                 EC_COUNT(healed_sinks, ec->nodes), heal_ranges);
 
-    ret = ec_rebuild_data(frame, ec, fd, size[source], sources, healed_sinks);
+    ret = ec_rebuild_data(frame, ec, fd, size[source], sources, healed_sinks,
+                          heal_ranges);
     if (ret < 0)
         goto out;
 
-    ret = ec_restore_time_and_adjust_versions(
-        frame, ec, fd, sources, healed_sinks, versions, dirty, size);
+    ret = ec_restore_time_and_adjust_versions(frame, ec, fd, sources,
+                                              healed_sinks, versions, dirty,
+                                              size, ranges);
 out:
     cluster_replies_wipe(replies, ec->nodes);
+    GF_FREE(ranges);
     return ret;
 }
 
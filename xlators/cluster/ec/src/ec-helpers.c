@@ -844,6 +844,32 @@ ec_is_data_fop(glusterfs_fop_t fop)
     }
     return _gf_false;
 }
+
+/* Returns the bitmap of the EC_DIRTY_RANGES touched by the fragment bytes
+ * from start to end, both included. */
+uint64_t
+ec_dirty_ranges_mask(off_t start, off_t end)
+{
+    uint64_t mask = 0;
+    uint64_t first, last;
+
+    if (end < start) {
+        return 0;
+    }
+
+    first = start / EC_DIRTY_RANGE_SIZE;
+    last = end / EC_DIRTY_RANGE_SIZE;
+    if (last - first >= EC_DIRTY_RANGES - 1) {
+        return ~0ULL;
+    }
+
+    while (first <= last) {
+        mask |= 1ULL << (first % EC_DIRTY_RANGES);
+        first++;
+    }
+
+    return mask;
+}
 /*
 gf_boolean_t
 ec_is_metadata_fop (int32_t lock_kind, glusterfs_fop_t fop)
@@ -194,6 +194,9 @@ ec_filter_internal_xattrs(dict_t *xattr);
 gf_boolean_t
 ec_is_data_fop(glusterfs_fop_t fop);
 
+uint64_t
+ec_dirty_ranges_mask(off_t start, off_t end);
+
 int32_t
 ec_launch_replace_heal(ec_t *ec);
 
@@ -1193,8 +1193,9 @@ ec_readv_rebuild(ec_t *ec, ec_fop_data_t *fop, ec_cbk_data_t *cbk)
             goto out;
         }
 
-        err = ec_method_decode(&ec->matrix, fsize, cbk->mask, values, blocks,
-                               ptr);
+        err = ec_method_decode(&ec->matrix,
+                               ec_get_inode_systematic(fop, fop->fd->inode),
+                               fsize, cbk->mask, values, blocks, ptr);
         if (err != 0) {
             goto out;
         }
@@ -1348,6 +1349,137 @@ ec_wind_readv(ec_t *ec, ec_fop_data_t *fop, int32_t idx)
                       fop->size, fop->offset, fop->uint32, fop->xdata);
 }
 
+static ec_stripe_t *
+__ec_readv_cached_stripe(ec_inode_t *ctx, uint64_t frag_offset)
+{
+    ec_stripe_t *stripe = NULL;
+
+    list_for_each_entry(stripe, &ctx->stripe_cache.lru, lru)
+    {
+        if (stripe->frag_offset == frag_offset) {
+            return stripe;
+        }
+    }
+
+    return NULL;
+}
+
+/* Reads of stripes recently written through this client are answered from
+ * the stripe cache. This is only valid while the inode lock is held, since it
+ * guarantees that no other client has modified the file. Stripes past the end
+ * of the file are not needed. */
+static gf_boolean_t
+ec_readv_from_cache(ec_t *ec, ec_fop_data_t *fop)
+{
+    ec_cbk_data_t *cbk = NULL;
+    ec_inode_t *ctx = NULL;
+    ec_stripe_t *stripe = NULL;
+    struct iobref *iobref = NULL;
+    struct iovec vector[1];
+    struct iovec *vec = NULL;
+    struct iatt iatt;
+    uint64_t first, last, offset, size, start, eof;
+    void *ptr = NULL;
+    gf_boolean_t found = _gf_false;
+
+    if (!ec->stripe_cache || (fop->parent != NULL)) {
+        return _gf_false;
+    }
+
+    first = fop->offset;
+    last = fop->offset + fop->size;
+
+    LOCK(&fop->fd->inode->lock);
+
+    ctx = __ec_inode_get(fop->fd->inode, fop->xl);
+    if ((ctx == NULL) || !ctx->stripe_cache.have_iatt ||
+        !__ec_get_inode_size(fop, fop->fd->inode, &size)) {
+        goto unlock;
+    }
+
+    eof = (size + ec->stripe_size - 1) / ec->stripe_size * ec->fragment_size;
+    if (last > eof) {
+        last = eof;
+    }
+    if ((first >= last) ||
+        ((last - first) / ec->fragment_size > ctx->stripe_cache.count)) {
+        goto unlock;
+    }
+
+    for (offset = first; offset < last; offset += ec->fragment_size) {
+        if (__ec_readv_cached_stripe(ctx, offset) == NULL) {
+            goto unlock;
+        }
+    }
+
+    if (ec_buffer_alloc(ec->xl, (last - first) * ec->fragments, &iobref,
+                        &ptr) != 0) {
+        GF_ATOMIC_INC(ec->stats.stripe_cache.errors);
+
+        goto unlock;
+    }
+
+    for (offset = first; offset < last; offset += ec->fragment_size) {
+        stripe = __ec_readv_cached_stripe(ctx, offset);
+        memcpy(ptr + (offset - first) * ec->fragments, stripe->data,
+               ec->stripe_size);
+        list_move_tail(&stripe->lru, &ctx->stripe_cache.lru);
+        ec_stripe_cache_touch(ec, stripe, _gf_true);
+    }
+
+    iatt = ctx->stripe_cache.iatt;
+    iatt.ia_size = size;
+    found = _gf_true;
+
+unlock:
+    UNLOCK(&fop->fd->inode->lock);
+
+    if (!found) {
+        GF_ATOMIC_INC(ec->stats.stripe_cache.read_misses);
+
+        return _gf_false;
+    }
+
+    /* Same trimming as ec_readv_rebuild() */
+    start = first * ec->fragments + fop->head;
+    size = (start < iatt.ia_size) ? iatt.ia_size - start : 0;
+    if (size > (last - first) * ec->fragments - fop->head) {
+        size = (last - first) * ec->fragments - fop->head;
+    }
+    if (size > fop->user_size) {
+        size = fop->user_size;
+    }
+
+    vector[0].iov_base = ptr + fop->head;
+    vector[0].iov_len = size;
+    vec = iov_dup(vector, 1);
+    if (vec != NULL) {
+        cbk = ec_cbk_data_allocate(fop->frame, fop->xl, fop, GF_FOP_READ, 0,
+                                   size, 0);
+    }
+    if (cbk == NULL) {
+        GF_FREE(vec);
+        iobref_unref(iobref);
+        GF_ATOMIC_INC(ec->stats.stripe_cache.errors);
+
+        return _gf_false;
+    }
+
+    cbk->vector = vec;
+    cbk->int32 = 1;
+    cbk->buffers = iobref;
+    cbk->iatt[0] = iatt;
+
+    /* No brick has been contacted, so the good mask of the lock must not be
+     * updated. */
+    fop->expected = 1;
+    fop->answer = cbk;
+
+    GF_ATOMIC_INC(ec->stats.stripe_cache.read_hits);
+
+    return _gf_true;
+}
+
 int32_t
 ec_manager_readv(ec_fop_data_t *fop, int32_t state)
 {
@@ -1372,6 +1504,10 @@ ec_manager_readv(ec_fop_data_t *fop, int32_t state)
             return EC_STATE_DISPATCH;
 
         case EC_STATE_DISPATCH:
+            if (ec_readv_from_cache(ec, fop)) {
+                return EC_STATE_REPORT;
+            }
+
             if (ec->read_mask) {
                 fop->mask &= ec->read_mask;
             }
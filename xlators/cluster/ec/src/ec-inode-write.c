@@ -1659,26 +1659,90 @@ out:
 }
 
 /* FOP: writev */
+
+/* Discards the least recently used stripes of any inode until the global
+ * cache fits in its memory budget. Must be called with the inode lock of
+ * 'inode' and the global stripe cache lock held. Other inodes are only
+ * try-locked because the usual lock order is the opposite. Stripes that can
+ * be discarded are moved to 'evicted' to be released without locks. */
+static void
+__ec_evict_stripes(ec_t *ec, inode_t *inode, ec_stripe_t *keep,
+                   struct list_head *evicted)
+{
+    ec_stripe_t *stripe, *tmp;
+    ec_inode_t *ctx;
+
+    list_for_each_entry_safe(stripe, tmp, &ec->stripes.lru, global)
+    {
+        if ((ec->stripes.size <= ec->stripes.max) || (stripe == keep)) {
+            break;
+        }
+
+        /* A stripe is removed from the cache before its inode is forgotten,
+         * so the inode is still valid while we hold the global lock. */
+        if ((stripe->inode != inode) && (TRY_LOCK(&stripe->inode->lock) != 0)) {
+            continue;
+        }
+
+        ctx = __ec_inode_get(stripe->inode, ec->xl);
+        if (ctx != NULL) {
+            ctx->stripe_cache.count--;
+            list_move_tail(&stripe->lru, evicted);
+            list_del(&stripe->global);
+            ec->stripes.size -= EC_STRIPE_MEM_SIZE(ec);
+
+            GF_ATOMIC_INC(ec->stats.stripe_cache.evicts);
+        }
+
+        if (stripe->inode != inode) {
+            UNLOCK(&stripe->inode->lock);
+        }
+    }
+}
+
 static ec_stripe_t *
-ec_allocate_stripe(ec_t *ec, ec_stripe_list_t *stripe_cache)
+ec_allocate_stripe(ec_t *ec, inode_t *inode, ec_stripe_list_t *stripe_cache)
 {
     ec_stripe_t *stripe = NULL;
+    ec_stripe_t *victim = NULL;
+    struct list_head evicted;
 
     if (stripe_cache->count >= stripe_cache->max) {
         GF_ASSERT(!list_empty(&stripe_cache->lru));
         stripe = list_first_entry(&stripe_cache->lru, ec_stripe_t, lru);
         list_move_tail(&stripe->lru, &stripe_cache->lru);
+        ec_stripe_cache_touch(ec, stripe, _gf_true);
         GF_ATOMIC_INC(ec->stats.stripe_cache.evicts);
-    } else {
-        stripe = GF_MALLOC(sizeof(ec_stripe_t) + ec->stripe_size,
-                           ec_mt_ec_stripe_t);
-        if (stripe != NULL) {
-            stripe_cache->count++;
-            list_add_tail(&stripe->lru, &stripe_cache->lru);
-            GF_ATOMIC_INC(ec->stats.stripe_cache.allocs);
-        } else {
-            GF_ATOMIC_INC(ec->stats.stripe_cache.errors);
-        }
+
+        return stripe;
+    }
+
+    stripe = GF_MALLOC(EC_STRIPE_MEM_SIZE(ec), ec_mt_ec_stripe_t);
+    if (stripe == NULL) {
+        GF_ATOMIC_INC(ec->stats.stripe_cache.errors);
+
+        return NULL;
+    }
+
+    stripe->inode = inode;
+    stripe_cache->count++;
+    list_add_tail(&stripe->lru, &stripe_cache->lru);
+    GF_ATOMIC_INC(ec->stats.stripe_cache.allocs);
+
+    INIT_LIST_HEAD(&evicted);
+
+    LOCK(&ec->stripes.lock);
+
+    list_add_tail(&stripe->global, &ec->stripes.lru);
+    ec->stripes.size += EC_STRIPE_MEM_SIZE(ec);
+    __ec_evict_stripes(ec, inode, stripe, &evicted);
+
+    UNLOCK(&ec->stripes.lock);
+
+    while (!list_empty(&evicted)) {
+        victim = list_first_entry(&evicted, ec_stripe_t, lru);
+        list_del(&victim->lru);
+        GF_FREE(victim);
     }
 
     return stripe;
@@ -1710,8 +1774,8 @@ ec_add_stripe_in_cache(ec_t *ec, ec_fop_data_t *fop)
     }
 
     stripe_cache = &ctx->stripe_cache;
-    if (stripe_cache->max > 0) {
-        stripe = ec_allocate_stripe(ec, stripe_cache);
+    if ((stripe_cache->max > 0) && (ec->stripes.max > 0)) {
+        stripe = ec_allocate_stripe(ec, fop->fd->inode, stripe_cache);
         if (stripe == NULL) {
             goto out;
         }
@@ -1730,6 +1794,33 @@ out:
     }
 }
 
+/* Merges the tail stripe, found 'skip' bytes into the data read */
+static void
+ec_writev_merge_tail_at(ec_t *ec, ec_fop_data_t *fop, int32_t op_ret,
+                        struct iovec *vector, int32_t count, uint64_t skip)
+{
+    uint64_t size, base, tmp;
+
+    tmp = 0;
+    size = fop->size - fop->user_size - fop->head;
+    base = ec->stripe_size - size;
+    if (op_ret > skip + base) {
+        tmp = min(op_ret - skip - base, size);
+        ec_iov_copy_to(fop->vector[0].iov_base + fop->size - size, vector,
+                       count, skip + base, tmp);
+
+        size -= tmp;
+    }
+
+    if (size > 0) {
+        memset(fop->vector[0].iov_base + fop->size - size, 0, size);
+    }
+
+    if (ec->stripe_cache) {
+        ec_add_stripe_in_cache(ec, fop);
+    }
+}
+
 int32_t
 ec_writev_merge_tail(call_frame_t *frame, void *cookie, xlator_t *this,
                      int32_t op_ret, int32_t op_errno, struct iovec *vector,
@@ -1738,27 +1829,9 @@ ec_writev_merge_tail(call_frame_t *frame, void *cookie, xlator_t *this,
 {
     ec_t *ec = this->private;
     ec_fop_data_t *fop = frame->local;
-    uint64_t size, base, tmp;
 
     if (op_ret >= 0) {
-        tmp = 0;
-        size = fop->size - fop->user_size - fop->head;
-        base = ec->stripe_size - size;
-        if (op_ret > base) {
-            tmp = min(op_ret - base, size);
-            ec_iov_copy_to(fop->vector[0].iov_base + fop->size - size, vector,
-                           count, base, tmp);
-
-            size -= tmp;
-        }
-
-        if (size > 0) {
-            memset(fop->vector[0].iov_base + fop->size - size, 0, size);
-        }
-
-        if (ec->stripe_cache) {
-            ec_add_stripe_in_cache(ec, fop);
-        }
+        ec_writev_merge_tail_at(ec, fop, op_ret, vector, count, 0);
     }
     return 0;
 }
@@ -1798,6 +1871,26 @@ ec_writev_merge_head(call_frame_t *frame, void *cookie, xlator_t *this,
     return 0;
 }
 
+/* Head and tail are in adjacent stripes and have been read together */
+int32_t
+ec_writev_merge_both(call_frame_t *frame, void *cookie, xlator_t *this,
+                     int32_t op_ret, int32_t op_errno, struct iovec *vector,
+                     int32_t count, struct iatt *stbuf, struct iobref *iobref,
+                     dict_t *xdata)
+{
+    ec_t *ec = this->private;
+    ec_fop_data_t *fop = frame->local;
+
+    if (op_ret >= 0) {
+        ec_writev_merge_head(frame, cookie, this, op_ret, op_errno, vector,
+                             count, stbuf, iobref, xdata);
+        ec_writev_merge_tail_at(ec, fop, op_ret, vector, count,
+                                ec->stripe_size);
+    }
+
+    return 0;
+}
+
 static int
 ec_make_internal_fop_xdata(dict_t **xdata)
 {
@@ -1928,6 +2021,7 @@ ec_get_stripe_from_cache_locked(ec_t *ec, ec_fop_data_t *fop,
     {
         if (stripe->frag_offset == frag_offset) {
             list_move_tail(&stripe->lru, &stripe_cache->lru);
+            ec_stripe_cache_touch(ec, stripe, _gf_true);
             GF_ATOMIC_INC(ec->stats.stripe_cache.hits);
             return stripe;
         }
@@ -1998,7 +2092,8 @@ ec_writev_start(ec_fop_data_t *fop)
     dict_t *xdata = NULL;
     uint64_t tail, current;
     int32_t err = -ENOMEM;
-    gf_boolean_t found_stripe = _gf_false;
+    gf_boolean_t read_head = _gf_false;
+    gf_boolean_t read_tail = _gf_false;
 
     /* This shouldn't fail because we have the inode locked. */
     GF_ASSERT(ec_get_inode_size(fop, fop->fd->inode, &current));
@@ -2028,17 +2123,7 @@ ec_writev_start(ec_fop_data_t *fop)
     tail = fop->size - fop->user_size - fop->head;
     if (fop->head > 0) {
         if (current > fop->offset) {
-            found_stripe = ec_get_and_merge_stripe(ec, fop, EC_STRIPE_HEAD);
-            if (!found_stripe) {
-                if (ec_make_internal_fop_xdata(&xdata)) {
-                    err = -ENOMEM;
-                    goto failed_xdata;
-                }
-                ec_readv(fop->frame, fop->xl,
-                         ec_get_lock_good_mask(fop->fd->inode, fop->xl),
-                         EC_MINIMUM_MIN, ec_writev_merge_head, NULL, fd,
-                         ec->stripe_size, fop->offset, 0, xdata);
-            }
+            read_head = !ec_get_and_merge_stripe(ec, fop, EC_STRIPE_HEAD);
         } else {
             memset(fop->vector[0].iov_base, 0, fop->head);
             memset(fop->vector[0].iov_base + fop->size - tail, 0, tail);
@@ -2054,18 +2139,7 @@ ec_writev_start(ec_fop_data_t *fop)
          * work as expected
          */
         if (current > fop->offset + fop->head + fop->user_size) {
-            found_stripe = ec_get_and_merge_stripe(ec, fop, EC_STRIPE_TAIL);
-            if (!found_stripe) {
-                if (ec_make_internal_fop_xdata(&xdata)) {
-                    err = -ENOMEM;
-                    goto failed_xdata;
-                }
-                ec_readv(fop->frame, fop->xl,
-                         ec_get_lock_good_mask(fop->fd->inode, fop->xl),
-                         EC_MINIMUM_MIN, ec_writev_merge_tail, NULL, fd,
-                         ec->stripe_size,
-                         fop->offset + fop->size - ec->stripe_size, 0, xdata);
-            }
+            read_tail = !ec_get_and_merge_stripe(ec, fop, EC_STRIPE_TAIL);
         } else {
             memset(fop->vector[0].iov_base + fop->size - tail, 0, tail);
             if (ec->stripe_cache) {
@@ -2074,6 +2148,34 @@ ec_writev_start(ec_fop_data_t *fop)
         }
     }
 
+    if ((read_head || read_tail) && ec_make_internal_fop_xdata(&xdata)) {
+        err = -ENOMEM;
+        goto failed_xdata;
+    }
+
+    if (read_head && read_tail && (fop->size == ec->stripe_size * 2)) {
+        /* A small write crossing a stripe boundary. Both stripes come in
+         * one read, which halves the requests sent to the bricks. */
+        ec_readv(fop->frame, fop->xl,
+                 ec_get_lock_good_mask(fop->fd->inode, fop->xl),
+                 EC_MINIMUM_MIN, ec_writev_merge_both, NULL, fd, fop->size,
+                 fop->offset, 0, xdata);
+    } else {
+        if (read_head) {
+            ec_readv(fop->frame, fop->xl,
+                     ec_get_lock_good_mask(fop->fd->inode, fop->xl),
+                     EC_MINIMUM_MIN, ec_writev_merge_head, NULL, fd,
+                     ec->stripe_size, fop->offset, 0, xdata);
+        }
+        if (read_tail) {
+            ec_readv(fop->frame, fop->xl,
+                     ec_get_lock_good_mask(fop->fd->inode, fop->xl),
+                     EC_MINIMUM_MIN, ec_writev_merge_tail, NULL, fd,
+                     ec->stripe_size,
+                     fop->offset + fop->size - ec->stripe_size, 0, xdata);
+        }
+    }
+
     err = 0;
 
 failed_xdata:
@@ -2133,8 +2235,9 @@ ec_writev_encode(ec_fop_data_t *fop)
     for (i = 1; i < ec->nodes; i++) {
         blocks[i] = blocks[i - 1] + fop->vector[1].iov_len;
     }
-    ec_method_encode(&ec->matrix, fop->vector[0].iov_len,
-                     fop->vector[0].iov_base, blocks);
+    ec_method_encode(&ec->matrix,
+                     ec_get_inode_systematic(fop, fop->fd->inode),
+                     fop->vector[0].iov_len, fop->vector[0].iov_base, blocks);
 }
 
 int32_t
@@ -56,6 +56,7 @@ GLFS_MSGID(EC, EC_MSG_INVALID_CONFIG, EC_MSG_HEAL_FAIL,
            EC_MSG_EXTENSION_UNKNOWN, EC_MSG_EXTENSION_UNSUPPORTED,
            EC_MSG_EXTENSION_FAILED, EC_MSG_NO_GF, EC_MSG_MATRIX_FAILED,
            EC_MSG_DYN_CREATE_FAILED, EC_MSG_DYN_CODEGEN_FAILED,
-           EC_MSG_THREAD_CLEANUP_FAILED, EC_MSG_FD_BAD);
+           EC_MSG_THREAD_CLEANUP_FAILED, EC_MSG_FD_BAD,
+           EC_MSG_CODER_THREAD_FAILED);
 
 #endif /* !_EC_MESSAGES_H_ */
@@ -10,6 +10,7 @@
 
 #include <string.h>
 #include <inttypes.h>
+#include <urcu/uatomic.h>
 
 #include "ec-types.h"
 #include "ec-mem-types.h"
@@ -17,6 +18,26 @@
 #include "ec-code.h"
 #include "ec-method.h"
 #include "ec-helpers.h"
+#include "ec-messages.h"
+
+/* Smallest amount of data worth handing to another thread */
+#define EC_METHOD_PART_MIN_SIZE (128 * 1024)
+
+/* Configurations with more brick combinations than this keep their decode
+ * matrices only in the LRU list */
+#define EC_METHOD_MAX_DECODE 4096
+/* Most decode matrices built in advance in one go */
+#define EC_METHOD_MAX_PREPARE 128
+
+/* Added to the mask of decode matrices of the systematic code to tell them
+ * apart from the ones of the original code. */
+#define EC_METHOD_SYSTEMATIC_KEY ((uintptr_t)1 << (sizeof(uintptr_t) * 8 - 1))
+
+struct _ec_coder_task;
+typedef struct _ec_coder_task ec_coder_task_t;
+
+struct _ec_coder_job;
+typedef struct _ec_coder_job ec_coder_job_t;
 
 static void
 ec_method_matrix_normal(ec_gf_t *gf, uint32_t *matrix, uint32_t columns,
@@ -70,6 +91,39 @@ ec_method_matrix_inverse(ec_gf_t *gf, uint32_t *matrix, uint32_t *values,
     }
 }
 
+/* dst = a * b, where a has 'rows' rows and b is a square matrix of
+ * 'columns' elements per side. */
+static void
+ec_method_matrix_multiply(ec_gf_t *gf, uint32_t *dst, uint32_t *a,
+                          uint32_t *b, uint32_t rows, uint32_t columns)
+{
+    uint32_t i, j, k, v;
+
+    for (i = 0; i < rows; i++) {
+        for (j = 0; j < columns; j++) {
+            v = 0;
+            for (k = 0; k < columns; k++) {
+                v ^= ec_gf_mul(gf, a[i * columns + k], b[k * columns + j]);
+            }
+            *dst++ = v;
+        }
+    }
+}
+
+/* The systematic code multiplies the original encoding matrix by the
+ * inverse of its first 'columns' rows, so that those rows become the
+ * identity. Decoding a set of fragments with it is decoding them with the
+ * original code and multiplying the result by those rows again. */
+static void
+ec_method_matrix_systematic(ec_matrix_list_t *list, uint32_t *values)
+{
+    uint32_t tmp[list->columns * list->columns];
+
+    memcpy(tmp, values, sizeof(tmp));
+    ec_method_matrix_multiply(list->gf, values, list->encode->values, tmp,
+                              list->columns, list->columns);
+}
+
 static void
 ec_method_matrix_init(ec_matrix_list_t *list, ec_matrix_t *matrix,
                       uintptr_t mask, uint32_t *rows, gf_boolean_t inverse)
@@ -86,6 +140,9 @@ ec_method_matrix_init(ec_matrix_list_t *list, ec_matrix_t *matrix,
         matrix->rows = list->columns;
         ec_method_matrix_inverse(matrix->code->gf, matrix->values, rows,
                                  matrix->rows);
+        if ((mask & EC_METHOD_SYSTEMATIC_KEY) != 0) {
+            ec_method_matrix_systematic(list, matrix->values);
+        }
         for (i = 0; i < matrix->rows; i++) {
             matrix->row_data[i].values = matrix->values + i * matrix->columns;
             matrix->row_data[i].func.interleaved = ec_code_build_interleaved(
@@ -197,6 +254,20 @@ ec_method_matrix_insert(ec_matrix_list_t *list, ec_matrix_t *matrix)
     list->count++;
 }
 
+static ec_matrix_t *
+ec_method_matrix_alloc(ec_matrix_list_t *list)
+{
+    ec_matrix_t *matrix;
+
+    matrix = mem_get0(list->pool);
+    if (matrix != NULL) {
+        matrix->values = (uint32_t *)((uintptr_t)matrix + sizeof(ec_matrix_t) +
+                                      sizeof(ec_matrix_row_t) * list->columns);
+    }
+
+    return matrix;
+}
+
 static ec_matrix_t *
 ec_method_matrix_get(ec_matrix_list_t *list, uintptr_t mask, uint32_t *rows)
 {
@@ -221,13 +292,11 @@ ec_method_matrix_get(ec_matrix_list_t *list, uintptr_t mask, uint32_t *rows)
 
         ec_method_matrix_release(matrix);
     } else {
-        matrix = mem_get0(list->pool);
+        matrix = ec_method_matrix_alloc(list);
         if (matrix == NULL) {
             matrix = EC_ERR(ENOMEM);
             goto out;
         }
-        matrix->values = (uint32_t *)((uintptr_t)matrix + sizeof(ec_matrix_t) +
-                                      sizeof(ec_matrix_row_t) * list->columns);
     }
 
     ec_method_matrix_init(list, matrix, mask, rows, _gf_true);
@@ -254,6 +323,414 @@ ec_method_matrix_put(ec_matrix_list_t *list, ec_matrix_t *matrix)
     UNLOCK(&list->lock);
 }
 
+static uint32_t
+ec_method_choose(ec_matrix_list_t *list, uint32_t n, uint32_t k)
+{
+    return list->choose[n * (list->columns + 1) + k];
+}
+
+/* Every mask of 'columns' bricks out of 'rows' gets a distinct index
+ * below decode_count (its rank in the combinatorial number system). The
+ * matrices of the systematic code go after all of them. */
+static gf_boolean_t
+ec_method_decode_rank(ec_matrix_list_t *list, gf_boolean_t systematic,
+                      uintptr_t mask, uint32_t *rank)
+{
+    uint32_t i, k;
+
+    if ((list->decode == NULL) || ((mask >> list->rows) != 0) ||
+        (gf_bits_count(mask) != list->columns)) {
+        return _gf_false;
+    }
+
+    *rank = systematic ? list->decode_count : 0;
+    k = 0;
+    for (i = 0; mask != 0; i++, mask >>= 1) {
+        if ((mask & 1) != 0) {
+            *rank += ec_method_choose(list, i, ++k);
+        }
+    }
+
+    return _gf_true;
+}
+
+/* Matrices are fully built before being published with a cmpxchg, and
+ * reading their contents depends on the pointer loaded here. */
+static ec_matrix_t *
+ec_method_decode_lookup(ec_matrix_list_t *list, uint32_t rank)
+{
+    return uatomic_read(&list->decode[rank]);
+}
+
+static ec_matrix_t *
+ec_method_decode_build(ec_matrix_list_t *list, uint32_t rank, uintptr_t key,
+                       uint32_t *rows)
+{
+    ec_matrix_t *matrix, *old;
+
+    matrix = ec_method_matrix_alloc(list);
+    if (matrix == NULL) {
+        return EC_ERR(ENOMEM);
+    }
+    ec_method_matrix_init(list, matrix, key, rows, _gf_true);
+
+    old = uatomic_cmpxchg(&list->decode[rank], NULL, matrix);
+    if (old != NULL) {
+        /* Another thread has built the same matrix first. */
+        ec_method_matrix_release(matrix);
+        mem_put(matrix);
+        matrix = old;
+    }
+
+    return matrix;
+}
+
+/* Builds the decode matrices of all combinations of bricks in 'mask' so
+ * that reads don't have to when they start using them. Nothing is done if
+ * there are too many combinations; they will be built on first use. */
+void
+ec_method_prepare(ec_matrix_list_t *list, gf_boolean_t systematic,
+                  uintptr_t mask)
+{
+    uint32_t pos[list->rows];
+    uint32_t idx[list->columns];
+    uint32_t rows[list->columns];
+    uint32_t i, k, count, rank;
+    uintptr_t sub;
+
+    if (list->decode == NULL) {
+        return;
+    }
+
+    count = 0;
+    for (i = 0; i < list->rows; i++) {
+        if ((mask & (1ULL << i)) != 0) {
+            pos[count++] = i;
+        }
+    }
+    k = list->columns;
+    if ((count < k) || (ec_method_choose(list, count, k) >
+                        EC_METHOD_MAX_PREPARE)) {
+        return;
+    }
+
+    for (i = 0; i < k; i++) {
+        idx[i] = i;
+    }
+    do {
+        sub = 0;
+        for (i = 0; i < k; i++) {
+            sub |= 1ULL << pos[idx[i]];
+            rows[i] = pos[idx[i]] + 1;
+        }
+        ec_method_decode_rank(list, systematic, sub, &rank);
+        if (systematic) {
+            sub |= EC_METHOD_SYSTEMATIC_KEY;
+        }
+        if ((ec_method_decode_lookup(list, rank) == NULL) &&
+            EC_IS_ERR(ec_method_decode_build(list, rank, sub, rows))) {
+            return;
+        }
+
+        /* next combination in lexicographic order */
+        i = k;
+        while ((i > 0) && (idx[i - 1] == count - k + i - 1)) {
+            i--;
+        }
+        if (i > 0) {
+            idx[i - 1]++;
+            for (; i < k; i++) {
+                idx[i] = idx[i - 1] + 1;
+            }
+        }
+    } while (i > 0);
+}
+
+static int32_t
+ec_method_decode_init(ec_matrix_list_t *list)
+{
+    uint32_t *row, *prev = NULL;
+    uint32_t n, k, width;
+
+    width = list->columns + 1;
+    list->choose = GF_CALLOC(list->rows + 1, sizeof(uint32_t) * width,
+                             ec_mt_ec_matrix_t);
+    if (list->choose == NULL) {
+        return -ENOMEM;
+    }
+    /* with at most 31 bricks none of them overflows */
+    for (n = 0; n <= list->rows; n++) {
+        row = list->choose + n * width;
+        row[0] = 1;
+        for (k = 1; (k <= n) && (k < width); k++) {
+            row[k] = prev[k - 1] + prev[k];
+        }
+        prev = row;
+    }
+
+    list->decode_count = ec_method_choose(list, list->rows, list->columns);
+    if (list->decode_count > EC_METHOD_MAX_DECODE) {
+        return 0;
+    }
+    list->decode = GF_CALLOC(list->decode_count * 2, sizeof(ec_matrix_t *),
+                             ec_mt_ec_matrix_t);
+    if (list->decode == NULL) {
+        GF_FREE(list->choose);
+        list->choose = NULL;
+        return -ENOMEM;
+    }
+
+    /* small configurations get all of them right away */
+    ec_method_prepare(list, _gf_false, (1ULL << list->rows) - 1);
+    ec_method_prepare(list, _gf_true, (1ULL << list->rows) - 1);
+
+    return 0;
+}
+
+static void
+ec_method_decode_fini(ec_matrix_list_t *list)
+{
+    ec_matrix_t *matrix;
+    uint32_t i;
+
+    if (list->decode != NULL) {
+        for (i = 0; i < list->decode_count * 2; i++) {
+            matrix = list->decode[i];
+            if (matrix != NULL) {
+                ec_method_matrix_release(matrix);
+                mem_put(matrix);
+            }
+        }
+        GF_FREE(list->decode);
+        list->decode = NULL;
+    }
+
+    GF_FREE(list->choose);
+    list->choose = NULL;
+}
+
+struct _ec_coder_task {
+    void (*func)(ec_coder_task_t *task, uint64_t offset, uint64_t size);
+    ec_matrix_list_t *list;
+    ec_matrix_t *matrix;
+    void *in;
+    void **in_blocks;
+    void *out;
+    void **out_blocks;
+    uint32_t pending; /* jobs not done yet, protected by coder->mutex */
+};
+
+struct _ec_coder_job {
+    struct list_head list;
+    ec_coder_task_t *task;
+    uint64_t offset;
+    uint64_t size;
+};
+
+static void *
+ec_coder_worker(void *data)
+{
+    ec_coder_t *coder = data;
+    ec_coder_job_t *job;
+
+    pthread_mutex_lock(&coder->mutex);
+    while (!coder->exiting) {
+        if (list_empty(&coder->jobs) || (coder->busy >= coder->threads)) {
+            pthread_cond_wait(&coder->cond, &coder->mutex);
+            continue;
+        }
+
+        job = list_first_entry(&coder->jobs, ec_coder_job_t, list);
+        list_del_init(&job->list);
+        coder->busy++;
+        pthread_mutex_unlock(&coder->mutex);
+
+        job->task->func(job->task, job->offset, job->size);
+
+        pthread_mutex_lock(&coder->mutex);
+        coder->busy--;
+        job->task->pending--;
+        pthread_cond_broadcast(&coder->done);
+    }
+    pthread_mutex_unlock(&coder->mutex);
+
+    return NULL;
+}
+
+/* Called with coder->mutex held. Workers are only created when there is
+ * work for them, so that processes which never read nor write large
+ * blocks don't have idle threads. */
+static void
+__ec_coder_start(ec_coder_t *coder, uint32_t count)
+{
+    while ((coder->started < count) && (coder->started < coder->threads)) {
+        if (gf_thread_create(&coder->workers[coder->started], NULL,
+                             ec_coder_worker, coder, "eccoder") != 0) {
+            gf_msg(THIS->name, GF_LOG_WARNING, errno,
+                   EC_MSG_CODER_THREAD_FAILED,
+                   "Failed to start a coding thread. %u running",
+                   coder->started);
+            /* don't try again on every request */
+            coder->threads = coder->started;
+            break;
+        }
+        coder->started++;
+    }
+}
+
+/* Splits 'size' bytes, in units of 'unit' bytes, into parts of at least
+ * 'min' bytes. The workers take all parts but the first, which is done
+ * by the caller. The caller also takes back the parts that no worker has
+ * picked yet while it waits, so it never sits idle behind other users
+ * of the pool. */
+static void
+ec_coder_run(ec_coder_t *coder, ec_coder_task_t *task, uint64_t size,
+             uint64_t unit, uint64_t min)
+{
+    uint64_t units, parts, offset, count;
+    uint32_t threads, i;
+    ec_coder_job_t *job;
+
+    /* unlocked, at worst this request is split for a stale value */
+    threads = coder->threads;
+    units = (size + unit - 1) / unit;
+    parts = size / max(min, unit);
+    parts = min(parts, threads + 1);
+    parts = min(parts, units);
+    if (parts <= 1) {
+        task->func(task, 0, size);
+        return;
+    }
+
+    ec_coder_job_t jobs[parts];
+
+    offset = 0;
+    for (i = 0; i < parts; i++) {
+        count = units / parts + ((i < units % parts) ? 1 : 0);
+        jobs[i].task = task;
+        jobs[i].offset = offset;
+        jobs[i].size = min(count * unit, size - offset);
+        offset += jobs[i].size;
+    }
+
+    pthread_mutex_lock(&coder->mutex);
+    {
+        __ec_coder_start(coder, parts - 1);
+        task->pending = parts - 1;
+        for (i = 1; i < parts; i++) {
+            list_add_tail(&jobs[i].list, &coder->jobs);
+        }
+        pthread_cond_broadcast(&coder->cond);
+    }
+    pthread_mutex_unlock(&coder->mutex);
+
+    task->func(task, jobs[0].offset, jobs[0].size);
+
+    pthread_mutex_lock(&coder->mutex);
+    while (task->pending > 0) {
+        job = NULL;
+        for (i = 1; i < parts; i++) {
+            if (!list_empty(&jobs[i].list)) {
+                job = &jobs[i];
+                break;
+            }
+        }
+        if (job == NULL) {
+            pthread_cond_wait(&coder->done, &coder->mutex);
+            continue;
+        }
+
+        list_del_init(&job->list);
+        pthread_mutex_unlock(&coder->mutex);
+
+        task->func(task, job->offset, job->size);
+
+        pthread_mutex_lock(&coder->mutex);
+        task->pending--;
+    }
+    pthread_mutex_unlock(&coder->mutex);
+}
+
+static void
+ec_coder_init(ec_coder_t *coder)
+{
+    pthread_mutex_init(&coder->mutex, NULL);
+    pthread_cond_init(&coder->cond, NULL);
+    pthread_cond_init(&coder->done, NULL);
+    INIT_LIST_HEAD(&coder->jobs);
+    coder->threads = coder->busy = coder->started = 0;
+    coder->exiting = _gf_false;
+}
+
+static void
+ec_coder_fini(ec_coder_t *coder)
+{
+    uint32_t i;
+
+    pthread_mutex_lock(&coder->mutex);
+    {
+        coder->exiting = _gf_true;
+        pthread_cond_broadcast(&coder->cond);
+    }
+    pthread_mutex_unlock(&coder->mutex);
+
+    for (i = 0; i < coder->started; i++) {
+        pthread_join(coder->workers[i], NULL);
+    }
+
+    pthread_cond_destroy(&coder->done);
+    pthread_cond_destroy(&coder->cond);
+    pthread_mutex_destroy(&coder->mutex);
+}
+
+/* Builds the rows of the systematic code that generate the redundancy. The
+ * other ones are the identity, their fragments are the data itself. */
+static int32_t
+ec_method_setup_systematic(ec_matrix_list_t *list)
+{
+    ec_matrix_t *matrix;
+    uint32_t inverse[list->columns * list->columns];
+    uint32_t values[list->columns];
+    uint32_t i;
+
+    matrix = GF_MALLOC(sizeof(ec_matrix_t) +
+                           sizeof(ec_matrix_row_t) * list->rows +
+                           sizeof(uint32_t) * list->columns * list->rows,
+                       ec_mt_ec_matrix_t);
+    if (matrix == NULL) {
+        return -ENOMEM;
+    }
+    memset(matrix, 0, sizeof(ec_matrix_t));
+    matrix->values = (uint32_t *)((uintptr_t)matrix + sizeof(ec_matrix_t) +
+                                  sizeof(ec_matrix_row_t) * list->rows);
+
+    matrix->refs = 1;
+    matrix->mask = EC_METHOD_SYSTEMATIC_KEY;
+    matrix->code = list->code;
+    matrix->columns = list->columns;
+    matrix->rows = list->rows - list->columns;
+    INIT_LIST_HEAD(&matrix->lru);
+
+    for (i = 0; i < list->columns; i++) {
+        values[i] = i + 1;
+    }
+    ec_method_matrix_inverse(list->gf, inverse, values, list->columns);
+    ec_method_matrix_multiply(
+        list->gf, matrix->values,
+        list->encode->values + list->columns * list->columns, inverse,
+        matrix->rows, list->columns);
+    for (i = 0; i < matrix->rows; i++) {
+        matrix->row_data[i].values = matrix->values + i * matrix->columns;
+        matrix->row_data[i].func.linear = ec_code_build_linear(
+            matrix->code, EC_METHOD_WORD_SIZE, matrix->row_data[i].values,
+            matrix->columns);
+    }
+
+    list->systematic = matrix;
+
+    return 0;
+}
+
 static int32_t
 ec_method_setup(xlator_t *xl, ec_matrix_list_t *list, const char *gen)
 {
@@ -307,6 +784,8 @@ ec_method_init(xlator_t *xl, ec_matrix_list_t *list, uint32_t columns,
     INIT_LIST_HEAD(&list->lru);
     int32_t err;
 
+    ec_coder_init(&list->coder);
+
     list->pool = mem_pool_new_fn(xl->ctx,
                                  sizeof(ec_matrix_t) +
                                      sizeof(ec_matrix_row_t) * columns +
@@ -334,10 +813,30 @@ ec_method_init(xlator_t *xl, ec_matrix_list_t *list, uint32_t columns,
         goto failed_gf;
     }
 
+    err = ec_method_setup_systematic(list);
+    if (err != 0) {
+        goto failed_setup;
+    }
+
+    err = ec_method_decode_init(list);
+    if (err != 0) {
+        goto failed_systematic;
+    }
+
     LOCK_INIT(&list->lock);
 
     return 0;
 
+failed_systematic:
+    ec_method_matrix_release(list->systematic);
+    GF_FREE(list->systematic);
+    list->systematic = NULL;
+failed_setup:
+    ec_method_matrix_release(list->encode);
+    GF_FREE(list->encode);
+    list->encode = NULL;
+    ec_code_destroy(list->code);
+    list->code = NULL;
 failed_gf:
     ec_gf_destroy(list->gf);
 failed_objects:
@@ -361,6 +860,8 @@ ec_method_fini(ec_matrix_list_t *list)
         return;
     }
 
+    ec_coder_fini(&list->coder);
+
     while (!list_empty(&list->lru)) {
         matrix = list_first_entry(&list->lru, ec_matrix_t, lru);
         ec_method_matrix_destroy(list, matrix);
@@ -368,9 +869,13 @@ ec_method_fini(ec_matrix_list_t *list)
 
     GF_ASSERT(list->count == 0);
 
+    ec_method_decode_fini(list);
+
     if (list->pool) /*Init was successful*/
         LOCK_DESTROY(&list->lock);
 
+    ec_method_matrix_release(list->systematic);
+    GF_FREE(list->systematic);
     ec_method_matrix_release(list->encode);
     GF_FREE(list->encode);
 
@@ -391,43 +896,131 @@ ec_method_update(xlator_t *xl, ec_matrix_list_t *list, const char *gen)
 }
 
 void
-ec_method_encode(ec_matrix_list_t *list, uint64_t size, void *in, void **out)
+ec_method_set_threads(ec_matrix_list_t *list, uint32_t threads)
 {
-    ec_matrix_t *matrix;
+    ec_coder_t *coder = &list->coder;
+
+    pthread_mutex_lock(&coder->mutex);
+    {
+        /* fewer threads only means fewer of them taking jobs */
+        coder->threads = min(threads, EC_CODER_MAX_THREADS);
+        pthread_cond_broadcast(&coder->cond);
+    }
+    pthread_mutex_unlock(&coder->mutex);
+}
+
+static void
+ec_method_encode_range(ec_coder_task_t *task, uint64_t offset, uint64_t size)
+{
+    ec_matrix_list_t *list = task->list;
+    ec_matrix_t *matrix = task->matrix;
+    void *out[list->rows];
     uint64_t pos;
-    uint32_t i;
+    uint32_t first, i;
 
-    matrix = list->encode;
-    for (pos = 0; pos < size; pos += list->stripe) {
-        for (i = 0; i < matrix->rows; i++) {
-            matrix->row_data[i].func.linear(
-                out[i], in, pos, matrix->row_data[i].values, list->columns);
+    /* The systematic code only computes the redundancy, the fragments of
+     * the other rows are copies of the data. */
+    first = list->rows - matrix->rows;
+    for (i = 0; i < list->rows; i++) {
+        out[i] = task->out_blocks[i] +
+                 offset / list->stripe * EC_METHOD_CHUNK_SIZE;
+    }
+    for (pos = offset; pos < offset + size; pos += list->stripe) {
+        for (i = 0; i < first; i++) {
+            memcpy(out[i], task->in + pos + i * EC_METHOD_CHUNK_SIZE,
+                   EC_METHOD_CHUNK_SIZE);
             out[i] += EC_METHOD_CHUNK_SIZE;
         }
+        for (i = 0; i < matrix->rows; i++) {
+            matrix->row_data[i].func.linear(out[first + i], task->in, pos,
+                                            matrix->row_data[i].values,
+                                            list->columns);
+            out[first + i] += EC_METHOD_CHUNK_SIZE;
+        }
     }
 }
 
-int32_t
-ec_method_decode(ec_matrix_list_t *list, uint64_t size, uintptr_t mask,
-                 uint32_t *rows, void **in, void *out)
+void
+ec_method_encode(ec_matrix_list_t *list, gf_boolean_t systematic,
+                 uint64_t size, void *in, void **out)
 {
-    ec_matrix_t *matrix;
+    ec_coder_task_t task = {
+        .func = ec_method_encode_range,
+        .list = list,
+        .matrix = systematic ? list->systematic : list->encode,
+        .in = in,
+        .out_blocks = out,
+    };
+
+    ec_coder_run(&list->coder, &task, size, list->stripe,
+                 EC_METHOD_PART_MIN_SIZE);
+}
+
+static void
+ec_method_decode_range(ec_coder_task_t *task, uint64_t offset, uint64_t size)
+{
+    ec_matrix_t *matrix = task->matrix;
+    uint32_t columns = task->list->columns;
+    void *out;
     uint64_t pos;
     uint32_t i;
 
-    matrix = ec_method_matrix_get(list, mask, rows);
-    if (EC_IS_ERR(matrix)) {
-        return EC_GET_ERR(matrix);
-    }
-    for (pos = 0; pos < size; pos += EC_METHOD_CHUNK_SIZE) {
-        for (i = 0; i < matrix->rows; i++) {
-            matrix->row_data[i].func.interleaved(
-                out, in, pos, matrix->row_data[i].values, list->columns);
+    out = task->out + offset * columns;
+    for (pos = offset; pos < offset + size; pos += EC_METHOD_CHUNK_SIZE) {
+        for (i = 0; i < columns; i++) {
+            if (matrix == NULL) {
+                /* data fragments of the systematic code */
+                memcpy(out, task->in_blocks[i] + pos, EC_METHOD_CHUNK_SIZE);
+            } else {
+                matrix->row_data[i].func.interleaved(
+                    out, task->in_blocks, pos, matrix->row_data[i].values,
+                    columns);
+            }
             out += EC_METHOD_CHUNK_SIZE;
         }
     }
+}
+
+int32_t
+ec_method_decode(ec_matrix_list_t *list, gf_boolean_t systematic,
+                 uint64_t size, uintptr_t mask, uint32_t *rows, void **in,
+                 void *out)
+{
+    ec_coder_task_t task = {
+        .func = ec_method_decode_range,
+        .list = list,
+        .in_blocks = in,
+        .out = out,
+    };
+    gf_boolean_t cached = _gf_true;
+    uintptr_t key = mask;
+    uint32_t rank;
+
+    if (systematic) {
+        key |= EC_METHOD_SYSTEMATIC_KEY;
+    }
+    if (systematic && (mask == (1ULL << list->columns) - 1)) {
+        task.matrix = NULL;
+    } else if (ec_method_decode_rank(list, systematic, mask, &rank)) {
+        task.matrix = ec_method_decode_lookup(list, rank);
+        if (task.matrix == NULL) {
+            task.matrix = ec_method_decode_build(list, rank, key, rows);
+        }
+    } else {
+        cached = _gf_false;
+        task.matrix = ec_method_matrix_get(list, key, rows);
+    }
+    if (EC_IS_ERR(task.matrix)) {
+        return EC_GET_ERR(task.matrix);
+    }
+
+    /* each fragment byte gives 'columns' bytes of data */
+    ec_coder_run(&list->coder, &task, size, EC_METHOD_CHUNK_SIZE,
+                 EC_METHOD_PART_MIN_SIZE / list->columns);
 
-    ec_method_matrix_put(list, matrix);
+    if (!cached) {
+        ec_method_matrix_put(list, task.matrix);
+    }
 
     return 0;
 }
@@ -39,10 +39,19 @@ int32_t
 ec_method_update(xlator_t *xl, ec_matrix_list_t *list, const char *gen);
 
 void
-ec_method_encode(ec_matrix_list_t *list, uint64_t size, void *in, void **out);
+ec_method_prepare(ec_matrix_list_t *list, gf_boolean_t systematic,
+                  uintptr_t mask);
+
+void
+ec_method_set_threads(ec_matrix_list_t *list, uint32_t threads);
+
+void
+ec_method_encode(ec_matrix_list_t *list, gf_boolean_t systematic,
+                 uint64_t size, void *in, void **out);
 
 int32_t
-ec_method_decode(ec_matrix_list_t *list, uint64_t size, uintptr_t mask,
-                 uint32_t *rows, void **in, void *out);
+ec_method_decode(ec_matrix_list_t *list, gf_boolean_t systematic,
+                 uint64_t size, uintptr_t mask, uint32_t *rows, void **in,
+                 void *out);
 
 #endif /* __EC_METHOD_H__ */
@@ -18,6 +18,8 @@
 
 #define EC_GF_MAX_REGS 16
 
+#define EC_CODER_MAX_THREADS 64
+
 enum _ec_heal_need;
 typedef enum _ec_heal_need ec_heal_need_t;
 
@@ -90,6 +92,9 @@ typedef struct _ec_stripe ec_stripe_t;
 struct _ec_stripe_list;
 typedef struct _ec_stripe_list ec_stripe_list_t;
 
+struct _ec_stripe_cache;
+typedef struct _ec_stripe_cache ec_stripe_cache_t;
+
 struct _ec_code_space;
 typedef struct _ec_code_space ec_code_space_t;
 
@@ -109,12 +114,18 @@ typedef struct _ec_matrix_row ec_matrix_row_t;
 struct _ec_matrix;
 typedef struct _ec_matrix ec_matrix_t;
 
+struct _ec_coder;
+typedef struct _ec_coder ec_coder_t;
+
 struct _ec_matrix_list;
 typedef struct _ec_matrix_list ec_matrix_list_t;
 
 struct _ec_heal;
 typedef struct _ec_heal ec_heal_t;
 
+struct _ec_heal_ranges;
+typedef struct _ec_heal_ranges ec_heal_ranges_t;
+
 struct _ec_self_heald;
 typedef struct _ec_self_heald ec_self_heald_t;
 
@@ -160,15 +171,27 @@ struct _ec_fd {
 };
 
 struct _ec_stripe {
-    struct list_head lru; /* LRU list member */
-    uint64_t frag_offset; /* Fragment offset of this stripe */
-    char data[];          /* Contents of the stripe */
+    struct list_head lru;    /* LRU list member */
+    struct list_head global; /* Member of the LRU shared by all inodes */
+    inode_t *inode;          /* Inode whose cache owns this stripe */
+    uint64_t frag_offset;    /* Fragment offset of this stripe */
+    char data[];             /* Contents of the stripe */
 };
 
 struct _ec_stripe_list {
     struct list_head lru;
     uint32_t count;
     uint32_t max;
+    gf_boolean_t have_iatt;
+    struct iatt iatt; /* Attributes returned by the last read or write */
+};
+
+struct _ec_stripe_cache {
+    gf_lock_t lock;
+    struct list_head lru; /* Stripes of all inodes, least recently used
+                             first. */
+    uint64_t size;        /* Memory currently used by cached stripes. */
+    uint64_t max;         /* Memory budget for all cached stripes. */
 };
 
 struct _ec_inode {
@@ -184,6 +207,8 @@ struct _ec_inode {
     uint64_t pre_size;
     uint64_t post_size;
     uint64_t dirty[2];
+    uint64_t dirty_ranges; /* EC_DIRTY_RANGES written since the last
+                              size and version update */
     struct list_head heal;
     ec_stripe_list_t stripe_cache;
     uint64_t bad_version;
@@ -546,6 +571,20 @@ struct _ec_matrix {
     ec_matrix_row_t row_data[0];
 };
 
+/* Threads encoding and decoding parts of large requests in parallel with
+ * the thread that made them. They are created when first needed. */
+struct _ec_coder {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond; /* jobs queued or exiting */
+    pthread_cond_t done; /* a job has finished */
+    struct list_head jobs;
+    uint32_t threads; /* how many workers can be busy */
+    uint32_t busy;
+    uint32_t started;
+    gf_boolean_t exiting;
+    pthread_t workers[EC_CODER_MAX_THREADS];
+};
+
 struct _ec_matrix_list {
     struct list_head lru;
     gf_lock_t lock;
@@ -558,7 +597,13 @@ struct _ec_matrix_list {
     ec_gf_t *gf;
     ec_code_t *code;
     ec_matrix_t *encode;
+    ec_matrix_t *systematic; /* redundancy rows of the systematic code */
     ec_matrix_t **objects;
+    ec_matrix_t **decode; /* indexed by mask rank, entries are never freed
+                             until fini, so they are read without locks */
+    uint32_t *choose;     /* binomial coefficients to rank masks */
+    uint32_t decode_count;
+    ec_coder_t coder;
 };
 
 struct _ec_heal {
@@ -586,6 +631,8 @@ struct _ec_heal {
     uint64_t total_size;
     uint64_t version[2];
     uint64_t raw_size;
+    ec_heal_ranges_t *ranges; /* shared by the tasks healing the file */
+    gf_boolean_t locked;
 };
 
 struct subvol_healer {
@@ -625,6 +672,10 @@ struct _ec_statistics {
         gf_atomic_t errors;  /* Number of errors that have caused extra
                                 requests. (Basically memory allocation
                                 errors). */
+        gf_atomic_t read_hits;   /* Number of reads answered from cached
+                                    stripes without contacting bricks. */
+        gf_atomic_t read_misses; /* Number of reads that had to be sent
+                                    to the bricks. */
     } stripe_cache;
     struct {
         gf_atomic_t attempted; /*Number of heals attempted on
@@ -667,12 +718,19 @@ struct _ec {
     gf_boolean_t optimistic_changelog;
     gf_boolean_t parallel_writes;
     uint32_t stripe_cache;
+    ec_stripe_cache_t stripes; /* Global LRU and memory budget of the
+                                  stripes cached by all inodes. */
     uint32_t quorum_count;
     uint32_t background_heals;
     uint32_t heal_wait_qlen;
     uint32_t self_heal_window_size; /* max size of read/writes */
+    uint32_t heal_range_tasks;      /* tasks healing the data of a file */
+    gf_boolean_t heal_dirty_ranges; /* only heal the ranges written while
+                                       the sinks were missing updates */
     uint32_t eager_lock_timeout;
     uint32_t other_eager_lock_timeout;
+    uint32_t coding_threads;
+    gf_boolean_t systematic; /* new files use the systematic code */
     struct list_head pending_fops;
     struct list_head heal_waiting;
     struct list_head healing;
@@ -192,6 +192,7 @@ __ec_destroy_private(xlator_t *this)
         }
 
         LOCK_DESTROY(&ec->lock);
+        LOCK_DESTROY(&ec->stripes.lock);
 
         if (ec->leaf_to_subvolid)
             dict_unref(ec->leaf_to_subvolid);
@@ -271,6 +272,10 @@ reconfigure(xlator_t *this, dict_t *options)
                      failed);
     GF_OPTION_RECONF("self-heal-window-size", ec->self_heal_window_size,
                      options, uint32, failed);
+    GF_OPTION_RECONF("heal-range-tasks", ec->heal_range_tasks, options, uint32,
+                     failed);
+    GF_OPTION_RECONF("heal-dirty-ranges", ec->heal_dirty_ranges, options, bool,
+                     failed);
     GF_OPTION_RECONF("heal-timeout", ec->shd.timeout, options, int32, failed);
     ec_configure_background_heal_opts(ec, background_heals, heal_wait_qlen);
     GF_OPTION_RECONF("shd-max-threads", ec->shd.max_threads, options, uint32,
@@ -285,7 +290,13 @@ reconfigure(xlator_t *this, dict_t *options)
     GF_OPTION_RECONF("parallel-writes", ec->parallel_writes, options, bool,
                      failed);
     GF_OPTION_RECONF("stripe-cache", ec->stripe_cache, options, uint32, failed);
+    GF_OPTION_RECONF("stripe-cache-size", ec->stripes.max, options,
+                     size_uint64, failed);
     GF_OPTION_RECONF("quorum-count", ec->quorum_count, options, uint32, failed);
+    GF_OPTION_RECONF("coding-threads", ec->coding_threads, options, uint32,
+                     failed);
+    ec_method_set_threads(&ec->matrix, ec->coding_threads);
+    GF_OPTION_RECONF("systematic", ec->systematic, options, bool, failed);
     ret = 0;
     if (ec_assign_read_policy(ec, read_policy)) {
         ret = -1;
@@ -581,6 +592,7 @@ ec_notify(xlator_t *this, int32_t event, void *data, void *data2)
     gf_boolean_t needs_shd_check = _gf_false;
     int32_t orig_event = event;
     uintptr_t mask = 0;
+    uintptr_t degraded = 0;
 
     gf_msg_trace(this->name, 0, "NOTIFY(%d): %p, %p", event, data, data2);
 
@@ -635,7 +647,10 @@ ec_notify(xlator_t *this, int32_t event, void *data, void *data2)
                 needs_shd_check = _gf_true;
             }
         } else if (event == GF_EVENT_CHILD_DOWN) {
-            ec_set_up_state(ec, mask, 0);
+            if (ec_set_up_state(ec, mask, 0)) {
+                /* reads will need new decode matrices from now on */
+                degraded = ec->xl_up;
+            }
         }
 
         event = ec_get_event_from_state(ec);
@@ -674,6 +689,9 @@ unlock:
     UNLOCK(&ec->lock);
 
 done:
+    if (degraded != 0) {
+        ec_method_prepare(&ec->matrix, ec->systematic, degraded);
+    }
     if (needs_shd_check) {
         ec_launch_replace_heal(ec);
     }
@@ -710,6 +728,8 @@ ec_statistics_init(ec_t *ec)
     GF_ATOMIC_INIT(ec->stats.stripe_cache.evicts, 0);
     GF_ATOMIC_INIT(ec->stats.stripe_cache.allocs, 0);
     GF_ATOMIC_INIT(ec->stats.stripe_cache.errors, 0);
+    GF_ATOMIC_INIT(ec->stats.stripe_cache.read_hits, 0);
+    GF_ATOMIC_INIT(ec->stats.stripe_cache.read_misses, 0);
     GF_ATOMIC_INIT(ec->stats.shd.attempted, 0);
     GF_ATOMIC_INIT(ec->stats.shd.completed, 0);
 }
@@ -802,6 +822,8 @@ init(xlator_t *this)
 
     ec->xl = this;
     LOCK_INIT(&ec->lock);
+    LOCK_INIT(&ec->stripes.lock);
+    INIT_LIST_HEAD(&ec->stripes.lru);
 
     GF_ATOMIC_INIT(ec->async_fop_count, 0);
     INIT_LIST_HEAD(&ec->pending_fops);
@@ -856,6 +878,8 @@ init(xlator_t *this)
     GF_OPTION_INIT("heal-wait-qlength", ec->heal_wait_qlen, uint32, failed);
     GF_OPTION_INIT("self-heal-window-size", ec->self_heal_window_size, uint32,
                    failed);
+    GF_OPTION_INIT("heal-range-tasks", ec->heal_range_tasks, uint32, failed);
+    GF_OPTION_INIT("heal-dirty-ranges", ec->heal_dirty_ranges, bool, failed);
     ec_configure_background_heal_opts(ec, ec->background_heals,
                                       ec->heal_wait_qlen);
     GF_OPTION_INIT("read-policy", read_policy, str, failed);
@@ -869,7 +893,11 @@ init(xlator_t *this)
                    failed);
     GF_OPTION_INIT("parallel-writes", ec->parallel_writes, bool, failed);
     GF_OPTION_INIT("stripe-cache", ec->stripe_cache, uint32, failed);
+    GF_OPTION_INIT("stripe-cache-size", ec->stripes.max, size_uint64, failed);
     GF_OPTION_INIT("quorum-count", ec->quorum_count, uint32, failed);
+    GF_OPTION_INIT("coding-threads", ec->coding_threads, uint32, failed);
+    ec_method_set_threads(&ec->matrix, ec->coding_threads);
+    GF_OPTION_INIT("systematic", ec->systematic, bool, failed);
     GF_OPTION_INIT("ec-read-mask", read_mask_str, str, failed);
 
     if (ec_assign_read_mask(ec, read_mask_str))
@@ -1533,6 +1561,7 @@ ec_dump_private(xlator_t *this)
     ec_t *ec = NULL;
     char key_prefix[GF_DUMP_MAX_BUF_LEN];
     char tmp[65];
+    uint64_t size;
 
     GF_ASSERT(this);
 
@@ -1557,11 +1586,16 @@ ec_dump_private(xlator_t *this)
     gf_proc_dump_write("heal-wait-qlength", "%d", ec->heal_wait_qlen);
     gf_proc_dump_write("self-heal-window-size", "%" PRIu32,
                        ec->self_heal_window_size);
+    gf_proc_dump_write("heal-range-tasks", "%" PRIu32, ec->heal_range_tasks);
+    gf_proc_dump_write("heal-dirty-ranges", "%d", ec->heal_dirty_ranges);
     gf_proc_dump_write("healers", "%d", ec->healers);
     gf_proc_dump_write("heal-waiters", "%d", ec->heal_waiters);
     gf_proc_dump_write("read-policy", "%s", ec_read_policies[ec->read_policy]);
     gf_proc_dump_write("parallel-writes", "%d", ec->parallel_writes);
     gf_proc_dump_write("quorum-count", "%u", ec->quorum_count);
+    gf_proc_dump_write("coding-threads", "%u", ec->coding_threads);
+    gf_proc_dump_write("systematic", "%d", ec->systematic);
+    gf_proc_dump_write("stripe-cache-size", "%" PRIu64, ec->stripes.max);
 
     snprintf(key_prefix, GF_DUMP_MAX_BUF_LEN, "%s.%s.stats.stripe_cache",
              this->type, this->name);
@@ -1581,6 +1615,14 @@ ec_dump_private(xlator_t *this)
                        GF_ATOMIC_GET(ec->stats.stripe_cache.allocs));
     gf_proc_dump_write("errors", "%" GF_PRI_ATOMIC,
                        GF_ATOMIC_GET(ec->stats.stripe_cache.errors));
+    gf_proc_dump_write("cached-reads", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(ec->stats.stripe_cache.read_hits));
+    gf_proc_dump_write("uncached-reads", "%" GF_PRI_ATOMIC,
+                       GF_ATOMIC_GET(ec->stats.stripe_cache.read_misses));
+    LOCK(&ec->stripes.lock);
+    size = ec->stripes.size;
+    UNLOCK(&ec->stripes.lock);
+    gf_proc_dump_write("memory-used", "%" PRIu64, size);
     gf_proc_dump_write("heals-attempted", "%" GF_PRI_ATOMIC,
                        GF_ATOMIC_GET(ec->stats.shd.attempted));
     gf_proc_dump_write("heals-completed", "%" GF_PRI_ATOMIC,
@@ -1783,7 +1825,7 @@ struct volume_options options[] = {
                     " that can wait in SHD per subvolume"},
     {.key = {"cpu-extensions"},
      .type = GF_OPTION_TYPE_STR,
-     .value = {"none", "auto", "x64", "sse", "avx"},
+     .value = {"none", "auto", "x64", "sse", "avx", "avx512"},
      .default_value = "auto",
      .op_version = {GD_OP_VERSION_3_9_0},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
@@ -1800,6 +1842,27 @@ struct volume_options options[] = {
      .tags = {"disperse"},
      .description = "Maximum number blocks(128KB) per file for which "
                     "self-heal process would be applied simultaneously."},
+    {.key = {"heal-range-tasks"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = 16,
+     .default_value = "1",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .tags = {"disperse"},
+     .description = "Number of tasks healing the data of a single file at the "
+                    "same time. Each task heals a different range of the "
+                    "file and only locks that range, so big files are healed "
+                    "faster."},
+    {.key = {"heal-dirty-ranges"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .tags = {"disperse"},
+     .description = "Only heal the ranges of a file that have been modified "
+                    "while the bricks being healed were missing updates. If "
+                    "that is not known, the whole file is healed."},
     {.key = {"optimistic-change-log"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "on",
@@ -1835,6 +1898,19 @@ struct volume_options options[] = {
                     "specially for sequential writes. However, this will also"
                     "lead to extra memory consumption, maximum "
                     "(cache size * stripe size) Bytes per open file."},
+    {.key = {"stripe-cache-size"},
+     .type = GF_OPTION_TYPE_SIZET,
+     .min = 0,
+     .max = 1 * GF_UNIT_GB,
+     .default_value = "16MB",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+     .tags = {"disperse"},
+     .description = "Maximum amount of memory used by the stripes cached for "
+                    "all files. When the limit is reached, the least recently "
+                    "used stripes of any file are discarded. Small reads of "
+                    "cached stripes are answered without contacting the "
+                    "bricks."},
     {
         .key = {"quorum-count"},
         .type = GF_OPTION_TYPE_INT,
@@ -1852,6 +1928,33 @@ struct volume_options options[] = {
         .description = "This option can be used to choose which bricks can be"
                        " used for reading data/metadata of a file/directory",
     },
+    {
+        .key = {"coding-threads"},
+        .type = GF_OPTION_TYPE_INT,
+        .min = 0,
+        .max = EC_CODER_MAX_THREADS,
+        .default_value = "4",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"disperse"},
+        .description = "Number of threads that encode and decode parts of "
+                       "large reads and writes in parallel with the thread "
+                       "doing the request. 0 does all the work on the "
+                       "requesting thread.",
+    },
+    {
+        .key = {"systematic"},
+        .type = GF_OPTION_TYPE_BOOL,
+        .default_value = "off",
+        .op_version = {GD_OP_VERSION_10_0},
+        .flags = OPT_FLAG_SETTABLE | OPT_FLAG_CLIENT_OPT | OPT_FLAG_DOC,
+        .tags = {"disperse"},
+        .description = "Files created while this is on store their data "
+                       "unmodified on the first bricks and only the "
+                       "redundancy is computed, so reads don't need to decode "
+                       "anything while those bricks are up. Existing files "
+                       "keep the layout they were created with.",
+    },
     {
         .key = {NULL},
     },
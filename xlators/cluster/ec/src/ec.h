@@ -20,8 +20,16 @@
 #define EC_XATTR_HEAL EC_XATTR_PREFIX "heal"
 #define EC_XATTR_HEAL_NEW EC_XATTR_PREFIX "heal-new"
 #define EC_XATTR_DIRTY EC_XATTR_PREFIX "dirty"
+#define EC_XATTR_DIRTY_RANGES EC_XATTR_PREFIX "dirty-ranges"
 #define EC_STRIPE_CACHE_MAX_SIZE 10
 #define EC_VERSION_SIZE 2
+/* Data modified while some brick was missing updates is tracked in
+ * EC_DIRTY_RANGES counters, one for each EC_DIRTY_RANGE_SIZE bytes of a
+ * fragment (bigger files wrap around). The first element of the xattr
+ * accumulates the data versions covered by the counters. */
+#define EC_DIRTY_RANGES 64
+#define EC_DIRTY_RANGE_SIZE (16 * GF_UNIT_MB)
+#define EC_DIRTY_RANGES_SIZE (EC_DIRTY_RANGES + 1)
 #define EC_SHD_INODE_LRU_LIMIT 10
 
 #define EC_MAX_FRAGMENTS EC_METHOD_MAX_FRAGMENTS
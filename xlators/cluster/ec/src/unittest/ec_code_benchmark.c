@@ -0,0 +1,251 @@
+/*
+  Copyright (c) 2021 Red Hat, Inc. <http://www.redhat.com>
+  This file is part of GlusterFS.
+
+  This file is licensed to you under your choice of the GNU Lesser
+  General Public License, version 3 or any later version (LGPLv3 or
+  later), or the GNU General Public License, version 2 (GPLv2), in all
+  cases as published by the Free Software Foundation.
+*/
+
+/*
+ * Throughput of the EC encode and decode paths for each of the code
+ * generators ("cpu-extensions" values) built in. All of them use the same
+ * matrices, and the fragments and decoded data of each one are compared
+ * with the ones of the plain C implementation ("none"). The systematic
+ * code is then measured with the best generator available, reading from
+ * the data fragments and from the last ones.
+ *
+ * Build from a configured tree with something like:
+ *
+ *   cc -O2 -include config.h -D_GNU_SOURCE -DGF_LINUX_HOST_OS \
+ *      -D_FILE_OFFSET_BITS=64 -DGLUSTERFS_LIBEXECDIR=\"/tmp\" \
+ *      -Ilibglusterfs/src -Ixlators/lib/src -Ixlators/cluster/ec/src \
+ *      xlators/cluster/ec/src/unittest/ec_code_benchmark.c \
+ *      xlators/cluster/ec/src/ec-method.c xlators/cluster/ec/src/ec-galois.c \
+ *      xlators/cluster/ec/src/ec-gf8.c xlators/cluster/ec/src/ec-code*.c \
+ *      -Llibglusterfs/src/.libs -lglusterfs -o ec_code_benchmark
+ *
+ * Usage: ec_code_benchmark [fragments [redundancy [MiB [coding threads]]]]
+ */
+
+#include "glusterfs/glusterfs.h"
+#include "glusterfs/globals.h"
+#include "glusterfs/xlator.h"
+
+#include "ec-method.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const char *generators[] = {"none", "x64",    "sse",
+                                   "avx",  "avx512", NULL};
+
+static uint64_t
+bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void *
+bench_alloc(size_t size)
+{
+    void *ptr = NULL;
+
+    if (posix_memalign(&ptr, EC_METHOD_WORD_SIZE, size) != 0)
+        return NULL;
+
+    return ptr;
+}
+
+int
+main(int argc, char *argv[])
+{
+    glusterfs_ctx_t *ctx = NULL;
+    xlator_t *xl = NULL;
+    ec_matrix_list_t list;
+    uint32_t fragments = 4;
+    uint32_t redundancy = 2;
+    uint32_t nodes = 0;
+    uint32_t threads = 0;
+    uint64_t size = 0;
+    uint64_t fsize = 0;
+    uint64_t rounds = 0;
+    uint64_t start = 0;
+    double encode = 0;
+    double decode = 0;
+    double degraded = 0;
+    uintptr_t mask = 0;
+    uintptr_t data_mask = 0;
+    char *data = NULL;
+    char *output = NULL;
+    char *reference = NULL;
+    char *frags = NULL;
+    void *out[EC_METHOD_MAX_NODES];
+    void *in[EC_METHOD_MAX_FRAGMENTS];
+    void *data_in[EC_METHOD_MAX_FRAGMENTS];
+    uint32_t rows[EC_METHOD_MAX_FRAGMENTS];
+    uint32_t data_rows[EC_METHOD_MAX_FRAGMENTS];
+    uint32_t i = 0;
+    uint64_t r = 0;
+    int gen = 0;
+
+    if (argc > 1)
+        fragments = atoi(argv[1]);
+    if (argc > 2)
+        redundancy = atoi(argv[2]);
+    size = (argc > 3) ? atoi(argv[3]) : 64;
+    if (argc > 4)
+        threads = atoi(argv[4]);
+    nodes = fragments + redundancy;
+    if ((fragments < 1) || (fragments > EC_METHOD_MAX_FRAGMENTS) ||
+        (redundancy < 1) || (redundancy >= fragments + redundancy) ||
+        (size < 1)) {
+        fprintf(stderr, "invalid configuration\n");
+        return 1;
+    }
+
+    /* whole stripes only */
+    fsize = (size << 20) / fragments;
+    fsize -= fsize % EC_METHOD_CHUNK_SIZE;
+    size = fsize * fragments;
+
+    ctx = glusterfs_ctx_new();
+    if (!ctx || glusterfs_globals_init(ctx))
+        return 1;
+    xl = THIS;
+    xl->ctx = ctx;
+
+    data = bench_alloc(size);
+    output = bench_alloc(size);
+    reference = bench_alloc(fsize * nodes);
+    frags = bench_alloc(fsize * nodes);
+    if (!data || !output || !reference || !frags)
+        return 1;
+
+    srandom(1);
+    for (r = 0; r < size; r++)
+        data[r] = random();
+
+    /* decode from the last fragments so that redundancy is needed */
+    for (i = 0; i < fragments; i++) {
+        rows[i] = redundancy + i + 1;
+        in[i] = frags + (redundancy + i) * fsize;
+        mask |= 1ULL << (redundancy + i);
+        data_rows[i] = i + 1;
+        data_in[i] = frags + i * fsize;
+        data_mask |= 1ULL << i;
+    }
+    for (i = 0; i < nodes; i++)
+        out[i] = frags + i * fsize;
+
+    rounds = (1024ULL << 20) / size + 1;
+
+    printf("%u+%u, %" PRIu64 " MiB per round, %" PRIu64
+           " rounds, %u coding threads\n",
+           fragments, redundancy, size >> 20, rounds, threads);
+
+    for (gen = 0; generators[gen] != NULL; gen++) {
+        /* unsupported generators fall back to the next one available */
+        memset(&list, 0, sizeof(list));
+        if (ec_method_init(xl, &list, fragments, nodes, nodes * 2,
+                           generators[gen]) != 0) {
+            fprintf(stderr, "%s: init failed\n", generators[gen]);
+            return 1;
+        }
+        if ((gen > 0) && (list.code->gen == NULL)) {
+            printf("%8s: not available\n", generators[gen]);
+            ec_method_fini(&list);
+            continue;
+        }
+        ec_method_set_threads(&list, threads);
+
+        start = bench_now_ns();
+        for (r = 0; r < rounds; r++)
+            ec_method_encode(&list, _gf_false, size, data, out);
+        encode = (double)(bench_now_ns() - start);
+
+        start = bench_now_ns();
+        for (r = 0; r < rounds; r++) {
+            if (ec_method_decode(&list, _gf_false, fsize, mask, rows, in,
+                                 output) != 0)
+                return 1;
+        }
+        decode = (double)(bench_now_ns() - start);
+
+        if (gen == 0) {
+            memcpy(reference, frags, fsize * nodes);
+        } else if (memcmp(reference, frags, fsize * nodes) != 0) {
+            fprintf(stderr, "%s: fragments differ\n", generators[gen]);
+            return 1;
+        }
+        if (memcmp(data, output, size) != 0) {
+            fprintf(stderr, "%s: decoded data differs\n", generators[gen]);
+            return 1;
+        }
+
+        printf("%8s (%s): encode %8.1f MiB/s, decode %8.1f MiB/s\n",
+               generators[gen],
+               list.code->gen ? list.code->gen->name : "none",
+               (double)size * rounds / 1048576.0 / (encode / 1e9),
+               (double)size * rounds / 1048576.0 / (decode / 1e9));
+
+        ec_method_fini(&list);
+    }
+
+    memset(&list, 0, sizeof(list));
+    if (ec_method_init(xl, &list, fragments, nodes, nodes * 2, "auto") != 0)
+        return 1;
+    ec_method_set_threads(&list, threads);
+
+    start = bench_now_ns();
+    for (r = 0; r < rounds; r++)
+        ec_method_encode(&list, _gf_true, size, data, out);
+    encode = (double)(bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for (r = 0; r < rounds; r++) {
+        if (ec_method_decode(&list, _gf_true, fsize, data_mask, data_rows,
+                             data_in, output) != 0)
+            return 1;
+    }
+    decode = (double)(bench_now_ns() - start);
+    if (memcmp(data, output, size) != 0) {
+        fprintf(stderr, "systematic: decoded data differs\n");
+        return 1;
+    }
+
+    memset(output, 0, size);
+    start = bench_now_ns();
+    for (r = 0; r < rounds; r++) {
+        if (ec_method_decode(&list, _gf_true, fsize, mask, rows, in,
+                             output) != 0)
+            return 1;
+    }
+    degraded = (double)(bench_now_ns() - start);
+    if (memcmp(data, output, size) != 0) {
+        fprintf(stderr, "systematic: degraded decoded data differs\n");
+        return 1;
+    }
+
+    printf("systematic (%s): encode %8.1f MiB/s, decode %8.1f MiB/s, "
+           "degraded decode %8.1f MiB/s\n",
+           list.code->gen ? list.code->gen->name : "none",
+           (double)size * rounds / 1048576.0 / (encode / 1e9),
+           (double)size * rounds / 1048576.0 / (decode / 1e9),
+           (double)size * rounds / 1048576.0 / (degraded / 1e9));
+
+    ec_method_fini(&list);
+
+    free(data);
+    free(output);
+    free(reference);
+    free(frags);
+
+    return 0;
+}
@@ -1659,5 +1659,6 @@ xlator_api_t xlator_api = {
     .cbks = &cbks,
     .options = options,
     .identifier = "error-gen",
+    .flags = GF_XLATOR_READS_WRITE_PAYLOAD,
     .category = GF_TECH_PREVIEW,
 };
@@ -4450,6 +4450,27 @@ struct volume_options options[] = {
      .description = "This option enables the global threading support for "
                     "bricks. If enabled, it's recommended to also enable "
                     "'performance.iot-pass-through'"},
+    {.key = {"iobuf-hugepages"},
+     .type = GF_OPTION_TYPE_STR,
+     .value = {"off", "thp", "hugetlb"},
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE,
+     .tags = {"io-stats", "iobuf"},
+     .description = "Back the I/O buffers of brick processes with "
+                    "transparent hugepages (thp) or with pages of the "
+                    "hugetlb pool (hugetlb), which fall back to thp when "
+                    "the pool is exhausted. Takes effect when the bricks "
+                    "are restarted"},
+    {.key = {"iobuf-numa"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE,
+     .tags = {"io-stats", "iobuf"},
+     .description = "Allocate the I/O buffers of brick processes from the "
+                    "NUMA node of the thread that uses them. Takes effect "
+                    "when the bricks are restarted"},
     {.key = {"threads"}, .type = GF_OPTION_TYPE_INT},
     {.key = {"brick-threads"},
      .type = GF_OPTION_TYPE_INT,
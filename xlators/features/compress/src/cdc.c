@@ -344,5 +344,6 @@ xlator_api_t xlator_api = {
     .cbks = &cbks,
     .options = options,
     .identifier = "cdc",
+    .flags = GF_XLATOR_READS_WRITE_PAYLOAD,
     .category = GF_TECH_PREVIEW,
 };
@@ -2094,6 +2094,9 @@ glusterd_volume_start_glusterfs(glusterd_volinfo_t *volinfo,
     char *inet_family = NULL;
     char *global_threading = NULL;
     bool threading = false;
+    char *iobuf_hugepages = NULL;
+    char *iobuf_numa = NULL;
+    gf_boolean_t numa = _gf_false;
 
     GF_ASSERT(volinfo);
     GF_ASSERT(brickinfo);
@@ -2264,6 +2267,19 @@ retry:
         }
     }
 
+    if (dict_get_strn(volinfo->dict, VKEY_CONFIG_IOBUF_HUGEPAGES,
+                      SLEN(VKEY_CONFIG_IOBUF_HUGEPAGES),
+                      &iobuf_hugepages) == 0) {
+        runner_argprintf(&runner, "--iobuf-hugepages=%s", iobuf_hugepages);
+    }
+
+    if (dict_get_strn(volinfo->dict, VKEY_CONFIG_IOBUF_NUMA,
+                      SLEN(VKEY_CONFIG_IOBUF_NUMA), &iobuf_numa) == 0) {
+        if ((gf_string2boolean(iobuf_numa, &numa) == 0) && numa) {
+            runner_add_arg(&runner, "--iobuf-numa");
+        }
+    }
+
     if (this->ctx->cmd_args.logger == gf_logger_syslog) {
         runner_argprintf(&runner, "--logger=syslog");
     }
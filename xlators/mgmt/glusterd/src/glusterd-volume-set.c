@@ -306,6 +306,41 @@ out:
     return ret;
 }
 
+static int
+validate_splice_write(glusterd_volinfo_t *volinfo, dict_t *dict, char *key,
+                      char *value, char **op_errstr)
+{
+    char errstr[2048] = "";
+    gf_boolean_t b = _gf_false;
+    int ret = -1;
+
+    ret = gf_string2boolean(value, &b);
+    if (ret) {
+        snprintf(errstr, sizeof(errstr),
+                 "Invalid value for volume set command. Use on/off only.");
+        gf_msg(THIS->name, GF_LOG_ERROR, EINVAL, GD_MSG_INVALID_ENTRY, "%s",
+               errstr);
+        *op_errstr = gf_strdup(errstr);
+        goto out;
+    }
+
+    /* disperse bricks never see a whole WRITE payload worth splicing */
+    if (b && (volinfo->type == GF_CLUSTER_TYPE_DISPERSE)) {
+        snprintf(errstr, sizeof(errstr),
+                 "Cannot set %s for a disperse volume.", key);
+        gf_msg(THIS->name, GF_LOG_ERROR, 0, GD_MSG_INVALID_ENTRY, "%s",
+               errstr);
+        *op_errstr = gf_strdup(errstr);
+        ret = -1;
+        goto out;
+    }
+
+out:
+    gf_msg_debug("glusterd", 0, "Returning %d", ret);
+
+    return ret;
+}
+
 static int
 validate_replica(glusterd_volinfo_t *volinfo, dict_t *dict, char *key,
                  char *value, char **op_errstr)
@@ -903,6 +938,48 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .op_version = GD_OP_VERSION_4_0_0,
         .flags = VOLOPT_FLAG_CLIENT_OPT,
     },
+    {
+        .key = "cluster.layout-cache-timeout",
+        .voltype = "cluster/distribute",
+        .option = "layout-cache-timeout",
+        .op_version = GD_OP_VERSION_10_0,
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+    },
+    {
+        .key = "cluster.readdirp-merge",
+        .voltype = "cluster/distribute",
+        .option = "readdirp-merge",
+        .op_version = GD_OP_VERSION_10_0,
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+    },
+    {
+        .key = "cluster.rebal-crawl-threads",
+        .voltype = "cluster/distribute",
+        .option = "rebal-crawl-threads",
+        .op_version = GD_OP_VERSION_10_0,
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+    },
+    {
+        .key = "cluster.rebal-checkpoint",
+        .voltype = "cluster/distribute",
+        .option = "rebal-checkpoint",
+        .op_version = GD_OP_VERSION_10_0,
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+    },
+    {
+        .key = "cluster.rebalance-io-window",
+        .voltype = "cluster/distribute",
+        .option = "rebalance-io-window",
+        .op_version = GD_OP_VERSION_10_0,
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+    },
+    {
+        .key = "cluster.rebalance-max-block-size",
+        .voltype = "cluster/distribute",
+        .option = "rebalance-max-block-size",
+        .op_version = GD_OP_VERSION_10_0,
+        .flags = VOLOPT_FLAG_CLIENT_OPT,
+    },
 
     /* NUFA xlator options (Distribute special case) */
     {.key = "cluster.nufa",
@@ -954,6 +1031,10 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .voltype = "cluster/replicate",
      .op_version = 2,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "cluster.read-latency-hysteresis",
+     .voltype = "cluster/replicate",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "cluster.background-self-heal-count",
      .voltype = "cluster/replicate",
      .op_version = 1,
@@ -993,6 +1074,14 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "data-self-heal-window-size",
      .op_version = 1,
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "cluster.data-self-heal-pipeline",
+     .voltype = "cluster/replicate",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "cluster.data-region-size",
+     .voltype = "cluster/replicate",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {.key = "cluster.data-change-log",
      .voltype = "cluster/replicate",
      .op_version = 1,
@@ -1673,6 +1762,21 @@ struct volopt_map_entry glusterd_volopt_map[] = {
         .op_version = GD_OP_VERSION_3_10_2,
         .value = "9",
     },
+    {
+        .key = "server.splice-write",
+        .voltype = "protocol/server",
+        .option = "transport.socket.splice-payload",
+        .value = "off",
+        .op_version = GD_OP_VERSION_10_0,
+        .validate_fn = validate_splice_write,
+    },
+    {
+        .key = "server.zerocopy-read",
+        .voltype = "protocol/server",
+        .option = "transport.socket.zerocopy-send",
+        .value = "off",
+        .op_version = GD_OP_VERSION_10_0,
+    },
     {
         .key = "transport.listen-backlog",
         .voltype = "protocol/server",
@@ -2338,6 +2442,18 @@ struct volopt_map_entry glusterd_volopt_map[] = {
     {.key = "storage.linux-io_uring",
      .voltype = "storage/posix",
      .op_version = GD_OP_VERSION_9_0},
+    {.key = "storage.io-uring-rings",
+     .voltype = "storage/posix",
+     .op_version = GD_OP_VERSION_10_0},
+    {.key = "storage.io-uring-sqpoll",
+     .voltype = "storage/posix",
+     .op_version = GD_OP_VERSION_10_0},
+    {.key = "storage.io-uring-sqpoll-idle",
+     .voltype = "storage/posix",
+     .op_version = GD_OP_VERSION_10_0},
+    {.key = "storage.io-uring-iopoll",
+     .voltype = "storage/posix",
+     .op_version = GD_OP_VERSION_10_0},
     {.key = "storage.batch-fsync-mode",
      .voltype = "storage/posix",
      .op_version = 3},
@@ -3002,6 +3118,26 @@ struct volopt_map_entry glusterd_volopt_map[] = {
                     " count should be in the range"
                     "[disperse-data-count,  disperse-count] (inclusive)",
      .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.coding-threads",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.systematic",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.stripe-cache-size",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.heal-range-tasks",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
+    {.key = "disperse.heal-dirty-ranges",
+     .voltype = "cluster/disperse",
+     .op_version = GD_OP_VERSION_10_0,
+     .flags = VOLOPT_FLAG_CLIENT_OPT},
     {
         .key = "features.sdfs",
         .voltype = "features/sdfs",
@@ -3075,6 +3211,16 @@ struct volopt_map_entry glusterd_volopt_map[] = {
      .option = "!brick-threads",
      .value = "16",
      .op_version = GD_OP_VERSION_6_0},
+    {.key = VKEY_CONFIG_IOBUF_HUGEPAGES,
+     .voltype = "debug/io-stats",
+     .option = "iobuf-hugepages",
+     .value = "off",
+     .op_version = GD_OP_VERSION_10_0},
+    {.key = VKEY_CONFIG_IOBUF_NUMA,
+     .voltype = "debug/io-stats",
+     .option = "iobuf-numa",
+     .value = "off",
+     .op_version = GD_OP_VERSION_10_0},
     {.key = "features.cloudsync-remote-read",
      .voltype = "features/cloudsync",
      .value = "off",
@@ -1355,9 +1355,9 @@ client_post_stat(xlator_t *this, gfs3_stat_rsp *rsp, struct iatt *iatt,
         gf_stat_to_iatt(&rsp->stat, iatt);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1373,9 +1373,9 @@ client_post_readlink(xlator_t *this, gfs3_readlink_rsp *rsp, struct iatt *iatt,
         gf_stat_to_iatt(&rsp->buf, iatt);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
 
@@ -1394,9 +1394,9 @@ client_post_mknod(xlator_t *this, gfs3_mknod_rsp *rsp, struct iatt *stbuf,
         gf_stat_to_iatt(&rsp->preparent, preparent);
         gf_stat_to_iatt(&rsp->postparent, postparent);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1415,9 +1415,9 @@ client_post_mkdir(xlator_t *this, gfs3_mkdir_rsp *rsp, struct iatt *stbuf,
         gf_stat_to_iatt(&rsp->postparent, postparent);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1434,9 +1434,9 @@ client_post_unlink(xlator_t *this, gfs3_unlink_rsp *rsp, struct iatt *preparent,
         gf_stat_to_iatt(&rsp->postparent, postparent);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
     ret = gf_replace_new_iatt_in_dict(*xdata);
 out:
@@ -1453,9 +1453,9 @@ client_post_rmdir(xlator_t *this, gfs3_rmdir_rsp *rsp, struct iatt *preparent,
         gf_stat_to_iatt(&rsp->preparent, preparent);
         gf_stat_to_iatt(&rsp->postparent, postparent);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1473,9 +1473,9 @@ client_post_symlink(xlator_t *this, gfs3_symlink_rsp *rsp, struct iatt *stbuf,
         gf_stat_to_iatt(&rsp->preparent, preparent);
         gf_stat_to_iatt(&rsp->postparent, postparent);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1498,9 +1498,9 @@ client_post_rename(xlator_t *this, gfs3_rename_rsp *rsp, struct iatt *stbuf,
         gf_stat_to_iatt(&rsp->postnewparent, postnewparent);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1517,9 +1517,9 @@ client_post_link(xlator_t *this, gfs3_link_rsp *rsp, struct iatt *stbuf,
         gf_stat_to_iatt(&rsp->preparent, preparent);
         gf_stat_to_iatt(&rsp->postparent, postparent);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1535,9 +1535,9 @@ client_post_truncate(xlator_t *this, gfs3_truncate_rsp *rsp,
         gf_stat_to_iatt(&rsp->prestat, prestat);
         gf_stat_to_iatt(&rsp->poststat, poststat);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1547,9 +1547,9 @@ client_post_open(xlator_t *this, gfs3_open_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1571,9 +1571,9 @@ client_post_readv(xlator_t *this, gfs3_read_rsp *rsp, struct iobref **iobref,
             vector[0].iov_base = rsp_vector->iov_base;
         *rspcount = 1;
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 #ifdef GF_TESTING_IO_XDATA
     dict_dump_to_log(xdata);
@@ -1593,9 +1593,9 @@ client_post_writev(xlator_t *this, gfs3_write_rsp *rsp, struct iatt *prestat,
         gf_stat_to_iatt(&rsp->poststat, poststat);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1610,9 +1610,9 @@ client_post_statfs(xlator_t *this, gfs3_statfs_rsp *rsp, struct statvfs *statfs,
     if (-1 != rsp->op_ret) {
         gf_statfs_to_statfs(&rsp->statfs, statfs);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1622,9 +1622,9 @@ client_post_flush(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1640,9 +1640,9 @@ client_post_fsync(xlator_t *this, gfs3_fsync_rsp *rsp, struct iatt *prestat,
         gf_stat_to_iatt(&rsp->prestat, prestat);
         gf_stat_to_iatt(&rsp->poststat, poststat);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1652,9 +1652,9 @@ client_post_setxattr(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
     ret = gf_replace_new_iatt_in_dict(*xdata);
 out:
@@ -1673,8 +1673,9 @@ client_post_getxattr(xlator_t *this, gfs3_getxattr_rsp *rsp, dict_t **dict,
                                      (rsp->dict.dict_len), rsp->op_ret,
                                      op_errno, out);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret, op_errno,
+                                       out);
 
 out:
     return -op_errno;
@@ -1685,9 +1686,9 @@ client_post_removexattr(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
     ret = gf_replace_new_iatt_in_dict(*xdata);
 out:
@@ -1699,9 +1700,9 @@ client_post_opendir(xlator_t *this, gfs3_opendir_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1711,9 +1712,9 @@ client_post_fsyncdir(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1723,9 +1724,9 @@ client_post_access(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1744,9 +1745,9 @@ client_post_create(xlator_t *this, gfs3_create_rsp *rsp, struct iatt *stbuf,
         gf_stat_to_iatt(&rsp->postparent, postparent);
         gf_uuid_copy(local->loc.gfid, stbuf->ia_gfid);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1762,9 +1763,9 @@ client_post_ftruncate(xlator_t *this, gfs3_ftruncate_rsp *rsp,
         gf_stat_to_iatt(&rsp->prestat, prestat);
         gf_stat_to_iatt(&rsp->poststat, poststat);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1778,9 +1779,9 @@ client_post_fstat(xlator_t *this, gfs3_fstat_rsp *rsp, struct iatt *stat,
     if (-1 != rsp->op_ret) {
         gf_stat_to_iatt(&rsp->stat, stat);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return -ret;
 }
@@ -1794,9 +1795,9 @@ client_post_lk(xlator_t *this, gfs3_lk_rsp *rsp, struct gf_flock *lock,
     if (rsp->op_ret >= 0) {
         gf_proto_flock_to_flock(&rsp->flock, lock);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1812,9 +1813,9 @@ client_post_lookup(xlator_t *this, gfs3_lookup_rsp *rsp, struct iatt *stbuf,
         gf_stat_to_iatt(&rsp->stat, stbuf);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1828,9 +1829,9 @@ client_post_readdir(xlator_t *this, gfs3_readdir_rsp *rsp, gf_dirent_t *entries,
     if (rsp->op_ret > 0) {
         unserialize_rsp_dirent(this, rsp, entries);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1841,9 +1842,9 @@ client_post_inodelk(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1854,9 +1855,9 @@ client_post_finodelk(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1867,9 +1868,9 @@ client_post_entrylk(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1880,9 +1881,9 @@ client_post_fentrylk(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
 out:
     return ret;
@@ -1900,8 +1901,9 @@ client_post_xattrop(xlator_t *this, gfs3_xattrop_rsp *rsp, dict_t **dict,
                                      (rsp->dict.dict_len), rsp->op_ret,
                                      op_errno, out);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret, op_errno,
+                                       out);
 
 out:
     return -op_errno;
@@ -1919,8 +1921,9 @@ client_post_fxattrop(xlator_t *this, gfs3_fxattrop_rsp *rsp, dict_t **dict,
                                      (rsp->dict.dict_len), rsp->op_ret,
                                      op_errno, out);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret, op_errno,
+                                       out);
 
 out:
     return -op_errno;
@@ -1938,8 +1941,9 @@ client_post_fgetxattr(xlator_t *this, gfs3_fgetxattr_rsp *rsp, dict_t **dict,
                                      (rsp->dict.dict_len), rsp->op_ret,
                                      op_errno, out);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret, op_errno,
+                                       out);
 
 out:
     return -op_errno;
@@ -1950,9 +1954,9 @@ client_post_fsetxattr(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
     ret = gf_replace_new_iatt_in_dict(*xdata);
 out:
@@ -1964,9 +1968,9 @@ client_post_rchecksum(xlator_t *this, gfs3_rchecksum_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1981,9 +1985,9 @@ client_post_setattr(xlator_t *this, gfs3_setattr_rsp *rsp, struct iatt *prestat,
         gf_stat_to_iatt(&rsp->statpre, prestat);
         gf_stat_to_iatt(&rsp->statpost, poststat);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1999,9 +2003,9 @@ client_post_fsetattr(xlator_t *this, gfs3_fsetattr_rsp *rsp,
         gf_stat_to_iatt(&rsp->statpre, prestat);
         gf_stat_to_iatt(&rsp->statpost, poststat);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -2016,9 +2020,9 @@ client_post_readdirp(xlator_t *this, gfs3_readdirp_rsp *rsp, fd_t *fd,
         unserialize_rsp_direntp(this, fd, rsp, entries);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -2028,9 +2032,9 @@ client_post_fremovexattr(xlator_t *this, gf_common_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 
     ret = gf_replace_new_iatt_in_dict(*xdata);
 out:
@@ -2048,9 +2052,9 @@ client_post_fallocate(xlator_t *this, gfs3_fallocate_rsp *rsp,
         gf_stat_to_iatt(&rsp->statpre, prestat);
         gf_stat_to_iatt(&rsp->statpost, poststat);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -2065,9 +2069,9 @@ client_post_discard(xlator_t *this, gfs3_discard_rsp *rsp, struct iatt *prestat,
         gf_stat_to_iatt(&rsp->statpre, prestat);
         gf_stat_to_iatt(&rsp->statpost, poststat);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -2083,9 +2087,9 @@ client_post_zerofill(xlator_t *this, gfs3_zerofill_rsp *rsp,
         gf_stat_to_iatt(&rsp->statpre, prestat);
         gf_stat_to_iatt(&rsp->statpost, poststat);
     }
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -2095,9 +2099,9 @@ client_post_ipc(xlator_t *this, gfs3_ipc_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -2107,9 +2111,9 @@ client_post_seek(xlator_t *this, gfs3_seek_rsp *rsp, dict_t **xdata)
 {
     int ret = 0;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -2124,9 +2128,9 @@ client_post_lease(xlator_t *this, gfs3_lease_rsp *rsp, struct gf_lease *lease,
         gf_proto_lease_to_lease(&rsp->lease, lease);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, *xdata, (rsp->xdata.xdata_val),
-                                 (rsp->xdata.xdata_len), ret, rsp->op_errno,
-                                 out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, *xdata, (rsp->xdata.xdata_val),
+                                       (rsp->xdata.xdata_len), ret,
+                                       rsp->op_errno, out);
 out:
     return ret;
 }
@@ -1895,8 +1895,9 @@ client3_3_fallocate_cbk(struct rpc_req *req, struct iovec *iov, int count,
     if (ret < 0)
         goto out;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, xdata, (rsp.xdata.xdata_val),
-                                 (rsp.xdata.xdata_len), ret, rsp.op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, xdata, (rsp.xdata.xdata_val),
+                                       (rsp.xdata.xdata_len), ret, rsp.op_errno,
+                                       out);
 
 out:
     if (rsp.op_ret == -1) {
@@ -2984,8 +2985,9 @@ client3_3_getactivelk_cbk(struct rpc_req *req, struct iovec *iov, int count,
         clnt_unserialize_rsp_locklist(this, &rsp, &locklist);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, xdata, (rsp.xdata.xdata_val),
-                                 (rsp.xdata.xdata_len), ret, rsp.op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, xdata, (rsp.xdata.xdata_val),
+                                       (rsp.xdata.xdata_len), ret, rsp.op_errno,
+                                       out);
 
 out:
     if (rsp.op_ret == -1) {
@@ -3037,8 +3039,9 @@ client3_3_setactivelk_cbk(struct rpc_req *req, struct iovec *iov, int count,
         goto out;
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(this, xdata, (rsp.xdata.xdata_val),
-                                 (rsp.xdata.xdata_len), ret, rsp.op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(this, xdata, (rsp.xdata.xdata_val),
+                                       (rsp.xdata.xdata_len), ret, rsp.op_errno,
+                                       out);
 
 out:
     if (rsp.op_ret == -1) {
@@ -1476,3 +1476,50 @@ unserialize_req_locklist_v2(gfx_setactivelk_req *req,
 out:
     return ret;
 }
+
+/* Returns true if @xl or an xlator below it reads the bytes of WRITE
+ * payloads */
+static gf_boolean_t
+server_graph_reads_write_payload(xlator_t *xl)
+{
+    xlator_list_t *trav = NULL;
+
+    if (xl->flags & GF_XLATOR_READS_WRITE_PAYLOAD)
+        return _gf_true;
+
+    for (trav = xl->children; trav; trav = trav->next) {
+        if (server_graph_reads_write_payload(trav->xlator))
+            return _gf_true;
+    }
+
+    return _gf_false;
+}
+
+/* A WRITE payload the transport spliced to a pipe reaches the xlators as a
+ * vector with a NULL base. If any xlator of the brick graph reads payloads,
+ * it is copied into an iobuf here, and the xlators get an ordinary write.
+ * Returns 0 or an errno. */
+int
+server_unsplice_payload(xlator_t *bound_xl, server_state_t *state)
+{
+    struct iobuf *iobuf = NULL;
+    size_t size = 0;
+
+    if (!iobref_spliced(state->iobref) ||
+        !server_graph_reads_write_payload(bound_xl))
+        return 0;
+
+    iobuf = iobref_splice_to_iobuf(bound_xl->ctx->iobuf_pool, state->iobref,
+                                   &size);
+    if (!iobuf)
+        return ENOMEM;
+
+    if (size != iov_length(state->payload_vector, state->payload_count))
+        return EIO;
+
+    state->payload_vector[0].iov_base = iobuf_ptr(iobuf);
+    state->payload_vector[0].iov_len = size;
+    state->payload_count = 1;
+
+    return 0;
+}
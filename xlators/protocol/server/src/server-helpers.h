@@ -104,4 +104,7 @@ serialize_rsp_dirent_v2(gf_dirent_t *entries, gfx_readdir_rsp *rsp);
 int
 serialize_rsp_direntp_v2(gf_dirent_t *entries, gfx_readdirp_rsp *rsp);
 
+int
+server_unsplice_payload(xlator_t *bound_xl, server_state_t *state);
+
 #endif /* !_SERVER_HELPERS_H */
@@ -3003,12 +3003,20 @@ int
 server_writev_resume(call_frame_t *frame, xlator_t *bound_xl)
 {
     server_state_t *state = NULL;
+    int op_errno = 0;
 
     state = CALL_STATE(frame);
 
     if (state->resolve.op_ret != 0)
         goto err;
 
+    op_errno = server_unsplice_payload(bound_xl, state);
+    if (op_errno != 0) {
+        server_writev_cbk(frame, NULL, frame->this, -1, op_errno, NULL,
+                          NULL, NULL);
+        return 0;
+    }
+
     STACK_WIND(frame, server_writev_cbk, bound_xl, bound_xl->fops->writev,
                state->fd, state->payload_vector, state->payload_count,
                state->offset, state->flags, state->iobref, state->xdata);
@@ -3453,9 +3461,10 @@ server3_3_stat(rpcsvc_request_t *req)
     state->resolve.type = RESOLVE_MUST;
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_stat_resume);
@@ -3497,9 +3506,10 @@ server3_3_setattr(rpcsvc_request_t *req)
     gf_stat_to_iatt(&args.stbuf, &state->stbuf);
     state->valid = args.valid;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_setattr_resume);
@@ -3539,9 +3549,10 @@ server3_3_fsetattr(rpcsvc_request_t *req)
     gf_stat_to_iatt(&args.stbuf, &state->stbuf);
     state->valid = args.valid;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fsetattr_resume);
@@ -3583,9 +3594,10 @@ server3_3_fallocate(rpcsvc_request_t *req)
     state->size = args.size;
     memcpy(state->resolve.gfid, args.gfid, 16);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fallocate_resume);
@@ -3626,9 +3638,10 @@ server3_3_discard(rpcsvc_request_t *req)
     state->size = args.size;
     memcpy(state->resolve.gfid, args.gfid, 16);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_discard_resume);
@@ -3669,9 +3682,10 @@ server3_3_zerofill(rpcsvc_request_t *req)
     state->size = args.size;
     memcpy(state->resolve.gfid, args.gfid, 16);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 (args.xdata.xdata_val), (args.xdata.xdata_len),
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, (args.xdata.xdata_val),
+                                       (args.xdata.xdata_len), ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_zerofill_resume);
@@ -3707,8 +3721,10 @@ server3_3_ipc(rpcsvc_request_t *req)
     }
 
     bound_xl = frame->root->client->bound_xl;
-    GF_PROTOCOL_DICT_UNSERIALIZE(bound_xl, state->xdata, args.xdata.xdata_val,
-                                 args.xdata.xdata_len, ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(bound_xl, state->xdata,
+                                       args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     STACK_WIND(frame, server_ipc_cbk, bound_xl, bound_xl->fops->ipc, args.op,
@@ -3754,8 +3770,10 @@ server3_3_seek(rpcsvc_request_t *req)
     memcpy(state->resolve.gfid, args.gfid, 16);
 
     bound_xl = frame->root->client->bound_xl;
-    GF_PROTOCOL_DICT_UNSERIALIZE(bound_xl, state->xdata, args.xdata.xdata_val,
-                                 args.xdata.xdata_len, ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(bound_xl, state->xdata,
+                                       args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_seek_resume);
@@ -3796,9 +3814,10 @@ server3_3_readlink(rpcsvc_request_t *req)
 
     state->size = args.size;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_readlink_resume);
@@ -3848,9 +3867,10 @@ server3_3_create(rpcsvc_request_t *req)
     }
 
     /* TODO: can do alloca for xdata field instead of stdalloc */
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_create_resume);
@@ -3893,9 +3913,10 @@ server3_3_open(rpcsvc_request_t *req)
 
     state->flags = gf_flags_to_flags(args.flags);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_open_resume);
@@ -3938,9 +3959,10 @@ server3_3_readv(rpcsvc_request_t *req)
 
     memcpy(state->resolve.gfid, args.gfid, 16);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_readv_resume);
@@ -4000,9 +4022,10 @@ server3_3_writev(rpcsvc_request_t *req)
 
     GF_ASSERT(state->size == len);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
 #ifdef GF_TESTING_IO_XDATA
     dict_dump_to_log(state->xdata);
@@ -4202,9 +4225,10 @@ server3_3_fsync(rpcsvc_request_t *req)
     state->flags = args.data;
     memcpy(state->resolve.gfid, args.gfid, 16);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fsync_resume);
@@ -4243,9 +4267,10 @@ server3_3_flush(rpcsvc_request_t *req)
     state->resolve.fd_no = args.fd;
     memcpy(state->resolve.gfid, args.gfid, 16);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_flush_resume);
@@ -4285,9 +4310,10 @@ server3_3_ftruncate(rpcsvc_request_t *req)
     state->offset = args.offset;
     memcpy(state->resolve.gfid, args.gfid, 16);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_ftruncate_resume);
@@ -4326,9 +4352,10 @@ server3_3_fstat(rpcsvc_request_t *req)
     state->resolve.fd_no = args.fd;
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fstat_resume);
@@ -4367,9 +4394,10 @@ server3_3_truncate(rpcsvc_request_t *req)
     memcpy(state->resolve.gfid, args.gfid, 16);
     state->offset = args.offset;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_truncate_resume);
@@ -4411,9 +4439,10 @@ server3_3_unlink(rpcsvc_request_t *req)
 
     state->flags = args.xflags;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_unlink_resume);
@@ -4463,9 +4492,10 @@ server3_3_setxattr(rpcsvc_request_t *req)
     /* There can be some commands hidden in key, check and proceed */
     gf_server_check_setxattr_cmd(frame, dict);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_setxattr_resume);
@@ -4520,9 +4550,10 @@ server3_3_fsetxattr(rpcsvc_request_t *req)
 
     state->dict = dict;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fsetxattr_resume);
@@ -4577,9 +4608,10 @@ server3_3_fxattrop(rpcsvc_request_t *req)
 
     state->dict = dict;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fxattrop_resume);
@@ -4633,9 +4665,10 @@ server3_3_xattrop(rpcsvc_request_t *req)
 
     state->dict = dict;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_xattrop_resume);
@@ -4687,9 +4720,10 @@ server3_3_getxattr(rpcsvc_request_t *req)
         gf_server_check_getxattr_cmd(frame, state->name);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_getxattr_resume);
@@ -4731,9 +4765,10 @@ server3_3_fgetxattr(rpcsvc_request_t *req)
     if (args.namelen)
         state->name = gf_strdup(args.name);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fgetxattr_resume);
@@ -4773,9 +4808,10 @@ server3_3_removexattr(rpcsvc_request_t *req)
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
     state->name = gf_strdup(args.name);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_removexattr_resume);
@@ -4816,9 +4852,10 @@ server3_3_fremovexattr(rpcsvc_request_t *req)
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
     state->name = gf_strdup(args.name);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fremovexattr_resume);
@@ -4857,9 +4894,10 @@ server3_3_opendir(rpcsvc_request_t *req)
     state->resolve.type = RESOLVE_MUST;
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_opendir_resume);
@@ -4966,9 +5004,10 @@ server3_3_readdir(rpcsvc_request_t *req)
     state->offset = args.offset;
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_readdir_resume);
@@ -5008,9 +5047,10 @@ server3_3_fsyncdir(rpcsvc_request_t *req)
     state->flags = args.data;
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fsyncdir_resume);
@@ -5054,9 +5094,10 @@ server3_3_mknod(rpcsvc_request_t *req)
     state->dev = args.dev;
     state->umask = args.umask;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_mknod_resume);
@@ -5102,9 +5143,10 @@ server3_3_mkdir(rpcsvc_request_t *req)
     state->umask = args.umask;
 
     /* TODO: can do alloca for xdata field instead of stdalloc */
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_mkdir_resume);
@@ -5147,9 +5189,10 @@ server3_3_rmdir(rpcsvc_request_t *req)
 
     state->flags = args.xflags;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_rmdir_resume);
@@ -5219,9 +5262,10 @@ server3_3_inodelk(rpcsvc_request_t *req)
             break;
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_inodelk_resume);
@@ -5293,9 +5337,10 @@ server3_3_finodelk(rpcsvc_request_t *req)
             break;
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_finodelk_resume);
@@ -5343,9 +5388,10 @@ server3_3_entrylk(rpcsvc_request_t *req)
     state->cmd = args.cmd;
     state->type = args.type;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_entrylk_resume);
@@ -5392,9 +5438,10 @@ server3_3_fentrylk(rpcsvc_request_t *req)
         state->name = gf_strdup(args.name);
     state->volume = gf_strdup(args.volume);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_fentrylk_resume);
@@ -5435,9 +5482,10 @@ server3_3_access(rpcsvc_request_t *req)
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
     state->mask = args.mask;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_access_resume);
@@ -5478,9 +5526,10 @@ server3_3_symlink(rpcsvc_request_t *req)
     state->name = gf_strdup(args.linkname);
     state->umask = args.umask;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_symlink_resume);
@@ -5527,9 +5576,10 @@ server3_3_link(rpcsvc_request_t *req)
     set_resolve_gfid(frame->root->client, state->resolve2.pargfid,
                      args.newgfid);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_link_resume);
@@ -5574,9 +5624,10 @@ server3_3_rename(rpcsvc_request_t *req)
     set_resolve_gfid(frame->root->client, state->resolve2.pargfid,
                      args.newgfid);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_rename_resume);
@@ -5617,9 +5668,10 @@ server3_3_lease(rpcsvc_request_t *req)
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
     gf_proto_lease_to_lease(&args.lease, &state->lease);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_lease_resume);
@@ -5706,9 +5758,10 @@ server3_3_lk(rpcsvc_request_t *req)
             break;
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_lk_resume);
@@ -5748,9 +5801,10 @@ server3_3_rchecksum(rpcsvc_request_t *req)
     state->offset = args.offset;
     state->size = args.len;
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_rchecksum_resume);
@@ -5809,9 +5863,9 @@ server3_3_lookup(rpcsvc_request_t *req)
         set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
     }
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, ret, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, ret, out);
 
     ret = 0;
     resolve_and_resume(frame, server_lookup_resume);
@@ -5857,9 +5911,10 @@ server3_3_statfs(rpcsvc_request_t *req)
     state->resolve.type = RESOLVE_MUST;
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 args.xdata.xdata_val, args.xdata.xdata_len,
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, args.xdata.xdata_val,
+                                       args.xdata.xdata_len, ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_statfs_resume);
@@ -5898,9 +5953,10 @@ server3_3_getactivelk(rpcsvc_request_t *req)
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
     /* here, dict itself works as xdata */
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 (args.xdata.xdata_val), (args.xdata.xdata_len),
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, (args.xdata.xdata_val),
+                                       (args.xdata.xdata_len), ret, op_errno,
+                                       out);
 
     ret = 0;
     resolve_and_resume(frame, server_getactivelk_resume);
@@ -5939,9 +5995,10 @@ server3_3_setactivelk(rpcsvc_request_t *req)
     set_resolve_gfid(frame->root->client, state->resolve.gfid, args.gfid);
 
     /* here, dict itself works as xdata */
-    GF_PROTOCOL_DICT_UNSERIALIZE(frame->root->client->bound_xl, state->xdata,
-                                 (args.xdata.xdata_val), (args.xdata.xdata_len),
-                                 ret, op_errno, out);
+    GF_PROTOCOL_DICT_UNSERIALIZE_ADOPT(frame->root->client->bound_xl,
+                                       state->xdata, (args.xdata.xdata_val),
+                                       (args.xdata.xdata_len), ret, op_errno,
+                                       out);
 
     ret = unserialize_req_locklist(&args, &state->locklist);
     if (ret)
@@ -3008,12 +3008,20 @@ int
 server4_writev_resume(call_frame_t *frame, xlator_t *bound_xl)
 {
     server_state_t *state = NULL;
+    int op_errno = 0;
 
     state = CALL_STATE(frame);
 
     if (state->resolve.op_ret != 0)
         goto err;
 
+    op_errno = server_unsplice_payload(bound_xl, state);
+    if (op_errno != 0) {
+        server4_writev_cbk(frame, NULL, frame->this, -1, op_errno, NULL,
+                           NULL, NULL);
+        return 0;
+    }
+
     STACK_WIND(frame, server4_writev_cbk, bound_xl, bound_xl->fops->writev,
                state->fd, state->payload_vector, state->payload_count,
                state->offset, state->flags, state->iobref, state->xdata);
@@ -239,6 +239,9 @@ server_priv(xlator_t *this)
     };
     uint64_t total_read = 0;
     uint64_t total_write = 0;
+    uint64_t zerocopy_sends = 0;
+    uint64_t zerocopy_completed = 0;
+    uint64_t zerocopy_copied = 0;
     int32_t ret = -1;
 
     GF_VALIDATE_OR_GOTO("server", this, out);
@@ -258,6 +261,9 @@ server_priv(xlator_t *this)
         {
             total_read += xprt->total_bytes_read;
             total_write += xprt->total_bytes_write;
+            zerocopy_sends += xprt->total_zerocopy_sends;
+            zerocopy_completed += xprt->total_zerocopy_completed;
+            zerocopy_copied += xprt->total_zerocopy_copied;
         }
     }
     pthread_mutex_unlock(&conf->mutex);
@@ -268,6 +274,15 @@ server_priv(xlator_t *this)
     gf_proc_dump_build_key(key, "server", "total-bytes-write");
     gf_proc_dump_write(key, "%" PRIu64, total_write);
 
+    gf_proc_dump_build_key(key, "server", "total-zerocopy-sends");
+    gf_proc_dump_write(key, "%" PRIu64, zerocopy_sends);
+
+    gf_proc_dump_build_key(key, "server", "total-zerocopy-completed");
+    gf_proc_dump_write(key, "%" PRIu64, zerocopy_completed);
+
+    gf_proc_dump_build_key(key, "server", "total-zerocopy-copied");
+    gf_proc_dump_write(key, "%" PRIu64, zerocopy_copied);
+
     rpcsvc_statedump(conf->rpc);
 
     ret = 0;
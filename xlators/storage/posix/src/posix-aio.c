@@ -333,6 +333,11 @@ posix_aio_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
     VALIDATE_OR_GOTO(this, err);
     VALIDATE_OR_GOTO(fd, err);
 
+    /* spliced payloads live in a pipe, not in memory */
+    if (iobref_spliced(iobref))
+        return posix_writev(frame, this, fd, iov, count, offset, flags, iobref,
+                            xdata);
+
     priv = this->private;
     DISK_SPACE_CHECK_AND_GOTO(frame, priv, xdata, op_errno, op_errno, err);
 
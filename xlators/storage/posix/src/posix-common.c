@@ -119,6 +119,8 @@ posix_priv(xlator_t *this)
     gf_proc_dump_write("max_read", "%" PRId64, GF_ATOMIC_GET(priv->read_value));
     gf_proc_dump_write("max_write", "%" PRId64,
                        GF_ATOMIC_GET(priv->write_value));
+    gf_proc_dump_write("spliced_writes", "%" PRId64,
+                       GF_ATOMIC_GET(priv->spliced_writes));
 
     return 0;
 }
@@ -342,6 +344,10 @@ posix_reconfigure(xlator_t *this, dict_t *options)
     int32_t create_mask = -1;
     int32_t create_directory_mask = -1;
     double old_disk_reserve = 0.0;
+    int32_t io_uring_rings = 1;
+    uint32_t io_uring_sqpoll_idle = 0;
+    gf_boolean_t io_uring_sqpoll = _gf_false;
+    gf_boolean_t io_uring_iopoll = _gf_false;
 
     priv = this->private;
 
@@ -393,6 +399,25 @@ posix_reconfigure(xlator_t *this, dict_t *options)
     else
         posix_aio_off(this);
 
+    GF_OPTION_RECONF("io-uring-rings", io_uring_rings, options, int32, out);
+    GF_OPTION_RECONF("io-uring-sqpoll", io_uring_sqpoll, options, bool, out);
+    GF_OPTION_RECONF("io-uring-sqpoll-idle", io_uring_sqpoll_idle, options,
+                     uint32, out);
+    GF_OPTION_RECONF("io-uring-iopoll", io_uring_iopoll, options, bool, out);
+
+    if ((io_uring_rings != priv->io_uring_rings) ||
+        (io_uring_sqpoll != priv->io_uring_sqpoll) ||
+        (io_uring_sqpoll_idle != priv->io_uring_sqpoll_idle) ||
+        (io_uring_iopoll != priv->io_uring_iopoll)) {
+        /* the rings are set up again below with the new layout */
+        if (priv->io_uring_configured)
+            posix_io_uring_off(this);
+        priv->io_uring_rings = io_uring_rings;
+        priv->io_uring_sqpoll = io_uring_sqpoll;
+        priv->io_uring_sqpoll_idle = io_uring_sqpoll_idle;
+        priv->io_uring_iopoll = io_uring_iopoll;
+    }
+
     GF_OPTION_RECONF("linux-io_uring", priv->io_uring_configured, options, bool,
                      out);
 
@@ -899,6 +924,7 @@ posix_init(xlator_t *this)
     LOCK_INIT(&_private->lock);
     GF_ATOMIC_INIT(_private->read_value, 0);
     GF_ATOMIC_INIT(_private->write_value, 0);
+    GF_ATOMIC_INIT(_private->spliced_writes, 0);
 
     _private->export_statfs = 1;
     tmp_data = dict_get(this->options, "export-statfs-size");
@@ -1100,6 +1126,15 @@ posix_init(xlator_t *this)
         }
     }
 
+    GF_OPTION_INIT("io-uring-rings", _private->io_uring_rings, int32, out);
+    GF_OPTION_INIT("io-uring-sqpoll", _private->io_uring_sqpoll, bool, out);
+    GF_OPTION_INIT("io-uring-sqpoll-idle", _private->io_uring_sqpoll_idle,
+                   uint32, out);
+    GF_OPTION_INIT("io-uring-iopoll", _private->io_uring_iopoll, bool, out);
+
+#ifdef HAVE_LIBURING
+    pthread_rwlock_init(&_private->uring_lock, NULL);
+#endif
     GF_OPTION_INIT("linux-io_uring", _private->io_uring_configured, bool, out);
     if (_private->io_uring_configured) {
         op_ret = posix_io_uring_on(this);
@@ -1356,6 +1391,9 @@ posix_fini(xlator_t *this)
     pthread_cond_destroy(&priv->fsync_cond);
     pthread_mutex_destroy(&priv->janitor_mutex);
     pthread_cond_destroy(&priv->janitor_cond);
+#ifdef HAVE_LIBURING
+    pthread_rwlock_destroy(&priv->uring_lock);
+#endif
     GF_FREE(priv->hostname);
     GF_FREE(priv->trash_path);
     GF_FREE(priv);
@@ -1395,9 +1433,48 @@ struct volume_options posix_options[] = {
     {.key = {"linux-io_uring"},
      .type = GF_OPTION_TYPE_BOOL,
      .default_value = "off",
-     .description = "Support for Linux io_uring",
+     .description = "Support for Linux io_uring. Reads, writes, fsync, open, "
+                    "fstat, fallocate and discard are submitted to the "
+                    "ring, using registered iobufs and files when possible",
      .op_version = {GD_OP_VERSION_9_0},
      .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"io-uring-rings"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 1,
+     .max = POSIX_URING_MAX_RINGS,
+     .default_value = "1",
+     .description = "Number of io_uring rings, each with its own completion "
+                    "thread. Requests are spread over the rings by fd, which "
+                    "lets a brick on fast NVMe devices use more than one core "
+                    "for completions",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"io-uring-sqpoll"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .description = "Set up the io_uring rings with a kernel submission "
+                    "polling thread (IORING_SETUP_SQPOLL), avoiding a system "
+                    "call per submission",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"io-uring-sqpoll-idle"},
+     .type = GF_OPTION_TYPE_INT,
+     .min = 0,
+     .max = POSIX_URING_MAX_SQPOLL_IDLE,
+     .default_value = "1000",
+     .description = "Time in milliseconds the submission polling thread "
+                    "spins without work before going to sleep",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
+    {.key = {"io-uring-iopoll"},
+     .type = GF_OPTION_TYPE_BOOL,
+     .default_value = "off",
+     .description = "Busy-poll for io_uring completions (IORING_SETUP_IOPOLL). "
+                    "Only reads and writes on O_DIRECT fds (see o-direct) are "
+                    "submitted to polled rings, all other requests are served "
+                    "synchronously",
+     .op_version = {GD_OP_VERSION_10_0},
+     .flags = OPT_FLAG_SETTABLE | OPT_FLAG_DOC},
     {.key = {"brick-uid"},
      .type = GF_OPTION_TYPE_INT,
      .min = -1,
@@ -676,6 +676,21 @@ posix_fdstat(xlator_t *this, inode_t *inode, int fd, struct iatt *stbuf_p)
     struct stat fstatbuf = {
         0,
     };
+
+    ret = sys_fstat(fd, &fstatbuf);
+    if (ret == -1)
+        return ret;
+
+    return posix_fdstat_from_stat(this, inode, fd, &fstatbuf, stbuf_p);
+}
+
+/* Completes a posix_fdstat() for which the fstat() itself has already been
+ * done by the caller (e.g. asynchronously through io_uring). */
+int
+posix_fdstat_from_stat(xlator_t *this, inode_t *inode, int fd,
+                       struct stat *fstatbuf, struct iatt *stbuf_p)
+{
+    int ret = 0;
     struct iatt stbuf = {
         0,
     };
@@ -683,14 +698,10 @@ posix_fdstat(xlator_t *this, inode_t *inode, int fd, struct iatt *stbuf_p)
 
     priv = this->private;
 
-    ret = sys_fstat(fd, &fstatbuf);
-    if (ret == -1)
-        goto out;
-
-    if (fstatbuf.st_nlink && !S_ISDIR(fstatbuf.st_mode))
-        fstatbuf.st_nlink--;
+    if (fstatbuf->st_nlink && !S_ISDIR(fstatbuf->st_mode))
+        fstatbuf->st_nlink--;
 
-    iatt_from_stat(&stbuf, &fstatbuf);
+    iatt_from_stat(&stbuf, fstatbuf);
 
     if (inode && priv->ctime) {
         ret = posix_get_mdata_xattr(this, NULL, fd, inode, &stbuf);
@@ -53,6 +53,7 @@
 #include "posix-metadata.h"
 #include <glusterfs/events.h>
 #include "posix-gfid-path.h"
+#include "posix-io-uring.h"
 #include <glusterfs/compat-uuid.h>
 #include <glusterfs/common-utils.h>
 
@@ -1945,6 +1946,57 @@ out:
     return rsp_xdata;
 }
 
+/* Writes a payload that the transport left in a pipe (see iobref_spliced())
+ * without copying it through user space. Files that can't be spliced to
+ * (O_DIRECT, O_APPEND, some filesystems) get the payload copied instead. */
+static int32_t
+__posix_splice_writev(xlator_t *this, int fd, struct iobref *iobref,
+                      off_t startoff, int odirect)
+{
+    int32_t op_ret = 0;
+    ssize_t retval = 0;
+    loff_t internal_off = startoff;
+    struct iobuf *iobuf = NULL;
+    struct iovec vec = {
+        0,
+    };
+    size_t size = 0;
+
+#ifdef GF_LINUX_HOST_OS
+    if (odirect)
+        goto copy;
+
+    while (op_ret < iobref->splice_len) {
+        retval = splice(iobref->splice_fd, NULL, fd, &internal_off,
+                        iobref->splice_len - op_ret, SPLICE_F_MOVE);
+        if (retval > 0) {
+            op_ret += retval;
+            continue;
+        }
+        if ((retval < 0) && (errno == EINTR))
+            continue;
+        if ((op_ret == 0) && (retval < 0) && (errno == EINVAL))
+            goto copy;
+        /* the pipe can't run dry before splice_len bytes were moved */
+        return (retval < 0) ? -errno : -EIO;
+    }
+
+    return op_ret;
+#endif
+
+copy:
+    iobuf = iobref_splice_to_iobuf(this->ctx->iobuf_pool, iobref, &size);
+    if (!iobuf)
+        return errno ? -errno : -ENOMEM;
+    if (size != iobref->splice_len)
+        return -EIO;
+
+    vec.iov_base = iobuf_ptr(iobuf);
+    vec.iov_len = size;
+
+    return __posix_writev(fd, &vec, 1, startoff, odirect);
+}
+
 int32_t
 posix_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
              struct iovec *vector, int32_t count, off_t offset, uint32_t flags,
@@ -2074,8 +2126,14 @@ overwrite:
             is_append = 1;
     }
 
-    op_ret = __posix_writev(_fd, vector, count, offset,
-                            (pfd->flags & O_DIRECT));
+    if (iobref_spliced(iobref)) {
+        op_ret = __posix_splice_writev(this, _fd, iobref, offset,
+                                       (pfd->flags & O_DIRECT));
+        GF_ATOMIC_INC(priv->spliced_writes);
+    } else {
+        op_ret = __posix_writev(_fd, vector, count, offset,
+                                (pfd->flags & O_DIRECT));
+    }
 
     if (locked && (!update_atomic)) {
         pthread_mutex_unlock(&ctx->write_atomic_lock);
@@ -2603,6 +2661,10 @@ posix_release(xlator_t *this, fd_t *fd)
                "pfd->dir is %p (not NULL) for file fd=%p", pfd->dir, fd);
     }
 
+    /* the slot must be dropped before the janitor closes the fd */
+    if (pfd->fixed_file)
+        posix_io_uring_fd_release(this, pfd);
+
     posix_add_fd_to_cleanup(this, pfd);
 
 out:
@@ -5883,6 +5945,46 @@ posix_readdirp(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
     return 0;
 }
 
+/* Checksums of each block_size bytes of buf, so that the caller can tell
+ * which parts of the range differ with a single request. */
+static int
+posix_rchecksum_blocks(xlator_t *this, char *buf, size_t size,
+                       uint32_t block_size, dict_t *rsp_xdata)
+{
+    struct posix_private *priv = this->private;
+    unsigned char *checksums = NULL;
+    size_t digest_len = GF_XXH64_DIGEST_LENGTH;
+    size_t count = 0;
+    size_t len = 0;
+    size_t i = 0;
+    int ret = 0;
+
+    if (priv->fips_mode_rchecksum)
+        digest_len = SHA256_DIGEST_LENGTH;
+
+    count = (size + block_size - 1) / block_size;
+    checksums = GF_CALLOC(count + 1, digest_len, gf_common_mt_char);
+    if (!checksums)
+        return -ENOMEM;
+
+    for (i = 0; i < count; i++) {
+        len = min(size - i * block_size, block_size);
+        if (priv->fips_mode_rchecksum)
+            gf_rsync_strong_checksum((unsigned char *)buf + i * block_size,
+                                     len, checksums + i * digest_len);
+        else
+            gf_rsync_xxh64_checksum((unsigned char *)buf + i * block_size,
+                                    len, checksums + i * digest_len);
+    }
+
+    ret = dict_set_bin(rsp_xdata, "rchecksum-blocks", checksums,
+                       count * digest_len);
+    if (ret)
+        GF_FREE(checksums);
+
+    return ret;
+}
+
 int32_t
 posix_rchecksum(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
                 int32_t len, dict_t *xdata)
@@ -5897,6 +5999,7 @@ posix_rchecksum(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
     ssize_t bytes_read = 0;
     int32_t weak_checksum = 0;
     int32_t zerofillcheck = 0;
+    uint32_t block_size = 0;
     /* Protocol version 4 uses 32 bytes i.e SHA256_DIGEST_LENGTH,
        so this is used. */
     unsigned char md5_checksum[SHA256_DIGEST_LENGTH] = {0};
@@ -5987,6 +6090,24 @@ posix_rchecksum(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
             goto out;
         }
     }
+    if (xdata &&
+        dict_get_uint32(xdata, "rchecksum-block-size", &block_size) == 0 &&
+        block_size) {
+        /* The checksums of the blocks replace the ones of the range. */
+        ret = posix_rchecksum_blocks(this, buf, bytes_read, block_size,
+                                     rsp_xdata);
+        if (ret) {
+            gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_DICT_SET_FAILED,
+                   "%s: Failed to set "
+                   "dictionary value for key: %s",
+                   uuid_utoa(fd->inode->gfid), "rchecksum-blocks");
+            op_errno = -ret;
+            goto out;
+        }
+        checksum = md5_checksum;
+        goto done;
+    }
+
     weak_checksum = gf_rsync_weak_checksum((unsigned char *)buf,
                                            (size_t)bytes_read);
 
@@ -6007,6 +6128,7 @@ posix_rchecksum(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
         gf_rsync_md5_checksum((unsigned char *)buf, (size_t)bytes_read,
                               (unsigned char *)checksum);
     }
+done:
     op_ret = 0;
 
     posix_set_ctime(frame, this, NULL, _fd, fd->inode, NULL);
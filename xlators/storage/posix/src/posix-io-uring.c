@@ -12,6 +12,9 @@
 #include "posix-messages.h"
 #include "posix-io-uring.h"
 #include "posix-handle.h"
+#include "posix-metadata.h"
+#include <glusterfs/syscall.h>
+#include <sched.h>
 
 #ifdef HAVE_LIBURING
 #include <liburing.h>
@@ -27,7 +30,9 @@ struct posix_uring_ctx {
     struct iatt prebuf;
     dict_t *xdata;
     fd_t *fd;
+    struct posix_uring *uring; /* ring the request is submitted to */
     int _fd;
+    int fixed; /* fixed file slot of _fd, -1 if not registered */
     int op;
 
     union {
@@ -46,12 +51,175 @@ struct posix_uring_ctx {
         struct {
             int32_t datasync;
         } fsync;
+
+        struct {
+            int32_t mode;
+            off_t offset;
+            size_t len;
+        } fallocate;
+
+        struct {
+            struct statx stx;
+        } fstat;
+
+        struct {
+            char *real_path;
+            int32_t flags;
+            struct iatt stbuf;
+        } open;
     } fop;
 
     fop_prep_f *prepare;
     fop_unwind_f *unwind;
 };
 
+/* Requests are sharded over the rings by fd, so that all requests on an fd
+ * (and its fixed file slot) stay on one ring. */
+static struct posix_uring *
+posix_io_uring_get_ring(struct posix_private *priv, int fd)
+{
+    return &priv->rings[(unsigned int)fd % priv->uring_count];
+}
+
+/* The rings can be torn down by a reconfigure while fops that already
+ * picked the io_uring handlers are running. The __posix_io_uring_* fops are
+ * called with priv->uring_lock read-locked and the rings set up; without
+ * rings the synchronous fops are used. */
+static gf_boolean_t
+posix_io_uring_enter(struct posix_private *priv)
+{
+    pthread_rwlock_rdlock(&priv->uring_lock);
+    if (priv->uring_count > 0)
+        return _gf_true;
+
+    pthread_rwlock_unlock(&priv->uring_lock);
+    return _gf_false;
+}
+
+static void
+posix_io_uring_exit(struct posix_private *priv)
+{
+    pthread_rwlock_unlock(&priv->uring_lock);
+}
+
+/* Returns the fixed file slot for @pfd, registering the fd with its ring on
+ * first use. -1 means the fd has to be passed to the kernel as is. */
+static int
+posix_io_uring_fixed_file(xlator_t *this, struct posix_uring *uring,
+                          struct posix_fd *pfd)
+{
+    int slot = -1;
+    int i = 0;
+    int ret = 0;
+
+    if (!uring->files || pfd->fd < 0)
+        return -1;
+
+    pthread_mutex_lock(&uring->files_lock);
+    {
+        /* a slot is only trusted while the table still maps it to our fd,
+         * so that stale slots from a previous ring are ignored */
+        if (pfd->fixed_file && uring->files[pfd->fixed_file - 1] == pfd->fd) {
+            slot = pfd->fixed_file - 1;
+            goto unlock;
+        }
+
+        for (i = 0; i < uring->file_count; i++) {
+            if (uring->files[uring->file_hint] == -1) {
+                slot = uring->file_hint;
+                break;
+            }
+            uring->file_hint = (uring->file_hint + 1) % uring->file_count;
+        }
+        if (slot == -1)
+            goto unlock;
+
+        ret = io_uring_register_files_update(&uring->ring, slot, &pfd->fd, 1);
+        if (ret != 1) {
+            gf_msg_debug(this->name, -ret,
+                         "failed to register fd %d in slot %d", pfd->fd,
+                         slot);
+            slot = -1;
+            goto unlock;
+        }
+        uring->files[slot] = pfd->fd;
+        pfd->fixed_file = slot + 1;
+    }
+unlock:
+    pthread_mutex_unlock(&uring->files_lock);
+
+    return slot;
+}
+
+void
+posix_io_uring_fd_release(xlator_t *this, struct posix_fd *pfd)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring *uring = NULL;
+    int slot = pfd->fixed_file - 1;
+    int unused = -1;
+
+    pfd->fixed_file = 0;
+    if (slot < 0 || !posix_io_uring_enter(priv))
+        return;
+
+    uring = posix_io_uring_get_ring(priv, pfd->fd);
+    pthread_mutex_lock(&uring->files_lock);
+    {
+        if (uring->files && uring->files[slot] == pfd->fd) {
+            (void)io_uring_register_files_update(&uring->ring, slot, &unused,
+                                                 1);
+            uring->files[slot] = -1;
+        }
+    }
+    pthread_mutex_unlock(&uring->files_lock);
+
+    posix_io_uring_exit(priv);
+}
+
+/* Returns the index of the buffer registered with @uring containing
+ * [@ptr, @ptr + @len), or -1 if there is none. */
+static int
+posix_io_uring_fixed_buf(struct posix_private *priv,
+                         struct posix_uring *uring, void *ptr, size_t len)
+{
+    char *base = NULL;
+    int i = 0;
+
+    for (i = 0; i < uring->buf_count; i++) {
+        base = priv->uring_bufs[i].iov_base;
+        if (((char *)ptr >= base) &&
+            ((char *)ptr + len <= base + priv->uring_bufs[i].iov_len))
+            return i;
+    }
+
+    return -1;
+}
+
+static void
+posix_io_uring_set_fixed_file(struct io_uring_sqe *sqe,
+                              struct posix_uring_ctx *ctx)
+{
+    if (ctx->fixed < 0)
+        return;
+
+    sqe->fd = ctx->fixed;
+    sqe->flags |= IOSQE_FIXED_FILE;
+}
+
+/* IOPOLL rings can only complete reads and writes on O_DIRECT fds */
+static gf_boolean_t
+posix_io_uring_can_poll(xlator_t *this, fd_t *fd)
+{
+    struct posix_fd *pfd = NULL;
+    int op_errno = 0;
+
+    if (posix_fd_ctx_get(fd, this, &pfd, &op_errno) < 0)
+        return _gf_false;
+
+    return (pfd->flags & O_DIRECT) ? _gf_true : _gf_false;
+}
+
 static void
 posix_io_uring_ctx_free(struct posix_uring_ctx *ctx)
 {
@@ -66,6 +234,9 @@ posix_io_uring_ctx_free(struct posix_uring_ctx *ctx)
             if (ctx->fop.read.iobuf)
                 iobuf_unref(ctx->fop.read.iobuf);
             break;
+        case GF_FOP_OPEN:
+            GF_FREE(ctx->fop.open.real_path);
+            break;
         default:
             break;
     }
@@ -77,6 +248,7 @@ posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
                         fop_prep_f prepare, fop_unwind_f unwind,
                         int32_t *op_errno, dict_t *xdata)
 {
+    struct posix_private *priv = this->private;
     struct posix_uring_ctx *ctx = NULL;
     struct posix_fd *pfd = NULL;
     int ret = 0;
@@ -93,6 +265,14 @@ posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
     if (xdata)
         ctx->xdata = dict_ref(xdata);
     ctx->op = op;
+    ctx->_fd = -1;
+    ctx->fixed = -1;
+
+    /* open creates the fd context on completion */
+    if (op == GF_FOP_OPEN) {
+        ctx->uring = posix_io_uring_get_ring(priv, fd->inode->gfid[15]);
+        return ctx;
+    }
 
     ret = posix_fd_ctx_get(fd, this, &pfd, op_errno);
     if (ret < 0) {
@@ -101,9 +281,15 @@ posix_io_uring_ctx_init(call_frame_t *frame, xlator_t *this, fd_t *fd, int op,
         goto err;
     }
     ctx->_fd = pfd->fd;
+    ctx->uring = posix_io_uring_get_ring(priv, pfd->fd);
+
+    /* statx cannot be issued on a fixed file */
+    if (op != GF_FOP_FSTAT)
+        ctx->fixed = posix_io_uring_fixed_file(this, ctx->uring, pfd);
 
     /* TODO: Explore filling up pre and post bufs using IOSQE_IO_LINK*/
-    if ((op == GF_FOP_WRITE) || (op == GF_FOP_FSYNC)) {
+    if ((op == GF_FOP_WRITE) || (op == GF_FOP_FSYNC) ||
+        (op == GF_FOP_FALLOCATE) || (op == GF_FOP_DISCARD)) {
         if (posix_fdstat(this, fd->inode, pfd->fd, &ctx->prebuf) != 0) {
             *op_errno = errno;
             gf_msg(this->name, GF_LOG_ERROR, *op_errno, P_MSG_FSTAT_FAILED,
@@ -197,20 +383,37 @@ out:
 static void
 posix_prep_readv(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
 {
+    struct posix_private *priv = ctx->frame->this->private;
+    int idx = -1;
+
+    idx = posix_io_uring_fixed_buf(priv, ctx->uring,
+                                   ctx->fop.read.iovec.iov_base,
+                                   ctx->fop.read.iovec.iov_len);
+    if (idx >= 0)
+        io_uring_prep_read_fixed(sqe, ctx->_fd, ctx->fop.read.iovec.iov_base,
+                                 ctx->fop.read.iovec.iov_len,
+                                 ctx->fop.read.offset, idx);
+    else
+        io_uring_prep_readv(sqe, ctx->_fd, &ctx->fop.read.iovec, 1,
+                            ctx->fop.read.offset);
     sqe->flags |= IOSQE_ASYNC;
-    io_uring_prep_readv(sqe, ctx->_fd, &ctx->fop.read.iovec, 1,
-                        ctx->fop.read.offset);
+    posix_io_uring_set_fixed_file(sqe, ctx);
 }
 
-int
-posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
-                     off_t offset, uint32_t flags, dict_t *xdata)
+static int
+__posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       size_t size, off_t offset, uint32_t flags,
+                       dict_t *xdata)
 {
+    struct posix_private *priv = this->private;
     struct posix_uring_ctx *ctx = NULL;
     int32_t op_errno = ENOMEM;
     struct iobuf *iobuf = NULL;
     int ret = 0;
 
+    if (priv->io_uring_iopoll && !posix_io_uring_can_poll(this, fd))
+        return posix_readv(frame, this, fd, size, offset, flags, xdata);
+
     ctx = posix_io_uring_ctx_init(
         frame, this, fd, GF_FOP_READ, posix_prep_readv,
         posix_io_uring_readv_complete, &op_errno, xdata);
@@ -313,19 +516,38 @@ out:
 static void
 posix_prep_writev(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
 {
-    io_uring_prep_writev(sqe, ctx->_fd, ctx->fop.write.iov,
-                         ctx->fop.write.count, ctx->fop.write.offset);
+    struct posix_private *priv = ctx->frame->this->private;
+    struct iovec *iov = ctx->fop.write.iov;
+    int idx = -1;
+
+    if (ctx->fop.write.count == 1)
+        idx = posix_io_uring_fixed_buf(priv, ctx->uring, iov->iov_base,
+                                       iov->iov_len);
+    if (idx >= 0)
+        io_uring_prep_write_fixed(sqe, ctx->_fd, iov->iov_base, iov->iov_len,
+                                  ctx->fop.write.offset, idx);
+    else
+        io_uring_prep_writev(sqe, ctx->_fd, ctx->fop.write.iov,
+                             ctx->fop.write.count, ctx->fop.write.offset);
+    posix_io_uring_set_fixed_file(sqe, ctx);
 }
 
-int
-posix_io_uring_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
-                      struct iovec *iov, int count, off_t offset,
-                      uint32_t flags, struct iobref *iobref, dict_t *xdata)
+static int
+__posix_io_uring_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                        struct iovec *iov, int count, off_t offset,
+                        uint32_t flags, struct iobref *iobref, dict_t *xdata)
 {
+    struct posix_private *priv = this->private;
     struct posix_uring_ctx *ctx = NULL;
     int32_t op_errno = ENOMEM;
     int ret = 0;
 
+    /* spliced payloads live in a pipe, not in memory */
+    if (iobref_spliced(iobref) ||
+        (priv->io_uring_iopoll && !posix_io_uring_can_poll(this, fd)))
+        return posix_writev(frame, this, fd, iov, count, offset, flags, iobref,
+                            xdata);
+
     ctx = posix_io_uring_ctx_init(
         frame, this, fd, GF_FOP_WRITE, posix_prep_writev,
         posix_io_uring_writev_complete, &op_errno, xdata);
@@ -406,11 +628,12 @@ static void
 posix_prep_fsync(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
 {
     io_uring_prep_fsync(sqe, ctx->_fd, ctx->fop.fsync.datasync);
+    posix_io_uring_set_fixed_file(sqe, ctx);
 }
 
-int
-posix_io_uring_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd,
-                     int32_t datasync, dict_t *xdata)
+static int
+__posix_io_uring_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       int32_t datasync, dict_t *xdata)
 {
     struct posix_uring_ctx *ctx = NULL;
     int32_t op_errno = ENOMEM;
@@ -444,19 +667,510 @@ err:
     return 0;
 }
 
+static void
+posix_io_uring_fallocate_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt postbuf = {
+        0,
+    };
+    fd_t *fd = NULL;
+    int _fd = -1;
+    int ret = 0;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    fd = ctx->fd;
+    _fd = ctx->_fd;
+
+    if (res < 0) {
+        op_ret = -1;
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FALLOCATE_FAILED,
+               "fallocate(async) failed on %s offset: %jd, len:%zu, "
+               "flags: %d",
+               uuid_utoa(fd->inode->gfid), ctx->fop.fallocate.offset,
+               ctx->fop.fallocate.len, ctx->fop.fallocate.mode);
+        goto out;
+    }
+
+    ret = posix_fdstat(this, fd->inode, _fd, &postbuf);
+    if (ret != 0) {
+        op_ret = -1;
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSTAT_FAILED,
+               "fstat failed on fd=%d", _fd);
+        goto out;
+    }
+
+    posix_set_ctime(frame, this, NULL, _fd, fd->inode, &postbuf);
+
+    op_ret = 0;
+    op_errno = 0;
+out:
+    if (ctx->op == GF_FOP_DISCARD)
+        STACK_UNWIND_STRICT(discard, frame, op_ret, op_errno, &ctx->prebuf,
+                            &postbuf, NULL);
+    else
+        STACK_UNWIND_STRICT(fallocate, frame, op_ret, op_errno, &ctx->prebuf,
+                            &postbuf, NULL);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_fallocate(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_fallocate(sqe, ctx->_fd, ctx->fop.fallocate.mode,
+                            ctx->fop.fallocate.offset, ctx->fop.fallocate.len);
+    posix_io_uring_set_fixed_file(sqe, ctx);
+}
+
 static int
-posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx)
+posix_io_uring_do_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                            int op, int32_t mode, off_t offset, size_t len,
+                            dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, op, posix_prep_fallocate,
+                                  posix_io_uring_fallocate_complete, &op_errno,
+                                  xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    ctx->fop.fallocate.mode = mode;
+    ctx->fop.fallocate.offset = offset;
+    ctx->fop.fallocate.len = len;
+
+    ret = posix_io_uring_submit(this, ctx);
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
+               "Failed to submit sqe");
+        op_errno = -ret;
+        goto err;
+    }
+    if (ret == 0) {
+        gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
+               "submit sqe got zero");
+    }
+    return 0;
+err:
+    posix_io_uring_ctx_free(ctx);
+    return -op_errno;
+}
+
+static int32_t
+__posix_io_uring_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                           int32_t keep_size, off_t offset, size_t len,
+                           dict_t *xdata)
 {
     struct posix_private *priv = this->private;
+    int32_t mode = 0;
+    int ret = 0;
+
+    /* storage.reserve accounting, atomic updates and cloudsync all need
+     * the synchronous path */
+    if (xdata || priv->disk_reserve)
+        return posix_glfallocate(frame, this, fd, keep_size, offset, len,
+                                 xdata);
+
+    if (keep_size)
+        mode = FALLOC_FL_KEEP_SIZE;
+
+    ret = posix_io_uring_do_fallocate(frame, this, fd, GF_FOP_FALLOCATE, mode,
+                                      offset, len, xdata);
+    if (ret < 0)
+        STACK_UNWIND_STRICT(fallocate, frame, -1, -ret, NULL, NULL, NULL);
+    return 0;
+}
+
+static int32_t
+__posix_io_uring_discard(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         off_t offset, size_t len, dict_t *xdata)
+{
+    int ret = 0;
+
+    if (xdata)
+        return posix_discard(frame, this, fd, offset, len, xdata);
+
+    ret = posix_io_uring_do_fallocate(frame, this, fd, GF_FOP_DISCARD,
+                                      FALLOC_FL_KEEP_SIZE |
+                                          FALLOC_FL_PUNCH_HOLE,
+                                      offset, len, xdata);
+    if (ret < 0)
+        STACK_UNWIND_STRICT(discard, frame, -1, -ret, NULL, NULL, NULL);
+    return 0;
+}
+
+static void
+posix_statx_to_stat(struct statx *stx, struct stat *st)
+{
+    st->st_dev = makedev(stx->stx_dev_major, stx->stx_dev_minor);
+    st->st_ino = stx->stx_ino;
+    st->st_mode = stx->stx_mode;
+    st->st_nlink = stx->stx_nlink;
+    st->st_uid = stx->stx_uid;
+    st->st_gid = stx->stx_gid;
+    st->st_rdev = makedev(stx->stx_rdev_major, stx->stx_rdev_minor);
+    st->st_size = stx->stx_size;
+    st->st_blksize = stx->stx_blksize;
+    st->st_blocks = stx->stx_blocks;
+    st->st_atim.tv_sec = stx->stx_atime.tv_sec;
+    st->st_atim.tv_nsec = stx->stx_atime.tv_nsec;
+    st->st_mtim.tv_sec = stx->stx_mtime.tv_sec;
+    st->st_mtim.tv_nsec = stx->stx_mtime.tv_nsec;
+    st->st_ctim.tv_sec = stx->stx_ctime.tv_sec;
+    st->st_ctim.tv_nsec = stx->stx_ctime.tv_nsec;
+}
+
+static void
+posix_io_uring_fstat_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct iatt buf = {
+        0,
+    };
+    struct stat fstatbuf = {
+        0,
+    };
+    dict_t *xattr_rsp = NULL;
+    fd_t *fd = NULL;
+    int _fd = -1;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    fd = ctx->fd;
+    _fd = ctx->_fd;
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FSTAT_FAILED,
+               "fstat(async) failed on fd=%p", fd);
+        goto out;
+    }
+
+    posix_statx_to_stat(&ctx->fop.fstat.stx, &fstatbuf);
+    op_ret = posix_fdstat_from_stat(this, fd->inode, _fd, &fstatbuf, &buf);
+    if (op_ret == -1) {
+        op_errno = errno;
+        gf_msg(this->name, GF_LOG_ERROR, errno, P_MSG_FSTAT_FAILED,
+               "fstat failed on fd=%p", fd);
+        goto out;
+    }
+
+    if (ctx->xdata) {
+        xattr_rsp = posix_xattr_fill(this, NULL, NULL, fd, _fd, ctx->xdata,
+                                     &buf);
+
+        op_ret = posix_cs_maintenance(this, fd, NULL, &_fd, &buf, NULL,
+                                      ctx->xdata, &xattr_rsp, _gf_false);
+        if (op_ret < 0) {
+            gf_msg(this->name, GF_LOG_ERROR, 0, 0,
+                   "file state check failed, fd %p", fd);
+        }
+        posix_cs_build_xattr_rsp(this, &xattr_rsp, ctx->xdata, _fd, NULL);
+    }
+
+    posix_update_iatt_buf(&buf, _fd, NULL, ctx->xdata);
+    op_ret = 0;
+out:
+    STACK_UNWIND_STRICT(fstat, frame, op_ret, op_errno, &buf, xattr_rsp);
+    if (xattr_rsp)
+        dict_unref(xattr_rsp);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_fstat(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    io_uring_prep_statx(sqe, ctx->_fd, "", AT_EMPTY_PATH, STATX_BASIC_STATS,
+                        &ctx->fop.fstat.stx);
+}
+
+static int32_t
+__posix_io_uring_fstat(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       dict_t *xdata)
+{
+    struct posix_uring_ctx *ctx = NULL;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_FSTAT,
+                                  posix_prep_fstat,
+                                  posix_io_uring_fstat_complete, &op_errno,
+                                  xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    ret = posix_io_uring_submit(this, ctx);
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
+               "Failed to submit sqe");
+        op_errno = -ret;
+        goto err;
+    }
+    if (ret == 0) {
+        gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
+               "submit sqe got zero");
+    }
+    return 0;
+err:
+    posix_io_uring_ctx_free(ctx);
+    STACK_UNWIND_STRICT(fstat, frame, -1, op_errno, NULL, NULL);
+    return 0;
+}
+
+static void
+posix_io_uring_open_complete(struct posix_uring_ctx *ctx, int32_t res)
+{
+    call_frame_t *frame = NULL;
+    xlator_t *this = NULL;
+    struct posix_fd *pfd = NULL;
+    fd_t *fd = NULL;
+    int op_ret = -1;
+    int op_errno = 0;
+
+    frame = ctx->frame;
+    this = frame->this;
+    fd = ctx->fd;
+
+    if (res < 0) {
+        op_errno = -res;
+        gf_msg(this->name, GF_LOG_ERROR, op_errno, P_MSG_FILE_OP_FAILED,
+               "open(async) on gfid-handle %s, flags: %d",
+               ctx->fop.open.real_path, ctx->fop.open.flags);
+        goto out;
+    }
+
+    posix_set_ctime(frame, this, ctx->fop.open.real_path, -1, fd->inode,
+                    &ctx->fop.open.stbuf);
+
+    pfd = GF_CALLOC(1, sizeof(*pfd), gf_posix_mt_posix_fd);
+    if (!pfd) {
+        op_errno = ENOMEM;
+        sys_close(res);
+        goto out;
+    }
+
+    pfd->flags = ctx->fop.open.flags;
+    pfd->fd = res;
+
+    if (fd_ctx_set(fd, this, (uint64_t)(long)pfd))
+        gf_msg(this->name, GF_LOG_WARNING, 0, P_MSG_FD_PATH_SETTING_FAILED,
+               "failed to set the fd context gfid-handle=%s fd=%p",
+               ctx->fop.open.real_path, fd);
+
+    op_ret = 0;
+out:
+    STACK_UNWIND_STRICT(open, frame, op_ret, op_errno, fd, NULL);
+    posix_io_uring_ctx_free(ctx);
+}
+
+static void
+posix_prep_open(struct io_uring_sqe *sqe, struct posix_uring_ctx *ctx)
+{
+    struct posix_private *priv = ctx->frame->this->private;
+
+    io_uring_prep_openat(sqe, AT_FDCWD, ctx->fop.open.real_path,
+                         ctx->fop.open.flags, priv->force_create_mode);
+}
+
+static int32_t
+__posix_io_uring_open(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                      int32_t flags, fd_t *fd, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring_ctx *ctx = NULL;
+    char *real_path = NULL;
+    struct iatt stbuf = {
+        0,
+    };
+    int32_t op_ret = -1;
+    int32_t op_errno = ENOMEM;
+    int ret = 0;
+
+    /* creation (storage.reserve) and cloudsync handling, as well as
+     * special files, stay on the synchronous path */
+    if ((flags & O_CREAT) || xdata ||
+        (loc->inode && ((loc->inode->ia_type == IA_IFBLK) ||
+                        (loc->inode->ia_type == IA_IFCHR))))
+        return posix_open(frame, this, loc, flags, fd, xdata);
+
+    MAKE_INODE_HANDLE(real_path, this, loc, &stbuf);
+    if (!real_path) {
+        op_errno = ESTALE;
+        goto err;
+    }
+
+    if (IA_ISLNK(stbuf.ia_type)) {
+        op_errno = ELOOP;
+        goto err;
+    }
+
+    ctx = posix_io_uring_ctx_init(frame, this, fd, GF_FOP_OPEN,
+                                  posix_prep_open, posix_io_uring_open_complete,
+                                  &op_errno, xdata);
+    if (!ctx) {
+        goto err;
+    }
+
+    if (priv->o_direct)
+        flags |= O_DIRECT;
+
+    /* the handle path lives on our stack, while the kernel may only look
+     * at it once the request is punted to its workers */
+    ctx->fop.open.real_path = gf_strdup(real_path);
+    if (!ctx->fop.open.real_path) {
+        op_errno = ENOMEM;
+        goto err;
+    }
+    ctx->fop.open.flags = flags;
+    ctx->fop.open.stbuf = stbuf;
+
+    ret = posix_io_uring_submit(this, ctx);
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
+               "Failed to submit sqe");
+        op_errno = -ret;
+        goto err;
+    }
+    if (ret == 0) {
+        gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
+               "submit sqe got zero");
+    }
+    return 0;
+err:
+    posix_io_uring_ctx_free(ctx);
+    STACK_UNWIND_STRICT(open, frame, op_ret, op_errno, fd, NULL);
+    return 0;
+}
+
+int
+posix_io_uring_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
+                     off_t offset, uint32_t flags, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+
+    if (!posix_io_uring_enter(priv))
+        return posix_readv(frame, this, fd, size, offset, flags, xdata);
+
+    __posix_io_uring_readv(frame, this, fd, size, offset, flags, xdata);
+    posix_io_uring_exit(priv);
+    return 0;
+}
+
+int
+posix_io_uring_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                      struct iovec *iov, int count, off_t offset,
+                      uint32_t flags, struct iobref *iobref, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+
+    if (!posix_io_uring_enter(priv))
+        return posix_writev(frame, this, fd, iov, count, offset, flags, iobref,
+                            xdata);
+
+    __posix_io_uring_writev(frame, this, fd, iov, count, offset, flags,
+                            iobref, xdata);
+    posix_io_uring_exit(priv);
+    return 0;
+}
+
+int
+posix_io_uring_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     int32_t datasync, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+
+    if (!posix_io_uring_enter(priv))
+        return posix_fsync(frame, this, fd, datasync, xdata);
+
+    __posix_io_uring_fsync(frame, this, fd, datasync, xdata);
+    posix_io_uring_exit(priv);
+    return 0;
+}
+
+int32_t
+posix_io_uring_fallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                         int32_t keep_size, off_t offset, size_t len,
+                         dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+
+    if (!posix_io_uring_enter(priv))
+        return posix_glfallocate(frame, this, fd, keep_size, offset, len,
+                                 xdata);
+
+    __posix_io_uring_fallocate(frame, this, fd, keep_size, offset, len, xdata);
+    posix_io_uring_exit(priv);
+    return 0;
+}
+
+int32_t
+posix_io_uring_discard(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                       off_t offset, size_t len, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+
+    if (!posix_io_uring_enter(priv))
+        return posix_discard(frame, this, fd, offset, len, xdata);
+
+    __posix_io_uring_discard(frame, this, fd, offset, len, xdata);
+    posix_io_uring_exit(priv);
+    return 0;
+}
+
+int32_t
+posix_io_uring_fstat(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                     dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+
+    if (!posix_io_uring_enter(priv))
+        return posix_fstat(frame, this, fd, xdata);
+
+    __posix_io_uring_fstat(frame, this, fd, xdata);
+    posix_io_uring_exit(priv);
+    return 0;
+}
+
+int32_t
+posix_io_uring_open(call_frame_t *frame, xlator_t *this, loc_t *loc,
+                    int32_t flags, fd_t *fd, dict_t *xdata)
+{
+    struct posix_private *priv = this->private;
+
+    if (!posix_io_uring_enter(priv))
+        return posix_open(frame, this, loc, flags, fd, xdata);
+
+    __posix_io_uring_open(frame, this, loc, flags, fd, xdata);
+    posix_io_uring_exit(priv);
+    return 0;
+}
+
+static int
+posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx)
+{
+    struct posix_uring *uring = ctx->uring;
     struct io_uring_sqe *sqe = NULL;
     int ret = 0;
 
-    pthread_mutex_lock(&priv->sq_mutex);
+    pthread_mutex_lock(&uring->sq_mutex);
     {
-        sqe = io_uring_get_sqe(&priv->ring);
+        sqe = io_uring_get_sqe(&uring->ring);
         if (!sqe) {
             /*TODO: Retry until we get an sqe instead of failing. */
-            pthread_mutex_unlock(&priv->sq_mutex);
+            pthread_mutex_unlock(&uring->sq_mutex);
             ret = -EAGAIN;
             gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
                    "Failed to get sqe");
@@ -464,9 +1178,9 @@ posix_io_uring_submit(xlator_t *this, struct posix_uring_ctx *ctx)
         }
         ctx->prepare(sqe, ctx);
         io_uring_sqe_set_data(sqe, ctx);
-        ret = io_uring_submit(&priv->ring);
+        ret = io_uring_submit(&uring->ring);
     }
-    pthread_mutex_unlock(&priv->sq_mutex);
+    pthread_mutex_unlock(&uring->sq_mutex);
 
 out:
     return ret;
@@ -475,22 +1189,22 @@ out:
 static void *
 posix_io_uring_thread(void *data)
 {
+    struct posix_uring *uring = NULL;
     xlator_t *this = NULL;
-    struct posix_private *priv = NULL;
     int ret = 0;
     int32_t res = 0;
     struct io_uring_cqe *cqe = NULL;
     struct posix_uring_ctx *ctx = NULL;
 
-    this = data;
+    uring = data;
+    this = uring->this;
     THIS = this;
-    priv = this->private;
     while (1) {
-        pthread_mutex_lock(&priv->cq_mutex);
+        pthread_mutex_lock(&uring->cq_mutex);
         {
-            ret = io_uring_wait_cqe(&priv->ring, &cqe);
+            ret = io_uring_wait_cqe(&uring->ring, &cqe);
         }
-        pthread_mutex_unlock(&priv->cq_mutex);
+        pthread_mutex_unlock(&uring->cq_mutex);
         if (ret != 0) {
             if (ret == -EINTR)
                 continue;
@@ -500,39 +1214,129 @@ posix_io_uring_thread(void *data)
         }
 
         ctx = (struct posix_uring_ctx *)io_uring_cqe_get_data(cqe);
-        if (priv->uring_thread_exit == _gf_true && ctx == NULL)
+        if (uring->thread_exit == _gf_true && ctx == NULL)
             pthread_exit(NULL);
         res = cqe->res;
-        io_uring_cqe_seen(&priv->ring, cqe);
+        io_uring_cqe_seen(&uring->ring, cqe);
         ctx->unwind(ctx, res);
     }
 
     return NULL;
 }
 
-int
-posix_io_uring_init(xlator_t *this)
+/* Registration of fixed buffers and files is an optimization only: if the
+ * kernel refuses (old kernel, RLIMIT_MEMLOCK), requests are issued with
+ * plain user pointers and fds. */
+static void
+posix_io_uring_register(xlator_t *this, struct posix_uring *uring)
 {
-    int ret = -1;
-    unsigned flags = 0;
     struct posix_private *priv = this->private;
+    int ret = 0;
+    int i = 0;
+
+    /* each ring only uses the buffers registered with it */
+    uring->buf_count = 0;
+    if (priv->uring_buf_count > 0) {
+        ret = io_uring_register_buffers(&uring->ring, priv->uring_bufs,
+                                        priv->uring_buf_count);
+        if (ret < 0) {
+            gf_msg(this->name, GF_LOG_INFO, -ret, P_MSG_POSIX_IO_URING,
+                   "io_uring fixed buffers unavailable");
+        } else {
+            uring->buf_count = priv->uring_buf_count;
+        }
+    }
+
+    uring->files = GF_MALLOC(POSIX_URING_MAX_FILES * sizeof(int),
+                             gf_posix_mt_uring_files);
+    if (!uring->files)
+        return;
+    for (i = 0; i < POSIX_URING_MAX_FILES; i++)
+        uring->files[i] = -1;
+
+    ret = io_uring_register_files(&uring->ring, uring->files,
+                                  POSIX_URING_MAX_FILES);
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_INFO, -ret, P_MSG_POSIX_IO_URING,
+               "io_uring fixed files unavailable");
+        GF_FREE(uring->files);
+        uring->files = NULL;
+        return;
+    }
+    uring->file_count = POSIX_URING_MAX_FILES;
+    uring->file_hint = 0;
+}
 
-    // TODO:Try-out flags |= IORING_SETUP_IOPOLL;
-    ret = io_uring_queue_init(POSIX_URING_MAX_ENTRIES, &priv->ring, flags);
-    if (ret == -1) {
-        gf_msg(this->name, GF_LOG_ERROR, 0, P_MSG_POSIX_IO_URING,
+static void
+posix_io_uring_unregister(struct posix_uring *uring)
+{
+    if (uring->buf_count > 0) {
+        io_uring_unregister_buffers(&uring->ring);
+        uring->buf_count = 0;
+    }
+
+    pthread_mutex_lock(&uring->files_lock);
+    {
+        if (uring->files) {
+            io_uring_unregister_files(&uring->ring);
+            GF_FREE(uring->files);
+            uring->files = NULL;
+        }
+        uring->file_count = 0;
+    }
+    pthread_mutex_unlock(&uring->files_lock);
+}
+
+static int
+posix_io_uring_ring_init(xlator_t *this, struct posix_uring *uring, int index)
+{
+    struct posix_private *priv = this->private;
+    struct io_uring_params params = {
+        0,
+    };
+    int ret = -1;
+
+    if (priv->io_uring_sqpoll) {
+        params.flags |= IORING_SETUP_SQPOLL;
+        params.sq_thread_idle = priv->io_uring_sqpoll_idle;
+    }
+    if (priv->io_uring_iopoll)
+        params.flags |= IORING_SETUP_IOPOLL;
+
+    ret = io_uring_queue_init_params(POSIX_URING_MAX_ENTRIES, &uring->ring,
+                                     &params);
+    if (ret < 0 && (params.flags & IORING_SETUP_SQPOLL)) {
+        /* SQPOLL needs CAP_SYS_NICE on older kernels */
+        gf_msg(this->name, GF_LOG_WARNING, -ret, P_MSG_POSIX_IO_URING,
+               "io_uring SQPOLL setup failed, continuing without it.");
+        memset(&params, 0, sizeof(params));
+        if (priv->io_uring_iopoll)
+            params.flags |= IORING_SETUP_IOPOLL;
+        ret = io_uring_queue_init_params(POSIX_URING_MAX_ENTRIES, &uring->ring,
+                                         &params);
+    }
+    if (ret < 0) {
+        gf_msg(this->name, GF_LOG_ERROR, -ret, P_MSG_POSIX_IO_URING,
                "io_uring init failed.");
         goto out;
     }
 
-    pthread_mutex_init(&priv->sq_mutex, NULL);
-    pthread_mutex_init(&priv->cq_mutex, NULL);
-    ret = gf_thread_create(&priv->uring_thread, NULL, posix_io_uring_thread,
-                           this, "posix-iouring");
+    uring->this = this;
+    uring->thread_exit = _gf_false;
+    pthread_mutex_init(&uring->sq_mutex, NULL);
+    pthread_mutex_init(&uring->cq_mutex, NULL);
+    pthread_mutex_init(&uring->files_lock, NULL);
+
+    posix_io_uring_register(this, uring);
+
+    ret = gf_thread_create(&uring->thread, NULL, posix_io_uring_thread, uring,
+                           "posix-iouring%d", index);
     if (ret != 0) {
-        io_uring_queue_exit(&priv->ring);
-        pthread_mutex_destroy(&priv->sq_mutex);
-        pthread_mutex_destroy(&priv->cq_mutex);
+        posix_io_uring_unregister(uring);
+        io_uring_queue_exit(&uring->ring);
+        pthread_mutex_destroy(&uring->sq_mutex);
+        pthread_mutex_destroy(&uring->cq_mutex);
+        pthread_mutex_destroy(&uring->files_lock);
         goto out;
     }
 
@@ -541,21 +1345,83 @@ out:
 }
 
 static int
-posix_io_uring_drain(struct posix_private *priv)
+posix_io_uring_drain(struct posix_uring *uring)
 {
     struct io_uring_sqe *sqe = NULL;
     int ret = -1;
 
-    priv->uring_thread_exit = _gf_true;
-    sqe = io_uring_get_sqe(&priv->ring);
-    if (!sqe)
-        return ret;
+    /* On IOPOLL rings older kernels fail the nop with -EINVAL, which still
+     * posts the NULL completion the reaper is waiting for. */
+    uring->thread_exit = _gf_true;
+    pthread_mutex_lock(&uring->sq_mutex);
+    {
+        /* the reaper must get the nop, so wait for room in a full ring */
+        while (!(sqe = io_uring_get_sqe(&uring->ring))) {
+            (void)io_uring_submit(&uring->ring);
+            sched_yield();
+        }
+        io_uring_sqe_set_flags(sqe, IOSQE_IO_DRAIN);
+        io_uring_sqe_set_data(sqe, NULL);
+        io_uring_prep_nop(sqe);
+        ret = io_uring_submit(&uring->ring);
+    }
+    pthread_mutex_unlock(&uring->sq_mutex);
+
+    return ret;
+}
+
+static void
+posix_io_uring_ring_fini(struct posix_uring *uring)
+{
+    posix_io_uring_drain(uring);
+    (void)pthread_join(uring->thread, NULL);
+    posix_io_uring_unregister(uring);
+    io_uring_queue_exit(&uring->ring);
+    pthread_mutex_destroy(&uring->sq_mutex);
+    pthread_mutex_destroy(&uring->cq_mutex);
+    pthread_mutex_destroy(&uring->files_lock);
+}
+
+int
+posix_io_uring_init(xlator_t *this)
+{
+    struct posix_private *priv = this->private;
+    struct posix_uring *rings = NULL;
+    int ret = -1;
+    int i = 0;
+
+    rings = GF_CALLOC(priv->io_uring_rings, sizeof(*rings),
+                      gf_posix_mt_uring_ring);
+    if (!rings)
+        goto out;
+
+    priv->uring_buf_count = iobuf_pool_pin_arenas(
+        this->ctx->iobuf_pool, priv->uring_bufs, POSIX_URING_MAX_BUFS);
+
+    for (i = 0; i < priv->io_uring_rings; i++) {
+        ret = posix_io_uring_ring_init(this, &rings[i], i);
+        if (ret != 0)
+            break;
+    }
+    if (ret != 0) {
+        while (--i >= 0)
+            posix_io_uring_ring_fini(&rings[i]);
+        GF_FREE(rings);
+        goto out;
+    }
 
-    io_uring_sqe_set_flags(sqe, IOSQE_IO_DRAIN);
-    io_uring_sqe_set_data(sqe, NULL);
-    io_uring_prep_nop(sqe);
-    ret = io_uring_submit(&priv->ring);
+    pthread_rwlock_wrlock(&priv->uring_lock);
+    {
+        priv->rings = rings;
+        priv->uring_count = priv->io_uring_rings;
+    }
+    pthread_rwlock_unlock(&priv->uring_lock);
 
+    gf_msg(this->name, GF_LOG_INFO, 0, P_MSG_POSIX_IO_URING,
+           "io_uring enabled with %d ring(s)%s%s", priv->io_uring_rings,
+           priv->io_uring_sqpoll ? ", sqpoll" : "",
+           priv->io_uring_iopoll ? ", iopoll" : "");
+out:
     return ret;
 }
 
@@ -563,12 +1429,27 @@ void
 posix_io_uring_fini(xlator_t *this)
 {
     struct posix_private *priv = this->private;
+    struct posix_uring *rings = NULL;
+    int count = 0;
+    int i = 0;
+
+    /* Once the write lock is taken no fop is submitting to the rings, and
+     * the ones coming later see no rings and stay synchronous. */
+    pthread_rwlock_wrlock(&priv->uring_lock);
+    {
+        rings = priv->rings;
+        count = priv->uring_count;
+        priv->rings = NULL;
+        priv->uring_count = 0;
+    }
+    pthread_rwlock_unlock(&priv->uring_lock);
 
-    posix_io_uring_drain(priv);
-    (void)pthread_join(priv->uring_thread, NULL);
-    io_uring_queue_exit(&priv->ring);
-    pthread_mutex_destroy(&priv->sq_mutex);
-    pthread_mutex_destroy(&priv->cq_mutex);
+    /* The requests already submitted are completed and unwound by the
+     * reapers before they exit. */
+    for (i = 0; i < count; i++)
+        posix_io_uring_ring_fini(&rings[i]);
+
+    GF_FREE(rings);
 }
 
 int
@@ -591,7 +1472,14 @@ posix_io_uring_on(xlator_t *this)
     if (priv->io_uring_capable) {
         this->fops->readv = posix_io_uring_readv;
         this->fops->writev = posix_io_uring_writev;
-        this->fops->fsync = posix_io_uring_fsync;
+        /* a polled ring only completes O_DIRECT reads and writes */
+        if (!priv->io_uring_iopoll) {
+            this->fops->fsync = posix_io_uring_fsync;
+            this->fops->open = posix_io_uring_open;
+            this->fops->fstat = posix_io_uring_fstat;
+            this->fops->fallocate = posix_io_uring_fallocate;
+            this->fops->discard = posix_io_uring_discard;
+        }
         ret = 0;
     }
 
@@ -611,9 +1499,16 @@ posix_io_uring_off(xlator_t *this)
     this->fops->readv = posix_readv;
     this->fops->writev = posix_writev;
     this->fops->fsync = posix_fsync;
+    this->fops->open = posix_open;
+    this->fops->fstat = posix_fstat;
+    this->fops->fallocate = posix_glfallocate;
+    this->fops->discard = posix_discard;
     if (priv->io_uring_capable)
         posix_io_uring_fini(this);
 
+    priv->io_uring_capable = _gf_false;
+    priv->io_uring_init_done = _gf_false;
+
     return 0;
 }
 
@@ -633,4 +1528,10 @@ posix_io_uring_off(xlator_t *this)
     return 0;
 }
 
+void
+posix_io_uring_fd_release(xlator_t *this, struct posix_fd *pfd)
+{
+    return;
+}
+
 #endif
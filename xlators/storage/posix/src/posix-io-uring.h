@@ -11,12 +11,43 @@
 #define _POSIX_IO_URING_H
 
 #define POSIX_URING_MAX_ENTRIES 512
+/* iobuf arenas registered with the ring as fixed buffers */
+#define POSIX_URING_MAX_BUFS 64
+/* size of the fixed file table of each ring */
+#define POSIX_URING_MAX_FILES 4096
+#define POSIX_URING_MAX_RINGS 64
+/* msecs, io-uring-sqpoll-idle is read as an unsigned value */
+#define POSIX_URING_MAX_SQPOLL_IDLE 3600000
+
+struct posix_fd;
+
+#ifdef HAVE_LIBURING
+/* One submission/completion ring with its own reaper thread */
+struct posix_uring {
+    struct io_uring ring;
+    pthread_mutex_t sq_mutex;
+    pthread_mutex_t cq_mutex;
+    pthread_t thread;
+    gf_boolean_t thread_exit;
+    xlator_t *this;
+    int buf_count; /* iobuf arenas registered as fixed buffers */
+    /* fixed file table, -1 marks a free slot */
+    int *files;
+    int file_count;
+    int file_hint;
+    pthread_mutex_t files_lock;
+};
+#endif
+
 int
 posix_io_uring_on(xlator_t *this);
 
 int
 posix_io_uring_off(xlator_t *this);
 
+void
+posix_io_uring_fd_release(xlator_t *this, struct posix_fd *pfd);
+
 #ifdef HAVE_LIBURING
 int
 posix_readv(call_frame_t *frame, xlator_t *this, fd_t *fd, size_t size,
@@ -26,6 +57,25 @@ int
 posix_writev(call_frame_t *frame, xlator_t *this, fd_t *fd,
              struct iovec *vector, int32_t count, off_t offset, uint32_t flags,
              struct iobref *iobref, dict_t *xdata);
+
+int32_t
+posix_fsync(call_frame_t *frame, xlator_t *this, fd_t *fd, int32_t datasync,
+            dict_t *xdata);
+
+int32_t
+posix_open(call_frame_t *frame, xlator_t *this, loc_t *loc, int32_t flags,
+           fd_t *fd, dict_t *xdata);
+
+int32_t
+posix_fstat(call_frame_t *frame, xlator_t *this, fd_t *fd, dict_t *xdata);
+
+int32_t
+posix_glfallocate(call_frame_t *frame, xlator_t *this, fd_t *fd,
+                  int32_t keep_size, off_t offset, size_t len, dict_t *xdata);
+
+int32_t
+posix_discard(call_frame_t *frame, xlator_t *this, fd_t *fd, off_t offset,
+              size_t len, dict_t *xdata);
 #endif
 
 #endif /* _POSIX_IO_URING_H */
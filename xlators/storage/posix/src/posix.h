@@ -131,7 +131,7 @@ struct posix_fd {
     struct list_head list; /* to add to the janitor list */
     int odirect;
     xlator_t *xl;
-    char _pad[4]; /* manual padding */
+    int fixed_file; /* io_uring registered file slot + 1, 0 if none */
 };
 
 struct posix_diskxl {
@@ -155,6 +155,7 @@ struct posix_private {
 
     gf_atomic_t read_value;  /* Total read, from init */
     gf_atomic_t write_value; /* Total write, from init */
+    gf_atomic_t spliced_writes; /* writes of a payload left in a pipe */
 
     /* janitor task which cleans up /.trash (created by replicate) */
     struct gf_tw_timer_list *janitor;
@@ -268,14 +269,20 @@ struct posix_private {
 
     /*io_uring related.*/
     gf_boolean_t io_uring_configured;
+    gf_boolean_t io_uring_sqpoll;
+    gf_boolean_t io_uring_iopoll;
+    uint32_t io_uring_sqpoll_idle; /* msecs before the SQ thread sleeps */
+    int32_t io_uring_rings;        /* configured number of rings */
 #ifdef HAVE_LIBURING
-    struct io_uring ring;
+    /* write-locked to set up or tear down the rings */
+    pthread_rwlock_t uring_lock;
+    struct posix_uring *rings;
+    int uring_count; /* rings currently set up */
     gf_boolean_t io_uring_init_done;
     gf_boolean_t io_uring_capable;
-    gf_boolean_t uring_thread_exit;
-    pthread_t uring_thread;
-    pthread_mutex_t sq_mutex;
-    pthread_mutex_t cq_mutex;
+    /* iobuf arenas registered as fixed buffers */
+    struct iovec uring_bufs[POSIX_URING_MAX_BUFS];
+    int uring_buf_count;
 #endif
     void *pxl;
 };
@@ -350,6 +357,9 @@ posix_gfid_set(xlator_t *this, const char *path, loc_t *loc, dict_t *xattr_req,
 int
 posix_fdstat(xlator_t *this, inode_t *inode, int fd, struct iatt *stbuf_p);
 int
+posix_fdstat_from_stat(xlator_t *this, inode_t *inode, int fd,
+                       struct stat *fstatbuf, struct iatt *stbuf_p);
+int
 posix_istat(xlator_t *this, inode_t *inode, uuid_t gfid, const char *basename,
             struct iatt *iatt);
 int
@@ -679,6 +689,9 @@ int
 posix_cs_maintenance(xlator_t *this, fd_t *fd, loc_t *loc, int *pfd,
                      struct iatt *buf, const char *realpath, dict_t *xattr_req,
                      dict_t **xattr_rsp, gf_boolean_t ignore_failure);
+void
+posix_cs_build_xattr_rsp(xlator_t *this, dict_t **rsp, dict_t *req, int fd,
+                         char *loc);
 int
 posix_check_dev_file(xlator_t *this, inode_t *inode, char *fop, int *op_errno);
 